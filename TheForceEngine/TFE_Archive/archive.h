@@ -60,6 +60,10 @@ public:
 	virtual size_t readFile(void *data, size_t size) = 0;
 	virtual bool seekFile(s32 offset, s32 origin = SEEK_SET) = 0;
 	virtual size_t getLocInFile() = 0;
+	// Direct read-only access to the file contents when the archive is memory resident or mapped,
+	// returns null if the data is not directly addressable - use openFile()/readFile() instead.
+	// The pointer is valid until the archive is closed or modified.
+	virtual const u8* getFileData(u32 index, size_t* size) { return nullptr; }
 
 	// Directory
 	virtual u32 getFileCount() = 0;
@@ -2,10 +2,25 @@
 
 #include <TFE_System/system.h>
 #include "gobArchive.h"
+#include <TFE_FileSystem/paths.h>
 #include <assert.h>
 #include <algorithm>
+#include <cctype>
 #include <vector>
 
+namespace
+{
+	std::string toLowerKey(const char* name, size_t maxLen)
+	{
+		std::string key;
+		for (size_t i = 0; i < maxLen && name[i]; i++)
+		{
+			key.push_back((char)tolower((u8)name[i]));
+		}
+		return key;
+	}
+}
+
 GobArchive::~GobArchive()
 {
 	close();
@@ -62,30 +77,91 @@ bool GobArchive::validate(const char *archivePath, s32 minFileCount)
 
 bool GobArchive::open(const char *archivePath)
 {
-	m_archiveOpen = m_file.open(archivePath, Stream::MODE_READ);
 	m_curFile = -1;
-	if (!m_archiveOpen) { return false; }
+	m_archiveOpen = false;
 
-	// Read the directory.
-	m_file.readBuffer(&m_header, sizeof(GOB_Header_t));
-	m_file.seek(m_header.MASTERX);
+	// Map the archive so file reads become memory copies and loaders can parse directly from the mapping.
+	// The mapping lives as long as the archive is open, so the file must not be rewritten or truncated while it
+	// is mounted - on POSIX systems touching pages past the new end of the file raises SIGBUS. addFile() unmaps
+	// the archive before writing it and switches to buffered reads from then on, other tools must close the
+	// archive (or remove it from the search paths) before writing to it.
+	if (FileUtil::mapFile(archivePath, &m_mapping))
+	{
+		m_archiveOpen = readMappedDirectory();
+		if (!m_archiveOpen)
+		{
+			TFE_System::logWrite(LOG_WARNING, "GOB", "Cannot use the mapped directory of \"%s\", falling back to file reads.", archivePath);
+			FileUtil::unmapFile(&m_mapping);
+		}
+	}
+
+	if (!m_archiveOpen)
+	{
+		m_archiveOpen = m_file.open(archivePath, Stream::MODE_READ);
+		if (!m_archiveOpen) { return false; }
 
-	m_file.readBuffer(&m_fileList.MASTERN, sizeof(u32));
-	m_fileList.entries = new GOB_Entry_t[m_fileList.MASTERN];
-	m_file.readBuffer(m_fileList.entries, sizeof(GOB_Entry_t), m_fileList.MASTERN);
+		// Read the directory.
+		m_file.readBuffer(&m_header, sizeof(GOB_Header_t));
+		m_file.seek(m_header.MASTERX);
+
+		m_file.readBuffer(&m_fileList.MASTERN, sizeof(u32));
+		m_fileList.entries = new GOB_Entry_t[m_fileList.MASTERN];
+		m_file.readBuffer(m_fileList.entries, sizeof(GOB_Entry_t), m_fileList.MASTERN);
+		m_file.close();
+	}
 
 	strcpy(m_archivePath, archivePath);
-	m_file.close();
+	buildIndex();
+	return true;
+}
+
+// Read the header and directory from the mapped archive, verifying that every entry lies inside of the mapping.
+bool GobArchive::readMappedDirectory()
+{
+	const u8* data = m_mapping.data;
+	const u64 size = m_mapping.size;
+	if (size < sizeof(GOB_Header_t)) { return false; }
+	memcpy(&m_header, data, sizeof(GOB_Header_t));
 
+	const u64 dirStart = u64(m_header.MASTERX) + sizeof(u32);
+	if (dirStart > size) { return false; }
+
+	u32 count;
+	memcpy(&count, data + m_header.MASTERX, sizeof(u32));
+	if (dirStart + u64(count) * sizeof(GOB_Entry_t) > size) { return false; }
+
+	const GOB_Entry_t* srcEntries = (const GOB_Entry_t*)(data + dirStart);
+	for (u32 i = 0; i < count; i++)
+	{
+		if (u64(srcEntries[i].IX) + u64(srcEntries[i].LEN) > size) { return false; }
+	}
+
+	m_fileList.MASTERN = count;
+	m_fileList.entries = new GOB_Entry_t[count];
+	memcpy(m_fileList.entries, srcEntries, sizeof(GOB_Entry_t) * count);
 	return true;
 }
 
+// Build the case-insensitive name lookup, if names are duplicated the first entry wins to match the original linear search.
+void GobArchive::buildIndex()
+{
+	m_index.clear();
+	m_index.reserve(m_fileList.MASTERN);
+	for (u32 i = 0; i < m_fileList.MASTERN; i++)
+	{
+		m_index.insert({ toLowerKey(m_fileList.entries[i].NAME, sizeof(m_fileList.entries[i].NAME)), i });
+	}
+}
+
 void GobArchive::close()
 {
 	m_file.close();
+	FileUtil::unmapFile(&m_mapping);
 	m_archiveOpen = false;
 	delete[] m_fileList.entries;
 	m_fileList.entries = nullptr;
+	m_fileList.MASTERN = 0;
+	m_index.clear();
 }
 
 // File Access
@@ -93,30 +169,15 @@ bool GobArchive::openFile(const char *file)
 {
 	if (!m_archiveOpen) { return false; }
 
-	m_file.open(m_archivePath, Stream::MODE_READ);
-	m_curFile = -1;
-	m_fileOffset = 0;
-
-	//search for this file.
-	for (u32 i = 0; i < m_fileList.MASTERN; i++)
-	{
-		if (strcasecmp(file, m_fileList.entries[i].NAME) == 0)
-		{
-			m_curFile = s32(i);
-			break;
-		}
-	}
-
-	if (m_curFile == -1)
+	const u32 index = getFileIndex(file);
+	if (index == INVALID_FILE)
 	{
-		m_file.close();
+		m_curFile = -1;
+		m_fileOffset = 0;
 		TFE_System::logWrite(LOG_ERROR, "GOB", "Failed to load \"%s\" from \"%s\"", file, m_archivePath);
+		return false;
 	}
-	else
-	{
-		m_file.seek(m_fileList.entries[m_curFile].IX);
-	}
-	return m_curFile > -1 ? true : false;
+	return openFile(index);
 }
 
 bool GobArchive::openFile(u32 index)
@@ -125,8 +186,11 @@ bool GobArchive::openFile(u32 index)
 
 	m_curFile = s32(index);
 	m_fileOffset = 0;
-	m_file.open(m_archivePath, Stream::MODE_READ);
-	m_file.seek(m_fileList.entries[m_curFile].IX);
+	if (!m_mapping.data)
+	{
+		m_file.open(m_archivePath, Stream::MODE_READ);
+		m_file.seek(m_fileList.entries[m_curFile].IX);
+	}
 	return true;
 }
 
@@ -140,31 +204,15 @@ u32 GobArchive::getFileIndex(const char* file)
 {
 	if (!m_archiveOpen) { return INVALID_FILE; }
 
-	//search for this file.
-	for (u32 i = 0; i < m_fileList.MASTERN; i++)
-	{
-		if (strcasecmp(file, m_fileList.entries[i].NAME) == 0)
-		{
-			return i;
-		}
-	}
-	return INVALID_FILE;
+	const auto entry = m_index.find(toLowerKey(file, TFE_MAX_PATH));
+	return entry != m_index.end() ? entry->second : INVALID_FILE;
 }
 
 bool GobArchive::fileExists(const char *file)
 {
 	if (!m_archiveOpen) { return false; }
 	m_curFile = -1;
-
-	//search for this file.
-	for (u32 i = 0; i < m_fileList.MASTERN; i++)
-	{
-		if (strcasecmp(file, m_fileList.entries[i].NAME) == 0)
-		{
-			return true;
-		}
-	}
-	return false;
+	return getFileIndex(file) != INVALID_FILE;
 }
 
 bool GobArchive::fileExists(u32 index)
@@ -183,7 +231,16 @@ size_t GobArchive::readFile(void *data, size_t size)
 {
 	if (m_curFile < 0) { return false; }
 	if (size == 0) { size = m_fileList.entries[m_curFile].LEN; }
-	const size_t sizeToRead = std::min(size, (size_t)m_fileList.entries[m_curFile].LEN);
+	const GOB_Entry_t* entry = &m_fileList.entries[m_curFile];
+	if (m_mapping.data)
+	{
+		const size_t remaining = entry->LEN - (size_t)m_fileOffset;
+		const size_t sizeToRead = std::min(size, remaining);
+		memcpy(data, m_mapping.data + entry->IX + m_fileOffset, sizeToRead);
+		m_fileOffset += (s32)sizeToRead;
+		return sizeToRead;
+	}
+	const size_t sizeToRead = std::min(size, (size_t)entry->LEN);
 
 	u32 bytesRead = m_file.readBuffer(data, (u32)sizeToRead);
 	m_fileOffset += (s32)sizeToRead;
@@ -217,7 +274,10 @@ bool GobArchive::seekFile(s32 offset, s32 origin)
 		return false;
 	}
 
-	m_file.seek(m_fileList.entries[m_curFile].IX + m_fileOffset);
+	if (!m_mapping.data)
+	{
+		m_file.seek(m_fileList.entries[m_curFile].IX + m_fileOffset);
+	}
 	return true;
 }
 
@@ -226,6 +286,13 @@ size_t GobArchive::getLocInFile()
 	return m_fileOffset;
 }
 
+const u8* GobArchive::getFileData(u32 index, size_t* size)
+{
+	if (!m_mapping.data || index >= getFileCount()) { return nullptr; }
+	*size = m_fileList.entries[index].LEN;
+	return m_mapping.data + m_fileList.entries[index].IX;
+}
+
 // Directory
 u32 GobArchive::getFileCount()
 {
@@ -258,6 +325,7 @@ void GobArchive::addFile(const char* fileName, const char* filePath)
 	m_fileList.MASTERN++;
 	GOB_Entry_t* newEntries = new GOB_Entry_t[m_fileList.MASTERN];
 	memcpy(newEntries, m_fileList.entries, sizeof(GOB_Entry_t) * newId);
+	delete[] m_fileList.entries;
 	m_fileList.entries = newEntries;
 
 	GOB_Entry_t* newFile = &m_fileList.entries[newId];
@@ -269,7 +337,21 @@ void GobArchive::addFile(const char* fileName, const char* filePath)
 
 	// Read all of the file data.
 	std::vector<std::vector<u8>> fileData(m_fileList.MASTERN);
-	if (m_file.open(m_archivePath, Stream::MODE_READ) && m_fileList.MASTERN >= 1)
+	if (m_mapping.data)
+	{
+		for (u32 f = 0; f < m_fileList.MASTERN - 1; f++)
+		{
+			fileData[f].resize(m_fileList.entries[f].LEN);
+			memcpy(fileData[f].data(), m_mapping.data + m_fileList.entries[f].IX, m_fileList.entries[f].LEN);
+		}
+		// The file cannot be rewritten while it is mapped, see open().
+		FileUtil::unmapFile(&m_mapping);
+
+		fileData[newId].resize(len);
+		file.readBuffer(fileData[newId].data(), (u32)len);
+		file.close();
+	}
+	else if (m_file.open(m_archivePath, Stream::MODE_READ) && m_fileList.MASTERN >= 1)
 	{
 		for (u32 f = 0; f < m_fileList.MASTERN - 1; f++)
 		{
@@ -297,4 +379,9 @@ void GobArchive::addFile(const char* fileName, const char* filePath)
 		m_file.writeBuffer(m_fileList.entries, sizeof(GOB_Entry_t), m_fileList.MASTERN);
 		m_file.close();
 	}
+	m_curFile = -1;
+	m_index.insert({ toLowerKey(newFile->NAME, sizeof(newFile->NAME)), newId });
+	// The archive may already be in the file index.
+	TFE_Paths::invalidateFileIndex();
+	// The archive is not remapped, it is being edited and may be rewritten again - so keep using buffered reads.
 }
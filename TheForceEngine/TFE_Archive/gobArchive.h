@@ -2,7 +2,10 @@
 #include <TFE_System/types.h>
 #include <TFE_FileSystem/filestream.h>
 #include <TFE_FileSystem/paths.h>
+#include <TFE_FileSystem/fileutil.h>
 #include "archive.h"
+#include <string>
+#include <unordered_map>
 
 class GobMemoryArchive;
 
@@ -11,7 +14,7 @@ class GobArchive : public Archive
 public:
 	friend GobMemoryArchive;
 public:
-	GobArchive() : Archive(ARCHIVE_GOB), m_archiveOpen(false), m_curFile(-1) {}
+	GobArchive() : Archive(ARCHIVE_GOB), m_archiveOpen(false), m_curFile(-1) { m_fileList.MASTERN = 0; m_fileList.entries = nullptr; }
 	~GobArchive() override;
 
 	// Archive
@@ -32,6 +35,7 @@ public:
 	size_t readFile(void *data, size_t size) override;
 	bool seekFile(s32 offset, s32 origin = SEEK_SET) override;
 	size_t getLocInFile() override;
+	const u8* getFileData(u32 index, size_t* size) override;
 
 	// Directory
 	u32 getFileCount() override;
@@ -69,7 +73,15 @@ private:
 
 	#pragma pack(pop)
 
+	bool readMappedDirectory();
+	void buildIndex();
+
 	FileStream m_file;
+	// The archive is mapped into memory when possible, in which case m_file is unused for reading.
+	// Archives edited through addFile() are unmapped and use buffered reads from then on.
+	MappedFile m_mapping;
+	// Lowercase file name -> entry index.
+	std::unordered_map<std::string, u32> m_index;
 	bool m_archiveOpen;
 
 	GOB_Header_t m_header;
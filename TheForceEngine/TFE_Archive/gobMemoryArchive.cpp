@@ -196,6 +196,13 @@ size_t GobMemoryArchive::getLocInFile()
 	return m_fileOffset;
 }
 
+const u8* GobMemoryArchive::getFileData(u32 index, size_t* size)
+{
+	if (!m_archiveOpen || index >= getFileCount()) { return nullptr; }
+	*size = m_fileList.entries[index].LEN;
+	return m_buffer + m_fileList.entries[index].IX;
+}
+
 // Directory
 u32 GobMemoryArchive::getFileCount()
 {
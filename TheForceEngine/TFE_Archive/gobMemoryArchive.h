@@ -32,6 +32,7 @@ public:
 	size_t readFile(void *data, size_t size) override;
 	bool seekFile(s32 offset, s32 origin = SEEK_SET) override;
 	size_t getLocInFile() override;
+	const u8* getFileData(u32 index, size_t* size) override;
 
 	// Directory
 	u32 getFileCount() override;
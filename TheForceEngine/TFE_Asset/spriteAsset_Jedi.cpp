@@ -46,6 +46,28 @@ namespace TFE_Sprite_Jedi
 	static NameList    s_spriteNames[POOL_COUNT];
 	static std::vector<u8> s_buffer;
 
+	// Returns the sprite file contents, directly from the archive when it is mapped otherwise read into s_buffer.
+	// The data must be treated as read-only.
+	static const u8* readSpriteData(const FilePath* filePath, size_t* size)
+	{
+		const u8* data = FileStream::getDirectContents(filePath, size);
+		if (data)
+		{
+			return data;
+		}
+
+		FileStream file;
+		if (!file.open(filePath, Stream::MODE_READ))
+		{
+			return nullptr;
+		}
+		*size = file.getSize();
+		s_buffer.resize(*size);
+		file.readBuffer(s_buffer.data(), u32(*size));
+		file.close();
+		return s_buffer.data();
+	}
+
 	bool loadFrameHd(const char* name, const JediFrame* frame, AssetPool pool, HdWax* hdWax, const WaxCell* cell)
 	{
 		char hdPath[TFE_MAX_PATH];
@@ -112,17 +134,12 @@ namespace TFE_Sprite_Jedi
 		{
 			return nullptr;
 		}
-		FileStream file;
-		if (!file.open(&filePath, Stream::MODE_READ))
+		size_t len = 0;
+		const u8* data = readSpriteData(&filePath, &len);
+		if (!data)
 		{
 			return nullptr;
 		}
-		size_t len = file.getSize();
-		s_buffer.resize(len);
-		file.readBuffer(s_buffer.data(), u32(len));
-		file.close();
-
-		const u8* data = s_buffer.data();
 
 		// Determine ahead of time how much we need to allocate.
 		const WaxFrame* base_frame = (WaxFrame*)data;
@@ -131,10 +148,10 @@ namespace TFE_Sprite_Jedi
 
 		// This is a "load in place" format in the original code.
 		// We are going to allocate new memory and copy the data.
-		u8* assetPtr = (u8*)malloc(s_buffer.size() + columnSize);
+		u8* assetPtr = (u8*)malloc(len + columnSize);
 		JediFrame* asset = (JediFrame*)assetPtr;
 		
-		memcpy(asset, data, s_buffer.size());
+		memcpy(asset, data, len);
 
 		WaxFrame* frame = asset;
 		WaxCell* cell = WAX_CellPtr(asset, frame);
@@ -158,7 +175,7 @@ namespace TFE_Sprite_Jedi
 		}
 		else
 		{
-			u32* columns = (u32*)((u8*)asset + s_buffer.size());
+			u32* columns = (u32*)((u8*)asset + len);
 			// Local pointer.
 			cell->columnOffset = u32((u8*)columns - (u8*)asset);
 			// Calculate column offsets.
@@ -397,18 +414,13 @@ namespace TFE_Sprite_Jedi
 		{
 			return nullptr;
 		}
-		FileStream file;
-		if (!file.open(&filePath, Stream::MODE_READ))
+		size_t len = 0;
+		const u8* data = readSpriteData(&filePath, &len);
+		if (!data)
 		{
 			return nullptr;
 		}
-		size_t len = file.getSize();
-		s_buffer.resize(len);
-		file.readBuffer(s_buffer.data(), u32(len));
-		file.close();
-
-		u8* data = s_buffer.data();
-		Wax* srcWax = (Wax*)data;
+		const Wax* srcWax = (const Wax*)data;
 		
 		// every animation is filled out until the end, so no animations = no wax.
 		if (!srcWax->animOffsets[0])
@@ -418,8 +430,7 @@ namespace TFE_Sprite_Jedi
 		s_cellOffsets.clear();
 
 		// First determine the size to allocate (note that this will overallocate a bit because cells are shared).
-		u32 cellId = 0;
-		u32 sizeToAlloc = sizeof(JediWax) + (u32)s_buffer.size();
+		u32 sizeToAlloc = sizeof(JediWax) + (u32)len;
 		const s32* animOffset = srcWax->animOffsets;
 		for (s32 animIdx = 0; animIdx < 32 && animOffset[animIdx]; animIdx++)
 		{
@@ -431,18 +442,13 @@ namespace TFE_Sprite_Jedi
 				const s32* frameOffset = view->frameOffsets;
 				for (s32 f = 0; f < 32 && frameOffset[f]; f++)
 				{
-					WaxFrame* frame = (WaxFrame*)(data + frameOffset[f]);
-					WaxCell* cell = frame->cellOffset ? (WaxCell*)(data + frame->cellOffset) : nullptr;
+					const WaxFrame* frame = (const WaxFrame*)(data + frameOffset[f]);
+					const WaxCell* cell = frame->cellOffset ? (const WaxCell*)(data + frame->cellOffset) : nullptr;
 					bool unique = cell && isUniqueCell(frame->cellOffset);
 					if (unique && cell->compressed == 0)
 					{
 						sizeToAlloc += cell->sizeX * sizeof(u32);
 					}
-					if (unique)
-					{
-						cell->id = cellId;
-						cellId++;
-					}
 				}
 			}
 		}
@@ -450,7 +456,16 @@ namespace TFE_Sprite_Jedi
 		// Allocate and copy the data (this is a "copy in place" format... mostly.
 		JediWax* asset = (JediWax*)malloc(sizeToAlloc);
 		Wax* dstWax = asset;
-		memcpy(dstWax, srcWax, s_buffer.size());
+		memcpy(dstWax, srcWax, len);
+
+		// Cell ids follow the order in which unique cells were found above.
+		// These are assigned to the copy since the source data may be read-only.
+		const s32 cellCount = (s32)s_cellOffsets.size();
+		for (s32 c = 0; c < cellCount; c++)
+		{
+			WaxCell* cell = (WaxCell*)((u8*)asset + s_cellOffsets[c]);
+			cell->id = c;
+		}
 
 		// Loop through animation list until we reach 32 (maximum count) or a null animation.
 		// This means that animations are contiguous.
@@ -512,7 +527,7 @@ namespace TFE_Sprite_Jedi
 							}
 							else
 							{
-								u32* columns = (u32*)((u8*)asset + s_buffer.size() + cellOffsetPtr);
+								u32* columns = (u32*)((u8*)asset + len + cellOffsetPtr);
 								cellOffsetPtr += dstCell->sizeX * sizeof(u32);
 
 								// Local pointer.
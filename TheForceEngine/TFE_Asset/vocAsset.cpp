@@ -62,6 +62,7 @@ namespace TFE_VocAsset
 			delete voc;
 			return nullptr;
 		}
+		TFE_Audio::prepareSoundBuffer(voc);
 
 		s_vocAssets[name] = voc;
 		voc->id = (u32)s_vocAssetList.size();
@@ -75,6 +76,7 @@ namespace TFE_VocAsset
 		for (; iVoc != s_vocAssetList.end(); ++iVoc)
 		{
 			SoundBuffer* voc = *iVoc;
+			TFE_Audio::freeSoundBufferSamples(voc);
 			delete[] voc->data;
 			delete voc;
 		}
@@ -102,6 +104,7 @@ namespace TFE_VocAsset
 			delete voc;
 			return -1;
 		}
+		TFE_Audio::prepareSoundBuffer(voc);
 
 		s_vocAssets[name] = voc;
 		voc->id = (u32)s_vocAssetList.size();
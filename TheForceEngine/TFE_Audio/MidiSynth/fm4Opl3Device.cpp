@@ -16,6 +16,7 @@
 #include <TFE_Audio/midi.h>
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_Jedi/IMuse/imList.h>
+#include <TFE_System/system.h>
 #include <cstring>
 #include <algorithm>
 #include <assert.h>
@@ -54,8 +55,8 @@ namespace TFE_Audio
 	{
 		FM4_Port      = 0x388,
 		FM4_MaxVolume = 127,
-		FM4_OutputCount = 1,
 		FM4_SampleRate  = 44100,
+		FM4_RenderBlock = 256,
 		FM4_DrumChannel = 9,
 		FM4_PitchCenter = 0x2000,
 		FM4_MaxAtten = 0x3f,
@@ -65,8 +66,20 @@ namespace TFE_Audio
 	};
 	const f32 c_outputScale = 1.5f / 32768.0f;	// slight volume boost to compete with other midi outputs.
 
+	// The outputs select between the accurate and fast OPL3 generators.
+	enum Fm4Output
+	{
+		FM4_OutputAccurate = 0,
+		FM4_OutputFast,
+		FM4_OutputCount
+	};
+
 	static const char* c_Opl3_Name = "OPL3";
-	static const char* c_Output_Name = "FM4 Driver";
+	static const char* c_Output_Name[FM4_OutputCount] =
+	{
+		"FM4 Driver",			// FM4_OutputAccurate
+		"FM4 Driver (Fast)",	// FM4_OutputFast
+	};
 
 	// This is stored internally, there will only be one FM chip (for now).
 	static opl3_chip s_fmChip = { 0 };
@@ -83,9 +96,9 @@ namespace TFE_Audio
 
 	void Fm4Opl3Device::getOutputName(s32 index, char* buffer, u32 maxLength)
 	{
-		// Only output 0 exists.
-		strncpy(buffer, c_Output_Name, maxLength);
-		buffer[strlen(c_Output_Name)] = 0;
+		if (index < 0 || index >= FM4_OutputCount || !maxLength) { return; }
+		strncpy(buffer, c_Output_Name[index], maxLength);
+		buffer[maxLength - 1] = 0;
 	}
 
 	bool Fm4Opl3Device::selectOutput(s32 index)
@@ -94,13 +107,15 @@ namespace TFE_Audio
 		{
 			beginStream(FM4_SampleRate);
 		}
+		// -1 or an invalid index selects the accurate output.
+		m_fastMode = (index == FM4_OutputFast);
+		OPL3_SetFastMode(&s_fmChip, m_fastMode ? 1 : 0);
 		return m_streamActive;
 	}
 
 	s32 Fm4Opl3Device::getActiveOutput(void)
 	{
-		// Only output 0 exists.
-		return 0;
+		return m_fastMode ? FM4_OutputFast : FM4_OutputAccurate;
 	}
 
 	void Fm4Opl3Device::fm4_reset()
@@ -124,6 +139,7 @@ namespace TFE_Audio
 		memset(m_registers, 0, FM4_RegisterCount * FM4_OutCount);
 
 		OPL3_Reset(&s_fmChip, sampleRate);
+		OPL3_SetFastMode(&s_fmChip, m_fastMode ? 1 : 0);
 		fm4_reset();
 
 		// Initialize channels
@@ -171,15 +187,19 @@ namespace TFE_Audio
 	{
 		if (!m_streamActive) { return false; }
 
-		for (u32 i = 0; i < sampleCount; i++)
+		// Generate in blocks, then convert to float in a simple loop the compiler can vectorize.
+		s16 block[FM4_RenderBlock * 2];
+		const f32 scale = m_volumeScaled;
+		while (sampleCount)
 		{
-			s16 buf[2];
-			OPL3_GenerateResampled(&s_fmChip, buf);
-			
-			s16 left  = clamp(s32(buf[0]), INT16_MIN, INT16_MAX);
-			s16 right = clamp(s32(buf[1]), INT16_MIN, INT16_MAX);
-			*buffer++ = f32(left)  * m_volumeScaled;
-			*buffer++ = f32(right) * m_volumeScaled;
+			const u32 count = std::min(sampleCount, u32(FM4_RenderBlock));
+			OPL3_GenerateBlock(&s_fmChip, block, count);
+			for (u32 i = 0; i < count * 2; i++)
+			{
+				buffer[i] = f32(block[i]) * scale;
+			}
+			buffer += count * 2;
+			sampleCount -= count;
 		}
 		return true;
 	}
@@ -250,6 +270,84 @@ namespace TFE_Audio
 		}
 	}
 		
+	/////////////////////////////////////////////
+	// Benchmark
+	/////////////////////////////////////////////
+	// Key on 'voiceCount' two operator channels with a simple sustained patch, spread across both register banks.
+	static void fm4_benchmarkKeyOn(opl3_chip* chip, s32 voiceCount, bool keyOn)
+	{
+		for (s32 c = 0; c < voiceCount; c++)
+		{
+			const u16 bank = (c >= 9) ? 0x100 : 0x000;
+			const u16 ch = u16(c % 9);
+			const u16 fnum = u16(0x200 + c * 23);
+			const u8 block = u8(3 + (c & 1));
+			OPL3_WriteReg(chip, bank + REG_FNUM_LOW + ch, fnum & 0xff);
+			OPL3_WriteReg(chip, bank + REG_KEYON_BLOCK + ch, (keyOn ? VALUE_KEYON_BIT : 0) | (block << 2) | (fnum >> 8));
+		}
+	}
+
+	static void fm4_benchmarkSetup(opl3_chip* chip, s32 voiceCount, bool fast)
+	{
+		OPL3_Reset(chip, FM4_SampleRate);
+		OPL3_SetFastMode(chip, fast ? 1 : 0);
+		OPL3_WriteReg(chip, 0x100 + REG_MODE_REGISTER, VALUE_ENABLE);
+		for (s32 c = 0; c < voiceCount; c++)
+		{
+			const u16 bank = (c >= 9) ? 0x100 : 0x000;
+			const u16 ch = u16(c % 9);
+			const u16 op = u16((ch % 3) + (ch / 3) * 8);
+			for (s32 i = 0; i < 2; i++)
+			{
+				const u16 slot = bank + op + i * 3;
+				OPL3_WriteReg(chip, slot + REG_ENABLE_WAVE_SELECT, 0x21);	// sustain, multiplier 1.
+				OPL3_WriteReg(chip, slot + REG_KSL_LEVEL, i ? 0x00 : 0x18);
+				OPL3_WriteReg(chip, slot + REG_ATTACK_DECAY, 0xf4);
+				OPL3_WriteReg(chip, slot + REG_SUSTAIN_RELEASE, 0x56);
+				OPL3_WriteReg(chip, slot + REG_WAVE_SELECT, i ? 0x00 : 0x01);
+			}
+			OPL3_WriteReg(chip, bank + REG_FEEDBACK_CONNECTION + ch, VALUE_VOICE_LEFT | VALUE_VOICE_RIGHT | 0x06);
+		}
+	}
+
+	static f64 fm4_benchmarkRun(opl3_chip* chip, s32 voiceCount, f64 seconds, bool fast)
+	{
+		fm4_benchmarkSetup(chip, voiceCount, fast);
+
+		// Retrigger the notes every 100ms so the envelopes are exercised, like music would.
+		const u32 noteFrames = FM4_SampleRate / 10;
+		const u32 totalFrames = u32(seconds * FM4_SampleRate);
+		s16 block[FM4_RenderBlock * 2];
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		for (u32 frame = 0; frame < totalFrames;)
+		{
+			const u32 notePos = frame % noteFrames;
+			if (notePos == 0) { fm4_benchmarkKeyOn(chip, voiceCount, true); }
+			else if (notePos == noteFrames / 2) { fm4_benchmarkKeyOn(chip, voiceCount, false); }
+
+			// Stop at the next note event.
+			const u32 nextEvent = (notePos < noteFrames / 2) ? noteFrames / 2 : noteFrames;
+			const u32 count = std::min(std::min(u32(FM4_RenderBlock), nextEvent - notePos), totalFrames - frame);
+			OPL3_GenerateBlock(chip, block, count);
+			frame += count;
+		}
+		const f64 elapsed = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+		return 1000.0 * elapsed / seconds;
+	}
+
+	void Fm4Opl3Device::benchmark(s32 voiceCount, f64 seconds, f64* accurateMs, f64* fastMs)
+	{
+		voiceCount = std::max(0, std::min(18, voiceCount));
+		seconds = std::max(seconds, 0.1);
+
+		// The chip is large, so keep it off of the stack.
+		opl3_chip* chip = new opl3_chip;
+		*accurateMs = fm4_benchmarkRun(chip, voiceCount, seconds, false);
+		*fastMs = fm4_benchmarkRun(chip, voiceCount, seconds, true);
+		delete chip;
+	}
+		
 	/////////////////////////////////////////////
 	// Low-level driver implementation.
 	/////////////////////////////////////////////
@@ -22,7 +22,7 @@ namespace TFE_Audio
 	class Fm4Opl3Device : public MidiDevice
 	{
 	public:
-		Fm4Opl3Device() : m_streamActive(false), m_volume(1.0f), m_volumeScaled(1.0f), m_fmVoicePitchRight(nullptr), m_fmVoicePitchLeft(nullptr), m_fmVoiceLevel(nullptr) {}
+		Fm4Opl3Device() : m_streamActive(false), m_fastMode(false), m_volume(1.0f), m_volumeScaled(1.0f), m_fmVoicePitchRight(nullptr), m_fmVoicePitchLeft(nullptr), m_fmVoiceLevel(nullptr) {}
 		~Fm4Opl3Device() override;
 
 		MidiDeviceType getType() override { return MIDI_TYPE_OPL3; }
@@ -44,6 +44,10 @@ namespace TFE_Audio
 		bool selectOutput(s32 index) override;
 		s32  getActiveOutput(void) override;
 
+		// Measure the CPU time in milliseconds needed to render one second of music with 'voiceCount' OPL3 channels
+		// playing, using the accurate and fast generators. Uses a separate chip, so it does not affect playback.
+		static void benchmark(s32 voiceCount, f64 seconds, f64* accurateMs, f64* fastMs);
+
 	private:
 		enum
 		{
@@ -127,6 +131,7 @@ namespace TFE_Audio
 		s32  fm4_getVelocityToVolumeMapping(s32 velocity);
 	
 		bool m_streamActive;
+		bool m_fastMode;
 		f32  m_volume;
 		f32  m_volumeScaled;
 		Fm4Channel m_channels[MIDI_CHANNEL_COUNT];
@@ -1100,8 +1100,26 @@ static int16_t OPL3_ClipSample(int32_t sample)
     return (int16_t)sample;
 }
 
+/* TFE: a slot that is keyed off and fully released only outputs silence until it is keyed on again,
+   and key on resets its phase, so it can be skipped. Rhythm mode uses the phase and noise of other slots. */
+static uint8_t OPL3_SlotIdle(opl3_slot *slot)
+{
+    if (slot->key || slot->eg_gen != envelope_gen_num_release || slot->eg_rout != 0x1ff || (slot->chip->rhy & 0x20))
+    {
+        return 0;
+    }
+    slot->out = 0;
+    slot->prout = 0;
+    slot->fbmod = 0;
+    return 1;
+}
+
 static void OPL3_ProcessSlot(opl3_slot *slot)
 {
+    if (slot->chip->fastmode && OPL3_SlotIdle(slot))
+    {
+        return;
+    }
     OPL3_SlotCalcFB(slot);
     OPL3_EnvelopeCalc(slot);
     OPL3_PhaseGenerate(slot);
@@ -1528,3 +1546,34 @@ void OPL3_GenerateStream(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples)
         sndptr += 2;
     }
 }
+
+void OPL3_GenerateBlock(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples)
+{
+    const int32_t rateratio = chip->rateratio;
+    uint_fast32_t i;
+
+    for (i = 0; i < numsamples; i++)
+    {
+        while (chip->samplecnt >= rateratio)
+        {
+            chip->oldsamples[0] = chip->samples[0];
+            chip->oldsamples[1] = chip->samples[1];
+            chip->oldsamples[2] = chip->samples[2];
+            chip->oldsamples[3] = chip->samples[3];
+            OPL3_Generate4Ch(chip, chip->samples);
+            chip->samplecnt -= rateratio;
+        }
+        /* Only the first stereo pair is needed, which halves the interpolation cost. */
+        sndptr[0] = (int16_t)((chip->oldsamples[0] * (rateratio - chip->samplecnt)
+                              + chip->samples[0] * chip->samplecnt) / rateratio);
+        sndptr[1] = (int16_t)((chip->oldsamples[1] * (rateratio - chip->samplecnt)
+                              + chip->samples[1] * chip->samplecnt) / rateratio);
+        chip->samplecnt += 1 << RSM_FRAC;
+        sndptr += 2;
+    }
+}
+
+void OPL3_SetFastMode(opl3_chip *chip, uint8_t enable)
+{
+    chip->fastmode = enable ? 1 : 0;
+}
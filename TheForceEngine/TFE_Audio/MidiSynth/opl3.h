@@ -151,6 +151,9 @@ struct _opl3_chip
     int16_t oldsamples[4];
     int16_t samples[4];
 
+    /* TFE: skip idle slots, see OPL3_SetFastMode() */
+    uint8_t fastmode;
+
     uint64_t writebuf_samplecnt;
     uint32_t writebuf_cur;
     uint32_t writebuf_last;
@@ -165,6 +168,12 @@ void OPL3_WriteReg(opl3_chip *chip, uint16_t reg, uint8_t v);
 void OPL3_WriteRegBuffered(opl3_chip *chip, uint16_t reg, uint8_t v);
 void OPL3_GenerateStream(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples);
 
+/* TFE: Generate a block of resampled stereo samples, the same output as calling OPL3_GenerateResampled() for each sample. */
+void OPL3_GenerateBlock(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples);
+/* TFE: In fast mode slots that are keyed off and fully released are not processed. This is not bit-accurate, since
+   a silent slot normally alternates between 0 and -1, so the output may differ by 1 LSB per idle slot. Reset clears fast mode. */
+void OPL3_SetFastMode(opl3_chip *chip, uint8_t enable);
+
 void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4);
 void OPL3_Generate4ChResampled(opl3_chip *chip, int16_t *buf4);
 void OPL3_Generate4ChStream(opl3_chip *chip, int16_t *sndptr1, int16_t *sndptr2, uint32_t numsamples);
@@ -1,6 +1,7 @@
 #include "soundFontDevice.h"
 #include <TFE_Audio/midi.h>
 #include <TFE_FileSystem/filestream.h>
+#include <TFE_System/profiler.h>
 #include <algorithm>
 #include <assert.h>
 
@@ -16,9 +17,15 @@ namespace TFE_Audio
 		SFD_DRUM_BANK    = 128,
 		SFD_SAMPLE_RATE  = 44100,
 	};
+	// Released voices below this level are inaudible at 16 bits, stop rendering them.
+	static const f32 c_SFD_CullThresholdDB = -90.0f;
 	static const char* c_SFD_Name = "SF2 Synthesized Midi";
 	static const char* c_defaultOutput = "Roland SC-55";
 
+	static s32 s_activeVoices = 0;
+	static s32 s_stolenVoices = 0;
+	static s32 s_culledVoices = 0;
+
 	SoundFontDevice::~SoundFontDevice()
 	{
 		exit();
@@ -104,6 +111,8 @@ namespace TFE_Audio
 			// Set the SoundFont rendering output mode
 			tsf_set_output(m_soundFont, TSF_STEREO_INTERLEAVED, sampleRate, 0);
 			tsf_set_max_voices(m_soundFont, SFD_MAX_VOICES);
+			tsf_set_polyphony(m_soundFont, m_polyphony);
+			tsf_set_cull_threshold(m_soundFont, c_SFD_CullThresholdDB);
 			// pre-allocate channels, clear programs or set them to the stored values.
 			for (s32 i = 0; i < MIDI_CHANNEL_COUNT; i++)
 			{
@@ -111,6 +120,10 @@ namespace TFE_Audio
 			}
 			// Set the drum bank.
 			tsf_channel_set_bank_preset(m_soundFont, SFD_DRUM_CHANNEL, SFD_DRUM_BANK, 0);
+
+			TFE_COUNTER(s_activeVoices, "SF2 Active Voices");
+			TFE_COUNTER(s_stolenVoices, "SF2 Voices Stolen");
+			TFE_COUNTER(s_culledVoices, "SF2 Voices Culled");
 		}
 		return m_soundFont != nullptr;
 	}
@@ -136,6 +149,9 @@ namespace TFE_Audio
 	{
 		if (!m_soundFont) { return false; }
 		tsf_render_float(m_soundFont, buffer, sampleCount);
+
+		s_activeVoices = tsf_active_voice_count(m_soundFont);
+		tsf_get_voice_stats(m_soundFont, &s_stolenVoices, &s_culledVoices);
 		return true;
 	}
 
@@ -144,6 +160,15 @@ namespace TFE_Audio
 		return m_soundFont != nullptr;
 	}
 
+	void SoundFontDevice::setPolyphony(s32 polyphony)
+	{
+		m_polyphony = std::max(0, std::min(polyphony, (s32)SFD_MAX_VOICES));
+		if (m_soundFont)
+		{
+			tsf_set_polyphony(m_soundFont, m_polyphony);
+		}
+	}
+
 	void SoundFontDevice::setVolume(f32 volume)
 	{
 		if (!m_soundFont) { return; }
@@ -10,7 +10,7 @@ namespace TFE_Audio
 	class SoundFontDevice : public MidiDevice
 	{
 	public:
-		SoundFontDevice() : m_soundFont(nullptr), m_outputId(-1) {}
+		SoundFontDevice() : m_soundFont(nullptr), m_outputId(-1), m_polyphony(SFD_DEFAULT_POLYPHONY) {}
 		~SoundFontDevice() override;
 
 		MidiDeviceType getType() override { return MIDI_TYPE_SF2; }
@@ -32,11 +32,18 @@ namespace TFE_Audio
 		bool selectOutput(s32 index) override;
 		s32  getActiveOutput(void) override;
 
+		// Maximum number of voices that sound at once, 0 only limits by the voice pool.
+		void setPolyphony(s32 polyphony);
+		s32  getPolyphony() const { return m_polyphony; }
+
+		enum { SFD_DEFAULT_POLYPHONY = 128 };
+
 	private:
 		bool beginStream(const char* soundFont, s32 sampleRate);
 
 		tsf* m_soundFont;
 		s32  m_outputId;
+		s32  m_polyphony;
 		FileList m_outputs;
 	};
 };
\ No newline at end of file
@@ -164,6 +164,21 @@ TSFDEF void tsf_set_volume(tsf* f, float global_gain);
 //   (tsf_set_max_voices returns 0 if allocation failed, otherwise 1)
 TSFDEF int tsf_set_max_voices(tsf* f, int max_voices);
 
+// Limit the number of voices that sound at once (TFE)
+// When a new voice would exceed the limit, the voice least likely to be missed is stolen
+// with a quick release: released voices first, then the quietest and finally the oldest.
+// If voices have been pre-allocated with tsf_set_max_voices and all are in use, the same
+// priority is used to cut a voice immediately instead of dropping the new note.
+//   polyphony: maximum number of sounding voices, 0 for no limit
+TSFDEF void tsf_set_polyphony(tsf* f, int polyphony);
+
+// Stop released voices once they fall below an audibility threshold (TFE)
+//   threshold_db: gain in decibels (i.e. -90), 0 disables culling
+TSFDEF void tsf_set_cull_threshold(tsf* f, float threshold_db);
+
+// Get the total number of voices stolen and culled since loading (TFE)
+TSFDEF void tsf_get_voice_stats(tsf* f, int* stolen, int* culled);
+
 // Start playing a note
 //   preset_index: preset index >= 0 and < tsf_get_presetcount()
 //   key: note value between 0 and 127 (60 being middle C)
@@ -272,6 +287,18 @@ TSFDEF float tsf_channel_get_tuning(tsf* f, int channel);
 // Grace release time for quick voice off (avoid clicking noise)
 #define TSF_FASTRELEASETIME 0.01f
 
+// TFE: SSE2 is always available on x64 (and when the compiler targets it on x86) and NEON on ARM64,
+// these are used to interpolate and mix voices 4 samples at a time.
+#if !defined(TSF_NO_SIMD)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP == 2)
+#    define TSF_SSE2 1
+#    include <emmintrin.h>
+#  elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#    define TSF_NEON 1
+#    include <arm_neon.h>
+#  endif
+#endif
+
 #if !defined(TSF_MALLOC) || !defined(TSF_FREE) || !defined(TSF_REALLOC)
 #  include <stdlib.h>
 #  define TSF_MALLOC  malloc
@@ -337,6 +364,11 @@ struct tsf
 	int maxVoiceNum;
 	unsigned int voicePlayIndex;
 
+	// TFE: voice limits.
+	int polyphony;
+	float cullGain;
+	int stolenVoiceNum, culledVoiceNum;
+
 	enum TSFOutputMode outputmode;
 	float outSampleRate;
 	float globalGainDB;
@@ -1083,6 +1115,39 @@ static void tsf_voice_endquick(tsf* f, struct tsf_voice* v)
 	}
 }
 
+// TFE: Find the voice that is least likely to be missed: released voices first, then the quietest and finally the oldest.
+// Voices started by the current note and voices that are already ending quickly are never picked.
+// Also returns the number of voices that are still sounding, not counting the ones ending quickly.
+static struct tsf_voice* tsf_voice_find_steal(tsf* f, unsigned int playIndex, int* soundingNum)
+{
+	struct tsf_voice *v = f->voices, *vEnd = v + f->voiceNum, *best = TSF_NULL;
+	float bestGain = 0.0f;
+	TSF_BOOL bestReleased = TSF_FALSE;
+	int count = 0;
+	for (; v != vEnd; v++)
+	{
+		TSF_BOOL released;
+		float gain;
+		if (v->playingPreset == -1) continue;
+		released = (v->ampenv.segment >= TSF_SEGMENT_RELEASE);
+		if (released && !v->ampenv.parameters.release) continue;
+		count++;
+		if (v->playIndex == playIndex) continue;
+
+		// The envelope level is still rising before the decay segment, so use the peak gain.
+		gain = tsf_decibelsToGain(v->noteGainDB) * (v->ampenv.segment < TSF_SEGMENT_DECAY ? 1.0f : v->ampenv.level);
+		if (!best || released > bestReleased || (released == bestReleased &&
+			(gain < bestGain || (gain == bestGain && (int)(v->playIndex - best->playIndex) < 0))))
+		{
+			best = v;
+			bestGain = gain;
+			bestReleased = released;
+		}
+	}
+	if (soundingNum) *soundingNum = count;
+	return best;
+}
+
 static void tsf_voice_calcpitchratio(struct tsf_voice* v, float pitchShift, float outSampleRate)
 {
 	double note = v->playingKey + v->region->transpose + v->region->tune / 100.0;
@@ -1092,6 +1157,60 @@ static void tsf_voice_calcpitchratio(struct tsf_voice* v, float pitchShift, floa
 	v->pitchOutputFactor = v->region->sample_rate / (tsf_timecents2Secsd(v->region->pitch_keycenter * 100.0) * outSampleRate);
 }
 
+#if defined(TSF_SSE2) || defined(TSF_NEON)
+// TFE: SIMD kernels for the interleaved stereo path, the math matches the scalar loop exactly so the output does not change.
+// Linear interpolation between the gathered sample pairs, the result is written over 'a'.
+static void tsf_voice_interpolate(float* a, const float* b, const float* alpha, int count)
+{
+	int i = 0;
+#if defined(TSF_SSE2)
+	const __m128 one = _mm_set1_ps(1.0f);
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 t = _mm_loadu_ps(alpha + i);
+		_mm_storeu_ps(a + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + i), _mm_sub_ps(one, t)), _mm_mul_ps(_mm_loadu_ps(b + i), t)));
+	}
+#else
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	for (; i + 4 <= count; i += 4)
+	{
+		const float32x4_t t = vld1q_f32(alpha + i);
+		vst1q_f32(a + i, vaddq_f32(vmulq_f32(vld1q_f32(a + i), vsubq_f32(one, t)), vmulq_f32(vld1q_f32(b + i), t)));
+	}
+#endif
+	for (; i < count; i++) a[i] = (a[i] * (1.0f - alpha[i]) + b[i] * alpha[i]);
+}
+
+// Mix mono voice samples into an interleaved stereo buffer.
+static void tsf_voice_mix_interleaved(float* out, const float* val, int count, float gainLeft, float gainRight)
+{
+	int i = 0;
+#if defined(TSF_SSE2)
+	const __m128 gain = _mm_setr_ps(gainLeft, gainRight, gainLeft, gainRight);
+	for (; i + 4 <= count; i += 4, out += 8)
+	{
+		const __m128 v = _mm_loadu_ps(val + i);
+		_mm_storeu_ps(out,     _mm_add_ps(_mm_loadu_ps(out),     _mm_mul_ps(_mm_unpacklo_ps(v, v), gain)));
+		_mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(_mm_unpackhi_ps(v, v), gain)));
+	}
+#else
+	const float gains[4] = { gainLeft, gainRight, gainLeft, gainRight };
+	const float32x4_t gain = vld1q_f32(gains);
+	for (; i + 4 <= count; i += 4, out += 8)
+	{
+		const float32x4x2_t pairs = vzipq_f32(vld1q_f32(val + i), vld1q_f32(val + i));
+		vst1q_f32(out,     vaddq_f32(vld1q_f32(out),     vmulq_f32(pairs.val[0], gain)));
+		vst1q_f32(out + 4, vaddq_f32(vld1q_f32(out + 4), vmulq_f32(pairs.val[1], gain)));
+	}
+#endif
+	for (; i < count; i++, out += 2)
+	{
+		out[0] += val[i] * gainLeft;
+		out[1] += val[i] * gainRight;
+	}
+}
+#endif
+
 static void tsf_voice_render(tsf* f, struct tsf_voice* v, float* outputBuffer, int numSamples)
 {
 	struct tsf_region* region = v->region;
@@ -1117,7 +1236,7 @@ static void tsf_voice_render(tsf* f, struct tsf_voice* v, float* outputBuffer, i
 	float tmpModLfoToPitch, tmpVibLfoToPitch, tmpModEnvToPitch;
 
 	TSF_BOOL dynamicGain = (region->modLfoToVolume != 0);
-	float noteGain = 0, tmpModLfoToVolume;
+	float noteGain = 0, tmpModLfoToVolume, cullGain;
 
 	if (dynamicLowpass) tmpInitialFilterFc = (float)region->initialFilterFc, tmpModLfoToFilterFc = (float)region->modLfoToFilterFc, tmpModEnvToFilterFc = (float)region->modEnvToFilterFc;
 	else tmpInitialFilterFc = 0, tmpModLfoToFilterFc = 0, tmpModEnvToFilterFc = 0;
@@ -1128,6 +1247,9 @@ static void tsf_voice_render(tsf* f, struct tsf_voice* v, float* outputBuffer, i
 	if (dynamicGain) tmpModLfoToVolume = (float)region->modLfoToVolume * 0.1f;
 	else noteGain = tsf_decibelsToGain(v->noteGainDB), tmpModLfoToVolume = 0;
 
+	// TFE: The LFO can raise the gain again, so leave room for it when culling.
+	cullGain = (f->cullGain && dynamicGain ? f->cullGain * tsf_decibelsToGain(tmpModLfoToVolume < 0 ? tmpModLfoToVolume : -tmpModLfoToVolume) : f->cullGain);
+
 	while (numSamples)
 	{
 		float gainMono, gainLeft, gainRight;
@@ -1150,6 +1272,14 @@ static void tsf_voice_render(tsf* f, struct tsf_voice* v, float* outputBuffer, i
 
 		gainMono = noteGain * v->ampenv.level;
 
+		// TFE: Released voices only get quieter, stop them once they can no longer be heard.
+		if (cullGain && v->ampenv.segment == TSF_SEGMENT_RELEASE && gainMono < cullGain)
+		{
+			f->culledVoiceNum++;
+			tsf_voice_kill(v);
+			return;
+		}
+
 		// Update EG.
 		tsf_voice_envelope_process(&v->ampenv, blockSamples, tmpSampleRate);
 		if (updateModEnv) tsf_voice_envelope_process(&v->modenv, blockSamples, tmpSampleRate);
@@ -1162,6 +1292,33 @@ static void tsf_voice_render(tsf* f, struct tsf_voice* v, float* outputBuffer, i
 		{
 			case TSF_STEREO_INTERLEAVED:
 				gainLeft = gainMono * v->panFactorLeft, gainRight = gainMono * v->panFactorRight;
+#if defined(TSF_SSE2) || defined(TSF_NEON)
+				{
+					// TFE: Advancing the position and the low-pass filter are serial, so gather the sample pairs first
+					// then interpolate and mix with SIMD around them.
+					float sampleA[TSF_RENDER_EFFECTSAMPLEBLOCK], sampleB[TSF_RENDER_EFFECTSAMPLEBLOCK], sampleAlpha[TSF_RENDER_EFFECTSAMPLEBLOCK];
+					int i, count = 0;
+					for (; count < blockSamples && tmpSourceSamplePosition < tmpSampleEndDbl; count++)
+					{
+						unsigned int pos = (unsigned int)tmpSourceSamplePosition, nextPos = (pos >= tmpLoopEnd && isLooping ? tmpLoopStart : pos + 1);
+						sampleA[count] = input[pos];
+						sampleB[count] = input[nextPos];
+						sampleAlpha[count] = (float)(tmpSourceSamplePosition - pos);
+
+						// Next sample.
+						tmpSourceSamplePosition += pitchRatio;
+						if (tmpSourceSamplePosition >= tmpLoopEndDbl && isLooping) tmpSourceSamplePosition -= (tmpLoopEnd - tmpLoopStart + 1.0);
+					}
+					tsf_voice_interpolate(sampleA, sampleB, sampleAlpha, count);
+					if (tmpLowpass.active)
+					{
+						for (i = 0; i < count; i++) sampleA[i] = tsf_voice_lowpass_process(&tmpLowpass, sampleA[i]);
+					}
+					tsf_voice_mix_interleaved(outL, sampleA, count, gainLeft, gainRight);
+					outL += count * 2;
+					break;
+				}
+#endif
 				while (blockSamples-- && tmpSourceSamplePosition < tmpSampleEndDbl)
 				{
 					unsigned int pos = (unsigned int)tmpSourceSamplePosition, nextPos = (pos >= tmpLoopEnd && isLooping ? tmpLoopStart : pos + 1);
@@ -1418,6 +1575,22 @@ TSFDEF int tsf_set_max_voices(tsf* f, int max_voices)
 	return 1;
 }
 
+TSFDEF void tsf_set_polyphony(tsf* f, int polyphony)
+{
+	f->polyphony = (polyphony > 0 ? polyphony : 0);
+}
+
+TSFDEF void tsf_set_cull_threshold(tsf* f, float threshold_db)
+{
+	f->cullGain = (threshold_db < 0 ? tsf_decibelsToGain(threshold_db) : 0.0f);
+}
+
+TSFDEF void tsf_get_voice_stats(tsf* f, int* stolen, int* culled)
+{
+	if (stolen) *stolen = f->stolenVoiceNum;
+	if (culled) *culled = f->culledVoiceNum;
+}
+
 TSFDEF int tsf_note_on(tsf* f, int preset_index, int key, float vel)
 {
 	short midiVelocity = (short)(vel * 127);
@@ -1443,14 +1616,30 @@ TSFDEF int tsf_note_on(tsf* f, int preset_index, int key, float vel)
 		}
 		else for (; v != vEnd; v++) if (v->playingPreset == -1) { voice = v; break; }
 
-		if (!voice)
+		// TFE: Over the polyphony limit, fade out the voice least likely to be missed to make room for this one.
+		if (f->polyphony)
 		{
-			struct tsf_voice* newVoices;
-			if (f->maxVoiceNum)
+			int soundingNum;
+			struct tsf_voice* steal = tsf_voice_find_steal(f, voicePlayIndex, &soundingNum);
+			if (steal && soundingNum >= f->polyphony)
 			{
-				// voices have been pre-allocated and limited to a maximum, unable to start playing this voice
-				continue;
+				tsf_voice_endquick(f, steal);
+				f->stolenVoiceNum++;
 			}
+		}
+
+		if (!voice && f->maxVoiceNum)
+		{
+			// voices have been pre-allocated and limited to a maximum, cut the voice least likely to be missed (TFE)
+			// rather than dropping the new note.
+			voice = tsf_voice_find_steal(f, voicePlayIndex, TSF_NULL);
+			if (!voice) continue;
+			f->stolenVoiceNum++;
+			tsf_voice_kill(voice);
+		}
+		if (!voice)
+		{
+			struct tsf_voice* newVoices;
 			f->voiceNum += 4;
 			newVoices = (struct tsf_voice*)TSF_REALLOC(f->voices, f->voiceNum * sizeof(struct tsf_voice));
 			if (!newVoices) return 0;
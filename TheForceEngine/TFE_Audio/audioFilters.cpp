@@ -1,5 +1,18 @@
 #include <cstring>
+#include <cmath>
 #include "audioFilters.h"
+#include <TFE_System/math.h>
+#include <algorithm>
+
+// SSE2 is always available on x64 (and when the compiler targets it on x86) and NEON on ARM64,
+// so the mixing kernels do not require runtime detection.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP == 2)
+	#define AUDIO_SSE2 1
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+	#define AUDIO_NEON 1
+	#include <arm_neon.h>
+#endif
 
 namespace TFE_Audio
 {
@@ -50,4 +63,262 @@ namespace TFE_Audio
 			output[7] = inRight0 + deltaRight * 0.75f;
 		}
 	}
+
+	/////////////////////////////////////////////
+	// Polyphase resampler
+	/////////////////////////////////////////////
+	enum SincResamplerConstants
+	{
+		SINC_TAPS = 16,			// Filter length in input samples when upsampling, longer when downsampling.
+		SINC_PHASES = 256,		// Phases in between are linearly interpolated.
+	};
+	// Cutoff relative to the lower of the two Nyquist frequencies, leaving room for the transition band.
+	static const f64 c_sincCutoff = 0.92;
+	static const f64 c_kaiserBeta = 7.0;
+	static const f64 c_pi = 3.14159265358979323846;
+
+	// Zero order modified Bessel function of the first kind, used by the Kaiser window.
+	static f64 bessel_i0(f64 x)
+	{
+		f64 sum = 1.0, term = 1.0;
+		const f64 halfX = x * 0.5;
+		for (s32 k = 1; k < 32; k++)
+		{
+			term *= halfX / f64(k);
+			sum += term * term;
+		}
+		return sum;
+	}
+
+	void resampler_init(SincResampler* resampler, u32 inRate, u32 outRate)
+	{
+		resampler->inRate = inRate;
+		resampler->outRate = outRate;
+		resampler->step = (u64(inRate) << 32ull) / u64(outRate);
+
+		// When downsampling the cutoff has to move below the output Nyquist frequency and the filter gets wider.
+		const f64 ratio = inRate > outRate ? f64(outRate) / f64(inRate) : 1.0;
+		const f64 cutoff = c_sincCutoff * ratio;
+		u32 taps = u32(f64(SINC_TAPS) / ratio + 0.5);
+		taps = (taps + 1) & ~1u;
+		resampler->taps = taps;
+		resampler->phases = SINC_PHASES;
+
+		// Tap 't' of phase 'p' is the filter value at (t - (taps/2 - 1)) - p/phases input samples from the output position.
+		const f64 center = f64(taps / 2 - 1);
+		const f64 halfWidth = f64(taps) * 0.5;
+		const f64 windowScale = 1.0 / bessel_i0(c_kaiserBeta);
+		resampler->table.resize((SINC_PHASES + 1) * taps);
+		for (u32 p = 0; p <= SINC_PHASES; p++)
+		{
+			f32* coeff = &resampler->table[p * taps];
+			const f64 frac = f64(p) / f64(SINC_PHASES);
+			f64 sum = 0.0;
+			for (u32 t = 0; t < taps; t++)
+			{
+				const f64 x = f64(t) - center - frac;
+				const f64 sincX = cutoff * x * c_pi;
+				const f64 sinc = (fabs(sincX) < 1e-9) ? cutoff : cutoff * sin(sincX) / sincX;
+				const f64 w = x / halfWidth;
+				const f64 window = (fabs(w) < 1.0) ? bessel_i0(c_kaiserBeta * sqrt(1.0 - w * w)) * windowScale : 0.0;
+				coeff[t] = f32(sinc * window);
+				sum += sinc * window;
+			}
+			// Normalize each phase to unity gain to avoid ripple in the output.
+			const f64 scale = (sum != 0.0) ? 1.0 / sum : 1.0;
+			for (u32 t = 0; t < taps; t++)
+			{
+				coeff[t] = f32(coeff[t] * scale);
+			}
+		}
+		resampler_reset(resampler);
+	}
+
+	void resampler_reset(SincResampler* resampler)
+	{
+		// Start with silent history, so the first output sample is centered on the first input sample.
+		const u32 history = resampler->taps / 2 - 1;
+		resampler->input.assign(history * 2, 0.0f);
+		resampler->pos = u64(history) << 32ull;
+	}
+
+	void resampler_write(SincResampler* resampler, const f32* input, u32 frameCount)
+	{
+		resampler->input.insert(resampler->input.end(), input, input + frameCount * 2);
+	}
+
+	u32 resampler_read(SincResampler* resampler, f32* output, u32 frameCount)
+	{
+		const u32 taps = resampler->taps;
+		const u32 history = taps / 2 - 1;
+		const u64 inputFrames = resampler->input.size() / 2;
+		const f32* input = resampler->input.data();
+
+		u32 written = 0;
+		u64 pos = resampler->pos;
+		for (; written < frameCount; written++, output += 2)
+		{
+			const u64 index = pos >> 32ull;
+			// The filter reads from index - history to index + taps/2.
+			if (index + taps / 2 >= inputFrames) { break; }
+
+			// Select the two nearest phases and blend them.
+			const u32 frac = u32(pos & 0xffffffffull);
+			const u32 phase = u32((u64(frac) * SINC_PHASES) >> 32ull);
+			const f32 blend = f32(u64(frac) * SINC_PHASES - (u64(phase) << 32ull)) * (1.0f / 4294967296.0f);
+			const f32* coeff0 = &resampler->table[phase * taps];
+			const f32* coeff1 = coeff0 + taps;
+			const f32* src = input + (index - history) * 2;
+
+			f32 left0 = 0.0f, right0 = 0.0f, left1 = 0.0f, right1 = 0.0f;
+			for (u32 t = 0; t < taps; t++, src += 2)
+			{
+				left0  += src[0] * coeff0[t];
+				right0 += src[1] * coeff0[t];
+				left1  += src[0] * coeff1[t];
+				right1 += src[1] * coeff1[t];
+			}
+			output[0] = left0  + (left1  - left0)  * blend;
+			output[1] = right0 + (right1 - right0) * blend;
+
+			pos += resampler->step;
+		}
+
+		// Discard input that is no longer needed.
+		const u64 index = pos >> 32ull;
+		if (index > history)
+		{
+			const u64 discard = std::min(index - history, inputFrames);
+			resampler->input.erase(resampler->input.begin(), resampler->input.begin() + size_t(discard * 2));
+			pos -= discard << 32ull;
+		}
+		resampler->pos = pos;
+		return written;
+	}
+
+	void mixMonoToStereo(f32* output, const f32* input, u32 frameCount, f32 volume)
+	{
+		u32 i = 0;
+	#if defined(AUDIO_SSE2)
+		const __m128 vol = _mm_set1_ps(volume);
+		for (; i + 4 <= frameCount; i += 4, input += 4, output += 8)
+		{
+			const __m128 mono = _mm_mul_ps(_mm_loadu_ps(input), vol);
+			// (s0, s0, s1, s1) and (s2, s2, s3, s3)
+			const __m128 lo = _mm_unpacklo_ps(mono, mono);
+			const __m128 hi = _mm_unpackhi_ps(mono, mono);
+			_mm_storeu_ps(output,     _mm_add_ps(_mm_loadu_ps(output),     lo));
+			_mm_storeu_ps(output + 4, _mm_add_ps(_mm_loadu_ps(output + 4), hi));
+		}
+	#elif defined(AUDIO_NEON)
+		for (; i + 4 <= frameCount; i += 4, input += 4, output += 8)
+		{
+			const float32x4_t mono = vmulq_n_f32(vld1q_f32(input), volume);
+			// Load the stereo frames de-interleaved so the same mono value can be added to both channels.
+			float32x4x2_t stereo = vld2q_f32(output);
+			stereo.val[0] = vaddq_f32(stereo.val[0], mono);
+			stereo.val[1] = vaddq_f32(stereo.val[1], mono);
+			vst2q_f32(output, stereo);
+		}
+	#endif
+		for (; i < frameCount; i++, input++, output += 2)
+		{
+			const f32 sample = input[0] * volume;
+			output[0] += sample;
+			output[1] += sample;
+		}
+	}
+
+	void limit_clip(f32* buffer, u32 sampleCount, f32 limit)
+	{
+		u32 i = 0;
+	#if defined(AUDIO_SSE2)
+		const __m128 maxValue = _mm_set1_ps(limit);
+		const __m128 minValue = _mm_set1_ps(-limit);
+		for (; i + 4 <= sampleCount; i += 4, buffer += 4)
+		{
+			_mm_storeu_ps(buffer, _mm_max_ps(minValue, _mm_min_ps(_mm_loadu_ps(buffer), maxValue)));
+		}
+	#elif defined(AUDIO_NEON)
+		const float32x4_t maxValue = vdupq_n_f32(limit);
+		const float32x4_t minValue = vdupq_n_f32(-limit);
+		for (; i + 4 <= sampleCount; i += 4, buffer += 4)
+		{
+			vst1q_f32(buffer, vmaxq_f32(minValue, vminq_f32(vld1q_f32(buffer), maxValue)));
+		}
+	#endif
+		for (; i < sampleCount; i++, buffer++)
+		{
+			buffer[0] = std::max(-limit, std::min(buffer[0], limit));
+		}
+	}
+
+	// Matches TFE_Math::tanhf_series(), including the exact -1 and 1 values outside of the effective range.
+	void limit_tanh(f32* buffer, u32 sampleCount)
+	{
+		u32 i = 0;
+	#if defined(AUDIO_SSE2)
+		const __m128 range = _mm_set1_ps(4.8f);
+		const __m128 one   = _mm_set1_ps(1.0f);
+		const __m128 sign  = _mm_set1_ps(-0.0f);
+		const __m128 c0 = _mm_set1_ps(135135.0f);
+		const __m128 a1 = _mm_set1_ps(17325.0f);
+		const __m128 a2 = _mm_set1_ps(378.0f);
+		const __m128 b1 = _mm_set1_ps(62370.0f);
+		const __m128 b2 = _mm_set1_ps(3150.0f);
+		const __m128 b3 = _mm_set1_ps(28.0f);
+		for (; i + 4 <= sampleCount; i += 4, buffer += 4)
+		{
+			const __m128 beta = _mm_loadu_ps(buffer);
+			const __m128 x2 = _mm_mul_ps(beta, beta);
+			const __m128 a = _mm_mul_ps(beta, _mm_add_ps(c0, _mm_mul_ps(x2, _mm_add_ps(a1, _mm_mul_ps(x2, _mm_add_ps(a2, x2))))));
+			const __m128 b = _mm_add_ps(c0, _mm_mul_ps(x2, _mm_add_ps(b1, _mm_mul_ps(x2, _mm_add_ps(b2, _mm_mul_ps(x2, b3))))));
+			const __m128 value = _mm_div_ps(a, b);
+
+			// beta > 4.8 -> 1, beta <= -4.8 -> -1
+			const __m128 outside = _mm_or_ps(_mm_cmpgt_ps(beta, range), _mm_cmple_ps(beta, _mm_xor_ps(range, sign)));
+			const __m128 clamped = _mm_or_ps(one, _mm_and_ps(beta, sign));
+			_mm_storeu_ps(buffer, _mm_or_ps(_mm_and_ps(outside, clamped), _mm_andnot_ps(outside, value)));
+		}
+	#elif defined(AUDIO_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+		// 32-bit NEON has no division, which is required to match the scalar results.
+		const float32x4_t range = vdupq_n_f32(4.8f);
+		const float32x4_t nrange = vdupq_n_f32(-4.8f);
+		const float32x4_t one  = vdupq_n_f32(1.0f);
+		const float32x4_t none = vdupq_n_f32(-1.0f);
+		const float32x4_t c0 = vdupq_n_f32(135135.0f);
+		for (; i + 4 <= sampleCount; i += 4, buffer += 4)
+		{
+			const float32x4_t beta = vld1q_f32(buffer);
+			const float32x4_t x2 = vmulq_f32(beta, beta);
+			const float32x4_t a = vmulq_f32(beta, vaddq_f32(c0, vmulq_f32(x2, vaddq_f32(vdupq_n_f32(17325.0f), vmulq_f32(x2, vaddq_f32(vdupq_n_f32(378.0f), x2))))));
+			const float32x4_t b = vaddq_f32(c0, vmulq_f32(x2, vaddq_f32(vdupq_n_f32(62370.0f), vmulq_f32(x2, vaddq_f32(vdupq_n_f32(3150.0f), vmulq_n_f32(x2, 28.0f))))));
+			float32x4_t value = vdivq_f32(a, b);
+			value = vbslq_f32(vcgtq_f32(beta, range), one, value);
+			value = vbslq_f32(vcleq_f32(beta, nrange), none, value);
+			vst1q_f32(buffer, value);
+		}
+	#endif
+		for (; i < sampleCount; i++, buffer++)
+		{
+			buffer[0] = TFE_Math::tanhf_series(buffer[0]);
+		}
+	}
+
+	void limit_rcpSqrt(f32* buffer, u32 sampleCount)
+	{
+		u32 i = 0;
+	#if defined(AUDIO_SSE2)
+		const __m128 one = _mm_set1_ps(1.0f);
+		for (; i + 4 <= sampleCount; i += 4, buffer += 4)
+		{
+			const __m128 value = _mm_loadu_ps(buffer);
+			_mm_storeu_ps(buffer, _mm_div_ps(value, _mm_sqrt_ps(_mm_add_ps(one, _mm_mul_ps(value, value)))));
+		}
+	#endif
+		for (; i < sampleCount; i++, buffer++)
+		{
+			buffer[0] = buffer[0] / sqrtf(1.0f + buffer[0] * buffer[0]);
+		}
+	}
 }
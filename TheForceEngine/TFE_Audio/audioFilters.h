@@ -1,16 +1,51 @@
 #pragma once
 #include <TFE_System/types.h>
+#include <vector>
 
 enum AudioUpsampleFilter
 {
 	AUF_NONE = 0,
 	AUF_LINEAR,
+	AUF_SINC,		// Polyphase windowed-sinc, supports any input and output rate.
 	AUF_COUNT,
-	AUF_DEFAULT = AUF_LINEAR
+	AUF_DEFAULT = AUF_SINC
+};
+
+// Polyphase windowed-sinc resampler for interleaved stereo audio.
+// Input is written in blocks of any size and output is read at the output rate, the resampler keeps
+// the filter history between blocks so the conversion is continuous.
+struct SincResampler
+{
+	u32 inRate = 0;
+	u32 outRate = 0;
+	u32 taps = 0;			// Filter length in input samples.
+	u32 phases = 0;			// Number of filter phases in the table.
+	u64 step = 0;			// Input samples per output sample, 32.32 fixed point.
+	u64 pos = 0;			// Input position of the next output sample relative to the start of 'input', 32.32 fixed point.
+
+	std::vector<f32> table;	// (phases + 1) x taps filter coefficients.
+	std::vector<f32> input;	// Interleaved stereo input, including the filter history.
 };
 
 namespace TFE_Audio
 {
 	void upsample4x_point(f32* output, const f32* input, s32 inputSampleCount);
 	void upsample4x_linear(f32* output, const f32* input, s32 inputSampleCount);
+
+	// Setup the resampler to convert from 'inRate' to 'outRate', this also clears the history.
+	void resampler_init(SincResampler* resampler, u32 inRate, u32 outRate);
+	void resampler_reset(SincResampler* resampler);
+	// Add 'frameCount' stereo input frames.
+	void resampler_write(SincResampler* resampler, const f32* input, u32 frameCount);
+	// Write up to 'frameCount' stereo frames to the output, returns the number of frames written.
+	// If the result is less than 'frameCount', more input is required.
+	u32  resampler_read(SincResampler* resampler, f32* output, u32 frameCount);
+
+	// Accumulate mono samples scaled by volume into an interleaved stereo buffer.
+	void mixMonoToStereo(f32* output, const f32* input, u32 frameCount, f32 volume);
+
+	// Map out of range samples back into [-1, 1] in place.
+	void limit_clip(f32* buffer, u32 sampleCount, f32 limit);
+	void limit_tanh(f32* buffer, u32 sampleCount);
+	void limit_rcpSqrt(f32* buffer, u32 sampleCount);
 }
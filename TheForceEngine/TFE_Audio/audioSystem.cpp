@@ -8,6 +8,8 @@
 #include <TFE_Settings/settings.h>
 #include <TFE_FrontEndUI/console.h>
 #include <TFE_System/profiler.h>
+#include <TFE_System/spscQueue.h>
+#include <TFE_FileSystem/filestream.h>
 #include <assert.h>
 #include <algorithm>
 
@@ -19,25 +21,22 @@
 // Volume level below which sound processing can be skipped.
 #define SND_CULL_VOLUME 0.0001f
 
-// Set to 1 to enable audio timing counters.
-#define AUDIO_TIMING 0
-
 enum SoundSourceFlags
 {
 	SND_FLAG_ONE_SHOT = (1 << 0),
 	SND_FLAG_ACTIVE   = (1 << 1),
 	SND_FLAG_LOOPING  = (1 << 2),
 	SND_FLAG_PLAYING  = (1 << 3),
-	SND_FLAG_FINISHED = (1 << 4),
 };
 
+// Sound sources are owned by the game thread, the audio thread only sees them through the command queue.
 struct SoundSource
 {
 	SoundType type;
 	f32 volume;
-	u32 sampleIndex;
 	u32 flags;
 	s32 slot;
+	u32 generation;		// Incremented each time the source is played or freed, used to discard stale finished events.
 
 	// Sound data.
 	const SoundBuffer* buffer;
@@ -59,32 +58,140 @@ namespace TFE_Audio
 		AUDIO_CHANNEL_COUNT = 2,
 		AUDIO_FRAME_SIZE = 1024,
 		AUDIO_CALLBACK_BUFFER_SIZE = 256,	// 256
+		AUDIO_CALLBACK_FREQ = AUDIO_FREQ * AUDIO_CALLBACK_BUFFER_SIZE / AUDIO_FRAME_SIZE,	// Rate of the audio thread callback samples.
 		BUFFERED_SILENT_FRAME_COUNT = 16,
 	};
 
+	enum AudioCommandType
+	{
+		ACMD_PLAY = 0,
+		ACMD_STOP,
+		ACMD_SET_VOLUME,
+		ACMD_SET_BUFFER,
+		// Commands that do not target a voice.
+		ACMD_STOP_ALL,
+		ACMD_SET_FILTER,
+		ACMD_SET_THREAD_CALLBACK,
+		ACMD_THREAD_COMMAND,
+	};
+
+	enum AudioVoiceFlags
+	{
+		VOICE_PLAYING  = (1 << 0),
+		VOICE_LOOPING  = (1 << 1),
+		VOICE_FINISHED = (1 << 2),	// Finished but the event has not been posted yet.
+	};
+
+	// Posted by the game thread, applied at the start of each audio callback.
+	struct AudioCommand
+	{
+		u32 type;
+		s32 slot;
+		u32 generation;
+		u32 looping;
+		f32 volume;
+		const SoundBuffer* buffer;
+		// ACMD_SET_FILTER
+		AudioUpsampleFilter filter;
+		// ACMD_SET_THREAD_CALLBACK
+		AudioThreadCallback callback;
+		AudioThreadCommandHandler commandHandler;
+		// ACMD_THREAD_COMMAND
+		AudioThreadCommand threadCommand;
+	};
+
+	// Posted by the audio thread when a voice reaches the end of a non-looping buffer.
+	struct AudioFinishedEvent
+	{
+		s32 slot;
+		u32 generation;
+	};
+
+	// Audio thread copy of the source state, only touched by the audio thread while the output is running.
+	struct AudioVoice
+	{
+		const SoundBuffer* buffer;
+		f32 volume;
+		u32 sampleIndex;
+		u32 flags;
+		u32 generation;
+	};
+
 	// Client volume controls, ranging from [0, 1]
 	static f32 s_soundFxVolume = 1.0f;
 
+	// Game thread.
 	static u32 s_sourceCount;
 	static SoundSource s_sources[MAX_SOUND_SOURCES];
+	static bool s_commandOverflow = false;
+	// Audio thread.
+	static u32 s_voiceCount;
+	static AudioVoice s_voices[MAX_SOUND_SOURCES];
+
+	static SpscQueue<AudioCommand, 1024> s_commandQueue;		// game thread -> audio thread.
+	static SpscQueue<AudioFinishedEvent, 256> s_finishedQueue;	// audio thread -> game thread.
+
+	// Serializes the threads posting commands (game and midi threads), see lock() and unlock().
+	// The audio thread never takes it.
 	static SDL_mutex* s_mutex;
-	static bool s_paused = false;
+	static atomic_bool s_paused(false);
 	static bool s_nullDevice = false;
+	static bool s_offline = false;		// No output device, the callback is driven by renderOffline().
 	static volatile s32 s_silentAudioFrames = 0;
 
 	static AudioUpsampleFilter s_upsampleFilter = AUF_DEFAULT;
+	// Audio thread copies, changed through commands.
+	static AudioUpsampleFilter s_mixFilter = AUF_DEFAULT;
 	static AudioThreadCallback s_audioThreadCallback = nullptr;
+	static AudioThreadCommandHandler s_audioThreadCommandHandler = nullptr;
+	static SincResampler s_resampler;
+	static f32 s_callbackBuffer[(AUDIO_CALLBACK_BUFFER_SIZE + 2)*AUDIO_CHANNEL_COUNT];	// 256 stereo + oversampling.
 
 	static void audioCallback(void*, unsigned char*, int);
+	static bool initAudioThreadState();
+	static void resetSources();
+	static bool postCommand(const AudioCommand& command);
 	void setSoundVolumeConsole(const ConsoleArgList& args);
 	void getSoundVolumeConsole(const ConsoleArgList& args);
+	void setAudioFilterConsole(const ConsoleArgList& args);
+	void audioStatsConsole(const ConsoleArgList& args);
+	void exportAudioStatsConsole(const ConsoleArgList& args);
 
-#if AUDIO_TIMING == 1
-	static f64 s_soundIterMaxF = 0.0;
-	static f64 s_soundIterAveF = 0.0;
-	static s32 s_soundIterMax = 0;
-	static s32 s_soundIterAve = 0;
-#endif
+	static const char* c_upsampleFilterName[AUF_COUNT] =
+	{
+		"none",		// AUF_NONE
+		"linear",	// AUF_LINEAR
+		"sinc",		// AUF_SINC
+	};
+
+	// Audio thread statistics, always collected since the cost is a few timer reads per callback.
+	// The audio thread accumulates into s_statsLocal and publishes a copy after each callback, see getThreadStats().
+	struct AudioStatsAccum
+	{
+		u32 callbacks;
+		u32 deadlineMisses;
+		u32 lateCallbacks;
+		f64 periodSec;
+		f64 totalSec;
+		f64 maxSec;
+		f64 waveSec;
+		f64 voiceSec;
+		f64 synthSec;
+		u32 histogram[AUDIO_STATS_BUCKET_COUNT];
+	};
+	// A callback that starts this many periods after the previous one means the output ran dry.
+	static const f64 c_lateCallbackPeriods = 2.0;
+
+	static AudioStatsAccum s_statsLocal = {};	// Audio thread.
+	static AudioStatsAccum s_statsShared = {};	// Published copy, guarded by s_statsSeq.
+	static atomic_u32 s_statsSeq(0);			// Odd while the audio thread is writing s_statsShared.
+	static atomic_bool s_statsReset(false);
+	static u64 s_lastCallbackStart = 0;
+	// Profiler counters, refreshed on the game thread by update().
+	static s32 s_callbackAveUs = 0;
+	static s32 s_callbackMaxUs = 0;
+	static s32 s_deadlineMisses = 0;
+	static s32 s_lateCallbacks = 0;
 
 	bool init(bool useNullDevice/*=false*/, s32 outputId/*=-1*/)
 	{
@@ -93,20 +200,18 @@ namespace TFE_Audio
 
 		CCMD("setSoundVolume", setSoundVolumeConsole, 1, "Sets the sound volume, range is 0.0 to 1.0");
 		CCMD("getSoundVolume", getSoundVolumeConsole, 0, "Get the current sound volume.");
-
-	#if AUDIO_TIMING == 1
-		TFE_COUNTER(s_soundIterMax, "SoundIterMax-MicroSec");
-		TFE_COUNTER(s_soundIterAve, "SoundIterAve-MicroSec");
-	#endif
+		CCMD("setAudioFilter", setAudioFilterConsole, 1, "Sets the audio upsample filter: none, linear or sinc.");
+		CCMD("audioStats", audioStatsConsole, 0, "Prints the audio thread timing statistics, pass 'reset' to clear them.");
+		CCMD("exportAudioStats", exportAudioStatsConsole, 0, "Writes the audio thread timing statistics to a JSON file, defaults to audiostats.json in the user documents.");
+		TFE_COUNTER(s_callbackAveUs, "Audio Callback Ave-MicroSec");
+		TFE_COUNTER(s_callbackMaxUs, "Audio Callback Max-MicroSec");
+		TFE_COUNTER(s_deadlineMisses, "Audio Deadline Misses");
+		TFE_COUNTER(s_lateCallbacks, "Audio Late Callbacks");
 
 		TFE_Settings_Sound* soundSettings = TFE_Settings::getSoundSettings();
 		setVolume(soundSettings->soundFxVolume);
 
-		memset(s_sources, 0, sizeof(SoundSource) * MAX_SOUND_SOURCES);
-		for (s32 i = 0; i < MAX_SOUND_SOURCES; i++)
-		{
-			s_sources[i].slot = i;
-		}
+		resetSources();
 
 		bool audDev = TFE_AudioDevice::init(AUDIO_FRAME_SIZE, outputId, useNullDevice);
 		if (!audDev)
@@ -116,27 +221,61 @@ namespace TFE_Audio
 			return false;
 		}
 
+		// The mutex must exist before the output starts, since the callback may run immediately.
+		if (!initAudioThreadState())
+		{
+			TFE_AudioDevice::destroy();
+			s_nullDevice = true;
+			return false;
+		}
+
 		bool audStream = TFE_AudioDevice::startOutput(audioCallback, nullptr, AUDIO_CHANNEL_COUNT, AUDIO_FREQ);
 		if (!audStream)
 		{
 			TFE_System::logWrite(LOG_ERROR, "Audio", "Cannot start audio stream.");
+			TFE_AudioDevice::destroy();
+			SDL_DestroyMutex(s_mutex);
+			s_mutex = nullptr;
 			s_nullDevice = true;
 			return false;
 		}
 
-		s_mutex = SDL_CreateMutex();
-		if (!s_mutex)
+		s_nullDevice = false;
+		s_offline = false;
+		return true;
+	}
+
+	bool initOffline()
+	{
+		TFE_System::logWrite(LOG_MSG, "Startup", "TFE_AudioSystem::initOffline");
+		s_sourceCount = 0u;
+
+		TFE_Settings_Sound* soundSettings = TFE_Settings::getSoundSettings();
+		setVolume(soundSettings->soundFxVolume);
+		resetSources();
+
+		if (!initAudioThreadState())
 		{
-			TFE_System::logWrite(LOG_ERROR, "Audio", "Cannot init SDL_mutex.");
-			TFE_AudioDevice::destroy();
 			s_nullDevice = true;
 			return false;
 		}
-
+		s_silentAudioFrames = 0;
 		s_nullDevice = false;
+		s_offline = true;
 		return true;
 	}
 
+	void renderOffline(f32* buffer, u32 frameCount)
+	{
+		if (!s_offline) { return; }
+		audioCallback(nullptr, (unsigned char*)buffer, s32(frameCount * AUDIO_CHANNEL_COUNT * sizeof(f32)));
+	}
+
+	u32 getOutputSampleRate()
+	{
+		return AUDIO_FREQ;
+	}
+
 	void shutdown()
 	{
 		TFE_System::logWrite(LOG_MSG, "Audio", "Shutdown");
@@ -144,26 +283,153 @@ namespace TFE_Audio
 
 		stopAllSounds();
 
-		TFE_AudioDevice::destroy();
+		if (!s_offline)
+		{
+			TFE_AudioDevice::destroy();
+		}
 		SDL_DestroyMutex(s_mutex);
+		s_mutex = nullptr;
+		s_offline = false;
 	}
 
 	void stopAllSounds()
 	{
 		if (s_nullDevice) { return; }
 
-		SDL_LockMutex(s_mutex);
-		s_sourceCount = 0u;
-		memset(s_sources, 0, sizeof(SoundSource) * MAX_SOUND_SOURCES);
-		for (s32 i = 0; i < MAX_SOUND_SOURCES; i++)
+		AudioCommand command = { ACMD_STOP_ALL };
+		postCommand(command);
+		resetSources();
+	}
+
+	// Process the sounds that finished on the audio thread: free one shots and call the finished callbacks.
+	void update()
+	{
+		if (s_nullDevice) { return; }
+
+		AudioFinishedEvent finished;
+		while (s_finishedQueue.pop(finished))
 		{
-			s_sources[i].slot = i;
+			SoundSource* source = &s_sources[finished.slot];
+			// Skip events for sources that have been stopped, freed or restarted since.
+			if (source->generation != finished.generation || !(source->flags & SND_FLAG_PLAYING))
+			{
+				continue;
+			}
+
+			source->flags = 0;
+			source->buffer = nullptr;
+			if (source->finishedCallback)
+			{
+				source->finishedCallback(source->finishedUserData, source->finishedArg);
+			}
 		}
-		SDL_UnlockMutex(s_mutex);
+
+		// Shrink the number of sources until an active source is found.
+		while (s_sourceCount && !(s_sources[s_sourceCount - 1].flags & SND_FLAG_ACTIVE))
+		{
+			s_sourceCount--;
+		}
+
+		AudioThreadStats stats;
+		getThreadStats(&stats);
+		s_callbackAveUs  = s32(stats.aveMs * 1000.0);
+		s_callbackMaxUs  = s32(stats.maxMs * 1000.0);
+		s_deadlineMisses = s32(stats.deadlineMisses);
+		s_lateCallbacks  = s32(stats.lateCallbacks);
+	}
+
+	void getThreadStats(AudioThreadStats* stats)
+	{
+		// Retry if the audio thread published new stats while copying, after a few tries take what was read.
+		AudioStatsAccum accum;
+		for (s32 attempt = 0; attempt < 8; attempt++)
+		{
+			const u32 seq = s_statsSeq.load(std::memory_order_acquire);
+			accum = s_statsShared;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (!(seq & 1) && s_statsSeq.load(std::memory_order_relaxed) == seq) { break; }
+		}
+
+		const f64 scale = accum.callbacks ? 1000.0 / f64(accum.callbacks) : 0.0;
+		stats->callbacks = accum.callbacks;
+		stats->deadlineMisses = accum.deadlineMisses;
+		stats->lateCallbacks = accum.lateCallbacks;
+		stats->periodMs = accum.periodSec * 1000.0;
+		stats->aveMs = accum.totalSec * scale;
+		stats->maxMs = accum.maxSec * 1000.0;
+		stats->waveAveMs = accum.waveSec * scale;
+		stats->voiceAveMs = accum.voiceSec * scale;
+		stats->synthAveMs = accum.synthSec * scale;
+		memcpy(stats->histogram, accum.histogram, sizeof(u32) * AUDIO_STATS_BUCKET_COUNT);
+	}
+
+	void resetThreadStats()
+	{
+		// Cleared by the audio thread at the start of the next callback.
+		s_statsReset.store(true);
+	}
+
+	bool writeThreadStats(const char* path)
+	{
+		FileStream file;
+		if (!file.open(path, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_ERROR, "Audio", "Cannot write audio stats to '%s'.", path);
+			return false;
+		}
+
+		AudioThreadStats stats;
+		getThreadStats(&stats);
+
+		s32 outputCount = 0, curOutput = -1;
+		const OutputDeviceInfo* outputs = s_nullDevice || s_offline ? nullptr : getOutputDeviceList(outputCount, curOutput);
+		const char* outputName = (outputs && curOutput >= 0 && curOutput < outputCount) ? outputs[curOutput].name.c_str() : "default";
+
+		file.writeString("{\n");
+		file.writeString("  \"version\": \"%s\",\n", TFE_System::getVersionString());
+		file.writeString("  \"output\": \"");
+		// Device names are user visible strings, drop anything that would need escaping.
+		for (const char* c = outputName; *c; c++)
+		{
+			if (*c != '"' && *c != '\\' && u8(*c) >= 32) { file.writeBuffer(c, 1); }
+		}
+		file.writeString("\",\n");
+		file.writeString("  \"sampleRate\": %u,\n", getOutputSampleRate());
+		file.writeString("  \"upsampleFilter\": \"%s\",\n", c_upsampleFilterName[s_upsampleFilter]);
+		file.writeString("  \"midiRenderAheadMs\": %d,\n", TFE_MidiPlayer::getRenderAhead());
+		file.writeString("  \"midiUnderruns\": %d,\n", TFE_MidiPlayer::getUnderrunCount());
+		file.writeString("  \"callbacks\": %u,\n", stats.callbacks);
+		file.writeString("  \"deadlineMisses\": %u,\n", stats.deadlineMisses);
+		file.writeString("  \"lateCallbacks\": %u,\n", stats.lateCallbacks);
+		file.writeString("  \"periodMs\": %.4f,\n", stats.periodMs);
+		file.writeString("  \"aveMs\": %.4f,\n", stats.aveMs);
+		file.writeString("  \"maxMs\": %.4f,\n", stats.maxMs);
+		file.writeString("  \"breakdownAveMs\": { \"wave\": %.4f, \"voices\": %.4f, \"synth\": %.4f },\n",
+			stats.waveAveMs, stats.voiceAveMs, stats.synthAveMs);
+		file.writeString("  \"histogram\": [\n");
+		for (s32 i = 0; i < AUDIO_STATS_BUCKET_COUNT; i++)
+		{
+			const bool last = (i == AUDIO_STATS_BUCKET_COUNT - 1);
+			if (last)
+			{
+				file.writeString("    { \"load\": \">100%%\", \"count\": %u }\n", stats.histogram[i]);
+			}
+			else
+			{
+				file.writeString("    { \"load\": \"%d-%d%%\", \"count\": %u },\n", i * 10, (i + 1) * 10, stats.histogram[i]);
+			}
+		}
+		file.writeString("  ]\n");
+		file.writeString("}\n");
+		file.close();
+
+		TFE_System::logWrite(LOG_MSG, "Audio", "Wrote audio stats to '%s'.", path);
+		return true;
 	}
 
 	void selectDevice(s32 id)
 	{
+		if (s_offline) { return; }
 		if (id < 0)
 		{
 			id = TFE_AudioDevice::getDefaultOutputDevice();
@@ -179,6 +445,12 @@ namespace TFE_Audio
 	void setUpsampleFilter(AudioUpsampleFilter filter)
 	{
 		s_upsampleFilter = filter;
+		if (s_nullDevice) { return; }
+
+		AudioCommand command = {};
+		command.type = ACMD_SET_FILTER;
+		command.filter = filter;
+		postCommand(command);
 	}
 
 	AudioUpsampleFilter getUpsampleFilter()
@@ -198,16 +470,12 @@ namespace TFE_Audio
 
 	void pause()
 	{
-		SDL_LockMutex(s_mutex);
 		s_paused = true;
-		SDL_UnlockMutex(s_mutex);
 	}
 
 	void resume()
 	{
-		SDL_LockMutex(s_mutex);
 		s_paused = false;
-		SDL_UnlockMutex(s_mutex);
 	}
 
 	// Really the buffered audio will continue to process so time advances properly.
@@ -218,13 +486,26 @@ namespace TFE_Audio
 		s_silentAudioFrames = BUFFERED_SILENT_FRAME_COUNT;
 	}
 		
-	void setAudioThreadCallback(AudioThreadCallback callback)
+	void setAudioThreadCallback(AudioThreadCallback callback, AudioThreadCommandHandler commandHandler)
 	{
 		if (s_nullDevice) { return; }
 
-		SDL_LockMutex(s_mutex);
-		s_audioThreadCallback = callback;
-		SDL_UnlockMutex(s_mutex);
+		AudioCommand command = {};
+		command.type = ACMD_SET_THREAD_CALLBACK;
+		command.callback = callback;
+		command.commandHandler = commandHandler;
+		postCommand(command);
+	}
+
+	bool postAudioThreadCommand(const AudioThreadCommand& threadCommand)
+	{
+		// There is no audio thread to apply it.
+		if (s_nullDevice) { return true; }
+
+		AudioCommand command = {};
+		command.type = ACMD_THREAD_COMMAND;
+		command.threadCommand = threadCommand;
+		return postCommand(command);
 	}
 
 	const OutputDeviceInfo* getOutputDeviceList(s32& count, s32& curOutput)
@@ -244,86 +525,156 @@ namespace TFE_Audio
 		SDL_UnlockMutex(s_mutex);
 	}
 
-	// One shot, play and forget. Only do this if the client needs no control until stopAllSounds() is called.
-	// Note that looping one shots are valid.
-	bool playOneShot(SoundType type, f32 volume, const SoundBuffer* buffer, bool looping, SoundFinishedCallback finishedCallback, void* cbUserData, s32 cbArg)
+	// Create the mutex and reset the state owned by the audio thread, which is not running yet.
+	// The audio thread callback is kept, so its owner stays registered when the output device changes.
+	static bool initAudioThreadState()
 	{
-		if (!buffer || s_nullDevice) { return false; }
-
-		SDL_LockMutex(s_mutex);
-		// Find the first inactive source.
-		SoundSource* snd = s_sources;
-		SoundSource* newSource = nullptr;
-		for (u32 s = 0; s < s_sourceCount; s++, snd++)
+		s_mutex = SDL_CreateMutex();
+		if (!s_mutex)
 		{
-			if (!(snd->flags&SND_FLAG_ACTIVE))
-			{
-				newSource = snd;
-				break;
-			}
+			TFE_System::logWrite(LOG_ERROR, "Audio", "Cannot init SDL_mutex.");
+			return false;
 		}
-		if (!newSource && s_sourceCount < MAX_SOUND_SOURCES)
+
+		// Pending commands are kept, the audio thread callback owner may have posted state changes that must not be lost.
+		// Sources posted before the previous shutdown are stopped by the ACMD_STOP_ALL it posted.
+		AudioFinishedEvent finished;
+		while (s_finishedQueue.pop(finished));
+		memset(s_voices, 0, sizeof(AudioVoice) * MAX_SOUND_SOURCES);
+		s_voiceCount = 0u;
+		s_mixFilter = s_upsampleFilter;
+
+		resampler_init(&s_resampler, AUDIO_CALLBACK_FREQ, AUDIO_FREQ);
+		return true;
+	}
+
+	static void resetSources()
+	{
+		s_sourceCount = 0u;
+		for (s32 i = 0; i < MAX_SOUND_SOURCES; i++)
 		{
-			newSource = &s_sources[s_sourceCount];
-			s_sourceCount++;
+			// Keep the generation so events already in flight are still discarded.
+			const u32 generation = s_sources[i].generation + 1;
+			s_sources[i] = {};
+			s_sources[i].slot = i;
+			s_sources[i].generation = generation;
 		}
+	}
 
-		if (newSource)
+	// Called from the game and midi threads, the queue has a single producer so posting is serialized by the mutex.
+	static bool postCommand(const AudioCommand& command)
+	{
+		bool posted = true;
+		SDL_LockMutex(s_mutex);
+		if (s_commandQueue.push(command))
 		{
-			newSource->type = type;
-			newSource->flags = SND_FLAG_ACTIVE | SND_FLAG_PLAYING | SND_FLAG_ONE_SHOT;
-			if (looping)
+			s_commandOverflow = false;
+		}
+		else
+		{
+			// The audio thread is not keeping up (or is not running), avoid flooding the log.
+			if (!s_commandOverflow)
 			{
-				newSource->flags |= SND_FLAG_LOOPING;
+				TFE_System::logWrite(LOG_WARNING, "Audio", "Audio command queue is full, commands are being dropped.");
+				s_commandOverflow = true;
 			}
-			newSource->volume = type == SOUND_3D ? 0.0f : volume;
-			newSource->buffer = buffer;
-			newSource->sampleIndex = 0u;
-			newSource->finishedCallback = finishedCallback;
-			newSource->finishedUserData = cbUserData;
-			newSource->finishedArg = cbArg;
+			posted = false;
 		}
 		SDL_UnlockMutex(s_mutex);
+		return posted;
+	}
 
-		return newSource != nullptr;
+	static bool postPlay(SoundSource* source)
+	{
+		source->generation++;
+
+		AudioCommand command;
+		command.type = ACMD_PLAY;
+		command.slot = source->slot;
+		command.generation = source->generation;
+		command.looping = (source->flags & SND_FLAG_LOOPING) ? 1 : 0;
+		command.volume = source->volume;
+		command.buffer = source->buffer;
+		return postCommand(command);
 	}
 
-	// Sound source that the client holds onto.
-	SoundSource* createSoundSource(SoundType type, f32 volume, const SoundBuffer* buffer, SoundFinishedCallback callback, void* userData)
+	static void postSlotCommand(SoundSource* source, u32 type)
 	{
-		if (!buffer || s_nullDevice) { return nullptr; }
-		assert(volume >= 0.0f && volume <= 1.0f);
+		AudioCommand command = {};
+		command.type = type;
+		command.slot = source->slot;
+		command.volume = source->volume;
+		command.buffer = source->buffer;
+		postCommand(command);
+	}
 
-		SDL_LockMutex(s_mutex);
+	static SoundSource* allocateSource()
+	{
 		// Find the first inactive source.
 		SoundSource* snd = s_sources;
-		SoundSource* newSource = nullptr;
 		for (u32 s = 0; s < s_sourceCount; s++, snd++)
 		{
 			if (!(snd->flags&SND_FLAG_ACTIVE))
 			{
-				newSource = snd;
-				break;
+				return snd;
 			}
 		}
-		if (!newSource && s_sourceCount < MAX_SOUND_SOURCES)
+		if (s_sourceCount < MAX_SOUND_SOURCES)
 		{
-			newSource = &s_sources[s_sourceCount];
+			snd = &s_sources[s_sourceCount];
 			s_sourceCount++;
+			return snd;
+		}
+		return nullptr;
+	}
+
+	// One shot, play and forget. Only do this if the client needs no control until stopAllSounds() is called.
+	// Note that looping one shots are valid.
+	bool playOneShot(SoundType type, f32 volume, const SoundBuffer* buffer, bool looping, SoundFinishedCallback finishedCallback, void* cbUserData, s32 cbArg)
+	{
+		if (!buffer || s_nullDevice) { return false; }
+
+		SoundSource* newSource = allocateSource();
+		if (!newSource) { return false; }
+
+		newSource->type = type;
+		newSource->flags = SND_FLAG_ACTIVE | SND_FLAG_PLAYING | SND_FLAG_ONE_SHOT;
+		if (looping)
+		{
+			newSource->flags |= SND_FLAG_LOOPING;
 		}
+		newSource->volume = type == SOUND_3D ? 0.0f : volume;
+		newSource->buffer = buffer;
+		newSource->finishedCallback = finishedCallback;
+		newSource->finishedUserData = cbUserData;
+		newSource->finishedArg = cbArg;
 
+		if (!postPlay(newSource))
+		{
+			newSource->flags = 0;
+			newSource->buffer = nullptr;
+			return false;
+		}
+		return true;
+	}
+
+	// Sound source that the client holds onto.
+	SoundSource* createSoundSource(SoundType type, f32 volume, const SoundBuffer* buffer, SoundFinishedCallback callback, void* userData)
+	{
+		if (!buffer || s_nullDevice) { return nullptr; }
+		assert(volume >= 0.0f && volume <= 1.0f);
+
+		SoundSource* newSource = allocateSource();
 		if (newSource)
 		{
 			newSource->type = type;
 			newSource->flags = SND_FLAG_ACTIVE;
 			newSource->volume = volume;
 			newSource->buffer = buffer;
-			newSource->sampleIndex = 0u;
 			newSource->finishedCallback = callback;
 			newSource->finishedUserData = userData;
+			newSource->finishedArg = 0;
 		}
-		SDL_UnlockMutex(s_mutex);
-
 		return newSource;
 	}
 
@@ -355,48 +706,53 @@ namespace TFE_Audio
 		{
 			return;
 		}
-		
-		SDL_LockMutex(s_mutex);
-			source->flags |= SND_FLAG_PLAYING;
-			if (looping) { source->flags |= SND_FLAG_LOOPING; }
-			source->sampleIndex = 0u;
-		SDL_UnlockMutex(s_mutex);
+
+		source->flags |= SND_FLAG_PLAYING;
+		if (looping) { source->flags |= SND_FLAG_LOOPING; }
+		if (!postPlay(source))
+		{
+			source->flags &= ~SND_FLAG_PLAYING;
+		}
 	}
 
 	void stopSource(SoundSource* source)
 	{
 		if (!source || s_nullDevice) { return; }
-		SDL_LockMutex(s_mutex);
-			source->flags &= ~SND_FLAG_PLAYING;
-		SDL_UnlockMutex(s_mutex);
+		source->flags &= ~SND_FLAG_PLAYING;
+		postSlotCommand(source, ACMD_STOP);
 	}
 	
 	void freeSource(SoundSource* source)
 	{
 		if (!source || s_nullDevice) { return; }
-		SDL_LockMutex(s_mutex);
-			source->flags &= ~SND_FLAG_PLAYING;
-			source->flags &= ~SND_FLAG_ACTIVE;
-			source->buffer = nullptr;
-		SDL_UnlockMutex(s_mutex);
+		source->flags &= ~(SND_FLAG_PLAYING | SND_FLAG_ACTIVE);
+		source->buffer = nullptr;
+		source->generation++;
+		postSlotCommand(source, ACMD_STOP);
 	}
 
 	void setSourceVolume(SoundSource* source, f32 volume)
 	{
 		if (s_nullDevice) { return; }
-		source->volume = std::max(0.0f, std::min(1.0f, volume));
+		volume = std::max(0.0f, std::min(1.0f, volume));
+		if (volume == source->volume) { return; }
+
+		source->volume = volume;
+		if (source->flags & SND_FLAG_PLAYING)
+		{
+			postSlotCommand(source, ACMD_SET_VOLUME);
+		}
 	}
 
 	// This will restart the sound and change the buffer.
 	void setSourceBuffer(SoundSource* source, const SoundBuffer* buffer)
 	{
 		if (s_nullDevice) { return; }
-		SDL_LockMutex(s_mutex);
-			source->sampleIndex = 0u;
-			source->buffer = buffer;
-		SDL_UnlockMutex(s_mutex);
+		source->buffer = buffer;
+		postSlotCommand(source, ACMD_SET_BUFFER);
 	}
 
+	// Note the source keeps playing until update() has processed the finished event from the audio thread.
 	bool isSourcePlaying(SoundSource* source)
 	{
 		if (s_nullDevice) { return false; }
@@ -413,191 +769,363 @@ namespace TFE_Audio
 	static const f32 c_scale[] = { 2.0f / 255.0f, 2.0f / 65535.0f, 1.0f };
 	static const f32 c_offset[] = { -1.0f, -1.0f, 0.0f };
 
-	void cleanupSources()
+	// Convert 'count' samples starting at 'start' to float.
+	static void convertSamples(f32* output, const SoundBuffer* buffer, u32 start, u32 count)
 	{
-		// call any finished callbacks.
-		for (u32 s = 0; s < s_sourceCount; s++)
+		const f32 scale = c_scale[buffer->type];
+		const f32 offset = c_offset[buffer->type];
+		switch (buffer->type)
 		{
-			if (s_sources[s].flags&SND_FLAG_FINISHED)
+			case SOUND_DATA_8BIT:
 			{
-				s_sources[s].flags = 0;
-				s_sources[s].buffer = nullptr;
-				if (s_sources[s].finishedCallback)
-				{
-					s_sources[s].finishedCallback(s_sources[s].finishedUserData, s_sources[s].finishedArg);
-				}
-			}
+				const u8* data = buffer->data + start;
+				for (u32 i = 0; i < count; i++) { output[i] = f32(data[i]) * scale + offset; }
+			} break;
+			case SOUND_DATA_16BIT:
+			{
+				const u16* data = (u16*)buffer->data + start;
+				for (u32 i = 0; i < count; i++) { output[i] = f32(data[i]) * scale + offset; }
+			} break;
+			case SOUND_DATA_FLOAT:
+			{
+				memcpy(output, (f32*)buffer->data + start, sizeof(f32) * count);
+			} break;
+		};
+	}
+
+	void prepareSoundBuffer(SoundBuffer* buffer)
+	{
+		if (!buffer || !buffer->data || !buffer->size || buffer->samples) { return; }
+		buffer->samples = new f32[buffer->size];
+		convertSamples(buffer->samples, buffer, 0, buffer->size);
+	}
+
+	void freeSoundBufferSamples(SoundBuffer* buffer)
+	{
+		if (!buffer) { return; }
+		delete[] buffer->samples;
+		buffer->samples = nullptr;
+	}
+
+	// Mix 'count' samples of the buffer starting at 'start' into the stereo output.
+	static void mixSource(f32* output, const SoundBuffer* buffer, u32 start, u32 count, f32 volume)
+	{
+		if (buffer->samples)
+		{
+			mixMonoToStereo(output, buffer->samples + start, count, volume);
+			return;
+		}
+
+		// The buffer was not prepared, so convert it in blocks.
+		f32 samples[256];
+		while (count)
+		{
+			const u32 blockCount = std::min(count, 256u);
+			convertSamples(samples, buffer, start, blockCount);
+			mixMonoToStereo(output, samples, blockCount, volume);
+
+			output += blockCount * 2;
+			start += blockCount;
+			count -= blockCount;
 		}
+	}
 
-		const s32 end = (s32)s_sourceCount - 1;
-		//shrink the number of sources until an active source is found.
-		for (s32 s = end; s >= 0; s--)
+	static void applyGlobalCommand(const AudioCommand& command)
+	{
+		switch (command.type)
 		{
-			if (s_sources[s].flags&SND_FLAG_ACTIVE)
+			case ACMD_STOP_ALL:
 			{
-				break;
-			}
-			s_sourceCount--;
+				memset(s_voices, 0, sizeof(AudioVoice) * s_voiceCount);
+				s_voiceCount = 0u;
+			} break;
+			case ACMD_SET_FILTER:
+			{
+				if (command.filter == AUF_SINC && s_mixFilter != AUF_SINC)
+				{
+					resampler_reset(&s_resampler);
+				}
+				s_mixFilter = command.filter;
+			} break;
+			case ACMD_SET_THREAD_CALLBACK:
+			{
+				s_audioThreadCallback = command.callback;
+				s_audioThreadCommandHandler = command.commandHandler;
+				// Drop any audio buffered from the previous callback.
+				resampler_reset(&s_resampler);
+			} break;
+			case ACMD_THREAD_COMMAND:
+			{
+				// Commands posted before the owner registered (or after it was removed) have nowhere to go.
+				if (s_audioThreadCommandHandler)
+				{
+					s_audioThreadCommandHandler(&command.threadCommand);
+				}
+			} break;
 		}
 	}
-		
-	f32 sampleBuffer(u32 index, SoundDataType type, const u8* data)
+
+	// Apply the commands posted by the game and midi threads since the last callback.
+	static void applyCommands()
 	{
-		f32 sampleValue = 0.0f;
-		switch (type)
+		AudioCommand command;
+		while (s_commandQueue.pop(command))
 		{
-			case SOUND_DATA_8BIT:  { sampleValue = (f32)data[index]; } break;
-			case SOUND_DATA_16BIT: { sampleValue = (f32)(*((u16*)data + index)); } break;
-			case SOUND_DATA_FLOAT: { sampleValue = *((f32*)data + index); } break;
-		};
+			if (command.type >= ACMD_STOP_ALL)
+			{
+				applyGlobalCommand(command);
+				continue;
+			}
 
-		return sampleValue * c_scale[type] + c_offset[type];
+			AudioVoice* voice = &s_voices[command.slot];
+			switch (command.type)
+			{
+				case ACMD_PLAY:
+				{
+					// Replaces any unposted finished event, it belongs to an older generation.
+					voice->buffer = command.buffer;
+					voice->volume = command.volume;
+					voice->sampleIndex = 0u;
+					voice->flags = VOICE_PLAYING | (command.looping ? VOICE_LOOPING : 0);
+					voice->generation = command.generation;
+					s_voiceCount = std::max(s_voiceCount, u32(command.slot + 1));
+				} break;
+				case ACMD_STOP:
+				{
+					voice->flags = 0;
+					voice->buffer = nullptr;
+				} break;
+				case ACMD_SET_VOLUME:
+				{
+					voice->volume = command.volume;
+				} break;
+				case ACMD_SET_BUFFER:
+				{
+					voice->buffer = command.buffer;
+					voice->sampleIndex = 0u;
+				} break;
+			}
+		}
+
+		// Shrink the number of voices until an active voice is found.
+		while (s_voiceCount && !s_voices[s_voiceCount - 1].flags)
+		{
+			s_voiceCount--;
+		}
 	}
-			
-	// Audio callback
-	static void audioCallback(void* userData, unsigned char* outputBuffer, int bufsize)
+
+	static void finishVoice(AudioVoice* voice)
 	{
-		f32* buffer = (f32*)outputBuffer;
-		u32 bufferSize = (u32)bufsize;
-		u32 frames = bufferSize / (AUDIO_CHANNEL_COUNT * sizeof(f32));
+		voice->flags = VOICE_FINISHED;
+		voice->sampleIndex = 0u;
+	}
 
-	#if AUDIO_TIMING == 1
-		u64 soundIterStart = TFE_System::getCurrentTimeInTicks();
-	#endif
+	// Post finished events back to the game thread, if the queue is full they are retried next callback.
+	static void postFinishedVoices()
+	{
+		AudioVoice* voice = s_voices;
+		for (u32 s = 0; s < s_voiceCount; s++, voice++)
+		{
+			if (!(voice->flags & VOICE_FINISHED)) { continue; }
 
-		// First clear samples
-		memset(buffer, 0, bufferSize);
-			   
-		SDL_LockMutex(s_mutex);
-		// Then call the audio thread callback
-		if (s_audioThreadCallback && !s_paused)
-		{
-			static f32 callbackBuffer[(AUDIO_CALLBACK_BUFFER_SIZE + 2)*AUDIO_CHANNEL_COUNT];	// 256 stereo + oversampling.
-			s_audioThreadCallback(callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE, s_soundFxVolume * c_soundHeadroom);
-			// The audio buffer is 1/4 as large as it should be.
-			// This means that in-between samples must be interpolated.
-			if (!s_silentAudioFrames)
+			const AudioFinishedEvent finished = { s32(s), voice->generation };
+			if (!s_finishedQueue.push(finished))
 			{
-				if (s_upsampleFilter == AUF_NONE)
-				{
-					upsample4x_point(buffer, callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE*AUDIO_CHANNEL_COUNT);
-				}
-				else if (s_upsampleFilter == AUF_LINEAR)
-				{
-					upsample4x_linear(buffer, callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE*AUDIO_CHANNEL_COUNT);
-				}
+				break;
 			}
+			voice->flags = 0;
+			voice->buffer = nullptr;
 		}
+	}
 
-		// Then loop through the sources.
-		// Note: this is no longer used by Dark Forces. However I decided to keep direct sound support around
-		// so it can be used for tools.
-		SoundSource* snd = s_sources;
-		for (u32 s = 0; s < s_sourceCount && !s_paused; s++, snd++)
+	static void mixVoices(f32* output, u32 frames)
+	{
+		AudioVoice* voice = s_voices;
+		for (u32 s = 0; s < s_voiceCount; s++, voice++)
 		{
-			if (!(snd->flags&SND_FLAG_PLAYING)) { continue; }
-			assert(snd->buffer->data);
+			if (!(voice->flags&VOICE_PLAYING)) { continue; }
+			assert(voice->buffer->data);
 
 			// Skip sound sample processing the sound is too quiet...
-			const u32 sndBufferSize = snd->buffer->size;
-			if (snd->volume < SND_CULL_VOLUME)
+			const u32 sndBufferSize = voice->buffer->size;
+			if (voice->volume < SND_CULL_VOLUME)
 			{
 				// Pretend we played the sound and handle looping.
-				snd->sampleIndex += frames;
-				if (snd->sampleIndex >= sndBufferSize)
+				voice->sampleIndex += frames;
+				if (voice->sampleIndex >= sndBufferSize)
 				{
-					if (snd->flags&SND_FLAG_LOOPING)
+					if (voice->flags&VOICE_LOOPING)
 					{
-						snd->sampleIndex = (snd->sampleIndex % sndBufferSize) + snd->buffer->loopStart;
+						voice->sampleIndex = (voice->sampleIndex % sndBufferSize) + voice->buffer->loopStart;
 					}
 					else
 					{
-						snd->flags &= ~SND_FLAG_PLAYING;
-						snd->flags |= SND_FLAG_FINISHED;
-						snd->sampleIndex = 0u;
+						finishVoice(voice);
 					}
 				}
 				continue;
 			}
 
 			// Sample loop.
-			buffer = (f32*)outputBuffer;
+			f32* buffer = output;
 			// The sound may be split into multiple iterations if it loops or the loop
 			// may end early, once we reach the end.
 			for (u32 i = 0; i < frames;)
 			{
-				if (snd->sampleIndex >= sndBufferSize)
+				if (voice->sampleIndex >= sndBufferSize)
 				{
-					if (snd->flags&SND_FLAG_LOOPING)
+					if (voice->flags&VOICE_LOOPING)
 					{
-						snd->sampleIndex = snd->buffer->loopStart;
+						voice->sampleIndex = voice->buffer->loopStart;
 					}
 					else
 					{
-						snd->flags &= ~SND_FLAG_PLAYING;
-						snd->flags |= SND_FLAG_FINISHED;
-						snd->sampleIndex = 0u;
+						finishVoice(voice);
 						break;
 					}
 				}
 
-				const SoundDataType type = snd->buffer->type;
-				const u8* data = snd->buffer->data;
-				const u32 end = std::min(sndBufferSize, snd->sampleIndex + frames - i);
-				u32 sIndex = snd->sampleIndex;
-				for (; sIndex < end; i++, sIndex++, buffer += 2)
+				const u32 count = std::min(sndBufferSize, voice->sampleIndex + frames - i) - voice->sampleIndex;
+				mixSource(buffer, voice->buffer, voice->sampleIndex, count, voice->volume);
+				voice->sampleIndex += count;
+				buffer += count * 2;
+				i += count;
+			}
+		}
+	}
+		
+	// Audio callback
+	// Audio thread: record the timing of a callback that produced 'frames' of audio.
+	static void recordCallbackStats(u32 frames, u64 start, u64 waveStart, u64 waveEnd, u64 voiceEnd, u64 synthEnd, u64 end)
+	{
+		AudioStatsAccum* stats = &s_statsLocal;
+		if (s_statsReset.exchange(false))
+		{
+			*stats = {};
+			s_lastCallbackStart = 0;
+		}
+
+		const f64 period = f64(frames) / f64(AUDIO_FREQ);
+		const f64 duration  = TFE_System::convertFromTicksToSeconds(end - start);
+		stats->callbacks++;
+		stats->periodSec = period;
+		stats->totalSec += duration;
+		stats->maxSec = std::max(stats->maxSec, duration);
+		stats->waveSec  += TFE_System::convertFromTicksToSeconds(waveEnd - waveStart);
+		stats->voiceSec += TFE_System::convertFromTicksToSeconds(voiceEnd - waveEnd);
+		stats->synthSec += TFE_System::convertFromTicksToSeconds(synthEnd - voiceEnd);
+
+		// Callback time as a fraction of the audio it produced.
+		const s32 bucket = period > 0.0 ? std::min(s32(duration / period * 10.0), AUDIO_STATS_BUCKET_COUNT - 1) : AUDIO_STATS_BUCKET_COUNT - 1;
+		stats->histogram[bucket]++;
+		if (duration > period)
+		{
+			stats->deadlineMisses++;
+		}
+		// Offline rendering is not driven by a device, so there is nothing to be late for.
+		if (!s_offline && s_lastCallbackStart && TFE_System::convertFromTicksToSeconds(start - s_lastCallbackStart) > period * c_lateCallbackPeriods)
+		{
+			stats->lateCallbacks++;
+		}
+		s_lastCallbackStart = start;
+
+		// Publish.
+		s_statsSeq.fetch_add(1, std::memory_order_acq_rel);
+		std::atomic_thread_fence(std::memory_order_release);
+		s_statsShared = *stats;
+		s_statsSeq.fetch_add(1, std::memory_order_release);
+	}
+
+	static void audioCallback(void* userData, unsigned char* outputBuffer, int bufsize)
+	{
+		f32* buffer = (f32*)outputBuffer;
+		u32 bufferSize = (u32)bufsize;
+		u32 frames = bufferSize / (AUDIO_CHANNEL_COUNT * sizeof(f32));
+		const u64 callbackStart = TFE_System::getCurrentTimeInTicks();
+
+		// First clear samples
+		memset(buffer, 0, bufferSize);
+
+		// Pick up the changes from the game and midi threads, including the audio thread callback state, this never blocks.
+		applyCommands();
+		const bool paused = s_paused;
+
+		// Then call the audio thread callback.
+		// The callback only touches state owned by the audio thread, its owner (iMuse) changes it through commands.
+		const u64 waveStart = TFE_System::getCurrentTimeInTicks();
+		if (s_audioThreadCallback && !paused)
+		{
+			if (s_mixFilter == AUF_SINC)
+			{
+				// Resample directly into the output, requesting more audio from the callback as needed.
+				// The number of callbacks per buffer depends on the output rate, at 44.1kHz it is exactly one.
+				u32 written = resampler_read(&s_resampler, buffer, frames);
+				while (written < frames)
+				{
+					s_audioThreadCallback(s_callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE, s_soundFxVolume * c_soundHeadroom);
+					resampler_write(&s_resampler, s_callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE);
+					written += resampler_read(&s_resampler, buffer + written * AUDIO_CHANNEL_COUNT, frames - written);
+				}
+				if (s_silentAudioFrames)
+				{
+					memset(buffer, 0, bufferSize);
+				}
+			}
+			else
+			{
+				s_audioThreadCallback(s_callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE, s_soundFxVolume * c_soundHeadroom);
+				// The audio buffer is 1/4 as large as it should be.
+				// This means that in-between samples must be interpolated.
+				if (!s_silentAudioFrames)
 				{
-					const f32 sample = sampleBuffer(sIndex, type, data) * snd->volume;
-					buffer[0] += sample;
-					buffer[1] += sample;
+					if (s_mixFilter == AUF_NONE)
+					{
+						upsample4x_point(buffer, s_callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE*AUDIO_CHANNEL_COUNT);
+					}
+					else if (s_mixFilter == AUF_LINEAR)
+					{
+						upsample4x_linear(buffer, s_callbackBuffer, AUDIO_CALLBACK_BUFFER_SIZE*AUDIO_CHANNEL_COUNT);
+					}
 				}
-				snd->sampleIndex = sIndex;
 			}
 		}
-		// Cleanup sound sources while we are still in the mutex.
-		cleanupSources();
+		const u64 waveEnd = TFE_System::getCurrentTimeInTicks();
+
+		// Then loop through the sources.
+		// Note: this is no longer used by Dark Forces. However I decided to keep direct sound support around
+		// so it can be used for tools.
+		if (!paused)
+		{
+			mixVoices(buffer, frames);
+		}
+		// Finished sounds are returned to the game thread, see update().
+		postFinishedVoices();
+		const u64 voiceEnd = TFE_System::getCurrentTimeInTicks();
 		
 		// Handle midi synthesis results.
-		if (!s_paused)
+		if (!paused)
 		{
 			TFE_MidiPlayer::synthesizeMidi((f32*)outputBuffer, frames, !s_silentAudioFrames);
 		}
+		const u64 synthEnd = TFE_System::getCurrentTimeInTicks();
 		if (s_silentAudioFrames > 0) { s_silentAudioFrames--; }
-		SDL_UnlockMutex(s_mutex);
 
 		// Handle out of range audio samples.
-		buffer = (f32*)outputBuffer;
-		for (u32 i = 0; i < frames; i++, buffer += 2)
-		{
-			const f32 valueLeft  = buffer[0];
-			const f32 valueRight = buffer[1];
-
-			// Audio outside of the [-1, 1] range will cause overflow, which is a major artifact.
-			// Instead the audio needs to be limited in range, which can be done in several ways.
-			// Sigmoid functions map an arbitrary range into [-1, 1] generall along an S-Curve, allowing us to avoid overflow.
-		#if defined(AUDIO_SIGMOID_CLIP)		// Not really a Sigmoid function but acts in a similar way, naively mapping to the required range.
-			buffer[0] = std::max(-c_channelLimit, std::min(valueLeft,  c_channelLimit));
-			buffer[1] = std::max(-c_channelLimit, std::min(valueRight, c_channelLimit));
-		#elif defined(AUDIO_SIGMOID_TANH)	// Considered one of the most "musical sounding" sigmoid functions, it avoids hard clipping.
-			// Note the usable range is approximately -4.8 to 4.8 so the volumes should be adjusted to stay within those ranges when possible.
-			// Still much better than the effect -1 to 1 range with hard clipping and cheaper than the more accurate library tanh(). :)
-			buffer[0] = TFE_Math::tanhf_series(valueLeft);
-			buffer[1] = TFE_Math::tanhf_series(valueRight);
-		#elif defined(AUDIO_SIGMOID_RCP_SQRT)
-			buffer[0] = valueLeft  / sqrtf(1.0f + valueLeft * valueLeft);
-			buffer[1] = valueRight / sqrtf(1.0f + valueRight * valueRight);
-		#endif
-		}
+		// Audio outside of the [-1, 1] range will cause overflow, which is a major artifact.
+		// Instead the audio needs to be limited in range, which can be done in several ways.
+		// Sigmoid functions map an arbitrary range into [-1, 1] generall along an S-Curve, allowing us to avoid overflow.
+	#if defined(AUDIO_SIGMOID_CLIP)		// Not really a Sigmoid function but acts in a similar way, naively mapping to the required range.
+		limit_clip((f32*)outputBuffer, frames * AUDIO_CHANNEL_COUNT, c_channelLimit);
+	#elif defined(AUDIO_SIGMOID_TANH)	// Considered one of the most "musical sounding" sigmoid functions, it avoids hard clipping.
+		// Note the usable range is approximately -4.8 to 4.8 so the volumes should be adjusted to stay within those ranges when possible.
+		// Still much better than the effect -1 to 1 range with hard clipping and cheaper than the more accurate library tanh(). :)
+		limit_tanh((f32*)outputBuffer, frames * AUDIO_CHANNEL_COUNT);
+	#elif defined(AUDIO_SIGMOID_RCP_SQRT)
+		limit_rcpSqrt((f32*)outputBuffer, frames * AUDIO_CHANNEL_COUNT);
+	#endif
 
 		// Timing
-	#if AUDIO_TIMING == 1
-		u64 soundIterEnd = TFE_System::getCurrentTimeInTicks();
-		f64 soundIterDeltaMS = 1000000.0 * TFE_System::convertFromTicksToSeconds(soundIterEnd - soundIterStart);
-		s_soundIterAveF = soundIterDeltaMS * 0.01 + s_soundIterAveF * 0.99;
-		s_soundIterMaxF = std::max(s_soundIterMaxF, soundIterDeltaMS);
-		s_soundIterAve = s32(s_soundIterAveF);
-		s_soundIterMax = s32(s_soundIterMaxF);
-	#endif
+		recordCallbackStats(frames, callbackStart, waveStart, waveEnd, voiceEnd, synthEnd, TFE_System::getCurrentTimeInTicks());
 	}
 
 	// Console functions.
@@ -618,4 +1146,57 @@ namespace TFE_Audio
 		sprintf(res, "Sound Volume: %2.3f", s_soundFxVolume);
 		TFE_Console::addToHistory(res);
 	}
+
+	void setAudioFilterConsole(const ConsoleArgList& args)
+	{
+		if (args.size() < 2) { return; }
+		for (s32 i = 0; i < AUF_COUNT; i++)
+		{
+			if (strcasecmp(args[1].c_str(), c_upsampleFilterName[i]) == 0)
+			{
+				setUpsampleFilter(AudioUpsampleFilter(i));
+				return;
+			}
+		}
+		TFE_Console::addToHistory("Unknown filter, valid filters are: none, linear, sinc");
+	}
+
+	void audioStatsConsole(const ConsoleArgList& args)
+	{
+		if (args.size() >= 2 && strcasecmp(args[1].c_str(), "reset") == 0)
+		{
+			resetThreadStats();
+			TFE_Console::addToHistory("Audio stats reset.");
+			return;
+		}
+
+		AudioThreadStats stats;
+		getThreadStats(&stats);
+
+		char res[256];
+		sprintf(res, "Callbacks: %u, period %.3fms, ave %.3fms, max %.3fms", stats.callbacks, stats.periodMs, stats.aveMs, stats.maxMs);
+		TFE_Console::addToHistory(res);
+		sprintf(res, "Deadline misses: %u, late callbacks: %u, midi underruns: %d", stats.deadlineMisses, stats.lateCallbacks, TFE_MidiPlayer::getUnderrunCount());
+		TFE_Console::addToHistory(res);
+		sprintf(res, "Ave breakdown: wave %.3fms, voices %.3fms, synth %.3fms", stats.waveAveMs, stats.voiceAveMs, stats.synthAveMs);
+		TFE_Console::addToHistory(res);
+	}
+
+	void exportAudioStatsConsole(const ConsoleArgList& args)
+	{
+		char path[TFE_MAX_PATH];
+		if (args.size() >= 2)
+		{
+			strncpy(path, args[1].c_str(), TFE_MAX_PATH - 1);
+			path[TFE_MAX_PATH - 1] = 0;
+		}
+		else
+		{
+			TFE_Paths::appendPath(PATH_USER_DOCUMENTS, "audiostats.json", path);
+		}
+
+		char res[TFE_MAX_PATH + 64];
+		sprintf(res, writeThreadStats(path) ? "Wrote audio stats to '%s'." : "Cannot write audio stats to '%s'.", path);
+		TFE_Console::addToHistory(res);
+	}
 }
@@ -4,7 +4,8 @@
 #include "audioOutput.h"
 #include "audioFilters.h"
 
-// Source data type. The sound data will be converted to float time during mixing.
+// Source data type. The sound data is converted to float samples when the buffer is prepared (see prepareSoundBuffer()),
+// or during mixing otherwise.
 enum SoundDataType
 {
 	SOUND_DATA_8BIT = 0,
@@ -31,6 +32,7 @@ struct SoundBuffer
 	u32 loopEnd;
 
 	u8* data;
+	f32* samples = nullptr;	// Float version of 'data' in the [-1, 1] range, created by prepareSoundBuffer().
 };
 
 struct SoundSource;
@@ -45,9 +47,42 @@ enum SoundType
 #define MONO_SEPERATION 0.5f
 #define MAX_SOUND_SOURCES 128
 
+enum
+{
+	AUDIO_STATS_BUCKET_COUNT = 11,	// 10% of the callback period per bucket, the last bucket is over 100%.
+};
+
+// Audio thread timing since the last TFE_Audio::resetThreadStats().
+struct AudioThreadStats
+{
+	u32 callbacks;
+	u32 deadlineMisses;		// Callbacks that took longer than the duration of the audio they produced.
+	u32 lateCallbacks;		// Callbacks that started well after the previous one, the output most likely ran dry.
+	f64 periodMs;			// Duration of the audio produced by each callback.
+	f64 aveMs;
+	f64 maxMs;
+	f64 waveAveMs;			// Audio thread callback (iMuse) and upsampling.
+	f64 voiceAveMs;			// Direct sound voices.
+	f64 synthAveMs;			// Midi synthesis, or mixing the midi audio rendered ahead.
+	u32 histogram[AUDIO_STATS_BUCKET_COUNT];	// Callback time as a fraction of the period.
+};
+
 typedef void(*SoundFinishedCallback)(void* userData, s32 arg);
 typedef void(*AudioThreadCallback)(f32* buffer, u32 bufferSize, f32 systemVolume);
 
+// State change for the owner of the audio thread callback (iMuse), see TFE_Audio::postAudioThreadCommand().
+// The meaning of the fields is up to the owner.
+struct AudioThreadCommand
+{
+	s32 type;
+	s32 slot;
+	u32 generation;
+	s32 args[6];
+	s64 id;
+	const void* data;
+};
+typedef void(*AudioThreadCommandHandler)(const AudioThreadCommand* command);
+
 namespace TFE_Audio
 {
 	// constants
@@ -58,24 +93,50 @@ namespace TFE_Audio
 
 	// functions
 	bool init(bool useNullDevice = false, s32 outputId = -1);
+	// Null device driven by renderOffline() instead of the SDL audio device, the mixer, iMuse and the midi player
+	// (see TFE_MidiPlayer::init()) run on the calling thread in simulated time so the output is deterministic.
+	bool initOffline();
+	// Render 'frameCount' stereo frames at getOutputSampleRate(), the same as a single device callback.
+	void renderOffline(f32* buffer, u32 frameCount);
+	u32  getOutputSampleRate();
 	void shutdown();
 	void stopAllSounds();
 	void selectDevice(s32 id);
+	// Call once per frame on the game thread, this is where sound finished callbacks are called.
+	void update();
+
+	// Audio thread statistics, these are always collected.
+	void getThreadStats(AudioThreadStats* stats);
+	void resetThreadStats();
+	// Write the statistics to a JSON file, for reports of audio problems.
+	bool writeThreadStats(const char* path);
 
 	void setUpsampleFilter(AudioUpsampleFilter filter = AUF_DEFAULT);
 	AudioUpsampleFilter getUpsampleFilter();
 
+	// Convert the buffer data to float samples once, so they do not need to be converted while mixing.
+	// The samples must be released with freeSoundBufferSamples() before the buffer is freed.
+	void prepareSoundBuffer(SoundBuffer* buffer);
+	void freeSoundBufferSamples(SoundBuffer* buffer);
+
 	void setVolume(f32 volume);
 	f32  getVolume();
 	void pause();
 	void resume();
 
+	// Serializes the threads that post commands to the audio thread (the game and midi threads), so a client can
+	// keep its own state consistent with the commands it posts. The audio thread never takes the lock.
 	void lock();
 	void unlock();
 
 	void bufferedAudioClear();
 
-	void setAudioThreadCallback(AudioThreadCallback callback = nullptr);
+	// The callback runs on the audio thread and must only touch state owned by the audio thread. Its owner changes that
+	// state by posting commands, which are passed to 'commandHandler' on the audio thread before the next callback.
+	// The change takes effect in order with the commands already posted.
+	void setAudioThreadCallback(AudioThreadCallback callback = nullptr, AudioThreadCommandHandler commandHandler = nullptr);
+	// Returns false if the command queue is full and the command was dropped.
+	bool postAudioThreadCommand(const AudioThreadCommand& command);
 	const OutputDeviceInfo* getOutputDeviceList(s32& count, s32& curOutput);
 
 	// One shot, play and forget. Only do this if the client needs no control until stopAllSounds() is called.
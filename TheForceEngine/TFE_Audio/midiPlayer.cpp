@@ -6,13 +6,17 @@
 #endif
 #include <SDL_mutex.h>
 #include <SDL_thread.h>
+#include <SDL_timer.h>
 #include <TFE_Asset/gmidAsset.h>
 #include <TFE_System/system.h>
 #include <TFE_Settings/settings.h>
 #include <TFE_FrontEndUI/console.h>
+#include <TFE_System/profiler.h>
 #include <TFE_Audio/MidiSynth/soundFontDevice.h>
 #include <TFE_Audio/MidiSynth/fm4Opl3Device.h>
 #include <algorithm>
+#include <cmath>
+#include <thread>
 #include <assert.h>
 
 #ifdef _WIN32
@@ -70,6 +74,52 @@ namespace TFE_MidiPlayer
 	static std::vector<f32> s_sampleBuffer;
 	static f32* s_sampleBufferPtr = nullptr;
 
+	// Render ahead.
+	// Synthesized midi is rendered by the midi thread into a ring buffer, so the audio callback only has to mix it.
+	// Positions are in stereo frames and free-running, only the low bits are used to index the ring.
+	enum
+	{
+		MIDI_SAMPLE_RATE = 44100,			// Output rate of the synthesized midi devices.
+		MIDI_RING_FRAMES = 32768,			// Must be a power of two, large enough to hold twice the maximum render ahead.
+		MIDI_RENDER_BLOCK = 256,			// Maximum frames rendered per midi thread iteration.
+		MIDI_FLUSH_FADE_FRAMES = 64,		// Flushed audio is faded out over this many frames instead of being cut off.
+		MIDI_MAX_RENDER_AHEAD_MS = 250,
+	};
+	// If the audio thread stops consuming the buffer for this long (null device, audio paused), the midi thread
+	// goes back to wall clock timing so the callback keeps running.
+	static const f64 c_consumerTimeout = 0.1;
+
+	static f32 s_ring[MIDI_RING_FRAMES * 2];
+	static atomic_u32 s_ringWrite(0);			// Written by the midi thread.
+	static atomic_u32 s_ringRead(0);			// Written by the audio thread.
+	static atomic_u32 s_ringFlush(0);			// The audio thread skips anything rendered before this position.
+	static atomic_bool s_renderAhead(false);	// True while the midi thread is rendering ahead.
+	static atomic_bool s_flushRequest(false);
+	static atomic_u32 s_renderAheadFrames(0);
+	static atomic_u32 s_consumeCount(0);		// Incremented by each synthesizeMidi() call.
+	static atomic_u32 s_consumeFrames(0);		// Frames requested by the last synthesizeMidi() call.
+	// The music volume is applied when mixing, so volume changes are not delayed by the buffered audio.
+	static atomic_f32 s_outputVolume(1.0f);
+	static f32 s_outputGain = 1.0f;				// Audio thread.
+	static s32 s_midiUnderruns = 0;
+	// Offline rendering: there is no midi thread, commands and the callback are processed when the audio is rendered.
+	static bool s_offline = false;
+	static bool s_offlinePaused = false;
+
+	// The midi thread sleeps until its next deadline - the next callback or when the audio thread needs more audio.
+	// Posting a command wakes it immediately, as does the audio thread if it is waiting on the output.
+	// A semaphore is used since the audio thread cannot take the midi thread mutex, so a wake posted before
+	// the midi thread starts waiting is kept instead of lost.
+	static SDL_sem* s_midiWake = nullptr;
+	static atomic_bool s_wakeOnConsume(false);	// Set by the midi thread when the audio thread should wake it.
+	static const f64 c_idleWait = 0.1;			// Re-evaluate the state at least this often when there is nothing to do.
+	// Timed waits are only millisecond accurate, so the end of a wait for the next callback is spent yielding instead.
+	static const f64 c_spinTime = 0.001;
+	// Profiler stats, updated once a second by the midi thread.
+	static s32 s_midiWakeups = 0;
+	static s32 s_midiTimingErrAve = 0;
+	static s32 s_midiTimingErrMax = 0;
+
 	// Hanging note detection.
 	struct Instrument
 	{
@@ -80,6 +130,8 @@ namespace TFE_MidiPlayer
 	static f64 s_curNoteTime = 0.0;
 
 	int midiUpdateFunc(void* userData);
+	static void wakeMidiThread();
+	static void renderOffline(f32* buffer, u32 frames, bool updateBuffer, f32 targetGain);
 	void stopAllNotes();
 	void changeVolume();
 	void allocateMidiDevice(MidiDeviceType type);
@@ -87,6 +139,9 @@ namespace TFE_MidiPlayer
 	// Console Functions
 	void setMusicVolumeConsole(const ConsoleArgList& args);
 	void getMusicVolumeConsole(const ConsoleArgList& args);
+	void setMidiRenderAheadConsole(const ConsoleArgList& args);
+	void setSf2PolyphonyConsole(const ConsoleArgList& args);
+	void opl3BenchmarkConsole(const ConsoleArgList& args);
 
 	static const char* c_midiDeviceTypes[] =
 	{
@@ -97,7 +152,7 @@ namespace TFE_MidiPlayer
 #endif
 	};
 
-	bool init(s32 midiDeviceIndex, MidiDeviceType type)
+	bool init(s32 midiDeviceIndex, MidiDeviceType type, bool offline)
 	{
 		TFE_System::logWrite(LOG_MSG, "Startup", "TFE_MidiPlayer::init");
 		bool res = false;
@@ -116,6 +171,13 @@ namespace TFE_MidiPlayer
 			return false;
 		}
 
+		s_midiWake = SDL_CreateSemaphore(0);
+		if (!s_midiWake)
+		{
+			TFE_System::logWrite(LOG_ERROR, "Midi", "cannot initialize SDL midi thread semaphore");
+			return false;
+		}
+
 		SDL_LockMutex(s_deviceChangeMutex);
 		{
 			allocateMidiDevice(type);
@@ -134,22 +196,35 @@ namespace TFE_MidiPlayer
 		}
 		SDL_UnlockMutex(s_deviceChangeMutex);
 
-		s_runMusicThread.store(true);
-		s_thread = SDL_CreateThread(midiUpdateFunc, "TFE_MidiThread", nullptr);
-		if (!s_thread)
+		s_offline = offline;
+		s_offlinePaused = false;
+		if (!offline)
 		{
-			TFE_System::logWrite(LOG_ERROR, "Midi", "cannot create Midi Thread!");
-			res = false;
+			s_runMusicThread.store(true);
+			s_thread = SDL_CreateThread(midiUpdateFunc, "TFE_MidiThread", nullptr);
+			if (!s_thread)
+			{
+				TFE_System::logWrite(LOG_ERROR, "Midi", "cannot create Midi Thread!");
+				res = false;
+			}
 		}
 
 		CCMD("setMusicVolume", setMusicVolumeConsole, 1, "Sets the music volume, range is 0.0 to 1.0");
 		CCMD("getMusicVolume", getMusicVolumeConsole, 0, "Get the current music volume where 0 = silent, 1 = maximum.");
+		CCMD("midiRenderAhead", setMidiRenderAheadConsole, 1, "Sets how far ahead synthesized music is rendered in milliseconds, 0 renders it in the audio callback.");
+		CCMD("sf2Polyphony", setSf2PolyphonyConsole, 1, "Sets the maximum number of SoundFont voices that sound at once, 0 only limits by the voice pool.");
+		CCMD("opl3Benchmark", opl3BenchmarkConsole, 0, "Compares the CPU time of the accurate and fast OPL3 emulation, optionally pass the number of seconds of music to render.");
+		TFE_COUNTER(s_midiUnderruns, "Midi Underruns");
+		TFE_COUNTER(s_midiWakeups, "Midi Thread Wakeups-PerSec");
+		TFE_COUNTER(s_midiTimingErrAve, "Midi Timing Error Ave-MicroSec");
+		TFE_COUNTER(s_midiTimingErrMax, "Midi Timing Error Max-MicroSec");
 
 		TFE_Settings_Sound* soundSettings = TFE_Settings::getSoundSettings();
 		setVolume(soundSettings->musicVolume);
 		setMaximumNoteLength();
+		setRenderAhead(soundSettings->midiRenderAheadMs);
 
-		return res && s_thread;
+		return res && (s_thread || offline);
 	}
 
 	void destroy()
@@ -159,12 +234,17 @@ namespace TFE_MidiPlayer
 		TFE_System::logWrite(LOG_MSG, "MidiPlayer", "Shutdown");
 		// Destroy the thread before shutting down the Midi Device.
 		s_runMusicThread.store(false);
+		wakeMidiThread();
 		SDL_WaitThread(s_thread, &i);
+		s_thread = nullptr;
+		s_offline = false;
 
 		delete s_midiDevice;
 
+		SDL_DestroySemaphore(s_midiWake);
 		SDL_DestroyMutex(s_midiThreadMutex);
 		SDL_DestroyMutex(s_deviceChangeMutex);
+		s_midiWake = nullptr;
 	}
 
 	MidiDevice* getMidiDevice()
@@ -181,6 +261,7 @@ namespace TFE_MidiPlayer
 	{
 		SDL_LockMutex(s_deviceChangeMutex);
 		{
+			s_flushRequest.store(true);
 			allocateMidiDevice(type);
 			if (s_midiDevice)
 			{
@@ -191,12 +272,14 @@ namespace TFE_MidiPlayer
 			}
 		}
 		SDL_UnlockMutex(s_deviceChangeMutex);
+		wakeMidiThread();
 	}
 
 	void selectDeviceOutput(s32 output)
 	{
 		SDL_LockMutex(s_deviceChangeMutex);
 		{
+			s_flushRequest.store(true);
 			if (s_midiDevice)
 			{
 				if (!s_midiDevice->selectOutput(output))
@@ -206,6 +289,7 @@ namespace TFE_MidiPlayer
 			}
 		}
 		SDL_UnlockMutex(s_deviceChangeMutex);
+		wakeMidiThread();
 	}
 
 	MidiDeviceType getDeviceType()
@@ -220,11 +304,14 @@ namespace TFE_MidiPlayer
 	//////////////////////////////////////////////////
 	// Command Buffer
 	//////////////////////////////////////////////////
+	// Must be called with the midi thread mutex held, the midi thread is woken to process the command
+	// once the mutex is released.
 	MidiCmd* midiAllocCmd()
 	{
 		if (s_midiCmdCount >= MAX_MIDI_CMD) { return nullptr; }
 		MidiCmd* cmd = &s_midiCmdBuffer[s_midiCmdCount];
 		s_midiCmdCount++;
+		wakeMidiThread();
 		return cmd;
 	}
 
@@ -238,6 +325,9 @@ namespace TFE_MidiPlayer
 	//////////////////////////////////////////////////
 	void setVolume(f32 volume)
 	{
+		// Takes effect on the next audio callback, even if music has been rendered ahead.
+		s_outputVolume.store(volume);
+
 		SDL_LockMutex(s_midiThreadMutex);
 		MidiCmd* midiCmd = midiAllocCmd();
 		if (midiCmd)
@@ -254,6 +344,18 @@ namespace TFE_MidiPlayer
 		s_maxNoteLength = f64(dt);
 	}
 
+	void setRenderAhead(s32 ms)
+	{
+		ms = std::max(0, std::min(s32(MIDI_MAX_RENDER_AHEAD_MS), ms));
+		s_renderAheadFrames.store(u32(ms * MIDI_SAMPLE_RATE / 1000));
+		wakeMidiThread();
+	}
+
+	s32 getRenderAhead()
+	{
+		return s32(s_renderAheadFrames.load() * 1000 / MIDI_SAMPLE_RATE);
+	}
+
 	void pauseThread()
 	{
 		if (!s_tPaused && s_midiThreadMutex)
@@ -305,8 +407,85 @@ namespace TFE_MidiPlayer
 		SDL_UnlockMutex(s_midiThreadMutex);
 	}
 
+	// Mix stereo frames into the output, ramping the gain to avoid zipper noise when the volume changes.
+	static void mixOutput(f32* output, const f32* input, u32 frames, f32 gainStart, f32 gainEnd)
+	{
+		const f32 step = frames ? (gainEnd - gainStart) / f32(frames) : 0.0f;
+		f32 gain = gainStart;
+		for (u32 i = 0; i < frames; i++, output += 2, input += 2)
+		{
+			output[0] += input[0] * gain;
+			output[1] += input[1] * gain;
+			gain += step;
+		}
+	}
+
+	// Mix frames from the ring, which may wrap around.
+	static void mixRing(f32* output, u32 readPos, u32 frames, f32 gainStart, f32 gainEnd)
+	{
+		const u32 index = readPos & (MIDI_RING_FRAMES - 1);
+		const u32 first = std::min(frames, MIDI_RING_FRAMES - index);
+		const f32 gainMid = frames ? gainStart + (gainEnd - gainStart) * f32(first) / f32(frames) : gainEnd;
+		mixOutput(output, &s_ring[index * 2], first, gainStart, gainMid);
+		mixOutput(output + first * 2, s_ring, frames - first, gainMid, gainEnd);
+	}
+
+	// Audio thread: mix the audio rendered ahead by the midi thread.
+	static void consumeRenderAhead(f32* buffer, u32 frames, bool updateBuffer, f32 targetGain)
+	{
+		u32 readPos = s_ringRead.load(std::memory_order_relaxed);
+		const u32 writePos = s_ringWrite.load(std::memory_order_acquire);
+		const u32 flushPos = s_ringFlush.load(std::memory_order_acquire);
+
+		f32 gain = s_outputGain;
+		u32 offset = 0;
+		if (s32(flushPos - readPos) > 0)
+		{
+			// The notes were stopped (or the device changed) after this audio was rendered.
+			// Fade out the start of it instead of cutting it off, then skip the rest.
+			offset = std::min(std::min(flushPos - readPos, u32(MIDI_FLUSH_FADE_FRAMES)), frames);
+			if (updateBuffer) { mixRing(buffer, readPos, offset, gain, 0.0f); }
+			readPos = flushPos;
+			gain = 0.0f;
+		}
+
+		const u32 count = std::min(writePos - readPos, frames - offset);
+		if (updateBuffer) { mixRing(buffer + offset * 2, readPos, count, gain, targetGain); }
+		readPos += count;
+		if (count < frames - offset)
+		{
+			// The midi thread did not keep up, the rest of the buffer is silent.
+			s_midiUnderruns++;
+		}
+
+		s_ringRead.store(readPos, std::memory_order_release);
+	}
+
 	void synthesizeMidi(f32* buffer, u32 stereoSampleCount, bool updateBuffer)
 	{
+		// Let the midi thread know how much audio is requested at a time and that the output is running.
+		s_consumeFrames.store(stereoSampleCount);
+		s_consumeCount++;
+		// The midi thread is waiting for the output to make room or to start running again.
+		if (s_wakeOnConsume.load(std::memory_order_relaxed) && s_wakeOnConsume.exchange(false))
+		{
+			wakeMidiThread();
+		}
+
+		const f32 targetGain = s_outputVolume.load();
+		if (s_offline)
+		{
+			renderOffline(buffer, stereoSampleCount, updateBuffer, targetGain);
+			s_outputGain = targetGain;
+			return;
+		}
+		if (s_renderAhead.load())
+		{
+			consumeRenderAhead(buffer, stereoSampleCount, updateBuffer, targetGain);
+			s_outputGain = targetGain;
+			return;
+		}
+
 		// In some cases, such as when using the System Midi Device, the midi audio is generated externally so
 		// rendering is not required.
 		SDL_LockMutex(s_deviceChangeMutex);  // Make sure we don't synthesize when the device is being changed.
@@ -326,13 +505,11 @@ namespace TFE_MidiPlayer
 			// Accumulate midi samples with existing audio samples (from soundFX).
 			if (updateBuffer)
 			{
-				for (s32 i = 0; i < linearSampleCount; i++)
-				{
-					buffer[i] += s_sampleBufferPtr[i];
-				}
+				mixOutput(buffer, s_sampleBufferPtr, stereoSampleCount, s_outputGain, targetGain);
 			}
 		}
 		SDL_UnlockMutex(s_deviceChangeMutex);
+		s_outputGain = targetGain;
 	}
 
 	f32 getVolume()
@@ -340,6 +517,11 @@ namespace TFE_MidiPlayer
 		return s_masterVolume;
 	}
 
+	s32 getUnderrunCount()
+	{
+		return s_midiUnderruns;
+	}
+
 	void midiSetCallback(void(*callback)(void), f64 timeStep)
 	{
 		SDL_LockMutex(s_midiThreadMutex);
@@ -353,6 +535,7 @@ namespace TFE_MidiPlayer
 		}
 		changeVolume();
 		SDL_UnlockMutex(s_midiThreadMutex);
+		wakeMidiThread();
 	}
 
 	void midiClearCallback()
@@ -362,6 +545,7 @@ namespace TFE_MidiPlayer
 		s_midiCallback.timeStep = 0.0;
 		s_midiCallback.accumulator = 0.0;
 		SDL_UnlockMutex(s_midiThreadMutex);
+		wakeMidiThread();
 	}
 
 	//////////////////////////////////////////////////
@@ -371,7 +555,8 @@ namespace TFE_MidiPlayer
 	{
 		if (s_midiDevice && s_midiDevice->hasGlobalVolumeCtrl())
 		{
-			s_midiDevice->setVolume(s_masterVolumeScaled);
+			// The master volume is applied when the output is mixed, see mixOutput().
+			s_midiDevice->setVolume(c_musicVolumeScale);
 		}
 		else if (s_midiDevice)
 		{
@@ -469,58 +654,251 @@ namespace TFE_MidiPlayer
 		}
 	}
 
+	// Midi thread: audio rendered before this point is skipped by the audio thread.
+	static void flushRenderAhead()
+	{
+		s_ringFlush.store(s_ringWrite.load(std::memory_order_relaxed), std::memory_order_release);
+	}
+
+	// Render 'frames' of the midi device output, running the midi callback in sample time so that its messages
+	// land on the correct sample.
+	static void renderWithCallback(f32* output, u32 frames, bool isPaused)
+	{
+		const bool runCallback = s_midiCallback.callback && !isPaused;
+		for (u32 offset = 0; offset < frames;)
+		{
+			u32 count = frames - offset;
+			if (runCallback)
+			{
+				while (s_midiCallback.callback && s_midiCallback.accumulator >= s_midiCallback.timeStep)
+				{
+					s_midiCallback.callback();
+					s_midiCallback.accumulator -= s_midiCallback.timeStep;
+					s_curNoteTime += s_midiCallback.timeStep;
+				}
+				// Stop rendering at the next callback.
+				const f64 untilNext = (s_midiCallback.timeStep - s_midiCallback.accumulator) * f64(MIDI_SAMPLE_RATE);
+				count = std::min(count, std::max(1u, u32(ceil(untilNext))));
+				s_midiCallback.accumulator += f64(count) / f64(MIDI_SAMPLE_RATE);
+			}
+
+			SDL_LockMutex(s_deviceChangeMutex);
+			if (!s_midiDevice || !s_midiDevice->render(output + offset * 2, count))
+			{
+				memset(output + offset * 2, 0, sizeof(f32) * 2 * count);
+			}
+			SDL_UnlockMutex(s_deviceChangeMutex);
+			offset += count;
+		}
+		if (runCallback)
+		{
+			// Check for hanging notes.
+			detectHangingNotes();
+		}
+	}
+
+	// Midi thread: render the next block ahead of the audio thread, running the midi callback in sample time so that
+	// its messages land on the correct sample. Returns false if enough audio is already buffered.
+	static bool renderAheadBlock(bool isPaused)
+	{
+		const u32 writePos = s_ringWrite.load(std::memory_order_relaxed);
+		const u32 readPos  = s_ringRead.load(std::memory_order_acquire);
+		const u32 flushPos = s_ringFlush.load(std::memory_order_relaxed);
+		// Flushed audio does not count, the audio thread will skip it.
+		const u32 buffered = writePos - (s32(flushPos - readPos) > 0 ? flushPos : readPos);
+		// Keep a full audio callback buffered on top of the requested amount.
+		const u32 target = s_renderAheadFrames.load() + s_consumeFrames.load();
+		if (buffered >= target || writePos - readPos >= MIDI_RING_FRAMES - MIDI_RENDER_BLOCK)
+		{
+			return false;
+		}
+
+		// Don't wrap around within a block.
+		const u32 index = writePos & (MIDI_RING_FRAMES - 1);
+		const u32 frames = std::min(std::min(target - buffered, u32(MIDI_RENDER_BLOCK)), MIDI_RING_FRAMES - index);
+		renderWithCallback(&s_ring[index * 2], frames, isPaused);
+
+		s_ringWrite.store(writePos + frames, std::memory_order_release);
+		return true;
+	}
+
+	// Apply the commands queued by the game thread, must be called with the midi thread mutex held.
+	// Returns true if the callback time should be reset.
+	static bool processCommands(bool* isPaused)
+	{
+		bool resetTime = false;
+		MidiCmd* midiCmd = s_midiCmdBuffer;
+		for (u32 i = 0; i < s_midiCmdCount; i++, midiCmd++)
+		{
+			switch (midiCmd->cmd)
+			{
+				case MIDI_PAUSE:
+				{
+					resetTime = true;
+					*isPaused = true;
+					stopAllNotes();
+					flushRenderAhead();
+				} break;
+				case MIDI_RESUME:
+				{
+					*isPaused = false;
+				} break;
+				case MIDI_CHANGE_VOL:
+				{
+					s_masterVolume = midiCmd->newVolume;
+					s_masterVolumeScaled = s_masterVolume * c_musicVolumeScale;
+					changeVolume();
+				} break;
+				case MIDI_STOP_NOTES:
+				{
+					stopAllNotes();
+					flushRenderAhead();
+					// Reset callback time.
+					resetTime = true;
+					s_midiCallback.accumulator = 0.0;
+				} break;
+			}
+		}
+		s_midiCmdCount = 0;
+		return resetTime;
+	}
+
+	// Offline rendering: do the work of the midi thread in sample time, directly in the (simulated) audio callback.
+	static void renderOffline(f32* buffer, u32 frames, bool updateBuffer, f32 targetGain)
+	{
+		const u32 linearSampleCount = frames * 2;
+		if (linearSampleCount > s_sampleBuffer.size() || !s_sampleBufferPtr)
+		{
+			s_sampleBuffer.resize(linearSampleCount);
+			s_sampleBufferPtr = s_sampleBuffer.data();
+		}
+
+		SDL_LockMutex(s_midiThreadMutex);
+		processCommands(&s_offlinePaused);
+		renderWithCallback(s_sampleBufferPtr, frames, s_offlinePaused);
+		SDL_UnlockMutex(s_midiThreadMutex);
+
+		if (updateBuffer)
+		{
+			mixOutput(buffer, s_sampleBufferPtr, frames, s_outputGain, targetGain);
+		}
+	}
+
+	static void wakeMidiThread()
+	{
+		if (s_midiWake)
+		{
+			SDL_SemPost(s_midiWake);
+		}
+	}
+
+	// Midi thread: wait for up to 'seconds' or until woken, must be called with the midi thread mutex held.
+	// When 'precise' is set, the end of the wait is spent yielding so the deadline is not overshot by the timer
+	// resolution.
+	static void waitForWork(f64 seconds, bool precise)
+	{
+		if (seconds <= 0.0) { return; }
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		const f64 timedWait = precise ? seconds - c_spinTime : seconds;
+		if (timedWait >= 0.001)
+		{
+			SDL_UnlockMutex(s_midiThreadMutex);
+			const s32 res = SDL_SemWaitTimeout(s_midiWake, u32(timedWait * 1000.0 + 0.5));
+			SDL_LockMutex(s_midiThreadMutex);
+			if (res == 0)
+			{
+				// Woken early by a command or the audio thread, the state is re-evaluated after this so
+				// any other pending wakes can be dropped.
+				while (SDL_SemTryWait(s_midiWake) == 0) {}
+				return;
+			}
+		}
+		if (!precise) { return; }
+
+		// Release the mutex while yielding, so commands can still be posted.
+		while (!s_midiCmdCount && TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start) < seconds)
+		{
+			SDL_UnlockMutex(s_midiThreadMutex);
+			std::this_thread::yield();
+			SDL_LockMutex(s_midiThreadMutex);
+		}
+	}
+
 	// Thread Function
 	int midiUpdateFunc(void* userData)
 	{
 		bool runThread  = true;
-		bool wasPlaying = false;
-		bool isPlaying  = false;
 		bool isPaused = false;
-		s32 loopStart = -1;
-		u64 localTime = 0;
+		bool renderAhead = false;
 		u64 localTimeCallback = 0;
-		f64 dt = 0.0;
+		u64 localTimeConsumer = 0;
+		u32 consumeCount = 0;
+		f64 consumerIdleTime = 0.0;
+
+		// Stats for the profiler.
+		u64 localTimeStats = 0;
+		f64 statsTime = 0.0;
+		f64 timingErrSum = 0.0;
+		f64 timingErrMax = 0.0;
+		u32 timingErrCount = 0;
+		u32 wakeups = 0;
 		while (runThread)
 		{
 			SDL_LockMutex(s_midiThreadMutex);
-						
-			// Read from the command buffer.
-			MidiCmd* midiCmd = s_midiCmdBuffer;
-			for (u32 i = 0; i < s_midiCmdCount; i++, midiCmd++)
+			wakeups++;
+			if (processCommands(&isPaused))
+			{
+				localTimeCallback = 0;
+			}
+
+			// Only render ahead while the audio thread is consuming the results.
+			const u32 curConsumeCount = s_consumeCount.load();
+			const f64 dt = TFE_System::updateThreadLocal(&localTimeConsumer);
+			consumerIdleTime = (curConsumeCount != consumeCount) ? 0.0 : consumerIdleTime + dt;
+			consumeCount = curConsumeCount;
+
+			const bool renderAheadEnabled = s_renderAheadFrames.load() && s_midiDevice && s_midiDevice->canRender();
+			const bool canRenderAhead = renderAheadEnabled && consumerIdleTime < c_consumerTimeout;
+			if (canRenderAhead != renderAhead)
+			{
+				// Anything buffered before the switch is stale.
+				renderAhead = canRenderAhead;
+				flushRenderAhead();
+				s_renderAhead.store(renderAhead);
+				localTimeCallback = 0;
+			}
+			if (s_flushRequest.exchange(false))
 			{
-				switch (midiCmd->cmd)
+				flushRenderAhead();
+			}
+
+			f64 waitTime = c_idleWait;
+			bool precise = false;
+			if (renderAhead)
+			{
+				if (renderAheadBlock(isPaused))
 				{
-					case MIDI_PAUSE:
-					{
-						localTimeCallback = 0;
-						isPaused = true;
-						stopAllNotes();
-					} break;
-					case MIDI_RESUME:
-					{
-						isPaused = false;
-					} break;
-					case MIDI_CHANGE_VOL:
-					{
-						s_masterVolume = midiCmd->newVolume;
-						s_masterVolumeScaled = s_masterVolume * c_musicVolumeScale;
-						changeVolume();
-					} break;
-					case MIDI_STOP_NOTES:
-					{
-						stopAllNotes();
-						// Reset callback time.
-						localTimeCallback = 0;
-						s_midiCallback.accumulator = 0.0;
-					} break;
+					waitTime = 0.0;
+				}
+				else
+				{
+					// The buffer is full, give the audio thread time to consume it.
+					s_wakeOnConsume.store(true);
+					waitTime = std::max(0.001, f64(s_consumeFrames.load()) / f64(MIDI_SAMPLE_RATE));
 				}
 			}
-			s_midiCmdCount = 0;
-
-			// Process the midi callback, if it exists.
-			if (s_midiCallback.callback && !isPaused)
+			// Otherwise process the midi callback in real time, if it exists.
+			else if (s_midiCallback.callback && !isPaused)
 			{
 				s_midiCallback.accumulator += TFE_System::updateThreadLocal(&localTimeCallback);
+				if (s_midiCallback.accumulator >= s_midiCallback.timeStep)
+				{
+					// How late the callback is compared to when it was due.
+					const f64 err = s_midiCallback.accumulator - s_midiCallback.timeStep;
+					timingErrSum += err;
+					timingErrMax = std::max(timingErrMax, err);
+					timingErrCount++;
+				}
 				while (s_midiCallback.callback && s_midiCallback.accumulator >= s_midiCallback.timeStep)
 				{
 					s_midiCallback.callback();
@@ -530,10 +908,39 @@ namespace TFE_MidiPlayer
 
 				// Check for hanging notes.
 				detectHangingNotes();
+
+				// Sleep until the next callback is due.
+				if (s_midiCallback.callback)
+				{
+					waitTime = s_midiCallback.timeStep - s_midiCallback.accumulator;
+					precise = true;
+				}
+			}
+			if (!renderAhead && renderAheadEnabled)
+			{
+				// Rendering ahead stopped because the output is not running, restart as soon as it is.
+				s_wakeOnConsume.store(true);
+			}
+
+			statsTime += TFE_System::updateThreadLocal(&localTimeStats);
+			if (statsTime >= 1.0)
+			{
+				s_midiWakeups = s32(f64(wakeups) / statsTime + 0.5);
+				s_midiTimingErrAve = timingErrCount ? s32(timingErrSum / f64(timingErrCount) * 1000000.0) : 0;
+				s_midiTimingErrMax = s32(timingErrMax * 1000000.0);
+				statsTime = 0.0;
+				timingErrSum = 0.0;
+				timingErrMax = 0.0;
+				timingErrCount = 0;
+				wakeups = 0;
 			}
 
-			SDL_UnlockMutex(s_midiThreadMutex);
 			runThread = s_runMusicThread.load();
+			if (runThread && !s_midiCmdCount)
+			{
+				waitForWork(waitTime, precise);
+			}
+			SDL_UnlockMutex(s_midiThreadMutex);
 		};
 		
 		return 0;
@@ -558,6 +965,50 @@ namespace TFE_MidiPlayer
 		TFE_Console::addToHistory(res);
 	}
 
+	void setMidiRenderAheadConsole(const ConsoleArgList& args)
+	{
+		if (args.size() < 2) { return; }
+		setRenderAhead(atoi(args[1].c_str()));
+
+		TFE_Settings_Sound* soundSettings = TFE_Settings::getSoundSettings();
+		soundSettings->midiRenderAheadMs = getRenderAhead();
+		TFE_Settings::writeToDisk();
+	}
+
+	void setSf2PolyphonyConsole(const ConsoleArgList& args)
+	{
+		if (args.size() < 2) { return; }
+		TFE_Settings_Sound* soundSettings = TFE_Settings::getSoundSettings();
+		soundSettings->sf2Polyphony = std::max(0, atoi(args[1].c_str()));
+
+		SDL_LockMutex(s_deviceChangeMutex);
+		if (s_midiDevice && s_midiDevice->getType() == MIDI_TYPE_SF2)
+		{
+			SoundFontDevice* device = (SoundFontDevice*)s_midiDevice;
+			device->setPolyphony(soundSettings->sf2Polyphony);
+			soundSettings->sf2Polyphony = device->getPolyphony();
+		}
+		SDL_UnlockMutex(s_deviceChangeMutex);
+		TFE_Settings::writeToDisk();
+	}
+
+	void opl3BenchmarkConsole(const ConsoleArgList& args)
+	{
+		const f64 seconds = args.size() >= 2 ? std::max(0.1, (f64)TFE_Console::getFloatArg(args[1])) : 4.0;
+		const s32 c_voiceCounts[] = { 0, 4, 9, 18 };
+
+		char res[256];
+		for (size_t i = 0; i < TFE_ARRAYSIZE(c_voiceCounts); i++)
+		{
+			f64 accurateMs, fastMs;
+			Fm4Opl3Device::benchmark(c_voiceCounts[i], seconds, &accurateMs, &fastMs);
+			sprintf(res, "OPL3 %2d voices: accurate %.2f ms, fast %.2f ms per second of music (%.2fx)",
+				c_voiceCounts[i], accurateMs, fastMs, fastMs > 0.0 ? accurateMs / fastMs : 0.0);
+			TFE_Console::addToHistory(res);
+			TFE_System::logWrite(LOG_MSG, "Midi", "%s", res);
+		}
+	}
+
 	void allocateMidiDevice(MidiDeviceType type)
 	{
 		if (s_midiDevice && s_midiDevice->getType() == type) { return; }
@@ -572,8 +1023,11 @@ namespace TFE_MidiPlayer
 				break;
 #endif
 			case MIDI_TYPE_SF2:
-				s_midiDevice = new SoundFontDevice();
-				break;
+			{
+				SoundFontDevice* device = new SoundFontDevice();
+				device->setPolyphony(TFE_Settings::getSoundSettings()->sf2Polyphony);
+				s_midiDevice = device;
+			} break;
 			case MIDI_TYPE_OPL3:
 				s_midiDevice = new Fm4Opl3Device();
 				break;
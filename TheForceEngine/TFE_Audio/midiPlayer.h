@@ -5,7 +5,9 @@ struct GMidiAsset;
 
 namespace TFE_MidiPlayer
 {
-	bool init(s32 midiDeviceIndex, MidiDeviceType type = MIDI_TYPE_OPL3);
+	// When 'offline' is set no midi thread is created, instead the midi callback runs in sample time as the audio is
+	// rendered by TFE_Audio::renderOffline(), so the output is deterministic and can be produced faster than real time.
+	bool init(s32 midiDeviceIndex, MidiDeviceType type = MIDI_TYPE_OPL3, bool offline = false);
 	void setDeviceType(MidiDeviceType type);
 	void selectDeviceOutput(s32 output);
 	MidiDeviceType getDeviceType();
@@ -23,6 +25,10 @@ namespace TFE_MidiPlayer
 	void setVolume(f32 volume);
 	// Set the maximum length in seconds that a note is allowed to play for in seconds.
 	void setMaximumNoteLength(f32 dt = 16.0f);
+	// Set how far ahead synthesized midi is rendered by the midi thread, in milliseconds.
+	// 0 renders in the audio callback instead, with the lowest latency but the full synthesis cost on the audio thread.
+	void setRenderAhead(s32 ms);
+	s32  getRenderAhead();
 
 	// Send a direct midi message.
 	// Note: this should be called from the midi thread.
@@ -42,6 +48,7 @@ namespace TFE_MidiPlayer
 	// Stop all notes.
 	void stopMidiSound();
 
+	// Called by the audio thread to mix the synthesized midi into the buffer.
 	void synthesizeMidi(f32* buffer, u32 stereoSampleCount, bool updateBuffer = true);
 
 	///////////////////////////////////////////////////////////
@@ -50,4 +57,6 @@ namespace TFE_MidiPlayer
 	//   results if not being read from an iMuse callback.
 	///////////////////////////////////////////////////////////
 	f32 getVolume();
+	// Number of times the audio thread ran out of audio rendered ahead by the midi thread.
+	s32 getUnderrunCount();
 };
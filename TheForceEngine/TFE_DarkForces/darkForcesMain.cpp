@@ -29,6 +29,7 @@
 #include <TFE_DarkForces/Landru/cutsceneList.h>
 #include <TFE_DarkForces/Actor/actor.h>
 #include <TFE_Game/reticle.h>
+#include <TFE_Game/audioRender.h>
 #include <TFE_Input/inputMapping.h>
 #include <TFE_Memory/memoryRegion.h>
 #include <TFE_Settings/settings.h>
@@ -346,6 +347,88 @@ namespace TFE_DarkForces
 		return true;
 	}
 
+	bool DarkForces::runTimeDemo()
+	{
+		// The level is never played, so do not write the agent progress on exit.
+		s_sharedState.gameStarted = JFALSE;
+
+		// Same setup as GMODE_MISSION, without the music or the mission tasks.
+		sound_levelStart();
+		bitmap_setAllocator(s_levelRegion);
+		actor_clearState();
+		task_reset();
+		inf_clearState();
+
+		return mission_runTimeDemo() != JFALSE;
+	}
+
+	// Sound effects played at random during the audio render, a mix of short and long sounds.
+	static const char* c_audioRenderSounds[] =
+	{
+		"pistol-1.voc", "rifle-1.voc", "repeater.voc", "fusion1.voc", "concuss5.voc",
+		"ex-small.voc", "missile1.voc", "mortar2.voc", "health1.voc", "key.voc",
+	};
+
+	bool DarkForces::runAudioRender()
+	{
+		// The level is never played, so do not write the agent progress on exit.
+		s_sharedState.gameStarted = JFALSE;
+
+		const AudioRenderSettings* settings = TFE_AudioRender::getSettings();
+		s32 levelIndex = agent_getLevelIndexFromName(settings->level);
+		if (!levelIndex)
+		{
+			levelIndex = atoi(settings->level);
+		}
+		if (levelIndex < 1 || levelIndex > s_maxLevelIndex)
+		{
+			TFE_System::logWrite(LOG_ERROR, "AudioRender", "Invalid level '%s'.", settings->level);
+			return false;
+		}
+
+		// Same setup as GMODE_MISSION, the game side is driven in the same simulated time as the audio.
+		random_seed(settings->seed);
+		sound_levelStart();
+		task_reset();
+
+		SoundSourceId sounds[TFE_ARRAYSIZE(c_audioRenderSounds)];
+		for (size_t i = 0; i < TFE_ARRAYSIZE(c_audioRenderSounds); i++)
+		{
+			sounds[i] = sound_load(c_audioRenderSounds[i], SOUND_PRIORITY_MED5);
+		}
+		gameMusic_start(levelIndex);
+
+		// Game updates happen once per block, which is the same size as a device callback.
+		const u32 blockFrames = 1024;
+		const u32 stateFrames = u32(settings->stateTime * f32(TFE_Audio::getOutputSampleRate()));
+		TFE_AudioRender::begin();
+		for (u32 frame = 0; frame < TFE_AudioRender::getFrameCount();)
+		{
+			if (stateFrames && frame / stateFrames != (frame + blockFrames) / stateFrames)
+			{
+				const bool fight = ((frame + blockFrames) / stateFrames) & 1;
+				gameMusic_setState(fight ? MUS_STATE_FIGHT : MUS_STATE_STALK);
+			}
+			// About 2.5 sound effects per second with a random volume and pan.
+			if (u32(random_next()) % 100 < 6)
+			{
+				const SoundSourceId sound = sounds[u32(random_next()) % TFE_ARRAYSIZE(sounds)];
+				const SoundEffectId effect = sound_play(sound);
+				sound_setVolume(effect, 64 + s32(u32(random_next()) % 64));
+				sound_setPan(effect, s32(u32(random_next()) % 128) - 64);
+			}
+
+			TFE_Audio::update();
+			const u32 rendered = TFE_AudioRender::renderBlock(blockFrames);
+			if (!rendered) { break; }
+			frame += rendered;
+		}
+
+		gameMusic_stop();
+		sound_levelStop();
+		return TFE_AudioRender::writeResults();
+	}
+
 	void DarkForces::exitGame()
 	{
 		if (s_sharedState.gameStarted)
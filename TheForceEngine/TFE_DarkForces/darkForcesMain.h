@@ -17,6 +17,8 @@ namespace TFE_DarkForces
 		void restartMusic() override;
 		void exitGame() override;
 		void loopGame() override;
+		bool runTimeDemo() override;
+		bool runAudioRender() override;
 		bool serializeGameState(Stream* stream, const char* filename, bool writeState) override;
 		bool canSave() override;
 		bool isPaused() override;
@@ -18,6 +18,7 @@
 #include <TFE_DarkForces/logic.h>
 #include <TFE_Game/igame.h>
 #include <TFE_Game/reticle.h>
+#include <TFE_Game/timeDemo.h>
 #include <TFE_Settings/settings.h>
 #include <TFE_RenderBackend/renderBackend.h>
 #include <TFE_Jedi/Level/rtexture.h>
@@ -35,6 +36,7 @@
 #include <TFE_FrontEndUI/console.h>
 #include <TFE_Settings/settings.h>
 #include <TFE_System/system.h>
+#include <TFE_System/profiler.h>
 #include <TFE_System/tfeMessage.h>
 #include <TFE_Input/inputMapping.h>
 
@@ -530,7 +532,95 @@ namespace TFE_DarkForces
 			vfb_swap();
 		}
 	}
-		
+
+	// TFE: Headless benchmark, loads the level directly (without the mission tasks) and then
+	// renders the world along the time demo camera path - see TFE_Game/timeDemo.h
+	JBool mission_runTimeDemo()
+	{
+		const TimeDemoSettings* settings = TFE_TimeDemo::getSettings();
+		if (!TFE_TimeDemo::loadPath())
+		{
+			return JFALSE;
+		}
+
+		mission_setupTasks();
+		// Medium difficulty, the same objects are loaded in every run.
+		if (!level_load(settings->level, 1))
+		{
+			TFE_System::logWrite(LOG_ERROR, "TimeDemo", "Cannot load level '%s'.", settings->level);
+			return JFALSE;
+		}
+		strcpy(s_colormapName, settings->level);
+		strcat(s_colormapName, ".CMP");
+		s_levelColorMap = nullptr;
+		mission_loadColormap();
+		setSkyParallax(s_levelState.parallax0, s_levelState.parallax1);
+		s_flatLighting = JFALSE;
+
+		// Override the display settings for this run, these are never written back to disk.
+		const bool fixed = settings->renderer == TDEMO_RENDERER_FIXED;
+		TFE_Settings_Graphics* graphics = TFE_Settings::getGraphicsSettings();
+		graphics->gameResolution.x = fixed ? 320 : settings->width;
+		graphics->gameResolution.z = fixed ? 200 : settings->height;
+		graphics->widescreen = false;
+		graphics->rendererIndex = 0;
+
+		vfb_setResolution(graphics->gameResolution.x, graphics->gameResolution.z);
+		TFE_Jedi::setSubRenderer(fixed ? TSR_CLASSIC_FIXED : TSR_HIGH_RESOLUTION);
+
+		u32 levelPalette[256];
+		u32* outColor = levelPalette;
+		u8* srcColor = s_levelPalette;
+		for (s32 i = 0; i < 256; i++, outColor++, srcColor += 3)
+		{
+			*outColor = CONV_6bitTo8bit(srcColor[0]) | (CONV_6bitTo8bit(srcColor[1]) << 8u) | (CONV_6bitTo8bit(srcColor[2]) << 16u) | (0xffu << 24u);
+		}
+		vfb_setPalette(levelPalette);
+		TFE_Jedi::renderer_setSourcePalette(levelPalette);
+
+		TFE_Jedi::renderer_setType(RENDERER_SOFTWARE);
+		TFE_Jedi::render_setResolution();
+		TFE_Jedi::renderer_setLimits();
+		s_framebuffer = vfb_getCpuBuffer();
+		s_missionMode = MISSION_MODE_MAIN;
+
+		TFE_System::logWrite(LOG_MSG, "TimeDemo", "Rendering %d frames of '%s' at %dx%d.", settings->frameCount, settings->level,
+			graphics->gameResolution.x, graphics->gameResolution.z);
+
+		RSector* sector = nullptr;
+		for (s32 f = 0; f < settings->frameCount; f++)
+		{
+			TimeDemoCamera camera;
+			TFE_TimeDemo::getCamera(f, &camera);
+
+			const fixed16_16 x = floatToFixed16(camera.pos.x);
+			const fixed16_16 y = floatToFixed16(camera.pos.y);
+			const fixed16_16 z = floatToFixed16(camera.pos.z);
+			// Keep the previous sector if the path briefly leaves the level geometry.
+			RSector* camSector = sector_which3D(x, y, z);
+			sector = camSector ? camSector : sector;
+			if (!sector)
+			{
+				TFE_System::logWrite(LOG_ERROR, "TimeDemo", "Camera path starts outside of the level at (%0.2f, %0.2f, %0.2f).", camera.pos.x, camera.pos.y, camera.pos.z);
+				return JFALSE;
+			}
+			// 16384 angle units = 360 degrees.
+			const angle14_32 yaw   = angle14_32(camera.yaw   * 16384.0f / 360.0f) & ANGLE_MASK;
+			const angle14_32 pitch = angle14_32(camera.pitch * 16384.0f / 360.0f);
+
+			TFE_TimeDemo::beginFrame();
+			{
+				TFE_ZONE("Time Demo Frame");
+				renderer_computeCameraTransform(sector, pitch, yaw, x, y, z);
+				TFE_Jedi::beginRender();
+				drawWorld(s_framebuffer, sector, s_levelColorMap, s_lightSourceRamp);
+				TFE_Jedi::endRender();
+			}
+			TFE_TimeDemo::endFrame();
+		}
+		return TFE_TimeDemo::writeResults() ? JTRUE : JFALSE;
+	}
+
 	void mission_mainTaskFunc(MessageType msg)
 	{
 		task_begin;
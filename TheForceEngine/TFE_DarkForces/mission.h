@@ -41,6 +41,7 @@ namespace TFE_DarkForces
 	void disableNightVision();
 
 	void mission_render(s32 rendererIndex = 0, bool forceTextureUpdate = false);
+	JBool mission_runTimeDemo();
 
 	void mission_setupTasks();
 	void mission_serialize(Stream* stream);
@@ -3,6 +3,8 @@
 #include "hotkeys.h"
 #include "levelEditor.h"
 #include "levelEditorData.h"
+#include "levelBvh.h"
+#include "levelGrid.h"
 #include "levelEditorHistory.h"
 #include "sharedState.h"
 #include <TFE_Editor/LevelEditor/Rendering/viewport.h>
@@ -50,6 +52,7 @@ namespace LevelEditor
 		obj.transform.m1.y = 1.0f;
 		obj.transform.m2.z = 1.0f;
 		sector->obj.push_back(obj);
+		levelBvh_markSectorDirty(sector->id);
 	}
 	
 	void findHoveredEntity2d(Vec2f worldPos)
@@ -168,10 +171,12 @@ namespace LevelEditor
 				{ std::max(worldPos[0].x, worldPos[1].x), 0.0f, std::max(worldPos[0].z, worldPos[1].z) }
 			};
 
-			const size_t sectorCount = s_level.sectors.size();
-			EditorSector* sector = s_level.sectors.data();
-			for (size_t s = 0; s < sectorCount; s++, sector++)
+			std::vector<s32> candidates;
+			levelGrid_getSectors(aabb, 0.0f, true, &candidates);
+			const size_t candidateCount = candidates.size();
+			for (size_t c = 0; c < candidateCount; c++)
 			{
+				EditorSector* sector = &s_level.sectors[candidates[c]];
 				if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
 				if (!aabbOverlap2d(sector->bounds, aabb)) { continue; }
 
@@ -303,6 +308,7 @@ namespace LevelEditor
 			obj->pos.x += delta.x;
 			obj->pos.y += delta.y;
 			obj->pos.z += delta.z;
+			levelBvh_markSectorDirty(sector->id);
 		}
 	}
 
@@ -380,6 +386,11 @@ namespace LevelEditor
 		}
 		if (!s_idList.empty())
 		{
+			const s32 idCount = (s32)s_idList.size();
+			for (s32 i = 0; i < idCount; i++)
+			{
+				levelBvh_markSectorDirty(s_idList[i]);
+			}
 			cmd_sectorSnapshot(name, s_idList);
 		}
 	}
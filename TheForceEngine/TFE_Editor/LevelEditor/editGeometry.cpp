@@ -4,6 +4,8 @@
 #include "infoPanel.h"
 #include "levelEditor.h"
 #include "levelEditorData.h"
+#include "levelGrid.h"
+#include "levelIndex.h"
 #include "levelEditorHistory.h"
 #include "sharedState.h"
 #include "selection.h"
@@ -46,6 +48,8 @@ namespace LevelEditor
 		s32 wallLight = 0;
 	};
 	static std::vector<SourceWall> s_sourceWallList;
+	static std::vector<s32> s_gridSectors;
+	static std::vector<LevelWallRef> s_mirrorWalls;
 	static s32 s_newWallTexOverride = -1;
 	static s32 s_curveSegDelta = 0;
 
@@ -797,10 +801,12 @@ namespace LevelEditor
 		shapeBounds[1].z += expand;
 
 		// 2c. Then add potentially overlapping sectors.
-		sector = s_level.sectors.data();
 		candidates->clear();
-		for (s32 s = 0; s < sectorCount; s++, sector++)
+		levelGrid_getSectors(shapeBounds, 0.0f, true, &s_gridSectors);
+		const s32 gridCount = (s32)s_gridSectors.size();
+		for (s32 s = 0; s < gridCount; s++)
 		{
+			sector = &s_level.sectors[s_gridSectors[s]];
 			if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
 			// The bounds have to overlap.
 			if (!aabbOverlap3d(shapeBounds, sector->bounds)) { continue; }
@@ -828,10 +834,17 @@ namespace LevelEditor
 			return;
 		}
 
-		// Fix-up adjoins.
+		// Only sectors in the list are adjoined to each other, the earliest sector in the list wins.
+		std::map<s32, s32> fixupOrder;
 		const s32 adjoinListCount = (s32)adjoinSectorsToFix.size();
 		const s32* adjoinListId = adjoinSectorsToFix.data();
 		for (s32 i = 0; i < adjoinListCount; i++)
+		{
+			fixupOrder.insert({ adjoinListId[i], i });
+		}
+
+		// Fix-up adjoins.
+		for (s32 i = 0; i < adjoinListCount; i++)
 		{
 			EditorSector* src = &s_level.sectors[adjoinListId[i]];
 			const s32 wallCountSrc = (s32)src->walls.size();
@@ -843,32 +856,33 @@ namespace LevelEditor
 				const Vec2f v0 = vtxSrc[wallSrc->idx[0]];
 				const Vec2f v1 = vtxSrc[wallSrc->idx[1]];
 
-				for (s32 j = 0; j < adjoinListCount; j++)
+				// Walls that go from v1 to v0, sorted by sector and wall.
+				levelIndex_getMirrorWalls(&v0, &v1, &s_mirrorWalls);
+				const s32 mirrorCount = (s32)s_mirrorWalls.size();
+				const LevelWallRef* mirror = s_mirrorWalls.data();
+				const LevelWallRef* best = nullptr;
+				s32 bestOrder = adjoinListCount;
+				for (s32 m = 0; m < mirrorCount; m++, mirror++)
 				{
-					if (i == j) { continue; }
-					EditorSector* dst = &s_level.sectors[adjoinListId[j]];
-					const s32 wallCountDst = (s32)dst->walls.size();
-					Vec2f* vtxDst = dst->vtx.data();
-					EditorWall* wallDst = dst->walls.data();
-					for (s32 w1 = 0; w1 < wallCountDst; w1++, wallDst++)
-					{
-						if (wallDst->adjoinId >= 0) { continue; }
-						const Vec2f v2 = vtxDst[wallDst->idx[0]];
-						const Vec2f v3 = vtxDst[wallDst->idx[1]];
-						if (TFE_Polygon::vtxEqual(&v0, &v3) && TFE_Polygon::vtxEqual(&v1, &v2))
-						{
-							// Make sure the vertices are *exactly* the same.
-							vtxDst[wallDst->idx[0]] = v1;
-							vtxDst[wallDst->idx[1]] = v0;
-
-							wallSrc->adjoinId = dst->id;
-							wallSrc->mirrorId = w1;
-							wallDst->adjoinId = src->id;
-							wallDst->mirrorId = w0;
-							break;
-						}
-					}
+					std::map<s32, s32>::const_iterator iOrder = fixupOrder.find(mirror->sectorId);
+					if (iOrder == fixupOrder.end() || iOrder->second == i || iOrder->second >= bestOrder) { continue; }
+					if (s_level.sectors[mirror->sectorId].walls[mirror->wallIndex].adjoinId >= 0) { continue; }
+					best = mirror;
+					bestOrder = iOrder->second;
 				}
+				if (!best) { continue; }
+
+				EditorSector* dst = &s_level.sectors[best->sectorId];
+				EditorWall* wallDst = &dst->walls[best->wallIndex];
+				// Make sure the vertices are *exactly* the same.
+				dst->vtx[wallDst->idx[0]] = v1;
+				dst->vtx[wallDst->idx[1]] = v0;
+				levelIndex_markSectorDirty(dst->id);
+
+				wallSrc->adjoinId = dst->id;
+				wallSrc->mirrorId = best->wallIndex;
+				wallDst->adjoinId = src->id;
+				wallDst->mirrorId = w0;
 			}
 		}
 	}
@@ -2656,11 +2670,12 @@ namespace LevelEditor
 		shapeBounds[1].z += extend;
 
 		// 2. Add sector edges to the map.
-		const s32 sectorCount = (s32)s_level.sectors.size();
-		EditorSector* sector = s_level.sectors.data();
+		levelGrid_getSectors(shapeBounds, 0.0f, true, &s_gridSectors);
+		const s32 gridCount = (s32)s_gridSectors.size();
 		s_adjacencyMap.clear();
-		for (s32 s = 0; s < sectorCount; s++, sector++)
+		for (s32 s = 0; s < gridCount; s++)
 		{
+			EditorSector* sector = &s_level.sectors[s_gridSectors[s]];
 			if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
 			// The bounds have to overlap.
 			if (!aabbOverlap2d(shapeBounds, sector->bounds)) { continue; }
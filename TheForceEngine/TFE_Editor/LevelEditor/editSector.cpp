@@ -9,6 +9,8 @@
 #include "infoPanel.h"
 #include "levelEditor.h"
 #include "levelEditorData.h"
+#include "levelBvh.h"
+#include "levelGrid.h"
 #include "levelEditorHistory.h"
 #include "sharedState.h"
 #include "selection.h"
@@ -63,10 +65,12 @@ namespace LevelEditor
 				{ std::max(worldPos[0].x, worldPos[1].x), 0.0f, std::max(worldPos[0].z, worldPos[1].z) }
 			};
 
-			const size_t sectorCount = s_level.sectors.size();
-			EditorSector* sector = s_level.sectors.data();
-			for (size_t s = 0; s < sectorCount; s++, sector++)
+			std::vector<s32> candidates;
+			levelGrid_getSectors(aabb, 0.0f, true, &candidates);
+			const size_t candidateCount = candidates.size();
+			for (size_t c = 0; c < candidateCount; c++)
 			{
+				EditorSector* sector = &s_level.sectors[candidates[c]];
 				if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
 				if (!aabbOverlap2d(sector->bounds, aabb)) { continue; }
 
@@ -210,6 +214,7 @@ namespace LevelEditor
 				obj->pos.y += delta.y;
 				obj->pos.z += delta.z;
 			}
+			levelBvh_markSectorDirty(sector->id);
 		}
 	}
 }
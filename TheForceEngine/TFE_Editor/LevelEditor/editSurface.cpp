@@ -9,6 +9,8 @@
 #include "infoPanel.h"
 #include "levelEditor.h"
 #include "levelEditorData.h"
+#include "levelGrid.h"
+#include "levelIndex.h"
 #include "levelEditorHistory.h"
 #include "sharedState.h"
 #include "selection.h"
@@ -288,10 +290,12 @@ namespace LevelEditor
 				{ std::max(worldPos[0].x, worldPos[1].x), 0.0f, std::max(worldPos[0].z, worldPos[1].z) }
 			};
 
-			const size_t sectorCount = s_level.sectors.size();
-			EditorSector* sector = s_level.sectors.data();
-			for (size_t s = 0; s < sectorCount; s++, sector++)
+			std::vector<s32> candidates;
+			levelGrid_getSectors(aabb, 0.0f, true, &candidates);
+			const size_t candidateCount = candidates.size();
+			for (size_t c = 0; c < candidateCount; c++)
 			{
+				EditorSector* sector = &s_level.sectors[candidates[c]];
 				if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
 				if (!aabbOverlap2d(sector->bounds, aabb)) { continue; }
 
@@ -493,6 +497,28 @@ namespace LevelEditor
 		const Vec2f s0 = srcVtx[srcWall->idx[0]];
 		const Vec2f s1 = srcVtx[srcWall->idx[1]];
 
+		// Walls with the same vertex positions going in the opposite direction are found directly.
+		std::vector<LevelWallRef> mirrorWalls;
+		levelIndex_getMirrorWalls(&s0, &s1, &mirrorWalls);
+		const s32 mirrorCount = (s32)mirrorWalls.size();
+		for (s32 m = 0; m < mirrorCount; m++)
+		{
+			EditorSector* conSector = &s_level.sectors[mirrorWalls[m].sectorId];
+			if (conSector->id == sectorId) { continue; }
+			if (!sector_isInteractable(conSector) || !sector_onActiveLayer(conSector)) { continue; }
+
+			const s32 w = mirrorWalls[m].wallIndex;
+			EditorWall* conWall = &conSector->walls[w];
+			srcWall->adjoinId = conSector->id;
+			srcWall->mirrorId = w;
+
+			conWall->adjoinId = sectorId;
+			conWall->mirrorId = wallId;
+			// Only one adjoin is possible.
+			return;
+		}
+		if (exactMatch) { return; }
+
 		SectorList overlaps;
 		getOverlappingSectorsBounds(srcBounds, &overlaps);
 		const s32 sectorCount = (s32)overlaps.size();
@@ -1205,6 +1231,7 @@ namespace LevelEditor
 		// Insert the new wall right after the wall being split.
 		// This makes the process a bit more complicated, but keeps things clean.
 		sector->walls.insert(sector->walls.begin() + wallIndex + 1, newWall);
+		levelIndex_markSectorDirty(sector->id);
 
 		// Pointers to the new walls (note that since the wall array was resized, the source wall
 		// pointer might have changed as well).
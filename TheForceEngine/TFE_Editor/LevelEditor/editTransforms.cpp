@@ -4,6 +4,7 @@
 #include "editSector.h"
 #include "hotkeys.h"
 #include "levelEditor.h"
+#include "levelBvh.h"
 #include "levelEditorHistory.h"
 #include "editVertex.h"
 #include "sharedState.h"
@@ -1313,6 +1314,7 @@ namespace LevelEditor
 		s32 newIndex = (s32)newSector->obj.size();
 		selection_entity(SA_ADD, newSector, newIndex);
 		newSector->obj.push_back(objCopy);
+		levelBvh_markSectorDirty(newSector->id);
 
 		if (newSector->searchKey != s_searchKey)
 		{
@@ -8,6 +8,9 @@
 #include "infoPanel.h"
 #include "levelEditor.h"
 #include "levelEditorData.h"
+#include "levelBvh.h"
+#include "levelGrid.h"
+#include "levelIndex.h"
 #include "levelEditorHistory.h"
 #include "sharedState.h"
 #include "selection.h"
@@ -40,6 +43,7 @@ namespace LevelEditor
 	static std::vector<VertexWallGroup> s_vertexWallGroups;
 	static std::vector<EditorSector> s_sectorSnapshot;
 	static std::vector<s32> s_deltaSectors;
+	static std::vector<s32> s_hoverSectors;
 
 	void findHoveredVertexOutside(Vec3f pos, f32 maxDist, bool use3dCheck);
 	void selectVerticesToDelete(EditorSector* root, s32 featureIndex, const Vec2f* rootVtx);
@@ -315,10 +319,12 @@ namespace LevelEditor
 				{ std::max(worldPos[0].x, worldPos[1].x), 0.0f, std::max(worldPos[0].z, worldPos[1].z) }
 			};
 
-			const size_t sectorCount = s_level.sectors.size();
-			EditorSector* sector = s_level.sectors.data();
-			for (size_t s = 0; s < sectorCount; s++, sector++)
+			std::vector<s32> candidates;
+			levelGrid_getSectors(aabb, 0.0f, true, &candidates);
+			const size_t candidateCount = candidates.size();
+			for (size_t c = 0; c < candidateCount; c++)
 			{
+				EditorSector* sector = &s_level.sectors[candidates[c]];
 				if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
 				if (!aabbOverlap2d(sector->bounds, aabb)) { continue; }
 
@@ -542,16 +548,17 @@ namespace LevelEditor
 	////////////////////////////////////////
 	void findHoveredVertexOutside(Vec3f pos, f32 maxDist, bool use3dCheck)
 	{
-		// TODO: Spatial partitioning.
-		const s32 count = (s32)s_level.sectors.size();
-		EditorSector* sector = s_level.sectors.data();
+		const Vec3f ptBounds[] = { pos, pos };
+		levelGrid_getSectors(ptBounds, maxDist, true, &s_hoverSectors);
+		const s32 count = (s32)s_hoverSectors.size();
 
 		f32 minDist = maxDist * maxDist;
 		s32 vtxIndex = -1;
 		EditorSector* vtxSector = nullptr;
 
-		for (s32 i = 0; i < count; i++, sector++)
+		for (s32 i = 0; i < count; i++)
 		{
+			EditorSector* sector = &s_level.sectors[s_hoverSectors[i]];
 			if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
 			if (use3dCheck && (pos.y < sector->bounds[0].y || pos.y > sector->bounds[1].y)) { continue; }
 
@@ -693,6 +700,9 @@ namespace LevelEditor
 			// Get the ID and then erase it from the level.
 			s32 delId = sector->id;
 			s_level.sectors.erase(s_level.sectors.begin() + delId);
+			levelBvh_invalidate();
+			levelGrid_invalidate();
+			levelIndex_invalidate();
 
 			// Update Sector IDs
 			const s32 levSectorCount = (s32)s_level.sectors.size();
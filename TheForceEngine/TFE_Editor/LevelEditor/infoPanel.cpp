@@ -1,5 +1,8 @@
 #include "levelEditor.h"
 #include "levelEditorData.h"
+#include "levelBvh.h"
+#include "levelGrid.h"
+#include "levelIndex.h"
 #include "levelEditorHistory.h"
 #include "editVertex.h"
 #include "editCommon.h"
@@ -1043,6 +1046,8 @@ namespace LevelEditor
 		for (s32 i = 0; i < count; i++)
 		{
 			pair[i] = { info[i]->id, -1 };
+			// The heights may have changed.
+			levelBvh_markSectorDirty(info[i]->id);
 			if (!pairsChanged && (pair[i].i0 != prev[i].i0 || pair[i].i1 != prev[i].i1))
 			{
 				pairsChanged = true;
@@ -1135,6 +1140,7 @@ namespace LevelEditor
 			if (s_sectorChanges.changes & SCF_LAYER)
 			{
 				sector->layer = s_sectorChanges.layer;
+				levelGrid_updateSector(sector->id);
 				// Adjust layer range.
 				s_level.layerRange[0] = std::min(s_level.layerRange[0], sector->layer);
 				s_level.layerRange[1] = std::max(s_level.layerRange[1], sector->layer);
@@ -1611,6 +1617,7 @@ namespace LevelEditor
 			if (ImGui::InputText(inputName, sectorName, getSectorNameLimit()))
 			{
 				sector->name = sectorName;
+				levelIndex_updateSectorName(sector->id);
 				changed = true;
 			}
 			ImGui::PopItemWidth();
@@ -1629,6 +1636,7 @@ namespace LevelEditor
 			if (layer != sector->layer)
 			{
 				sector->layer = layer;
+				levelGrid_updateSector(sector->id);
 				// Adjust layer range.
 				s_level.layerRange[0] = std::min(s_level.layerRange[0], (s32)layer);
 				s_level.layerRange[1] = std::max(s_level.layerRange[1], (s32)layer);
@@ -1981,6 +1989,8 @@ namespace LevelEditor
 				break;
 			}
 		}
+		// The object bounds depend on the entity.
+		levelBvh_markSectorDirty(sector->id);
 		if (entityIndex >= 0)
 		{
 			obj->entityId = entityIndex;
@@ -2207,7 +2217,10 @@ namespace LevelEditor
 			ImGui::Separator();
 
 			ImGui::Text("%s", "Position"); ImGui::SameLine(0.0f, 8.0f);
-			ImGui::InputFloat3("##Position", &obj->pos.x);
+			if (ImGui::InputFloat3("##Position", &obj->pos.x))
+			{
+				levelBvh_markSectorDirty(sector->id);
+			}
 
 			bool orientAdjusted = false;
 			ImGui::Text("%s", "Angle"); ImGui::SameLine(0.0f, 32.0f);
@@ -2251,6 +2264,7 @@ namespace LevelEditor
 				if (orientAdjusted)
 				{
 					compute3x3Rotation(&obj->transform, obj->angle, obj->pitch, obj->roll);
+					levelBvh_markSectorDirty(sector->id);
 				}
 			}
 
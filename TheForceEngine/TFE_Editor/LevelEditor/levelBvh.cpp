@@ -0,0 +1,589 @@
+#include "levelBvh.h"
+#include "levelEditorData.h"
+#include "sharedState.h"
+#include "entity.h"
+#include <TFE_Editor/EditorAsset/editorObj3D.h>
+#include <TFE_System/math.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+namespace LevelEditor
+{
+	enum BvhConstants
+	{
+		BVH_LEAF_SIZE = 4,
+		BVH_MAX_DEPTH = 64,
+		// Sectors with fewer walls are tested directly.
+		BVH_WALL_TREE_MIN = 32,
+		// Rebuild instead of refitting when more than 1 / N sectors change at once.
+		BVH_REBUILD_FRACTION = 4,
+	};
+	// Padding added to the bounds, larger than the tolerances used by the intersection tests.
+	static const f32 c_bvhPad = 0.01f;
+
+	struct BvhNode
+	{
+		Vec3f bounds[2];
+		s32 parent;
+		// Internal nodes: the children are at first and first + 1, count = 0.
+		// Leaf nodes: the items are at s_items[first .. first + count - 1].
+		s32 first;
+		s32 count;
+	};
+
+	struct WallNode
+	{
+		Vec2f bounds[2];
+		s32 first;
+		s32 count;
+	};
+
+	struct SectorWallTree
+	{
+		std::vector<WallNode> nodes;
+		std::vector<s32> walls;
+		bool built = false;
+	};
+
+	struct BvhSector
+	{
+		Vec3f bounds[2];
+		Vec3f center;
+		u32 key;
+		s32 leaf;
+		bool dirty;
+	};
+
+	static std::vector<BvhNode> s_nodes;
+	static std::vector<s32> s_items;
+	static std::vector<BvhSector> s_sectors;
+	static std::vector<SectorWallTree> s_wallTrees;
+	static std::vector<s32> s_dirty;
+	static bool s_rebuild = true;
+	// The sector keys are only compared when the edit generation changes.
+	static u32 s_editGen = 0;
+	static u32 s_checkedGen = 0;
+
+	/////////////////////////////////////////////
+	// Sector bounds
+	/////////////////////////////////////////////
+	static void hashValue(u32& hash, u32 value)
+	{
+		hash = (hash ^ value) * 16777619u;
+	}
+
+	static void hashValue(u32& hash, f32 value)
+	{
+		u32 bits;
+		memcpy(&bits, &value, sizeof(u32));
+		hashValue(hash, bits);
+	}
+
+	// Cheap key covering everything the sector bounds depend on, used to catch edits that do not mark the sector dirty.
+	static u32 computeSectorKey(const EditorSector* sector)
+	{
+		u32 key = 2166136261u;
+		hashValue(key, sector->floorHeight);
+		hashValue(key, sector->ceilHeight);
+		hashValue(key, sector->bounds[0].x);
+		hashValue(key, sector->bounds[0].z);
+		hashValue(key, sector->bounds[1].x);
+		hashValue(key, sector->bounds[1].z);
+		hashValue(key, u32(sector->vtx.size()));
+		hashValue(key, u32(sector->walls.size()));
+		hashValue(key, u32(sector->obj.size()));
+
+		const s32 objCount = (s32)sector->obj.size();
+		const EditorObject* obj = sector->obj.data();
+		for (s32 o = 0; o < objCount; o++, obj++)
+		{
+			hashValue(key, u32(obj->entityId));
+			hashValue(key, obj->pos.x);
+			hashValue(key, obj->pos.y);
+			hashValue(key, obj->pos.z);
+			hashValue(key, obj->angle);
+			hashValue(key, obj->pitch);
+			hashValue(key, obj->roll);
+		}
+		return key;
+	}
+
+	static void boundsAddPoint(Vec3f* bounds, const Vec3f& pt)
+	{
+		bounds[0].x = std::min(bounds[0].x, pt.x);
+		bounds[0].y = std::min(bounds[0].y, pt.y);
+		bounds[0].z = std::min(bounds[0].z, pt.z);
+		bounds[1].x = std::max(bounds[1].x, pt.x);
+		bounds[1].y = std::max(bounds[1].y, pt.y);
+		bounds[1].z = std::max(bounds[1].z, pt.z);
+	}
+
+	static void boundsAdd(Vec3f* bounds, const Vec3f* src)
+	{
+		boundsAddPoint(bounds, src[0]);
+		boundsAddPoint(bounds, src[1]);
+	}
+
+	static void boundsClear(Vec3f* bounds)
+	{
+		bounds[0] = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+		bounds[1] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	}
+
+	// Conservative object bounds, these must contain the boxes tested by traceRay().
+	static void getObjectBounds(const EditorObject* obj, Vec3f* bounds)
+	{
+		const Entity* entity = &s_level.entities[obj->entityId];
+		const Vec3f& pos = obj->pos;
+		if (entity->type == ETYPE_3D && entity->obj3d)
+		{
+			// Bound the oriented box with a sphere, scaled by the largest possible axis scale of the transform.
+			const Vec3f* objBounds = entity->obj3d->bounds;
+			f32 radiusSq = 0.0f;
+			for (s32 i = 0; i < 8; i++)
+			{
+				const Vec3f corner = { objBounds[i & 1].x, objBounds[(i >> 1) & 1].y, objBounds[(i >> 2) & 1].z };
+				radiusSq = std::max(radiusSq, TFE_Math::dot(&corner, &corner));
+			}
+			f32 scaleSq = 0.0f;
+			for (s32 i = 0; i < 9; i++) { scaleSq += obj->transform.data[i] * obj->transform.data[i]; }
+			const f32 radius = sqrtf(radiusSq * scaleSq);
+
+			bounds[0] = { pos.x - radius, pos.y - radius, pos.z - radius };
+			bounds[1] = { pos.x + radius, pos.y + radius, pos.z + radius };
+		}
+		else
+		{
+			// Sprites may be offset vertically, see traceRay().
+			const f32 offset = fabsf(entity->offset.y + fabsf(entity->st[1].z - entity->st[0].z)) * 0.1f;
+			const f32 width = fabsf(entity->size.x) * 0.5f;
+			const f32 height = fabsf(entity->size.z);
+			bounds[0] = { pos.x - width, pos.y - offset - height, pos.z - width };
+			bounds[1] = { pos.x + width, pos.y + offset + height, pos.z + width };
+		}
+	}
+
+	static void computeSectorBounds(s32 index)
+	{
+		const EditorSector* sector = &s_level.sectors[index];
+		BvhSector* bvhSector = &s_sectors[index];
+		Vec3f* bounds = bvhSector->bounds;
+		boundsClear(bounds);
+
+		// Walls and the polygon used by the floor and ceiling tests.
+		const f32 y0 = std::min(sector->floorHeight, sector->ceilHeight);
+		const f32 y1 = std::max(sector->floorHeight, sector->ceilHeight);
+		const s32 vtxCount = (s32)sector->vtx.size();
+		for (s32 v = 0; v < vtxCount; v++)
+		{
+			boundsAddPoint(bounds, { sector->vtx[v].x, y0, sector->vtx[v].z });
+			boundsAddPoint(bounds, { sector->vtx[v].x, y1, sector->vtx[v].z });
+		}
+		const s32 polyCount = (s32)sector->poly.vtx.size();
+		for (s32 v = 0; v < polyCount; v++)
+		{
+			boundsAddPoint(bounds, { sector->poly.vtx[v].x, y0, sector->poly.vtx[v].z });
+			boundsAddPoint(bounds, { sector->poly.vtx[v].x, y1, sector->poly.vtx[v].z });
+		}
+
+		// Objects.
+		const s32 objCount = (s32)sector->obj.size();
+		const EditorObject* obj = sector->obj.data();
+		for (s32 o = 0; o < objCount; o++, obj++)
+		{
+			if (obj->entityId < 0 || obj->entityId >= (s32)s_level.entities.size()) { continue; }
+			Vec3f objBounds[2];
+			getObjectBounds(obj, objBounds);
+			boundsAdd(bounds, objBounds);
+		}
+
+		if (bounds[0].x <= bounds[1].x)
+		{
+			bounds[0] = { bounds[0].x - c_bvhPad, bounds[0].y - c_bvhPad, bounds[0].z - c_bvhPad };
+			bounds[1] = { bounds[1].x + c_bvhPad, bounds[1].y + c_bvhPad, bounds[1].z + c_bvhPad };
+			bvhSector->center = { (bounds[0].x + bounds[1].x) * 0.5f, (bounds[0].y + bounds[1].y) * 0.5f, (bounds[0].z + bounds[1].z) * 0.5f };
+		}
+		else
+		{
+			// Empty sector, nothing can be hit.
+			bvhSector->center = { 0 };
+		}
+		bvhSector->key = computeSectorKey(sector);
+		bvhSector->dirty = false;
+
+		// The wall tree is rebuilt on demand.
+		s_wallTrees[index].built = false;
+	}
+
+	/////////////////////////////////////////////
+	// Sector tree
+	/////////////////////////////////////////////
+	static void updateNodeBounds(BvhNode* node)
+	{
+		boundsClear(node->bounds);
+		if (node->count)
+		{
+			for (s32 i = 0; i < node->count; i++)
+			{
+				const BvhSector* bvhSector = &s_sectors[s_items[node->first + i]];
+				if (bvhSector->bounds[0].x <= bvhSector->bounds[1].x)
+				{
+					boundsAdd(node->bounds, bvhSector->bounds);
+				}
+			}
+		}
+		else
+		{
+			for (s32 c = 0; c < 2; c++)
+			{
+				const BvhNode* child = &s_nodes[node->first + c];
+				if (child->bounds[0].x <= child->bounds[1].x)
+				{
+					boundsAdd(node->bounds, child->bounds);
+				}
+			}
+		}
+	}
+
+	static void buildNode(s32 nodeIndex, s32 first, s32 count, s32 depth)
+	{
+		BvhNode* node = &s_nodes[nodeIndex];
+		node->first = first;
+		node->count = count;
+		if (count <= BVH_LEAF_SIZE || depth >= BVH_MAX_DEPTH)
+		{
+			for (s32 i = 0; i < count; i++) { s_sectors[s_items[first + i]].leaf = nodeIndex; }
+			updateNodeBounds(node);
+			return;
+		}
+
+		// Split at the median center along the longest axis.
+		Vec3f centerBounds[2];
+		boundsClear(centerBounds);
+		for (s32 i = 0; i < count; i++) { boundsAddPoint(centerBounds, s_sectors[s_items[first + i]].center); }
+		const Vec3f ext = { centerBounds[1].x - centerBounds[0].x, centerBounds[1].y - centerBounds[0].y, centerBounds[1].z - centerBounds[0].z };
+		const s32 axis = (ext.x >= ext.y && ext.x >= ext.z) ? 0 : (ext.y >= ext.z ? 1 : 2);
+
+		const s32 half = count / 2;
+		std::nth_element(s_items.begin() + first, s_items.begin() + first + half, s_items.begin() + first + count, [axis](s32 a, s32 b)
+		{
+			return s_sectors[a].center.m[axis] < s_sectors[b].center.m[axis];
+		});
+
+		const s32 left = (s32)s_nodes.size();
+		s_nodes.push_back({});
+		s_nodes.push_back({});
+		// s_nodes may have been reallocated.
+		node = &s_nodes[nodeIndex];
+		node->first = left;
+		node->count = 0;
+		s_nodes[left].parent = nodeIndex;
+		s_nodes[left + 1].parent = nodeIndex;
+
+		buildNode(left, first, half, depth + 1);
+		buildNode(left + 1, first + half, count - half, depth + 1);
+		updateNodeBounds(&s_nodes[nodeIndex]);
+	}
+
+	static void rebuildTree()
+	{
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		s_sectors.resize(sectorCount);
+		s_wallTrees.clear();
+		s_wallTrees.resize(sectorCount);
+		s_items.resize(sectorCount);
+		for (s32 s = 0; s < sectorCount; s++)
+		{
+			computeSectorBounds(s);
+			s_items[s] = s;
+		}
+
+		s_nodes.clear();
+		s_nodes.reserve(sectorCount * 2 / BVH_LEAF_SIZE + 2);
+		s_nodes.push_back({});
+		s_nodes[0].parent = -1;
+		buildNode(0, 0, sectorCount, 0);
+
+		s_dirty.clear();
+		s_rebuild = false;
+		s_checkedGen = s_editGen;
+	}
+
+	static void refit()
+	{
+		const s32 dirtyCount = (s32)s_dirty.size();
+		for (s32 i = 0; i < dirtyCount; i++)
+		{
+			const s32 index = s_dirty[i];
+			computeSectorBounds(index);
+			for (s32 n = s_sectors[index].leaf; n >= 0; n = s_nodes[n].parent)
+			{
+				updateNodeBounds(&s_nodes[n]);
+			}
+		}
+		s_dirty.clear();
+	}
+
+	// Bring the tree up to date with the level.
+	static void updateTree()
+	{
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		if (s_rebuild || sectorCount != (s32)s_sectors.size())
+		{
+			rebuildTree();
+			return;
+		}
+
+		// Catch changes that were not reported, once per recorded edit.
+		if (s_checkedGen != s_editGen)
+		{
+			for (s32 s = 0; s < sectorCount; s++)
+			{
+				BvhSector* bvhSector = &s_sectors[s];
+				if (!bvhSector->dirty && bvhSector->key != computeSectorKey(&s_level.sectors[s]))
+				{
+					bvhSector->dirty = true;
+					s_dirty.push_back(s);
+				}
+			}
+			s_checkedGen = s_editGen;
+		}
+
+		if ((s32)s_dirty.size() * BVH_REBUILD_FRACTION > sectorCount)
+		{
+			rebuildTree();
+		}
+		else if (!s_dirty.empty())
+		{
+			refit();
+		}
+	}
+
+	// Slab test, returns true if the ray overlaps the box for t in [0, maxT].
+	static bool rayOverlapsBounds(const Vec3f& origin, const Vec3f& invDir, f32 maxT, const Vec3f* bounds)
+	{
+		f32 t0 = 0.0f, t1 = maxT;
+		for (s32 a = 0; a < 3; a++)
+		{
+			f32 n = (bounds[0].m[a] - origin.m[a]) * invDir.m[a];
+			f32 f = (bounds[1].m[a] - origin.m[a]) * invDir.m[a];
+			// NaN (0 * inf) means the origin is on the slab plane with a parallel ray, which is treated as overlapping.
+			if (n != n || f != f)
+			{
+				if (origin.m[a] < bounds[0].m[a] || origin.m[a] > bounds[1].m[a]) { return false; }
+				continue;
+			}
+			if (n > f) { std::swap(n, f); }
+			t0 = std::max(t0, n);
+			t1 = std::min(t1, f);
+			if (t0 > t1) { return false; }
+		}
+		return true;
+	}
+
+	/////////////////////////////////////////////
+	// Wall trees
+	/////////////////////////////////////////////
+	static void getWallBounds(const EditorSector* sector, s32 wallIndex, Vec2f* bounds)
+	{
+		const EditorWall* wall = &sector->walls[wallIndex];
+		const Vec2f* v0 = &sector->vtx[wall->idx[0]];
+		const Vec2f* v1 = &sector->vtx[wall->idx[1]];
+		bounds[0] = { std::min(v0->x, v1->x) - c_bvhPad, std::min(v0->z, v1->z) - c_bvhPad };
+		bounds[1] = { std::max(v0->x, v1->x) + c_bvhPad, std::max(v0->z, v1->z) + c_bvhPad };
+	}
+
+	static void buildWallNode(SectorWallTree* tree, const EditorSector* sector, s32 nodeIndex, s32 first, s32 count)
+	{
+		Vec2f bounds[2] = { { FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX } };
+		Vec2f centerBounds[2] = { { FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX } };
+		for (s32 i = 0; i < count; i++)
+		{
+			Vec2f wallBounds[2];
+			getWallBounds(sector, tree->walls[first + i], wallBounds);
+			bounds[0] = { std::min(bounds[0].x, wallBounds[0].x), std::min(bounds[0].z, wallBounds[0].z) };
+			bounds[1] = { std::max(bounds[1].x, wallBounds[1].x), std::max(bounds[1].z, wallBounds[1].z) };
+
+			const Vec2f center = { (wallBounds[0].x + wallBounds[1].x) * 0.5f, (wallBounds[0].z + wallBounds[1].z) * 0.5f };
+			centerBounds[0] = { std::min(centerBounds[0].x, center.x), std::min(centerBounds[0].z, center.z) };
+			centerBounds[1] = { std::max(centerBounds[1].x, center.x), std::max(centerBounds[1].z, center.z) };
+		}
+		tree->nodes[nodeIndex].bounds[0] = bounds[0];
+		tree->nodes[nodeIndex].bounds[1] = bounds[1];
+		tree->nodes[nodeIndex].first = first;
+		tree->nodes[nodeIndex].count = count;
+		if (count <= BVH_LEAF_SIZE) { return; }
+
+		const bool splitX = (centerBounds[1].x - centerBounds[0].x) >= (centerBounds[1].z - centerBounds[0].z);
+		const s32 half = count / 2;
+		std::nth_element(tree->walls.begin() + first, tree->walls.begin() + first + half, tree->walls.begin() + first + count, [sector, splitX](s32 a, s32 b)
+		{
+			const EditorWall* wa = &sector->walls[a];
+			const EditorWall* wb = &sector->walls[b];
+			const Vec2f* vtx = sector->vtx.data();
+			return splitX ? (vtx[wa->idx[0]].x + vtx[wa->idx[1]].x) < (vtx[wb->idx[0]].x + vtx[wb->idx[1]].x)
+			              : (vtx[wa->idx[0]].z + vtx[wa->idx[1]].z) < (vtx[wb->idx[0]].z + vtx[wb->idx[1]].z);
+		});
+
+		const s32 left = (s32)tree->nodes.size();
+		tree->nodes.push_back({});
+		tree->nodes.push_back({});
+		tree->nodes[nodeIndex].first = left;
+		tree->nodes[nodeIndex].count = 0;
+		buildWallNode(tree, sector, left, first, half);
+		buildWallNode(tree, sector, left + 1, first + half, count - half);
+	}
+
+	static void buildWallTree(s32 sectorIndex)
+	{
+		const EditorSector* sector = &s_level.sectors[sectorIndex];
+		SectorWallTree* tree = &s_wallTrees[sectorIndex];
+		const s32 wallCount = (s32)sector->walls.size();
+
+		tree->walls.resize(wallCount);
+		for (s32 w = 0; w < wallCount; w++) { tree->walls[w] = w; }
+		tree->nodes.clear();
+		tree->nodes.reserve(wallCount * 2 / BVH_LEAF_SIZE + 2);
+		tree->nodes.push_back({});
+		buildWallNode(tree, sector, 0, 0, wallCount);
+		tree->built = true;
+	}
+
+	static bool segmentOverlapsBounds(const Vec2f* p0, const Vec2f* p1, const Vec2f* bounds)
+	{
+		const Vec2f d = { p1->x - p0->x, p1->z - p0->z };
+		f32 t0 = 0.0f, t1 = 1.0f;
+		for (s32 a = 0; a < 2; a++)
+		{
+			const f32 o = a ? p0->z : p0->x;
+			const f32 dir = a ? d.z : d.x;
+			const f32 b0 = a ? bounds[0].z : bounds[0].x;
+			const f32 b1 = a ? bounds[1].z : bounds[1].x;
+			if (dir == 0.0f)
+			{
+				if (o < b0 || o > b1) { return false; }
+				continue;
+			}
+			f32 n = (b0 - o) / dir;
+			f32 f = (b1 - o) / dir;
+			if (n > f) { std::swap(n, f); }
+			t0 = std::max(t0, n);
+			t1 = std::min(t1, f);
+			if (t0 > t1) { return false; }
+		}
+		return true;
+	}
+
+	/////////////////////////////////////////////
+	// API
+	/////////////////////////////////////////////
+	void levelBvh_invalidate()
+	{
+		s_rebuild = true;
+	}
+
+	void levelBvh_markSectorDirty(s32 sectorIndex)
+	{
+		if (s_rebuild || sectorIndex < 0 || sectorIndex >= (s32)s_sectors.size()) { return; }
+		BvhSector* bvhSector = &s_sectors[sectorIndex];
+		if (!bvhSector->dirty)
+		{
+			bvhSector->dirty = true;
+			s_dirty.push_back(sectorIndex);
+		}
+		// Vertices may have moved without changing the sector bounds.
+		s_wallTrees[sectorIndex].built = false;
+	}
+
+	void levelBvh_markEdited()
+	{
+		s_editGen++;
+	}
+
+	void levelBvh_destroy()
+	{
+		s_nodes.clear();
+		s_items.clear();
+		s_sectors.clear();
+		s_wallTrees.clear();
+		s_dirty.clear();
+		s_rebuild = true;
+	}
+
+	void levelBvh_getRaySectors(const Ray* ray, bool unbounded, std::vector<s32>* sectors)
+	{
+		sectors->clear();
+		updateTree();
+		if (s_nodes.empty() || s_sectors.empty()) { return; }
+
+		const Vec3f invDir = { 1.0f / ray->dir.x, 1.0f / ray->dir.y, 1.0f / ray->dir.z };
+		const f32 maxT = unbounded ? FLT_MAX : ray->maxDist;
+
+		s32 stack[BVH_MAX_DEPTH + 2];
+		s32 stackCount = 0;
+		stack[stackCount++] = 0;
+		while (stackCount)
+		{
+			const BvhNode* node = &s_nodes[stack[--stackCount]];
+			if (node->bounds[0].x > node->bounds[1].x || !rayOverlapsBounds(ray->origin, invDir, maxT, node->bounds))
+			{
+				continue;
+			}
+
+			if (node->count)
+			{
+				for (s32 i = 0; i < node->count; i++)
+				{
+					const s32 index = s_items[node->first + i];
+					const BvhSector* bvhSector = &s_sectors[index];
+					if (node->count == 1 || (bvhSector->bounds[0].x <= bvhSector->bounds[1].x && rayOverlapsBounds(ray->origin, invDir, maxT, bvhSector->bounds)))
+					{
+						sectors->push_back(index);
+					}
+				}
+			}
+			else
+			{
+				stack[stackCount++] = node->first;
+				stack[stackCount++] = node->first + 1;
+			}
+		}
+		// Keep the same order as a linear search, so ties resolve the same way.
+		std::sort(sectors->begin(), sectors->end());
+	}
+
+	bool levelBvh_getSegmentWalls(s32 sectorIndex, const Vec2f* p0, const Vec2f* p1, std::vector<s32>* walls)
+	{
+		walls->clear();
+		if (s_rebuild || sectorIndex < 0 || sectorIndex >= (s32)s_wallTrees.size()) { return false; }
+		if ((s32)s_level.sectors[sectorIndex].walls.size() < BVH_WALL_TREE_MIN) { return false; }
+
+		SectorWallTree* tree = &s_wallTrees[sectorIndex];
+		if (!tree->built || tree->walls.size() != s_level.sectors[sectorIndex].walls.size())
+		{
+			buildWallTree(sectorIndex);
+		}
+
+		s32 stack[BVH_MAX_DEPTH + 2];
+		s32 stackCount = 0;
+		stack[stackCount++] = 0;
+		while (stackCount)
+		{
+			const WallNode* node = &tree->nodes[stack[--stackCount]];
+			if (!segmentOverlapsBounds(p0, p1, node->bounds)) { continue; }
+
+			if (node->count)
+			{
+				walls->insert(walls->end(), tree->walls.begin() + node->first, tree->walls.begin() + node->first + node->count);
+			}
+			else
+			{
+				stack[stackCount++] = node->first;
+				stack[stackCount++] = node->first + 1;
+			}
+		}
+		std::sort(walls->begin(), walls->end());
+		return true;
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine Editor
+// A system built to view and edit Dark Forces data files.
+// The viewing aspect needs to be put in place at the beginning
+// in order to properly test elements in isolation without having
+// to "play" the game as intended.
+//////////////////////////////////////////////////////////////////////
+// Bounding volume hierarchy over the level sectors, used to limit the
+// sectors (and walls of large sectors) tested by traceRay().
+//
+// Sector bounds include the objects in the sector. Sectors that change
+// are refit on the next query. sectorToPolygon() and the height and
+// object edits call levelBvh_markSectorDirty(). As a safety net, each
+// recorded edit calls levelBvh_markEdited() and the next query compares
+// a cheap per-sector key covering heights, bounds and objects - once per
+// edit rather than once per query. Large operations such as loading or
+// undo call levelBvh_invalidate() and the tree is rebuilt lazily.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <vector>
+
+namespace LevelEditor
+{
+	struct Ray;
+
+	// Rebuild the hierarchy on the next query.
+	void levelBvh_invalidate();
+	// Refit the sector on the next query.
+	void levelBvh_markSectorDirty(s32 sectorIndex);
+	// An edit was recorded, check for sector changes that were not reported on the next query.
+	void levelBvh_markEdited();
+	void levelBvh_destroy();
+
+	// Get the indices of the sectors that the ray may hit, in increasing order.
+	// If 'unbounded' is false, only hits within ray->maxDist are considered.
+	void levelBvh_getRaySectors(const Ray* ray, bool unbounded, std::vector<s32>* sectors);
+	// Get the indices of the walls in the sector that the 2D segment p0 -> p1 may cross, in increasing order.
+	// Returns false if the sector is small enough that all of the walls should be tested instead.
+	bool levelBvh_getSegmentWalls(s32 sectorIndex, const Vec2f* p0, const Vec2f* p1, std::vector<s32>* walls);
+}
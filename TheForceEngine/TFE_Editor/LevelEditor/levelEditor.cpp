@@ -1,5 +1,8 @@
 #include "levelEditor.h"
 #include "levelEditorData.h"
+#include "levelBvh.h"
+#include "levelGrid.h"
+#include "levelIndex.h"
 #include "levelEditorHistory.h"
 #include "levelEditorInf.h"
 #include "contextMenu.h"
@@ -347,6 +350,9 @@ namespace LevelEditor
 	void destroy()
 	{
 		s_level.sectors.clear();
+		levelBvh_destroy();
+		levelGrid_destroy();
+		levelIndex_destroy();
 		viewport_destroy();
 		TFE_RenderShared::destroy();
 
@@ -491,6 +497,9 @@ namespace LevelEditor
 
 		// Then erase the sector.
 		s_level.sectors.erase(s_level.sectors.begin() + sectorId);
+		levelBvh_invalidate();
+		levelGrid_invalidate();
+		levelIndex_invalidate();
 
 		// Finally fix-up any references.
 		sectorCount = (s32)s_level.sectors.size();
@@ -1125,6 +1134,7 @@ namespace LevelEditor
 		if (sector && index >= 0 && index < (s32)sector->obj.size())
 		{
 			sector->obj.erase(sector->obj.begin() + index);
+			levelBvh_markSectorDirty(sector->id);
 			clearEntityChanges();
 		}
 	}
@@ -2615,6 +2625,7 @@ namespace LevelEditor
 			EditorSector* sector = sectorList[i];
 			sector->bounds[0].y = std::min(sector->floorHeight, sector->ceilHeight);
 			sector->bounds[1].y = std::max(sector->floorHeight, sector->ceilHeight);
+			levelBvh_markSectorDirty(sector->id);
 		}
 	}
 	
@@ -6,6 +6,9 @@
 #include "error.h"
 #include "shell.h"
 #include "levelEditorInf.h"
+#include "levelBvh.h"
+#include "levelGrid.h"
+#include "levelIndex.h"
 #include "sharedState.h"
 #include <TFE_Editor/snapshotReaderWriter.h>
 #include <TFE_Editor/history.h>
@@ -85,6 +88,10 @@ namespace LevelEditor
 	std::vector<u8> s_fileData;
 	std::vector<IndexPair> s_pairs;
 	std::vector<IndexPair> s_prevPairs;
+	// Spatial query results.
+	static std::vector<s32> s_gridSectors;
+	static std::vector<s32> s_raySectors;
+	static std::vector<s32> s_rayWalls;
 	SelectionList s_featureList;
 	static u32* s_palette = nullptr;
 	static s32 s_palIndex = 0;
@@ -499,6 +506,9 @@ namespace LevelEditor
 	bool loadLevelFromAsset(Asset* asset)
 	{
 		EditorLevel* level = &s_level;
+		levelBvh_invalidate();
+		levelGrid_invalidate();
+		levelIndex_invalidate();
 		char slotName[256];
 		FileUtil::stripExtension(asset->name.c_str(), slotName);
 
@@ -1953,6 +1963,10 @@ namespace LevelEditor
 		sector->bounds[1] = { poly.bounds[1].x, 0.0f, poly.bounds[1].z };
 		sector->bounds[0].y = min(sector->floorHeight, sector->ceilHeight);
 		sector->bounds[1].y = max(sector->floorHeight, sector->ceilHeight);
+		levelBvh_markSectorDirty(sector->id);
+		levelGrid_updateSector(sector->id);
+		levelIndex_markSectorDirty(sector->id);
+		selection_geometryChanged();
 	}
 
 	// Update the sector itself from the sector's polygon.
@@ -1964,28 +1978,21 @@ namespace LevelEditor
 	s32 findSectorByName(const char* name, s32 excludeId)
 	{
 		if (s_level.sectors.empty() || !name || name[0] == 0) { return -1; }
-		const s32 sectorCount = (s32)s_level.sectors.size();
-		EditorSector* sector = s_level.sectors.data();
-		for (s32 i = 0; i < sectorCount; i++, sector++)
-		{
-			if (sector->name.empty() || excludeId == sector->id) { continue; }
-			if (strcasecmp(name, sector->name.c_str()) == 0)
-			{
-				return i;
-			}
-		}
-		return -1;
+		return levelIndex_findSectorByName(name, excludeId);
 	}
 
 	EditorSector* findSector2d(Vec2f pos)
 	{
 		if (s_level.sectors.empty()) { return nullptr; }
 
-		const s32 sectorCount = (s32)s_level.sectors.size();
+		const Vec3f ptBounds[] = { { pos.x, 0.0f, pos.z }, { pos.x, 0.0f, pos.z } };
+		levelGrid_getSectors(ptBounds, 0.0f, true, &s_gridSectors);
+		const s32 candidateCount = (s32)s_gridSectors.size();
 		EditorSector* sectors = s_level.sectors.data();
 
-		for (s32 i = 0; i < sectorCount; i++)
+		for (s32 c = 0; c < candidateCount; c++)
 		{
+			const s32 i = s_gridSectors[c];
 			if (!sector_isInteractable(&sectors[i]) || !sector_onActiveLayer(&sectors[i])) { continue; }
 			if (TFE_Polygon::pointInsidePolygon(&sectors[i].poly, pos))
 			{
@@ -1999,8 +2006,9 @@ namespace LevelEditor
 	{
 		if (s_level.sectors.empty()) { return nullptr; }
 
-		const s32 sectorCount = (s32)s_level.sectors.size();
-		EditorSector* sector = s_level.sectors.data();
+		const Vec3f ptBounds[] = { { pos.x, 0.0f, pos.z }, { pos.x, 0.0f, pos.z } };
+		levelGrid_getSectors(ptBounds, 0.0f, true, &s_gridSectors);
+		const s32 candidateCount = (s32)s_gridSectors.size();
 
 		EditorSector* firstHit = nullptr;
 		EditorSector* closestInside = nullptr;
@@ -2008,8 +2016,9 @@ namespace LevelEditor
 		f32 distFromFloorInside = FLT_MAX;
 		f32 distFromFloorOutside = FLT_MAX;
 
-		for (s32 i = 0; i < sectorCount; i++, sector++)
+		for (s32 c = 0; c < candidateCount; c++)
 		{
+			EditorSector* sector = &s_level.sectors[s_gridSectors[c]];
 			if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
 			if (TFE_Polygon::pointInsidePolygon(&sector->poly, pos))
 			{
@@ -2234,8 +2243,7 @@ namespace LevelEditor
 	{
 		EditorLevel* level = &s_level;
 		if (level->sectors.empty()) { return false; }
-		const s32 sectorCount = (s32)level->sectors.size();
-		EditorSector* sector = level->sectors.data();
+		EditorSector* sectorList = level->sectors.data();
 
 		f32 maxDist  = ray->maxDist;
 		Vec3f origin = ray->origin;
@@ -2251,23 +2259,28 @@ namespace LevelEditor
 		hitInfo->hitPos = { 0 };
 		hitInfo->dist = FLT_MAX;
 
-		// Loop through sectors in the world.
-		for (s32 s = 0; s < sectorCount; s++, sector++)
+		// Only the sectors whose bounds (including objects) the ray overlaps are tested, in the same order as a linear search.
+		// Objects are tested against the full ray, so the bounds test is only limited to maxDist when they cannot be hit.
+		levelBvh_getRaySectors(ray, canHitObjects, &s_raySectors);
+
+		const s32 candidateCount = (s32)s_raySectors.size();
+		for (s32 c = 0; c < candidateCount; c++)
 		{
+			EditorSector* sector = &sectorList[s_raySectors[c]];
 			if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
 
-			// Check the bounds.
-			//if (!rayHitAABB(ray, sector->bounds)) { continue; }
-
-			// Now check against the walls.
-			const u32 wallCount = (u32)sector->walls.size();
-			const EditorWall* wall = sector->walls.data();
+			// Now check against the walls, large sectors only test the walls near the ray.
+			const bool useWallList = levelBvh_getSegmentWalls(s_raySectors[c], &p0xz, &p1xz, &s_rayWalls);
+			const u32 wallCount = useWallList ? (u32)s_rayWalls.size() : (u32)sector->walls.size();
+			const EditorWall* wall = nullptr;
 			const Vec2f* vtx = sector->vtx.data();
 			f32 closestHit = FLT_MAX;
 			s32 closestWallId = -1;
 			bool rayInSector = false;
-			for (u32 w = 0; w < wallCount; w++, wall++)
+			for (u32 i = 0; i < wallCount; i++)
 			{
+				const u32 w = useWallList ? (u32)s_rayWalls[i] : i;
+				wall = &sector->walls[w];
 				const Vec2f* v0 = &vtx[wall->idx[0]];
 				const Vec2f* v1 = &vtx[wall->idx[1]];
 				Vec2f nrm = { -(v1->z - v0->z), v1->x - v0->x };
@@ -2621,16 +2634,17 @@ namespace LevelEditor
 		return closestId;
 	}
 
-	// TODO: Spatial data structure to handle cases where there are 10k, 100k, etc. sectors.
 	bool getOverlappingSectorsPt(const Vec3f* pos, SectorList* result, f32 padding)
 	{
 		if (!pos || !result) { return false; }
 
 		result->clear();
-		const s32 count = (s32)s_level.sectors.size();
-		EditorSector* sector = s_level.sectors.data();
-		for (s32 i = 0; i < count; i++, sector++)
+		const Vec3f ptBounds[] = { *pos, *pos };
+		levelGrid_getSectors(ptBounds, padding, true, &s_gridSectors);
+		const s32 count = (s32)s_gridSectors.size();
+		for (s32 i = 0; i < count; i++)
 		{
+			EditorSector* sector = &s_level.sectors[s_gridSectors[i]];
 			if (!sector_isInteractable(sector) || !sector_onActiveLayer(sector)) { continue; }
 			// The position has to be within the bounds of the sector.
 			// TODO: Increase the bounds range?
@@ -2653,10 +2667,11 @@ namespace LevelEditor
 
 		result->clear();
 		const f32 padding = 0.1f;
-		const s32 count = (s32)s_level.sectors.size();
-		EditorSector* sector = s_level.sectors.data();
-		for (s32 i = 0; i < count; i++, sector++)
+		levelGrid_getSectors(bounds, padding, false, &s_gridSectors);
+		const s32 count = (s32)s_gridSectors.size();
+		for (s32 i = 0; i < count; i++)
 		{
+			EditorSector* sector = &s_level.sectors[s_gridSectors[i]];
 			if (boundsOverlap3D(sector->bounds, bounds, padding)) // Add padding for sectors that are just touching.
 			{
 				result->push_back(sector);
@@ -2713,6 +2728,8 @@ namespace LevelEditor
 	void level_unpackEntiyListSnapshot(u32 size, void* data)
 	{
 		setSnapshotReadBuffer((u8*)data, size);
+		// Entity definitions may have changed, which changes the object bounds.
+		levelBvh_invalidate();
 
 		const s32 sectorId = readS32();
 		const u32 entityCount = readU32();      // Number of unique entities from sectors in snapshot.
@@ -3032,6 +3049,9 @@ namespace LevelEditor
 	void level_unpackSectorSnapshot(u32 size, void* data)
 	{
 		setSnapshotReadBuffer((u8*)data, size);
+		levelBvh_invalidate();
+		levelGrid_invalidate();
+		levelIndex_invalidate();
 		
 		const u32 newSectorCount = readU32();   // Total sectors in level after snapshot.
 		const u32 texCount = readU32();         // Number of unique textures from sectors in snapshot.
@@ -3237,6 +3257,7 @@ namespace LevelEditor
 			{
 				sector->name.clear();
 			}
+			levelIndex_updateSectorName(sector->id);
 			readData(&attrib, (u32)sizeof(SectorAttrib));
 
 			sector->groupId = attrib.groupId;
@@ -3249,6 +3270,8 @@ namespace LevelEditor
 			for (s32 i = 0; i < 3; i++) { sector->flags[i] = attrib.flags[i]; }
 			sector->bounds[0].y = std::min(sector->floorHeight, sector->ceilHeight);
 			sector->bounds[1].y = std::max(sector->floorHeight, sector->ceilHeight);
+			levelGrid_updateSector(sector->id);
+			levelBvh_markSectorDirty(sector->id);
 			sector->floorTex = attrib.floorTex;
 			sector->ceilTex = attrib.ceilTex;
 		}
@@ -3320,6 +3343,9 @@ namespace LevelEditor
 
 	void level_unpackSnapshot(s32 id, u32 size, void* data)
 	{
+		levelBvh_invalidate();
+		levelGrid_invalidate();
+		levelIndex_invalidate();
 		// Clear the current snapshot ID.
 		if (id < 0)
 		{
@@ -1,9 +1,11 @@
 #include "levelEditorHistory.h"
+#include "levelBvh.h"
 #include "sharedState.h"
 #include "error.h"
 #include <TFE_System/system.h>
 #include <TFE_Editor/LevelEditor/levelEditor.h>
 #include <TFE_Editor/LevelEditor/levelEditorData.h>
+#include <TFE_Editor/editorConfig.h>
 #include <TFE_Archive/zstdCompression.h>
 #include <TFE_System/system.h>
 #include <assert.h>
@@ -49,6 +51,9 @@ namespace LevelEditor
 	void levHistory_init()
 	{
 		history_init(level_unpackSnapshot, level_createSnapshot);
+		// The budget is stored in megabytes, clamp so it fits in 32 bits.
+		const s32 budgetMB = std::max(0, std::min(4095, s_editorConfig.historyBudgetMB));
+		history_setMemoryBudget(u32(budgetMB) * 1024u * 1024u);
 
 		history_registerCommand(LCmd_Sector_Snapshot, cmd_applySectorSnapshot);
 		history_registerCommand(LCmd_Sector_Wall_Snapshot, cmd_applySectorWallSnapshot);
@@ -98,6 +103,7 @@ namespace LevelEditor
 	void levHistory_createSnapshot(const char* name)
 	{
 		history_createSnapshot(name);
+		levelBvh_markEdited();
 	}
 		
 	void levHistory_undo()
@@ -135,6 +141,7 @@ namespace LevelEditor
 			hBuffer_addArrayU8(compressedSize, s_workBuffer[1].data());
 		}
 		CMD_END();
+		levelBvh_markEdited();
 	}
 
 	void cmd_objectListSnapshot(u32 name, s32 sectorId)
@@ -155,6 +162,7 @@ namespace LevelEditor
 			hBuffer_addArrayU8(compressedSize, s_workBuffer[1].data());
 		}
 		CMD_END();
+		levelBvh_markEdited();
 	}
 
 	void cmd_sectorWallSnapshot(u32 name, std::vector<IndexPair>& sectorWallIds, bool idsChanged)
@@ -186,6 +194,7 @@ namespace LevelEditor
 			hBuffer_addArrayU8(compressedSize, s_workBuffer[1].data());
 		}
 		CMD_END();
+		levelBvh_markEdited();
 	}
 
 	void cmd_sectorAttributeSnapshot(u32 name, std::vector<IndexPair>& sectorIds, bool idsChanged)
@@ -217,6 +226,7 @@ namespace LevelEditor
 			hBuffer_addArrayU8(compressedSize, s_workBuffer[1].data());
 		}
 		CMD_END();
+		levelBvh_markEdited();
 	}
 
 	void cmd_setTextures(u32 name, s32 count, FeatureId* features)
@@ -239,6 +249,7 @@ namespace LevelEditor
 			hBuffer_addArrayU8(compressedSize, s_workBuffer[1].data());
 		}
 		CMD_END();
+		levelBvh_markEdited();
 	}
 		
 	////////////////////////////////
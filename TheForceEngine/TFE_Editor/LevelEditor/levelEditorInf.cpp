@@ -1491,16 +1491,10 @@ namespace LevelEditor
 		}
 		s_infEditor.itemWallIndex = wallIndex;
 
-		const s32 count = (s32)s_level.sectors.size();
-		EditorSector* sector = s_level.sectors.data();
-		for (s32 i = 0; i < count; i++, sector++)
+		const s32 sectorId = findSectorByName(sectorName);
+		if (sectorId >= 0)
 		{
-			if (sector->name.empty()) { continue; }
-			if (strcasecmp(sectorName, sector->name.c_str()) == 0)
-			{
-				s_infEditor.sector = sector;
-				break;
-			}
+			s_infEditor.sector = &s_level.sectors[sectorId];
 		}
 
 		const s32 itemCount = (s32)s_levelInf.item.size();
@@ -0,0 +1,274 @@
+#include "levelGrid.h"
+#include "levelEditor.h"
+#include "levelEditorData.h"
+#include "sharedState.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace LevelEditor
+{
+	enum GridConstants
+	{
+		GRID_MAX_DIM = 256,
+		// Sectors covering more cells are stored in a single list instead.
+		GRID_MAX_SECTOR_CELLS = 256,
+	};
+	static const f32 c_gridMinCellSize = 1.0f;
+
+	struct LayerGrid
+	{
+		std::vector<std::vector<s32>> cells;
+		std::vector<s32> large;
+	};
+
+	struct GridEntry
+	{
+		s32 layer;
+		// Cell range, x0 < 0 if the sector is not in the grid (no vertices).
+		s32 x0, z0, x1, z1;
+		bool large;
+	};
+
+	static std::map<s32, LayerGrid> s_layerGrids;
+	static std::vector<GridEntry> s_entries;
+	static std::vector<u32> s_queryStamp;
+	static u32 s_curStamp = 0;
+	static Vec2f s_gridOrigin = { 0 };
+	static f32 s_cellScale = 1.0f;	// 1 / cell size.
+	static s32 s_gridDim[2] = { 1, 1 };
+	static bool s_rebuild = true;
+
+	static s32 getCellX(f32 x)
+	{
+		return std::max(0, std::min(s_gridDim[0] - 1, s32(floorf((x - s_gridOrigin.x) * s_cellScale))));
+	}
+
+	static s32 getCellZ(f32 z)
+	{
+		return std::max(0, std::min(s_gridDim[1] - 1, s32(floorf((z - s_gridOrigin.z) * s_cellScale))));
+	}
+
+	static LayerGrid* getLayerGrid(s32 layer)
+	{
+		LayerGrid* grid = &s_layerGrids[layer];
+		if (grid->cells.empty())
+		{
+			grid->cells.resize(s_gridDim[0] * s_gridDim[1]);
+		}
+		return grid;
+	}
+
+	static void eraseIndex(std::vector<s32>& list, s32 index)
+	{
+		for (size_t i = 0; i < list.size(); i++)
+		{
+			if (list[i] == index)
+			{
+				list[i] = list.back();
+				list.pop_back();
+				return;
+			}
+		}
+	}
+
+	static void insertSector(s32 index)
+	{
+		const EditorSector* sector = &s_level.sectors[index];
+		GridEntry* entry = &s_entries[index];
+		entry->layer = sector->layer;
+		entry->x0 = -1;
+		entry->large = false;
+		if (sector->bounds[0].x > sector->bounds[1].x || sector->bounds[0].z > sector->bounds[1].z) { return; }
+
+		entry->x0 = getCellX(sector->bounds[0].x);
+		entry->z0 = getCellZ(sector->bounds[0].z);
+		entry->x1 = getCellX(sector->bounds[1].x);
+		entry->z1 = getCellZ(sector->bounds[1].z);
+
+		LayerGrid* grid = getLayerGrid(entry->layer);
+		if ((entry->x1 - entry->x0 + 1) * (entry->z1 - entry->z0 + 1) > GRID_MAX_SECTOR_CELLS)
+		{
+			entry->large = true;
+			grid->large.push_back(index);
+			return;
+		}
+		for (s32 z = entry->z0; z <= entry->z1; z++)
+		{
+			for (s32 x = entry->x0; x <= entry->x1; x++)
+			{
+				grid->cells[z * s_gridDim[0] + x].push_back(index);
+			}
+		}
+	}
+
+	static void removeSector(s32 index)
+	{
+		const GridEntry* entry = &s_entries[index];
+		if (entry->x0 < 0) { return; }
+
+		LayerGrid* grid = getLayerGrid(entry->layer);
+		if (entry->large)
+		{
+			eraseIndex(grid->large, index);
+			return;
+		}
+		for (s32 z = entry->z0; z <= entry->z1; z++)
+		{
+			for (s32 x = entry->x0; x <= entry->x1; x++)
+			{
+				eraseIndex(grid->cells[z * s_gridDim[0] + x], index);
+			}
+		}
+	}
+
+	static void rebuildGrid()
+	{
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		s_layerGrids.clear();
+		s_entries.resize(sectorCount);
+		s_queryStamp.assign(sectorCount, 0);
+		s_curStamp = 0;
+
+		// Fit the grid to the current level, sectors added outside of it later are clamped to the edge cells.
+		Vec2f bounds[2] = { { FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX } };
+		const EditorSector* sector = s_level.sectors.data();
+		for (s32 s = 0; s < sectorCount; s++, sector++)
+		{
+			if (sector->bounds[0].x > sector->bounds[1].x || sector->bounds[0].z > sector->bounds[1].z) { continue; }
+			bounds[0].x = std::min(bounds[0].x, sector->bounds[0].x);
+			bounds[0].z = std::min(bounds[0].z, sector->bounds[0].z);
+			bounds[1].x = std::max(bounds[1].x, sector->bounds[1].x);
+			bounds[1].z = std::max(bounds[1].z, sector->bounds[1].z);
+		}
+		if (bounds[0].x > bounds[1].x)
+		{
+			bounds[0] = { 0.0f, 0.0f };
+			bounds[1] = { 0.0f, 0.0f };
+		}
+
+		// Roughly one sector per cell along each axis.
+		const f32 extent = std::max(bounds[1].x - bounds[0].x, bounds[1].z - bounds[0].z);
+		const s32 dim = std::max(1, std::min((s32)GRID_MAX_DIM, s32(ceilf(sqrtf(f32(sectorCount))))));
+		const f32 cellSize = std::max(c_gridMinCellSize, extent / f32(dim));
+		s_gridOrigin = bounds[0];
+		s_cellScale = 1.0f / cellSize;
+		s_gridDim[0] = std::max(1, std::min((s32)GRID_MAX_DIM, s32(ceilf((bounds[1].x - bounds[0].x) * s_cellScale)) + 1));
+		s_gridDim[1] = std::max(1, std::min((s32)GRID_MAX_DIM, s32(ceilf((bounds[1].z - bounds[0].z) * s_cellScale)) + 1));
+
+		for (s32 s = 0; s < sectorCount; s++)
+		{
+			insertSector(s);
+		}
+		s_rebuild = false;
+	}
+
+	static void updateGrid()
+	{
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		const s32 entryCount = (s32)s_entries.size();
+		if (s_rebuild || sectorCount < entryCount)
+		{
+			rebuildGrid();
+		}
+		else if (sectorCount > entryCount)
+		{
+			// New sectors are added to the end.
+			s_entries.resize(sectorCount);
+			s_queryStamp.resize(sectorCount, 0);
+			for (s32 s = entryCount; s < sectorCount; s++)
+			{
+				insertSector(s);
+			}
+		}
+	}
+
+	static void addCandidates(const std::vector<s32>& list, std::vector<s32>* sectors)
+	{
+		const s32 count = (s32)list.size();
+		for (s32 i = 0; i < count; i++)
+		{
+			const s32 index = list[i];
+			if (s_queryStamp[index] != s_curStamp)
+			{
+				s_queryStamp[index] = s_curStamp;
+				sectors->push_back(index);
+			}
+		}
+	}
+
+	static void getLayerSectors(const LayerGrid* grid, s32 x0, s32 z0, s32 x1, s32 z1, std::vector<s32>* sectors)
+	{
+		if (grid->cells.empty()) { return; }
+		addCandidates(grid->large, sectors);
+		for (s32 z = z0; z <= z1; z++)
+		{
+			for (s32 x = x0; x <= x1; x++)
+			{
+				addCandidates(grid->cells[z * s_gridDim[0] + x], sectors);
+			}
+		}
+	}
+
+	/////////////////////////////////////////////
+	// API
+	/////////////////////////////////////////////
+	void levelGrid_invalidate()
+	{
+		s_rebuild = true;
+	}
+
+	void levelGrid_updateSector(s32 sectorIndex)
+	{
+		// Sectors that are not in the grid yet are added on the next query.
+		if (s_rebuild || sectorIndex < 0 || sectorIndex >= (s32)s_entries.size() || sectorIndex >= (s32)s_level.sectors.size()) { return; }
+		removeSector(sectorIndex);
+		insertSector(sectorIndex);
+	}
+
+	void levelGrid_destroy()
+	{
+		s_layerGrids.clear();
+		s_entries.clear();
+		s_queryStamp.clear();
+		s_rebuild = true;
+	}
+
+	void levelGrid_getSectors(const Vec3f* bounds, f32 padding, bool activeLayers, std::vector<s32>* sectors)
+	{
+		sectors->clear();
+		updateGrid();
+		if (s_entries.empty()) { return; }
+
+		// Stamps avoid adding sectors that span several cells more than once.
+		s_curStamp++;
+		if (s_curStamp == 0)
+		{
+			std::fill(s_queryStamp.begin(), s_queryStamp.end(), 0);
+			s_curStamp = 1;
+		}
+
+		const s32 x0 = getCellX(bounds[0].x - padding);
+		const s32 z0 = getCellZ(bounds[0].z - padding);
+		const s32 x1 = getCellX(bounds[1].x + padding);
+		const s32 z1 = getCellZ(bounds[1].z + padding);
+		if (activeLayers && !(s_editFlags & LEF_SHOW_ALL_LAYERS))
+		{
+			std::map<s32, LayerGrid>::const_iterator iLayer = s_layerGrids.find(s_curLayer);
+			if (iLayer != s_layerGrids.end())
+			{
+				getLayerSectors(&iLayer->second, x0, z0, x1, z1, sectors);
+			}
+		}
+		else
+		{
+			std::map<s32, LayerGrid>::const_iterator iLayer = s_layerGrids.begin();
+			for (; iLayer != s_layerGrids.end(); ++iLayer)
+			{
+				getLayerSectors(&iLayer->second, x0, z0, x1, z1, sectors);
+			}
+		}
+		// Keep the same order as a linear search.
+		std::sort(sectors->begin(), sectors->end());
+	}
+}
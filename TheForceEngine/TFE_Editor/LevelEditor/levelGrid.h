@@ -0,0 +1,31 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine Editor
+// A system built to view and edit Dark Forces data files.
+// The viewing aspect needs to be put in place at the beginning
+// in order to properly test elements in isolation without having
+// to "play" the game as intended.
+//////////////////////////////////////////////////////////////////////
+// Uniform grid per layer over the 2D (XZ) sector bounds, used to find
+// the sectors near a point or rectangle without testing every sector.
+//
+// The grid is kept in sync by sectorToPolygon() and layer changes
+// through levelGrid_updateSector(); sectors added to the end of the
+// list are picked up automatically. Loading, undo and sector deletion
+// call levelGrid_invalidate() and the grid is rebuilt lazily.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <vector>
+
+namespace LevelEditor
+{
+	// Rebuild the grid on the next query.
+	void levelGrid_invalidate();
+	// The sector bounds or layer changed.
+	void levelGrid_updateSector(s32 sectorIndex);
+	void levelGrid_destroy();
+
+	// Get the indices of the sectors whose XZ bounds may overlap the rectangle (bounds[0].xz - bounds[1].xz) expanded by padding,
+	// in increasing order. If 'activeLayers' is true, only sectors on the active layer(s) are returned.
+	void levelGrid_getSectors(const Vec3f* bounds, f32 padding, bool activeLayers, std::vector<s32>* sectors);
+}
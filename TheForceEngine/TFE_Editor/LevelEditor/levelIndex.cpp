@@ -0,0 +1,301 @@
+#include "levelIndex.h"
+#include "levelEditorData.h"
+#include "sharedState.h"
+#include <TFE_Polygon/polygon.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+namespace LevelEditor
+{
+	// Cells match the vtxEqual() tolerance, so matching vertices are at most one cell apart.
+	static const f32 c_vtxCellSize = 1e-3f;
+
+	typedef std::unordered_map<std::string, std::vector<s32>> NameMap;
+	typedef std::unordered_map<u64, std::vector<LevelWallRef>> WallMap;
+
+	struct IndexedSector
+	{
+		std::string name;			// Lowercase name or empty.
+		std::vector<u64> wallKeys;	// Cell key of each indexed wall.
+		bool dirty;
+	};
+
+	static NameMap s_nameMap;
+	static WallMap s_wallMap;
+	static std::vector<IndexedSector> s_indexed;
+	static std::vector<s32> s_dirtyList;
+	static bool s_rebuild = true;
+
+	static s32 getCell(f32 x)
+	{
+		return s32(floorf(x / c_vtxCellSize));
+	}
+
+	static u64 getCellKey(s32 x, s32 z)
+	{
+		return (u64(u32(x)) << 32ull) | u64(u32(z));
+	}
+
+	static void toLowerName(const std::string& src, std::string& dst)
+	{
+		dst = src;
+		const size_t len = dst.length();
+		for (size_t i = 0; i < len; i++)
+		{
+			dst[i] = (char)tolower((u8)dst[i]);
+		}
+	}
+
+	static void eraseSectorId(std::vector<s32>& list, s32 index)
+	{
+		for (size_t i = 0; i < list.size(); i++)
+		{
+			if (list[i] == index)
+			{
+				list[i] = list.back();
+				list.pop_back();
+				return;
+			}
+		}
+	}
+
+	static void eraseWallRef(std::vector<LevelWallRef>& list, s32 sectorId, s32 wallIndex)
+	{
+		for (size_t i = 0; i < list.size(); i++)
+		{
+			if (list[i].sectorId == sectorId && list[i].wallIndex == wallIndex)
+			{
+				list[i] = list.back();
+				list.pop_back();
+				return;
+			}
+		}
+	}
+
+	static void removeName(s32 index)
+	{
+		IndexedSector* indexed = &s_indexed[index];
+		if (indexed->name.empty()) { return; }
+
+		NameMap::iterator iName = s_nameMap.find(indexed->name);
+		if (iName != s_nameMap.end())
+		{
+			eraseSectorId(iName->second, index);
+			if (iName->second.empty()) { s_nameMap.erase(iName); }
+		}
+		indexed->name.clear();
+	}
+
+	static void insertName(s32 index)
+	{
+		IndexedSector* indexed = &s_indexed[index];
+		const EditorSector* sector = &s_level.sectors[index];
+		if (sector->name.empty()) { return; }
+
+		toLowerName(sector->name, indexed->name);
+		s_nameMap[indexed->name].push_back(index);
+	}
+
+	static void removeWalls(s32 index)
+	{
+		IndexedSector* indexed = &s_indexed[index];
+		const s32 wallCount = (s32)indexed->wallKeys.size();
+		for (s32 w = 0; w < wallCount; w++)
+		{
+			WallMap::iterator iCell = s_wallMap.find(indexed->wallKeys[w]);
+			if (iCell == s_wallMap.end()) { continue; }
+
+			eraseWallRef(iCell->second, index, w);
+			if (iCell->second.empty()) { s_wallMap.erase(iCell); }
+		}
+		indexed->wallKeys.clear();
+	}
+
+	static void insertWalls(s32 index)
+	{
+		IndexedSector* indexed = &s_indexed[index];
+		const EditorSector* sector = &s_level.sectors[index];
+		const s32 wallCount = (s32)sector->walls.size();
+		const s32 vtxCount = (s32)sector->vtx.size();
+		const EditorWall* wall = sector->walls.data();
+
+		indexed->wallKeys.resize(wallCount);
+		for (s32 w = 0; w < wallCount; w++, wall++)
+		{
+			if (wall->idx[0] < 0 || wall->idx[0] >= vtxCount)
+			{
+				// Keep the key list in sync with the walls, the key is never looked up.
+				indexed->wallKeys[w] = ~0ull;
+				continue;
+			}
+			const Vec2f* v0 = &sector->vtx[wall->idx[0]];
+			const u64 key = getCellKey(getCell(v0->x), getCell(v0->z));
+			indexed->wallKeys[w] = key;
+			s_wallMap[key].push_back({ index, w });
+		}
+	}
+
+	static void insertSector(s32 index)
+	{
+		s_indexed[index].dirty = false;
+		insertName(index);
+		insertWalls(index);
+	}
+
+	static void rebuildIndex()
+	{
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		s_nameMap.clear();
+		s_wallMap.clear();
+		s_dirtyList.clear();
+		s_indexed.clear();
+		s_indexed.resize(sectorCount);
+		for (s32 s = 0; s < sectorCount; s++)
+		{
+			insertSector(s);
+		}
+		s_rebuild = false;
+	}
+
+	static void updateIndex()
+	{
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		const s32 indexedCount = (s32)s_indexed.size();
+		if (s_rebuild || sectorCount < indexedCount)
+		{
+			rebuildIndex();
+			return;
+		}
+		if (sectorCount > indexedCount)
+		{
+			// New sectors are added to the end.
+			s_indexed.resize(sectorCount);
+			for (s32 s = indexedCount; s < sectorCount; s++)
+			{
+				insertSector(s);
+			}
+		}
+
+		const s32 dirtyCount = (s32)s_dirtyList.size();
+		for (s32 i = 0; i < dirtyCount; i++)
+		{
+			const s32 index = s_dirtyList[i];
+			if (!s_indexed[index].dirty) { continue; }
+
+			removeName(index);
+			removeWalls(index);
+			insertSector(index);
+		}
+		s_dirtyList.clear();
+	}
+
+	static bool sortWallRef(const LevelWallRef& a, const LevelWallRef& b)
+	{
+		return a.sectorId < b.sectorId || (a.sectorId == b.sectorId && a.wallIndex < b.wallIndex);
+	}
+
+	/////////////////////////////////////////////
+	// API
+	/////////////////////////////////////////////
+	void levelIndex_invalidate()
+	{
+		s_rebuild = true;
+	}
+
+	void levelIndex_markSectorDirty(s32 sectorIndex)
+	{
+		// Sectors that are not in the index yet are added on the next query.
+		if (s_rebuild || sectorIndex < 0 || sectorIndex >= (s32)s_indexed.size()) { return; }
+		if (!s_indexed[sectorIndex].dirty)
+		{
+			s_indexed[sectorIndex].dirty = true;
+			s_dirtyList.push_back(sectorIndex);
+		}
+	}
+
+	void levelIndex_updateSectorName(s32 sectorIndex)
+	{
+		if (s_rebuild || sectorIndex < 0 || sectorIndex >= (s32)s_indexed.size() || sectorIndex >= (s32)s_level.sectors.size()) { return; }
+		removeName(sectorIndex);
+		insertName(sectorIndex);
+	}
+
+	void levelIndex_destroy()
+	{
+		s_nameMap.clear();
+		s_wallMap.clear();
+		s_indexed.clear();
+		s_dirtyList.clear();
+		s_rebuild = true;
+	}
+
+	s32 levelIndex_findSectorByName(const char* name, s32 excludeId)
+	{
+		if (!name || name[0] == 0) { return -1; }
+		updateIndex();
+
+		std::string key;
+		toLowerName(name, key);
+		NameMap::const_iterator iName = s_nameMap.find(key);
+		if (iName == s_nameMap.end()) { return -1; }
+
+		// Return the first match in level order, same as a linear search.
+		s32 foundIndex = -1;
+		const s32 count = (s32)iName->second.size();
+		const s32* list = iName->second.data();
+		for (s32 i = 0; i < count; i++)
+		{
+			const s32 index = list[i];
+			if (index == excludeId || (foundIndex >= 0 && index > foundIndex)) { continue; }
+			if (strcasecmp(name, s_level.sectors[index].name.c_str()) == 0)
+			{
+				foundIndex = index;
+			}
+		}
+		return foundIndex;
+	}
+
+	void levelIndex_getMirrorWalls(const Vec2f* v0, const Vec2f* v1, std::vector<LevelWallRef>* walls)
+	{
+		walls->clear();
+		updateIndex();
+		if (s_wallMap.empty()) { return; }
+
+		// The mirror wall starts at v1, so search the cells around it.
+		const s32 sectorCount = (s32)s_level.sectors.size();
+		const s32 cx = getCell(v1->x);
+		const s32 cz = getCell(v1->z);
+		for (s32 z = cz - 1; z <= cz + 1; z++)
+		{
+			for (s32 x = cx - 1; x <= cx + 1; x++)
+			{
+				WallMap::const_iterator iCell = s_wallMap.find(getCellKey(x, z));
+				if (iCell == s_wallMap.end()) { continue; }
+
+				const s32 count = (s32)iCell->second.size();
+				const LevelWallRef* ref = iCell->second.data();
+				for (s32 i = 0; i < count; i++, ref++)
+				{
+					if (ref->sectorId >= sectorCount) { continue; }
+					const EditorSector* sector = &s_level.sectors[ref->sectorId];
+					if (ref->wallIndex >= (s32)sector->walls.size()) { continue; }
+
+					const EditorWall* wall = &sector->walls[ref->wallIndex];
+					const s32 vtxCount = (s32)sector->vtx.size();
+					if (wall->idx[0] < 0 || wall->idx[0] >= vtxCount || wall->idx[1] < 0 || wall->idx[1] >= vtxCount) { continue; }
+					const Vec2f* w0 = &sector->vtx[wall->idx[0]];
+					const Vec2f* w1 = &sector->vtx[wall->idx[1]];
+					if (TFE_Polygon::vtxEqual(w0, v1) && TFE_Polygon::vtxEqual(w1, v0))
+					{
+						walls->push_back(*ref);
+					}
+				}
+			}
+		}
+		std::sort(walls->begin(), walls->end(), sortWallRef);
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine Editor
+// A system built to view and edit Dark Forces data files.
+// The viewing aspect needs to be put in place at the beginning
+// in order to properly test elements in isolation without having
+// to "play" the game as intended.
+//////////////////////////////////////////////////////////////////////
+// Sector name and wall adjacency indices.
+//
+// Names are mapped case-insensitively to the sectors that use them and
+// walls are hashed by their first vertex, so that name lookups and
+// adjoin matching do not have to walk every sector in the level.
+//
+// sectorToPolygon() marks sectors dirty, renames go through
+// levelIndex_updateSectorName() and sectors added to the end of the
+// list are picked up automatically. Loading, undo and sector deletion
+// call levelIndex_invalidate() and the indices are rebuilt lazily.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <vector>
+
+namespace LevelEditor
+{
+	struct LevelWallRef
+	{
+		s32 sectorId;
+		s32 wallIndex;
+	};
+
+	// Rebuild the indices on the next query.
+	void levelIndex_invalidate();
+	// The sector walls or vertices changed.
+	void levelIndex_markSectorDirty(s32 sectorIndex);
+	// The sector name changed.
+	void levelIndex_updateSectorName(s32 sectorIndex);
+	void levelIndex_destroy();
+
+	// Returns the lowest index of the sector named 'name' (case-insensitive), ignoring 'excludeId', or -1.
+	s32 levelIndex_findSectorByName(const char* name, s32 excludeId);
+	// Get the walls going from v1 to v0 (the mirror of the wall v0 -> v1) within vtxEqual() tolerance,
+	// sorted by sector and wall index.
+	void levelIndex_getMirrorWalls(const Vec2f* v0, const Vec2f* v1, std::vector<LevelWallRef>* walls);
+}
@@ -5,23 +5,49 @@
 #include "selection.h"
 #include "sharedState.h"
 #include "infoPanel.h"
+#include <unordered_map>
 
 using namespace TFE_Editor;
 
 namespace LevelEditor
 {
-	SelectionList s_selectionList2[SEL_COUNT];
-	SelectionList s_savedSelections[SEL_GEO_COUNT];
+	// Selection list with constant time membership, insert and remove.
+	// The list keeps the insertion order for the UI, removed entries are flagged and compacted
+	// before the list is read by index.
+	struct SelectionSet
+	{
+		SelectionSet(FeatureId keyMask = FID_COMPARE_MASK) : mask(keyMask) {}
+
+		SelectionList list;
+		std::vector<u8> removed;
+		std::unordered_map<FeatureId, s32> index;	// (id & mask) -> list index.
+		std::vector<u32> sectorCount;				// Selected features per sector, so most sectors are rejected without a lookup.
+		FeatureId mask;
+		s32 removedCount = 0;
+	};
+	// Vertices are compared without the feature data (floor or ceiling).
+	SelectionSet s_selectionList2[SEL_COUNT] = { SelectionSet(FID_COMPARE_MASK_NO_DATA) };
+	SelectionSet s_savedSelections[SEL_GEO_COUNT] = { SelectionSet(FID_COMPARE_MASK_NO_DATA) };
 	SelectionListId s_currentSelection = SEL_VERTEX;
 	FeatureId s_hovered = FEATUREID_NULL;
 	bool s_derivedBuildNeeded = false;
 
+	// Selected vertices by position, used to find overlapping vertices.
+	// Vertex positions are only valid until the geometry changes, so it is rebuilt on demand afterward.
+	static const f32 c_vertexCellSize = 1e-3f;	// Matches the TFE_Polygon::vtxEqual() tolerance.
+	static std::unordered_map<u64, std::vector<FeatureId>> s_vertexCells;
+	static std::vector<FeatureId> s_vertexMatches;
+	static bool s_vertexCellsValid = false;
+
 	bool selection_insertVertex(FeatureId id, Vec2f value, EditorSector* root = nullptr, HitPart part = HP_FLOOR);
 	bool selection_removeVertex(FeatureId id, Vec2f value);
 	bool selection_isVertexInSet(FeatureId id);
-	bool selection_insertFeatureId(SelectionList& list, FeatureId id);
-	bool selection_removeFeatureId(SelectionList& list, FeatureId id);
-	bool selection_isFeatureIdInSet(SelectionList& list, FeatureId id, s32* index = nullptr);
+	bool selection_insertFeatureId(SelectionSet& set, FeatureId id);
+	bool selection_removeFeatureId(SelectionSet& set, FeatureId id);
+	bool selection_isFeatureIdInSet(SelectionSet& set, FeatureId id, s32* index = nullptr);
+	void selection_clearSet(SelectionSet& set);
+	void selection_compactSet(SelectionSet& set);
+	u32  selection_getSetCount(const SelectionSet& set);
 	bool selection_featureId(SelectAction action, FeatureId id);
 	void selection_buildDerived();
 	void selection_derivedBuildNeeded();
@@ -34,7 +60,7 @@ namespace LevelEditor
 		{
 			if ((1 << i) & selections)
 			{
-				s_selectionList2[i].clear();
+				selection_clearSet(s_selectionList2[i]);
 			}
 		}
 		if (clearDragSelect)
@@ -66,7 +92,7 @@ namespace LevelEditor
 
 	bool selection_hasSelection(SelectionListId id)
 	{
-		return !s_selectionList2[id >= SEL_CURRENT ? s_currentSelection : id].empty();
+		return selection_getSetCount(s_selectionList2[id >= SEL_CURRENT ? s_currentSelection : id]) > 0;
 	}
 
 	void selection_saveGeoSelections()
@@ -82,8 +108,9 @@ namespace LevelEditor
 		for (s32 i = 0; i < SEL_GEO_COUNT; i++)
 		{
 			s_selectionList2[i] = s_savedSelections[i];
-			s_savedSelections[i].clear();
+			selection_clearSet(s_savedSelections[i]);
 		}
+		s_vertexCellsValid = false;
 	}
 		
 	// Selection interface.
@@ -98,7 +125,7 @@ namespace LevelEditor
 		{
 			case SA_SET:
 			{
-				s_selectionList2[SEL_VERTEX].clear();
+				selection_clearSet(s_selectionList2[SEL_VERTEX]);
 				actionDone = selection_insertVertex(id, sector->vtx[index], sector, part);
 				buildDerived = actionDone;
 				infoPanel_clearSelection();
@@ -190,7 +217,7 @@ namespace LevelEditor
 	u32 selection_getCount(SelectionListId id)
 	{
 		if (id != SEL_CURRENT && id != s_currentSelection) { selection_buildDerived(); }
-		return (u32)s_selectionList2[id >= SEL_CURRENT ? s_currentSelection : id].size();
+		return selection_getSetCount(s_selectionList2[id >= SEL_CURRENT ? s_currentSelection : id]);
 	}
 		
 	bool selection_getVertex(s32 index, EditorSector*& sector, s32& featureIndex, HitPart* part, bool* isOverlapped)
@@ -335,9 +362,10 @@ namespace LevelEditor
 	u32 selection_getList(FeatureId*& list, SelectionListId id)
 	{
 		if (id != SEL_CURRENT && id != s_currentSelection) { selection_buildDerived(); }
-		SelectionList& selList = s_selectionList2[id >= SEL_CURRENT ? s_currentSelection : id];
-		u32 count = (u32)selList.size();
-		list = count > 0 ? selList.data() : nullptr;
+		SelectionSet& set = s_selectionList2[id >= SEL_CURRENT ? s_currentSelection : id];
+		selection_compactSet(set);
+		u32 count = (u32)set.list.size();
+		list = count > 0 ? set.list.data() : nullptr;
 		return count;
 	}
 		
@@ -398,29 +426,191 @@ namespace LevelEditor
 	////////////////////////////////////////////////////////////
 	// Internal
 	////////////////////////////////////////////////////////////
-	bool selection_insertVertex(FeatureId id, Vec2f value, EditorSector* root/*=nullptr*/, HitPart part/*=HP_FLOOR*/)
+	u32 selection_getSetSector(FeatureId id)
 	{
-		// Insert the vertex if not found.
-		const s32 count = (s32)s_selectionList2[SEL_VERTEX].size();
-		const FeatureId* featureId = s_selectionList2[SEL_VERTEX].data();
-		s32 matchId = -1;
+		return u32(id & FID_SECTOR_MASK);
+	}
+
+	void selection_clearSet(SelectionSet& set)
+	{
+		set.list.clear();
+		set.removed.clear();
+		set.index.clear();
+		set.sectorCount.clear();
+		set.removedCount = 0;
+		if (&set == &s_selectionList2[SEL_VERTEX])
+		{
+			s_vertexCells.clear();
+			s_vertexCellsValid = true;
+		}
+	}
+
+	u32 selection_getSetCount(const SelectionSet& set)
+	{
+		return u32(set.list.size()) - u32(set.removedCount);
+	}
+
+	// Remove the flagged entries, keeping the order of the rest.
+	void selection_compactSet(SelectionSet& set)
+	{
+		if (!set.removedCount) { return; }
+
+		const s32 count = (s32)set.list.size();
+		s32 outIndex = 0;
 		for (s32 i = 0; i < count; i++)
 		{
-			if (featuresEqualNoData(featureId[i], id)) { return false; }
+			if (set.removed[i]) { continue; }
+			if (outIndex != i)
+			{
+				set.list[outIndex] = set.list[i];
+				set.index[set.list[outIndex] & set.mask] = outIndex;
+			}
+			outIndex++;
+		}
+		set.list.resize(outIndex);
+		set.removed.assign(outIndex, 0);
+		set.removedCount = 0;
+	}
 
-			s32 index;
-			EditorSector* sector = unpackFeatureId(featureId[i], &index);
-			const Vec2f& srcValue = sector->vtx[index];
+	void selection_addToSet(SelectionSet& set, FeatureId id)
+	{
+		set.index[id & set.mask] = (s32)set.list.size();
+		set.list.push_back(id);
+		set.removed.push_back(0);
+
+		const u32 sectorId = selection_getSetSector(id);
+		if (sectorId < (u32)s_level.sectors.size())
+		{
+			if (sectorId >= (u32)set.sectorCount.size()) { set.sectorCount.resize(sectorId + 1, 0); }
+			set.sectorCount[sectorId]++;
+		}
+	}
 
-			if (TFE_Polygon::vtxEqual(&value, &srcValue))
+	void selection_removeFromSet(SelectionSet& set, s32 index)
+	{
+		const FeatureId id = set.list[index];
+		set.index.erase(id & set.mask);
+		set.removed[index] = 1;
+		set.removedCount++;
+
+		const u32 sectorId = selection_getSetSector(id);
+		if (sectorId < (u32)set.sectorCount.size() && set.sectorCount[sectorId])
+		{
+			set.sectorCount[sectorId]--;
+		}
+		// Compact once most of the list has been removed, so removing many features stays linear.
+		if (set.removedCount > 32 && set.removedCount * 2 > (s32)set.list.size())
+		{
+			selection_compactSet(set);
+		}
+	}
+
+	u64 selection_getVertexCell(s32 x, s32 z)
+	{
+		return (u64(u32(x)) << 32ull) | u64(u32(z));
+	}
+
+	bool selection_getVertexPos(FeatureId id, Vec2f* pos)
+	{
+		s32 index;
+		EditorSector* sector = unpackFeatureId(id, &index);
+		if (!sector || index < 0 || index >= (s32)sector->vtx.size()) { return false; }
+		*pos = sector->vtx[index];
+		return true;
+	}
+
+	void selection_addVertexCell(FeatureId id)
+	{
+		Vec2f pos;
+		if (!s_vertexCellsValid || !selection_getVertexPos(id, &pos)) { return; }
+		const s32 x = s32(floorf(pos.x / c_vertexCellSize));
+		const s32 z = s32(floorf(pos.z / c_vertexCellSize));
+		s_vertexCells[selection_getVertexCell(x, z)].push_back(id);
+	}
+
+	void selection_removeVertexCell(FeatureId id)
+	{
+		Vec2f pos;
+		if (!s_vertexCellsValid || !selection_getVertexPos(id, &pos)) { return; }
+		const s32 x = s32(floorf(pos.x / c_vertexCellSize));
+		const s32 z = s32(floorf(pos.z / c_vertexCellSize));
+		std::unordered_map<u64, std::vector<FeatureId>>::iterator iCell = s_vertexCells.find(selection_getVertexCell(x, z));
+		if (iCell == s_vertexCells.end()) { return; }
+
+		std::vector<FeatureId>& cell = iCell->second;
+		const size_t count = cell.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			if (cell[i] == id)
 			{
-				// Keep looking after this, the feature may still be in here...
-				matchId = i;
+				cell[i] = cell.back();
+				cell.pop_back();
+				break;
 			}
 		}
+		if (cell.empty()) { s_vertexCells.erase(iCell); }
+	}
 
-		id = setIsOverlapped(id, matchId >= 0);
-		s_selectionList2[SEL_VERTEX].push_back(id);
+	void selection_buildVertexCells()
+	{
+		if (s_vertexCellsValid) { return; }
+		s_vertexCellsValid = true;
+		s_vertexCells.clear();
+
+		const SelectionSet& set = s_selectionList2[SEL_VERTEX];
+		const s32 count = (s32)set.list.size();
+		for (s32 i = 0; i < count; i++)
+		{
+			if (!set.removed[i]) { selection_addVertexCell(set.list[i]); }
+		}
+	}
+
+	// Get the selected vertices at 'value', in no particular order.
+	void selection_getVerticesAtPos(Vec2f value, std::vector<FeatureId>& matches)
+	{
+		selection_buildVertexCells();
+		matches.clear();
+
+		// Vertices within the tolerance are at most one cell away.
+		const s32 x0 = s32(floorf(value.x / c_vertexCellSize));
+		const s32 z0 = s32(floorf(value.z / c_vertexCellSize));
+		for (s32 z = z0 - 1; z <= z0 + 1; z++)
+		{
+			for (s32 x = x0 - 1; x <= x0 + 1; x++)
+			{
+				std::unordered_map<u64, std::vector<FeatureId>>::const_iterator iCell = s_vertexCells.find(selection_getVertexCell(x, z));
+				if (iCell == s_vertexCells.end()) { continue; }
+
+				const size_t count = iCell->second.size();
+				const FeatureId* cellId = iCell->second.data();
+				for (size_t i = 0; i < count; i++)
+				{
+					Vec2f pos;
+					if (selection_getVertexPos(cellId[i], &pos) && TFE_Polygon::vtxEqual(&value, &pos))
+					{
+						matches.push_back(cellId[i]);
+					}
+				}
+			}
+		}
+	}
+
+	void selection_geometryChanged()
+	{
+		s_vertexCellsValid = false;
+	}
+
+	bool selection_insertVertex(FeatureId id, Vec2f value, EditorSector* root/*=nullptr*/, HitPart part/*=HP_FLOOR*/)
+	{
+		// Insert the vertex if not found.
+		SelectionSet& set = s_selectionList2[SEL_VERTEX];
+		if (selection_isFeatureIdInSet(set, id)) { return false; }
+
+		// The vertex is overlapped if another selected vertex is at the same position.
+		selection_getVerticesAtPos(value, s_vertexMatches);
+		id = setIsOverlapped(id, !s_vertexMatches.empty());
+		selection_addToSet(set, id);
+		selection_addVertexCell(id);
 
 		// If root is non-null, then start from this sector and include potential overlaps from other sectors.
 		if (root)
@@ -495,80 +685,60 @@ namespace LevelEditor
 	// Remove all vertices in the list at 'value'.
 	bool selection_removeVertex(FeatureId id, Vec2f value)
 	{
-		const s32 count = (s32)s_selectionList2[SEL_VERTEX].size();
-		const FeatureId* featureId = s_selectionList2[SEL_VERTEX].data();
-		std::vector<s32> idxToRemove;
+		SelectionSet& set = s_selectionList2[SEL_VERTEX];
+		selection_getVerticesAtPos(value, s_vertexMatches);
+		s_vertexMatches.push_back(id);
+
+		bool removed = false;
+		const s32 count = (s32)s_vertexMatches.size();
 		for (s32 i = 0; i < count; i++)
 		{
-			if (featuresEqualNoData(featureId[i], id))
-			{
-				idxToRemove.push_back(i);
-			}
-			else
-			{
-				s32 index;
-				EditorSector* sector = unpackFeatureId(featureId[i], &index);
-				const Vec2f& srcValue = sector->vtx[index];
+			s32 index;
+			if (!selection_isFeatureIdInSet(set, s_vertexMatches[i], &index)) { continue; }
 
-				if (TFE_Polygon::vtxEqual(&value, &srcValue))
-				{
-					idxToRemove.push_back(i);
-				}
-			}
-		}
-		if (idxToRemove.empty()) { return false; }
-		const s32 delCount = (s32)idxToRemove.size();
-		const s32* idxList = idxToRemove.data();
-		for (s32 i = delCount - 1; i >= 0; i--)
-		{
-			s_selectionList2[SEL_VERTEX].erase(s_selectionList2[SEL_VERTEX].begin() + idxList[i]);
+			selection_removeVertexCell(set.list[index]);
+			selection_removeFromSet(set, index);
+			removed = true;
 		}
-		return true;
+		return removed;
 	}
 
 	bool selection_isVertexInSet(FeatureId id)
 	{
-		// Insert the vertex if not found.
-		const s32 count = (s32)s_selectionList2[SEL_VERTEX].size();
-		const FeatureId* featureId = s_selectionList2[SEL_VERTEX].data();
-		for (s32 i = 0; i < count; i++)
-		{
-			if (featuresEqualNoData(featureId[i], id)) { return true; }
-		}
-		return false;
+		return selection_isFeatureIdInSet(s_selectionList2[SEL_VERTEX], id);
 	}
-		
-	bool selection_insertFeatureId(SelectionList& list, FeatureId id)
+
+	bool selection_insertFeatureId(SelectionSet& set, FeatureId id)
 	{
-		if (selection_isFeatureIdInSet(list, id)) { return false; }
-		list.push_back(id);
+		if (selection_isFeatureIdInSet(set, id)) { return false; }
+		selection_addToSet(set, id);
 		return true;
 	}
 
-	bool selection_removeFeatureId(SelectionList& list, FeatureId id)
+	bool selection_removeFeatureId(SelectionSet& set, FeatureId id)
 	{
 		s32 index;
-		selection_isFeatureIdInSet(list, id, &index);
-		if (index < 0) { return false; }
+		if (!selection_isFeatureIdInSet(set, id, &index)) { return false; }
 
-		list.erase(list.begin() + index);
+		selection_removeFromSet(set, index);
 		return true;
 	}
 
-	bool selection_isFeatureIdInSet(SelectionList& list, FeatureId id, s32* index)
+	bool selection_isFeatureIdInSet(SelectionSet& set, FeatureId id, s32* index)
 	{
-		const s32 count = (s32)list.size();
-		const FeatureId* listId = list.data();
 		if (index) { *index = -1; }
-		for (s32 i = 0; i < count; i++)
+
+		// Most sectors have nothing selected.
+		const u32 sectorId = selection_getSetSector(id);
+		if (sectorId < (u32)s_level.sectors.size() && (sectorId >= (u32)set.sectorCount.size() || !set.sectorCount[sectorId]))
 		{
-			if (featuresEqual(listId[i], id))
-			{
-				if (index) { *index = i; }
-				return true;
-			}
+			return false;
 		}
-		return false;
+
+		std::unordered_map<FeatureId, s32>::const_iterator iFeature = set.index.find(id & set.mask);
+		if (iFeature == set.index.end()) { return false; }
+		if (index) { *index = iFeature->second; }
+		return true;
 	}
 
 	bool selection_featureId(SelectAction action, FeatureId id)
@@ -579,7 +749,7 @@ namespace LevelEditor
 		{
 			case SA_SET:
 			{
-				s_selectionList2[s_currentSelection].clear();
+				selection_clearSet(s_selectionList2[s_currentSelection]);
 				actionDone = selection_insertFeatureId(s_selectionList2[s_currentSelection], id);
 				buildDerived = actionDone;
 				infoPanel_clearSelection();
@@ -635,9 +805,10 @@ namespace LevelEditor
 		{
 			id = s_hovered;
 		}
-		else if (index >= 0 && index < (s32)s_selectionList2[listId].size())
+		else if (index >= 0 && index < (s32)selection_getSetCount(s_selectionList2[listId]))
 		{
-			id = s_selectionList2[listId][index];
+			selection_compactSet(s_selectionList2[listId]);
+			id = s_selectionList2[listId].list[index];
 		}
 		return id;
 	}
@@ -657,9 +828,9 @@ namespace LevelEditor
 			return;
 		}
 		// Clear any geometry selection that does not match the current selection.
-		if (s_currentSelection != SEL_VERTEX) { s_selectionList2[SEL_VERTEX].clear(); }
-		if (s_currentSelection != SEL_SURFACE) { s_selectionList2[SEL_SURFACE].clear(); }
-		if (s_currentSelection != SEL_SECTOR) { s_selectionList2[SEL_SECTOR].clear(); }
+		if (s_currentSelection != SEL_VERTEX) { selection_clearSet(s_selectionList2[SEL_VERTEX]); }
+		if (s_currentSelection != SEL_SURFACE) { selection_clearSet(s_selectionList2[SEL_SURFACE]); }
+		if (s_currentSelection != SEL_SECTOR) { selection_clearSet(s_selectionList2[SEL_SECTOR]); }
 
 		s_derivedBuildNeeded = true;
 	}
@@ -683,8 +854,9 @@ namespace LevelEditor
 		else if (s_currentSelection == SEL_SURFACE)
 		{
 			// Surfaces select vertices.
-			const s32 count = (s32)s_selectionList2[SEL_SURFACE].size();
-			const FeatureId* list = s_selectionList2[SEL_SURFACE].data();
+			selection_compactSet(s_selectionList2[SEL_SURFACE]);
+			const s32 count = (s32)s_selectionList2[SEL_SURFACE].list.size();
+			const FeatureId* list = s_selectionList2[SEL_SURFACE].list.data();
 			for (s32 i = 0; i < count; i++)
 			{
 				s32 featureIndex;
@@ -712,8 +884,9 @@ namespace LevelEditor
 		else if (s_currentSelection == SEL_SECTOR)
 		{
 			// Sectors select surfaces and vertices.
-			const s32 count = (s32)s_selectionList2[SEL_SECTOR].size();
-			const FeatureId* list = s_selectionList2[SEL_SECTOR].data();
+			selection_compactSet(s_selectionList2[SEL_SECTOR]);
+			const s32 count = (s32)s_selectionList2[SEL_SECTOR].list.size();
+			const FeatureId* list = s_selectionList2[SEL_SECTOR].list.data();
 			for (s32 i = 0; i < count; i++)
 			{
 				EditorSector* sector = unpackFeatureId(list[i]);
@@ -71,6 +71,8 @@ namespace LevelEditor
 	// Save and restore
 	void selection_saveGeoSelections();
 	void selection_restoreGeoSelections();
+	// Call when vertex positions change.
+	void selection_geometryChanged();
 
 	// Selection interface.
 	bool selection_vertex(SelectAction action, EditorSector* sector, s32 index, HitPart part = HP_FLOOR, u32 flags = SEL_FLAG_INCLUDE_OVERLAPPING);
@@ -114,6 +114,7 @@ namespace TFE_Editor
 		// Level Editor
 		TFE_IniParser::writeKeyValue_Int(configFile, "Interface_Flags", s_editorConfig.interfaceFlags);
 		TFE_IniParser::writeKeyValue_Float(configFile, "Curve_SegmentSize", s_editorConfig.curve_segmentSize);
+		TFE_IniParser::writeKeyValue_Int(configFile, "History_BudgetMB", s_editorConfig.historyBudgetMB);
 
 		// Recent files.
 		std::vector<RecentProject>* recentProjects = getRecentProjects();
@@ -278,6 +279,10 @@ namespace TFE_Editor
 		{
 			s_editorConfig.curve_segmentSize = TFE_IniParser::parseFloat(value);
 		}
+		else if (strcasecmp(key, "History_BudgetMB") == 0)
+		{
+			s_editorConfig.historyBudgetMB = TFE_IniParser::parseInt(value);
+		}
 		else if (strncasecmp(key, "Recent", strlen("Recent")) == 0)
 		{
 			addToRecents(value);
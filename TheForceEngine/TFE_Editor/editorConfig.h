@@ -23,6 +23,7 @@ namespace TFE_Editor
 		// Level editor
 		s32 interfaceFlags = 0;
 		f32 curve_segmentSize = 2.0f;
+		s32 historyBudgetMB = 256;	// Undo history memory budget, 0 = unlimited.
 	};
 	enum EditorFontConst
 	{
@@ -12,13 +12,22 @@ namespace TFE_Editor
 	enum
 	{
 		CMD_MAX_DEPTH = 64,
+		// Snapshots are stored as deltas against the previous snapshot, with a full keyframe every N snapshots.
+		SNAPSHOT_KEYFRAME_INTERVAL = 16,
+		DELTA_BLOCK_SIZE = 32,
+		DELTA_MIN_COPY = 16,
 	};
+	static const u32 c_deltaInvalidOffset = 0xffffffff;
+	static const u32 c_defaultMemoryBudget = 256u * 1024u * 1024u;
 
 	struct Snapshot
 	{
 		std::string name;
 		u32 uncompressedSize;
 		u32 compressedSize; // if zero, then uncompressed.
+		u32 deltaSize;      // uncompressed size of the delta against the previous snapshot, zero for keyframes.
+		u32 chainLength;    // number of deltas since the last keyframe.
+		f64 createTime;     // time to create and encode the snapshot, in seconds.
 		std::vector<u8> compressedData;
 	};
 
@@ -45,6 +54,25 @@ namespace TFE_Editor
 	u32 s_curBufferAddr = 0;
 	u32 s_curSnapshot = 0;
 
+	// The newest snapshot, used as the base of the next delta.
+	static std::vector<u8> s_baseData;
+	static s32 s_baseId = -1;
+	// The last snapshot reconstructed from the deltas, so stepping through the history only applies new deltas.
+	static std::vector<u8> s_decodedData;
+	static s32 s_decodedId = -1;
+	static std::vector<u8> s_decodeTemp;
+	static std::vector<u8> s_deltaBuffer;
+	static std::vector<u32> s_deltaTable;
+
+	static u32 s_memoryBudget = c_defaultMemoryBudget;
+	static u32 s_trimCount = 0;
+
+	static void clearSnapshotCache();
+	static void storeSnapshotData(Snapshot* snapshot, const u8* data, u32 size);
+	static bool encodeDelta(const u8* base, u32 baseSize, const u8* data, u32 size, std::vector<u8>& delta);
+	static const u8* getSnapshotData(s32 id);
+	static void enforceMemoryBudget();
+
 	void history_init(UnpackSnapshotFunc snapshotUnpackFunc, CreateSnapshotFunc createSnapshotFunc)
 	{
 		s_snapshotUnpack = snapshotUnpackFunc;
@@ -71,6 +99,7 @@ namespace TFE_Editor
 		s_curPosInHistory = 0;
 		s_curBufferAddr = 0;
 		s_curSnapshot = 0;
+		clearSnapshotCache();
 		// Clear the previous snapshot index.
 		if (s_snapshotUnpack)
 		{
@@ -154,26 +183,30 @@ namespace TFE_Editor
 	s32 history_createSnapshotInternal(u32 size, void* data, const char* name/*=nullptr*/)
 	{
 		u16 parentId = u16(s_curPosInHistory);
+		const s32 id = (s32)s_snapShots.size();
 
 		Snapshot snapshot = {};
 		snapshot.uncompressedSize = size;
 
-		bool useUncompressed = true;
-		if (zstd_compress(snapshot.compressedData, (u8*)data, size, 4))
+		// Store a delta against the previous snapshot unless a keyframe is due or the delta is not worth it.
+		const Snapshot* prev = id > 0 ? &s_snapShots[id - 1] : nullptr;
+		if (prev && s_baseId == id - 1 && prev->chainLength + 1 < SNAPSHOT_KEYFRAME_INTERVAL &&
+			encodeDelta(s_baseData.data(), (u32)s_baseData.size(), (u8*)data, size, s_deltaBuffer))
 		{
-			if (snapshot.compressedData.size() < size)
-			{
-				useUncompressed = false;
-				snapshot.compressedSize = (u32)snapshot.compressedData.size();
-			}
+			snapshot.deltaSize = (u32)s_deltaBuffer.size();
+			snapshot.chainLength = prev->chainLength + 1;
+			storeSnapshotData(&snapshot, s_deltaBuffer.data(), snapshot.deltaSize);
 		}
-		if (useUncompressed)
+		else
 		{
-			snapshot.compressedSize = size;
-			snapshot.compressedData.resize(size);
-			memcpy(snapshot.compressedData.data(), data, size);
+			storeSnapshotData(&snapshot, (u8*)data, size);
 		}
 
+		// This becomes the base for the next delta.
+		s_baseData.resize(size);
+		memcpy(s_baseData.data(), data, size);
+		s_baseId = id;
+
 		if (name)
 		{
 			snapshot.name = name;
@@ -183,7 +216,6 @@ namespace TFE_Editor
 			snapshot.name = "";
 		}
 
-		s32 id = (s32)s_snapShots.size();
 		s_snapShots.push_back(std::move(snapshot));
 		s_curSnapshot = u32(id);
 
@@ -203,22 +235,25 @@ namespace TFE_Editor
 
 	void history_createSnapshot(const char* name/*=nullptr*/)
 	{
+		const u64 startTime = TFE_System::getCurrentTimeInTicks();
 		// Callback setup by the client.
 		s_snapshotBuffer.clear();
 		s_snapshotCreate(&s_snapshotBuffer);
-		history_createSnapshotInternal((u32)s_snapshotBuffer.size(), s_snapshotBuffer.data(), name);
+		const s32 id = history_createSnapshotInternal((u32)s_snapshotBuffer.size(), s_snapshotBuffer.data(), name);
+		s_snapShots[id].createTime = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - startTime);
+		enforceMemoryBudget();
 	}
 		
 	bool history_createCommand(u16 cmd, u16 name)
 	{
+		// Trim before adding the command, the caller adds the command data after this returns.
+		enforceMemoryBudget();
+
 		u16 parentId = u16(s_curPosInHistory);
 		const CommandHeader prevHeader = *hBuffer_getHeader(parentId);
 		if (prevHeader.depth >= CMD_MAX_DEPTH)
 		{
-			// Callback setup by the client.
-			s_snapshotBuffer.clear();
-			s_snapshotCreate(&s_snapshotBuffer);
-			history_createSnapshotInternal((u32)s_snapshotBuffer.size(), s_snapshotBuffer.data(), s_cmdName[name].c_str());
+			history_createSnapshot(s_cmdName[name].c_str());
 			// Return false to let the caller know a snapshot was created instead of the command.
 			return false;
 		}
@@ -353,18 +388,10 @@ namespace TFE_Editor
 			if (cmdHeader->cmdId == CMD_SNAPSHOT)
 			{
 				const s32 id = cmdHeader->cmdName;
-				Snapshot* snapshot = &s_snapShots[id];
-				if (snapshot->uncompressedSize > snapshot->compressedSize)
-				{
-					s_snapshotBuffer.resize(snapshot->uncompressedSize);
-					if (zstd_decompress(s_snapshotBuffer.data(), snapshot->uncompressedSize, snapshot->compressedData.data(), snapshot->compressedSize))
-					{
-						s_snapshotUnpack(id, snapshot->uncompressedSize, s_snapshotBuffer.data());
-					}
-				}
-				else
+				const u8* data = getSnapshotData(id);
+				if (data)
 				{
-					s_snapshotUnpack(id, snapshot->compressedSize, snapshot->compressedData.data());
+					s_snapshotUnpack(id, s_snapShots[id].uncompressedSize, (void*)data);
 				}
 			}
 			else
@@ -428,6 +455,8 @@ namespace TFE_Editor
 		if (snapShotMin < 0xffff)
 		{
 			s_snapShots.resize(snapShotMin);
+			if (s_baseId >= snapShotMin) { s_baseId = -1; }
+			if (s_decodedId >= snapShotMin) { s_decodedId = -1; }
 		}
 		// Clear the previous snapshot index.
 		s_snapshotUnpack(-1, 0, nullptr);
@@ -472,9 +501,42 @@ namespace TFE_Editor
 			size += sizeof(Snapshot);
 		}
 		size += (u32)s_history.size() * sizeof(u32);
+		// The uncompressed snapshots kept for delta encoding and decoding.
+		size += (u32)s_baseData.size() + (u32)s_decodedData.size();
 		return size;
 	}
 
+	void history_getStats(HistoryStats* stats)
+	{
+		*stats = {};
+		stats->memoryBudget = s_memoryBudget;
+		stats->trimCount = s_trimCount;
+		stats->snapshotCount = (u32)s_snapShots.size();
+
+		f64 totalTime = 0.0;
+		u32 timedCount = 0;
+		const Snapshot* snapshot = s_snapShots.data();
+		for (u32 i = 0; i < stats->snapshotCount; i++, snapshot++)
+		{
+			stats->keyframeCount += snapshot->deltaSize ? 0 : 1;
+			stats->snapshotSize += (u32)snapshot->compressedData.size();
+			stats->uncompressedSize += snapshot->uncompressedSize;
+			if (snapshot->createTime > 0.0)
+			{
+				totalTime += snapshot->createTime;
+				timedCount++;
+				stats->lastCreateTime = snapshot->createTime;
+				stats->maxCreateTime = std::max(stats->maxCreateTime, snapshot->createTime);
+			}
+		}
+		stats->avgCreateTime = timedCount ? totalTime / f64(timedCount) : 0.0;
+	}
+
+	void history_setMemoryBudget(u32 budget)
+	{
+		s_memoryBudget = budget;
+	}
+
 	void history_getPrevCmdAndName(u16& cmd, u16& name)
 	{
 		CommandHeader* header = hBuffer_getHeader(s_curPosInHistory);
@@ -618,4 +680,294 @@ namespace TFE_Editor
 		memcpy(&s_historyBuffer[s_curBufferAddr], values, dataSize);
 		s_curBufferAddr += dataSize;
 	}
-}
\ No newline at end of file
+
+	/////////////////////////////////////////////
+	// Internal
+	/////////////////////////////////////////////
+	static void clearSnapshotCache()
+	{
+		s_baseData.clear();
+		s_decodedData.clear();
+		s_baseId = -1;
+		s_decodedId = -1;
+	}
+
+	// Compress the snapshot data or delta, keeping it uncompressed if compression does not help.
+	static void storeSnapshotData(Snapshot* snapshot, const u8* data, u32 size)
+	{
+		if (zstd_compress(snapshot->compressedData, data, size, 4) && snapshot->compressedData.size() < size)
+		{
+			snapshot->compressedSize = (u32)snapshot->compressedData.size();
+		}
+		else
+		{
+			snapshot->compressedSize = size;
+			snapshot->compressedData.resize(size);
+			memcpy(snapshot->compressedData.data(), data, size);
+		}
+	}
+
+	// Get the stored data (snapshot or delta), decompressing into 'buffer' if needed.
+	static const u8* getStoredData(const Snapshot* snapshot, std::vector<u8>& buffer)
+	{
+		const u32 size = snapshot->deltaSize ? snapshot->deltaSize : snapshot->uncompressedSize;
+		if (snapshot->compressedSize >= size)
+		{
+			return snapshot->compressedData.data();
+		}
+		buffer.resize(size);
+		if (!zstd_decompress(buffer.data(), size, snapshot->compressedData.data(), snapshot->compressedSize))
+		{
+			return nullptr;
+		}
+		return buffer.data();
+	}
+
+	static u32 hashDeltaBlock(const u8* data)
+	{
+		u32 hash = 2166136261u;
+		for (s32 i = 0; i < DELTA_BLOCK_SIZE; i++)
+		{
+			hash = (hash ^ data[i]) * 16777619u;
+		}
+		return hash;
+	}
+
+	static u32 getMatchLength(const u8* a, const u8* b, u32 maxLength)
+	{
+		u32 length = 0;
+		while (length < maxLength && a[length] == b[length]) { length++; }
+		return length;
+	}
+
+	static void addDeltaU32(std::vector<u8>& delta, u32 value)
+	{
+		const size_t offset = delta.size();
+		delta.resize(offset + sizeof(u32));
+		memcpy(delta.data() + offset, &value, sizeof(u32));
+	}
+
+	static void addDeltaOp(std::vector<u8>& delta, const u8* literals, u32 literalCount, u32 copyOffset, u32 copyCount)
+	{
+		addDeltaU32(delta, literalCount);
+		delta.insert(delta.end(), literals, literals + literalCount);
+		addDeltaU32(delta, copyOffset);
+		addDeltaU32(delta, copyCount);
+	}
+
+	// Encode 'data' as a list of literal runs and copies from 'base'.
+	// Each operation is { u32 literalCount, u8 literals[literalCount], u32 copyOffset, u32 copyCount }.
+	// Returns false if the data differs too much from the base for a delta to be worth it.
+	static bool encodeDelta(const u8* base, u32 baseSize, const u8* data, u32 size, std::vector<u8>& delta)
+	{
+		delta.clear();
+		if (!baseSize || !size) { return false; }
+
+		// Hash the base in aligned blocks.
+		u32 tableSize = 1024;
+		while (tableSize < 2 * (baseSize / DELTA_BLOCK_SIZE)) { tableSize <<= 1; }
+		s_deltaTable.assign(tableSize, c_deltaInvalidOffset);
+		for (u32 offset = 0; offset + DELTA_BLOCK_SIZE <= baseSize; offset += DELTA_BLOCK_SIZE)
+		{
+			s_deltaTable[hashDeltaBlock(base + offset) & (tableSize - 1)] = offset;
+		}
+
+		const u32 maxLiterals = size / 2;
+		u32 literalTotal = 0;
+		u32 literalStart = 0;
+		u32 nextBase = 0;
+		u32 pos = 0;
+		while (pos < size)
+		{
+			// Most of the data continues where the last copy left off.
+			u32 copyOffset = nextBase;
+			u32 copyCount = nextBase < baseSize ? getMatchLength(base + nextBase, data + pos, std::min(baseSize - nextBase, size - pos)) : 0;
+			if (copyCount < DELTA_MIN_COPY && pos + DELTA_BLOCK_SIZE <= size)
+			{
+				// Otherwise look for the block elsewhere in the base (data inserted, removed or moved).
+				const u32 offset = s_deltaTable[hashDeltaBlock(data + pos) & (tableSize - 1)];
+				if (offset != c_deltaInvalidOffset && memcmp(base + offset, data + pos, DELTA_BLOCK_SIZE) == 0)
+				{
+					copyOffset = offset;
+					copyCount = getMatchLength(base + offset, data + pos, std::min(baseSize - offset, size - pos));
+				}
+			}
+
+			if (copyCount < DELTA_MIN_COPY)
+			{
+				pos++;
+				literalTotal++;
+				if (literalTotal > maxLiterals) { return false; }
+				continue;
+			}
+
+			addDeltaOp(delta, data + literalStart, pos - literalStart, copyOffset, copyCount);
+			pos += copyCount;
+			literalStart = pos;
+			nextBase = copyOffset + copyCount;
+		}
+		if (literalStart < size || delta.empty())
+		{
+			addDeltaOp(delta, data + literalStart, size - literalStart, 0, 0);
+		}
+		return true;
+	}
+
+	static bool applyDelta(const u8* base, u32 baseSize, const u8* delta, u32 deltaSize, u8* out, u32 outSize)
+	{
+		u32 readPos = 0;
+		u32 writePos = 0;
+		while (writePos < outSize)
+		{
+			u32 literalCount, copyOffset, copyCount;
+			if (readPos + sizeof(u32) > deltaSize) { return false; }
+			memcpy(&literalCount, delta + readPos, sizeof(u32));
+			readPos += sizeof(u32);
+
+			if (literalCount > deltaSize - readPos || literalCount > outSize - writePos) { return false; }
+			memcpy(out + writePos, delta + readPos, literalCount);
+			readPos += literalCount;
+			writePos += literalCount;
+
+			if (readPos + 2 * sizeof(u32) > deltaSize) { return false; }
+			memcpy(&copyOffset, delta + readPos, sizeof(u32));
+			memcpy(&copyCount, delta + readPos + sizeof(u32), sizeof(u32));
+			readPos += 2 * sizeof(u32);
+
+			if (copyOffset > baseSize || copyCount > baseSize - copyOffset || copyCount > outSize - writePos) { return false; }
+			memcpy(out + writePos, base + copyOffset, copyCount);
+			writePos += copyCount;
+		}
+		return readPos == deltaSize;
+	}
+
+	// Reconstruct the snapshot by applying the deltas since the last keyframe (or the last reconstructed snapshot).
+	static const u8* getSnapshotData(s32 id)
+	{
+		if (id == s_baseId) { return s_baseData.data(); }
+		if (id == s_decodedId) { return s_decodedData.data(); }
+
+		s32 start = id;
+		while (s_snapShots[start].deltaSize && start != s_decodedId)
+		{
+			start--;
+		}
+		if (start != s_decodedId)
+		{
+			const Snapshot* keyframe = &s_snapShots[start];
+			const u8* data = getStoredData(keyframe, s_decodedData);
+			if (!data)
+			{
+				s_decodedId = -1;
+				return nullptr;
+			}
+			if (data != s_decodedData.data())
+			{
+				s_decodedData.assign(data, data + keyframe->uncompressedSize);
+			}
+			s_decodedId = start;
+		}
+
+		for (s32 i = start + 1; i <= id; i++)
+		{
+			const Snapshot* snapshot = &s_snapShots[i];
+			const u8* delta = getStoredData(snapshot, s_deltaBuffer);
+			s_decodeTemp.resize(snapshot->uncompressedSize);
+			if (!delta || !applyDelta(s_decodedData.data(), (u32)s_decodedData.size(), delta, snapshot->deltaSize, s_decodeTemp.data(), snapshot->uncompressedSize))
+			{
+				s_decodedId = -1;
+				return nullptr;
+			}
+			std::swap(s_decodedData, s_decodeTemp);
+			s_decodedId = i;
+		}
+		return s_decodedData.data();
+	}
+
+	// Remove the history before the oldest snapshot on the current branch (other than the root),
+	// that snapshot becomes the new root. Returns false if there is nothing left to remove.
+	static bool trimHistory()
+	{
+		const s32 count = (s32)s_history.size();
+		const u32 bufferAddr = s_curBufferAddr;
+		s32 newRoot = -1;
+		s32 pos = s_curPosInHistory;
+		while (pos > 0)
+		{
+			const CommandHeader* header = hBuffer_getHeader(pos);
+			if (header->cmdId == CMD_SNAPSHOT) { newRoot = pos; }
+			pos = header->parentId;
+		}
+		const s32 minSnapshot = newRoot > 0 ? hBuffer_getHeader(newRoot)->cmdName : 0;
+		s_curBufferAddr = bufferAddr;
+		if (newRoot <= 0) { return false; }
+
+		// The new root snapshot is stored as a keyframe, older snapshots are no longer needed.
+		const u8* rootData = getSnapshotData(minSnapshot);
+		if (!rootData) { return false; }
+		Snapshot* rootSnapshot = &s_snapShots[minSnapshot];
+		if (rootSnapshot->deltaSize)
+		{
+			s_decodeTemp.assign(rootData, rootData + rootSnapshot->uncompressedSize);
+			rootSnapshot->deltaSize = 0;
+			storeSnapshotData(rootSnapshot, s_decodeTemp.data(), rootSnapshot->uncompressedSize);
+		}
+		s_snapShots.erase(s_snapShots.begin(), s_snapShots.begin() + minSnapshot);
+		const s32 snapshotCount = (s32)s_snapShots.size();
+		for (s32 i = 0; i < snapshotCount; i++)
+		{
+			s_snapShots[i].chainLength = (i > 0 && s_snapShots[i].deltaSize) ? s_snapShots[i - 1].chainLength + 1 : 0;
+		}
+		s_baseId = s_baseId >= minSnapshot ? s_baseId - minSnapshot : -1;
+		s_decodedId = s_decodedId >= minSnapshot ? s_decodedId - minSnapshot : -1;
+
+		// Keep the new root and its descendants, parents always come before their children.
+		std::vector<s32> remap(count, -1);
+		std::vector<u32> history;
+		std::vector<u8> buffer;
+		for (s32 i = newRoot; i < count; i++)
+		{
+			const CommandHeader* header = hBuffer_getHeader(i);
+			if (i != newRoot && remap[header->parentId] < 0) { continue; }
+
+			u32 addr = (u32)buffer.size();
+			if ((addr & 3) != 0)
+			{
+				buffer.resize(addr + 4 - (addr & 3));
+				addr = (u32)buffer.size();
+			}
+			const u32 srcAddr = s_history[i];
+			const u32 srcEnd = (i + 1 < count) ? s_history[i + 1] : (u32)s_historyBuffer.size();
+			buffer.insert(buffer.end(), s_historyBuffer.begin() + srcAddr, s_historyBuffer.begin() + srcEnd);
+
+			CommandHeader* newHeader = (CommandHeader*)(buffer.data() + addr);
+			newHeader->parentId = (i == newRoot) ? 0 : u16(remap[header->parentId]);
+			if (newHeader->cmdId == CMD_SNAPSHOT)
+			{
+				newHeader->cmdName = u16(newHeader->cmdName - minSnapshot);
+			}
+			remap[i] = (s32)history.size();
+			history.push_back(addr);
+		}
+
+		s_curPosInHistory = remap[s_curPosInHistory];
+		s_history = std::move(history);
+		s_historyBuffer = std::move(buffer);
+		s_curBufferAddr = (u32)s_historyBuffer.size();
+		s_curSnapshot = (u32)s_snapShots.size() - 1;
+		s_trimCount++;
+
+		// Snapshot IDs changed, so clear the previous snapshot index.
+		s_snapshotUnpack(-1, 0, nullptr);
+		return true;
+	}
+
+	static void enforceMemoryBudget()
+	{
+		if (!s_memoryBudget || s_history.empty()) { return; }
+		while (history_getSize() > s_memoryBudget)
+		{
+			if (!trimHistory()) { break; }
+		}
+	}
+}
@@ -31,6 +31,19 @@ namespace TFE_Editor
 		hError_Count
 	};
 
+	struct HistoryStats
+	{
+		u32 snapshotCount;
+		u32 keyframeCount;		// Snapshots stored in full, the rest are deltas against the previous snapshot.
+		u32 snapshotSize;		// Stored (compressed) size of all snapshots.
+		u32 uncompressedSize;	// Size of all snapshots if they were stored in full.
+		u32 memoryBudget;		// Zero if unlimited.
+		u32 trimCount;			// Number of times old history was removed to fit the budget.
+		f64 lastCreateTime;		// Snapshot creation times in seconds.
+		f64 avgCreateTime;
+		f64 maxCreateTime;
+	};
+
 	// TODO: Add load and save functionality.
 	void history_init(UnpackSnapshotFunc snapshotUnpackFunc, CreateSnapshotFunc createSnapshotFunc);
 	void history_destroy();
@@ -52,6 +65,9 @@ namespace TFE_Editor
 	s32  history_getPos();
 	u32  history_getSize();
 	u32  history_getItemCount();
+	void history_getStats(HistoryStats* stats);
+	// When the history grows past the budget (in bytes), the oldest items are removed. Zero means unlimited.
+	void history_setMemoryBudget(u32 budget);
 	void history_collapseToPos(s32 pos);
 	void history_collapse();
 	const char* history_getItemNameAndState(u32 index, u32& parentId, bool& isHidden);
@@ -32,6 +32,17 @@ namespace TFE_Editor
 			}
 			ImGui::Text("Items: %d   Size: %0.2f %s", history_getItemCount(), f64(history_getSize()) * scale, sizeTypeStr[sizeType]);
 
+			HistoryStats stats;
+			history_getStats(&stats);
+			const f64 mbScale = 1.0 / (1024.0 * 1024.0);
+			if (stats.memoryBudget)
+			{
+				ImGui::Text("Budget: %0.1f MB   Trimmed: %u", f64(stats.memoryBudget) * mbScale, stats.trimCount);
+			}
+			ImGui::Text("Snapshots: %u (%u keyframes)", stats.snapshotCount, stats.keyframeCount);
+			ImGui::Text("Stored: %0.2f MB of %0.2f MB", f64(stats.snapshotSize) * mbScale, f64(stats.uncompressedSize) * mbScale);
+			ImGui::Text("Create: %0.2f ms (avg %0.2f, max %0.2f)", stats.lastCreateTime * 1000.0, stats.avgCreateTime * 1000.0, stats.maxCreateTime * 1000.0);
+
 			ImGui::BeginChild("##HistoryList", ImVec2(256, 512), ImGuiChildFlags_Border);
 			{
 				const u32 count = history_getItemCount();
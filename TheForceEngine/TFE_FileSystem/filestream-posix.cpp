@@ -71,6 +71,9 @@ bool FileStream::open(const char *filename, AccessMode mode)
 		free(fn2);
 	}
 	m_mode = mode;
+	// The file may have just been created, make sure it can be found by name.
+	if (m_file && mode != MODE_READ)
+		TFE_Paths::invalidateFileIndex(fn);
 
 	return m_file != nullptr;
 }
@@ -165,6 +168,12 @@ u32 FileStream::readContents(const FilePath *filePath, void *output, size_t size
 	return 0;
 }
 
+const u8 *FileStream::getDirectContents(const FilePath *filePath, size_t *size)
+{
+	if (!filePath->archive || filePath->index == INVALID_FILE) { return nullptr; }
+	return filePath->archive->getFileData(filePath->index, size);
+}
+
 //derived from Stream
 bool FileStream::seek(s32 offset, Origin origin/*=ORIGIN_START*/)
 {
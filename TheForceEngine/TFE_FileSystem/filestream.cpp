@@ -1,4 +1,5 @@
 #include "filestream.h"
+#include "paths.h"
 #include <TFE_Archive/archive.h>
 #include <cassert>
 #include <cstring>
@@ -35,6 +36,11 @@ bool FileStream::open(const char* filename, AccessMode mode)
 	const char* modeStrings[] = { "rb", "wb", "rb+" };
 	m_file = fopen(filename, modeStrings[mode]);
 	m_mode = mode;
+	// The file may have just been created, make sure it can be found by name.
+	if (m_file && mode != MODE_READ)
+	{
+		TFE_Paths::invalidateFileIndex(filename);
+	}
 
 	return m_file != nullptr;
 }
@@ -144,6 +150,12 @@ u32 FileStream::readContents(const FilePath* filePath, void* output, size_t size
 	return 0;
 }
 
+const u8* FileStream::getDirectContents(const FilePath* filePath, size_t* size)
+{
+	if (!filePath->archive || filePath->index == INVALID_FILE) { return nullptr; }
+	return filePath->archive->getFileData(filePath->index, size);
+}
+
 //derived from Stream
 bool FileStream::seek(s32 offset, Origin origin/*=ORIGIN_START*/)
 {
@@ -24,6 +24,8 @@ public:
 	static u32 readContents(const char* filePath, void* output, size_t size);
 	static u32 readContents(const FilePath* filePath, void** output);
 	static u32 readContents(const FilePath* filePath, void* output, size_t size);
+	// Returns a read-only pointer to the file contents if they are directly addressable (mapped archives), otherwise null.
+	static const u8* getDirectContents(const FilePath* filePath, size_t* size);
 	
 	//derived functions.
 	bool seek(s32 offset, Origin origin=ORIGIN_START) override;
@@ -7,11 +7,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <TFE_System/system.h>
 #include "fileutil.h"
 #include "filestream.h"
+#include "paths.h"
 
 // implement TFE FileUtil for Linux and compatibles.
 namespace FileUtil
@@ -58,6 +60,28 @@ namespace FileUtil
 		closedir(d);
 	}
 
+	void readDirectoryFiles(const char *dir, FileList& fileList)
+	{
+		char buf[PATH_MAX];
+		struct dirent *de;
+		struct stat st;
+		DIR *d;
+
+		d = opendir(dir);
+		if (!d) {
+			TFE_System::logWrite(LOG_ERROR, "readDirectoryFiles", "opendir(%s) failed with %d\n", dir, errno);
+			return;
+		}
+
+		while (NULL != (de = readdir(d))) {
+			snprintf(buf, PATH_MAX, "%s%s", dir, de->d_name);
+			if (stat(buf, &st) || !S_ISREG(st.st_mode))
+				continue;
+			fileList.push_back(string(de->d_name));
+		}
+		closedir(d);
+	}
+
 	void readSubdirectories(const char *dir, FileList& dirList)
 	{
 		char *dn, fp[PATH_MAX];
@@ -220,6 +244,7 @@ namespace FileUtil
 		} while (rd > 0);
 		close(d);
 		close(s);
+		TFE_Paths::invalidateFileIndex(dst);
 	}
 
 	void deleteFile(const char *fn)
@@ -228,6 +253,7 @@ namespace FileUtil
 		if (ret) {
 			TFE_System::logWrite(LOG_WARNING, "deleteFile", "unlink(%s) failed with %d\n", fn, errno);
 		}
+		TFE_Paths::invalidateFileIndex(fn);
 	}
 
 	bool directoryExits(const char *path, char *outPath)
@@ -366,6 +392,57 @@ namespace FileUtil
 		return mtim;
 	}
 
+	u64 getFileSize(const char *path)
+	{
+		struct stat st;
+		if (stat(path, &st))
+			return 0;
+		return (u64)st.st_size;
+	}
+
+	bool mapFile(const char *path, MappedFile *mapping)
+	{
+		*mapping = {};
+		int fd = open(path, O_RDONLY);
+		if (fd < 0)
+		{
+			char *fnd = findFileNoCase(path);
+			if (!fnd)
+				return false;
+			fd = open(fnd, O_RDONLY);
+			free(fnd);
+			if (fd < 0)
+				return false;
+		}
+
+		struct stat st;
+		if (fstat(fd, &st) || st.st_size <= 0)
+		{
+			close(fd);
+			return false;
+		}
+
+		// The mapping stays valid after the descriptor is closed.
+		void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (data == MAP_FAILED)
+		{
+			TFE_System::logWrite(LOG_WARNING, "mapFile", "mmap(%s) failed with %d\n", path, errno);
+			return false;
+		}
+
+		mapping->data = (const u8 *)data;
+		mapping->size = (size_t)st.st_size;
+		return true;
+	}
+
+	void unmapFile(MappedFile *mapping)
+	{
+		if (mapping->data)
+			munmap((void *)mapping->data, mapping->size);
+		*mapping = {};
+	}
+
 	void fixupPath(char *path)
 	{
 		char *c = path;
@@ -1,6 +1,7 @@
 #pragma once
 #include "fileutil.h"
 #include "filestream.h"
+#include "paths.h"
 
 #include <assert.h>
 #include <stdio.h>
@@ -30,6 +31,26 @@ namespace FileUtil
 		}
 	}
 
+	void readDirectoryFiles(const char* dir, FileList& fileList)
+	{
+		char searchStr[TFE_MAX_PATH];
+		_finddata_t fileInfo;
+
+		sprintf(searchStr, "%s*", dir);
+		intptr_t hFile = _findfirst(searchStr, &fileInfo);
+		if (hFile != -1)
+		{
+			do
+			{
+				if (!(fileInfo.attrib & _A_SUBDIR))
+				{
+					fileList.push_back(string(fileInfo.name));
+				}
+			} while (_findnext(hFile, &fileInfo) == 0);
+			_findclose(hFile);
+		}
+	}
+
 	void readSubdirectories(const char* dir, FileList& dirList)
 	{
 		#ifdef _WIN32
@@ -214,11 +235,13 @@ namespace FileUtil
 	void copyFile(const char* srcFile, const char* dstFile)
 	{
 		CopyFile(srcFile, dstFile, FALSE);
+		TFE_Paths::invalidateFileIndex(dstFile);
 	}
 
 	void deleteFile(const char* srcFile)
 	{
 		DeleteFile(srcFile);
+		TFE_Paths::invalidateFileIndex(srcFile);
 	}
 
 	bool directoryExits(const char* path, char* outPath)
@@ -256,6 +279,66 @@ namespace FileUtil
 		return modTime;
 	}
 
+	u64 getFileSize(const char* path)
+	{
+		WIN32_FILE_ATTRIBUTE_DATA fileInfo;
+		if (!GetFileAttributesExA(path, GetFileExInfoStandard, &fileInfo))
+		{
+			return 0;
+		}
+		return u64(fileInfo.nFileSizeHigh) << 32ULL | u64(fileInfo.nFileSizeLow);
+	}
+
+	bool mapFile(const char* path, MappedFile* mapping)
+	{
+		*mapping = {};
+		HANDLE fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0)
+		{
+			CloseHandle(fileHandle);
+			return false;
+		}
+
+		// The view keeps the file alive, so only the mapping handle needs to be kept.
+		HANDLE mapHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+		CloseHandle(fileHandle);
+		if (!mapHandle)
+		{
+			return false;
+		}
+
+		const void* data = MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+		if (!data)
+		{
+			CloseHandle(mapHandle);
+			return false;
+		}
+
+		mapping->data = (const u8*)data;
+		mapping->size = size_t(fileSize.QuadPart);
+		mapping->handle = mapHandle;
+		return true;
+	}
+
+	void unmapFile(MappedFile* mapping)
+	{
+		if (mapping->data)
+		{
+			UnmapViewOfFile(mapping->data);
+		}
+		if (mapping->handle)
+		{
+			CloseHandle((HANDLE)mapping->handle);
+		}
+		*mapping = {};
+	}
+
 	void fixupPath(char* path)
 	{
 		const size_t len = strlen(path);
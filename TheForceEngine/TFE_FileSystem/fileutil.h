@@ -6,9 +6,19 @@
 using namespace std;
 typedef vector<string> FileList;
 
+// Read-only view of a whole file mapped into the address space.
+struct MappedFile
+{
+	const u8* data = nullptr;
+	size_t size = 0;
+	void* handle = nullptr;	// platform specific mapping handle.
+};
+
 namespace FileUtil
 {
 	void readDirectory(const char* dir, const char* ext, FileList& fileList);
+	// Read the names of all regular files in a directory, without recursing into subdirectories.
+	void readDirectoryFiles(const char* dir, FileList& fileList);
 	bool makeDirectory(const char* dir);
 	void getCurrentDirectory(char* dir);
 	void getExecutionDirectory(char* dir);
@@ -26,6 +36,11 @@ namespace FileUtil
 	bool exists(const char* path);
 	bool directoryExits(const char* path, char* outPath = nullptr);
 	u64  getModifiedTime(const char* path);
+	u64  getFileSize(const char* path);
+
+	// Map a file read-only, returns false if the file is missing, empty or cannot be mapped.
+	bool mapFile(const char* path, MappedFile* mapping);
+	void unmapFile(MappedFile* mapping);
 
 	void fixupPath(char* path);
 	void convertToOSPath(const char* path, char* pathOS);
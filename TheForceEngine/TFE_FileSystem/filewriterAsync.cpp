@@ -1,99 +1,135 @@
 #include "filewriterAsync.h"
+#include "filestream.h"
 #include <assert.h>
-#include <stdio.h>
-#include <stdarg.h>
-#include <vector>
-
-#ifdef _WIN32
-#define WIN32_LEAN_AND_MEAN 1
-#include <Windows.h>
-#endif
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
 
 namespace FileWriterAsync
 {
-#ifdef _WIN32
-	#define MAX_REQUEST_COUNT 32
-
 	struct WriteRequest
 	{
+		std::string path;
 		std::vector<u8> buffer;
-		OVERLAPPED file;
 
 		FileWriteCompletionCallback callback;
 		void* userData;
 	};
-	WriteRequest s_requests[MAX_REQUEST_COUNT];
-	s32 s_freeRequests[MAX_REQUEST_COUNT];
-	s32 s_processRequest[MAX_REQUEST_COUNT];
 
-	std::atomic<s32> s_requestCount = 0;
-	std::atomic<s32> s_freeRequestCount = 0;
-	std::atomic<s32> s_processRequestCount = 0;
+	static std::thread s_writerThread;
+	static std::mutex s_mutex;
+	static std::condition_variable s_requestReady;
+	static std::condition_variable s_requestsDone;
+	static std::deque<WriteRequest> s_requests;
+	static bool s_writing = false;
+	static bool s_exit = false;
 
-	void CALLBACK fileWrittenCallback(DWORD dwErrorCode, DWORD dwBytesTransferred, LPOVERLAPPED lpOverlapped)
+	static void writeRequest(WriteRequest& request)
 	{
-		// Note that this won't be called unless the calling thread is waiting in an "alertable" state.
-		const size_t id = (size_t)lpOverlapped->hEvent;
-		WriteRequest& request = s_requests[id];
+		size_t bytesWritten = 0;
+		u32 errorCode = AFW_SUCCESS;
 
-		if (dwErrorCode == 0 && request.callback)	// Success
+		FileStream file;
+		if (file.open(request.path.c_str(), Stream::MODE_WRITE))
 		{
-			request.callback(size_t(dwBytesTransferred), request.userData, u32(dwErrorCode));
+			file.writeBuffer(request.buffer.data(), (u32)request.buffer.size());
+			file.flush();
+			bytesWritten = file.getLoc();
+			file.close();
+
+			if (bytesWritten != request.buffer.size())
+			{
+				TFE_System::logWrite(LOG_ERROR, "AsyncFileWrite", "Cannot write file: %s", request.path.c_str());
+				errorCode = AFW_WRITE_FAILED;
+			}
 		}
-		else if (request.callback)  // Failure
+		else
 		{
-			request.callback(0, request.userData, u32(dwErrorCode));
+			TFE_System::logWrite(LOG_ERROR, "AsyncFileWrite", "Cannot create file handle for: %s", request.path.c_str());
+			errorCode = AFW_CANNOT_OPEN;
 		}
 
-		request.buffer.clear();
-		s_freeRequests[s_freeRequestCount++] = id;
+		if (request.callback)
+		{
+			request.callback(errorCode == AFW_SUCCESS ? bytesWritten : 0, request.userData, errorCode);
+		}
 	}
 
-	bool writeFileToDisk(const char* path, u8* data, size_t dataSize, FileWriteCompletionCallback completionCallback, void* userData)
+	static void writerThread()
 	{
-		size_t index = 0;
-		if (s_freeRequestCount)
+		std::unique_lock<std::mutex> lock(s_mutex);
+		while (true)
 		{
-			index = s_freeRequests[s_freeRequestCount - 1];
-			s_freeRequestCount--;
-		}
-		else if (s_requestCount < MAX_REQUEST_COUNT)
-		{
-			index = s_requestCount;
-			s_requestCount++;
+			s_requestReady.wait(lock, [] { return s_exit || !s_requests.empty(); });
+			if (s_requests.empty())
+			{
+				// Only exit once all of the queued requests have been written.
+				break;
+			}
+
+			WriteRequest request = std::move(s_requests.front());
+			s_requests.pop_front();
+			s_writing = true;
+
+			lock.unlock();
+			writeRequest(request);
+			lock.lock();
+
+			s_writing = false;
+			if (s_requests.empty())
+			{
+				s_requestsDone.notify_all();
+			}
 		}
-		else
+	}
+
+	bool writeFileToDisk(const char* path, std::vector<u8>&& data, FileWriteCompletionCallback completionCallback, void* userData)
+	{
+		if (!path || data.empty()) { return false; }
+
 		{
-			return false;
+			std::lock_guard<std::mutex> lock(s_mutex);
+			if (!s_writerThread.joinable())
+			{
+				s_exit = false;
+				s_writerThread = std::thread(writerThread);
+			}
+
+			WriteRequest request;
+			request.path = path;
+			request.buffer = std::move(data);
+			request.callback = completionCallback;
+			request.userData = userData;
+			s_requests.push_back(std::move(request));
 		}
+		s_requestReady.notify_one();
+		return true;
+	}
 
-		WriteRequest* request = &s_requests[index];
-		request->buffer.resize(dataSize);
-		memcpy(request->buffer.data(), data, dataSize);
+	bool writeFileToDisk(const char* path, u8* data, size_t dataSize, FileWriteCompletionCallback completionCallback, void* userData)
+	{
+		if (!data || !dataSize) { return false; }
+		return writeFileToDisk(path, std::vector<u8>(data, data + dataSize), completionCallback, userData);
+	}
 
-		request->callback = completionCallback;
-		request->userData = userData;
+	void flush()
+	{
+		std::unique_lock<std::mutex> lock(s_mutex);
+		s_requestsDone.wait(lock, [] { return s_requests.empty() && !s_writing; });
+	}
 
-		HANDLE hFile = CreateFile(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_FLAG_OVERLAPPED, NULL);
-		if (hFile == INVALID_HANDLE_VALUE)
+	void destroy()
+	{
 		{
-			TFE_System::logWrite(LOG_ERROR, "AsyncFileWrite", "Cannot create file handle for: %s", path);
-			return false;
+			std::lock_guard<std::mutex> lock(s_mutex);
+			s_exit = true;
 		}
-
-		memset(&request->file, 0, sizeof(OVERLAPPED));
-		request->file.Offset = 0;
-		request->file.OffsetHigh = 0;
-		request->file.hEvent = HANDLE(index);
-
-		if (!WriteFileEx(hFile, request->buffer.data(), DWORD(dataSize), &request->file, fileWrittenCallback))
+		s_requestReady.notify_one();
+		if (s_writerThread.joinable())
 		{
-			TFE_System::logWrite(LOG_ERROR, "AsyncFileWrite", "Cannot write file: %s", path);
-			return false;
+			s_writerThread.join();
 		}
-
-		CloseHandle(hFile);
-		return true;
 	}
-#endif
 };
@@ -1,15 +1,29 @@
 #pragma once
 #include <TFE_System/system.h>
+#include <vector>
 
 // TODO: Flesh out error codes.
 enum AsyncFileWriteCodes
 {
 	AFW_SUCCESS = 0,
+	AFW_CANNOT_OPEN,
+	AFW_WRITE_FAILED,
 };
 
+// Note the completion callback is called from the writer thread.
 typedef void(*FileWriteCompletionCallback)(size_t bytesWritten, void* userData, u32 errorCode);
 
+// Files are written in request order by a single background thread, so a later write
+// to the same path always wins.
 namespace FileWriterAsync
 {
+	// Copies the data, so it can be freed or reused once this returns.
 	bool writeFileToDisk(const char* path, u8* data, size_t dataSize, FileWriteCompletionCallback completionCallback = nullptr, void* userData = nullptr);
+	// Takes ownership of the data without copying.
+	bool writeFileToDisk(const char* path, std::vector<u8>&& data, FileWriteCompletionCallback completionCallback = nullptr, void* userData = nullptr);
+
+	// Block until all pending writes have finished, call before reading a file that may still be queued.
+	void flush();
+	// Finish pending writes and stop the writer thread.
+	void destroy();
 };
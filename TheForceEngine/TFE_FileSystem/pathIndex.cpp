@@ -0,0 +1,139 @@
+#include <cstring>
+#include <cctype>
+#include "pathIndex.h"
+#include "fileutil.h"
+#include <TFE_Archive/archive.h>
+#include <string>
+#include <unordered_map>
+
+namespace TFE_PathIndex
+{
+	struct IndexEntry
+	{
+		Archive* archive;	// archive or null for loose files and mappings.
+		u32 index;			// index in the archive or INVALID_FILE.
+		std::string path;	// full path for loose files and mappings.
+	};
+
+	static std::unordered_map<std::string, IndexEntry> s_index;
+	static std::unordered_map<std::string, FileList> s_directoryCache;
+
+	static void toLower(const char* name, std::string& key)
+	{
+		key.clear();
+		for (const char* c = name; *c; c++)
+		{
+			key.push_back((char)tolower((u8)*c));
+		}
+	}
+
+	static void insertEntry(const char* name, Archive* archive, u32 index, const char* path)
+	{
+		std::string key;
+		toLower(name, key);
+		// The first source to add a name has the highest priority.
+		s_index.insert({ key, { archive, index, path ? path : "" } });
+	}
+
+	void beginBuild()
+	{
+		s_index.clear();
+	}
+
+	void addMapping(const char* fileName, const char* realPath)
+	{
+		insertEntry(fileName, nullptr, INVALID_FILE, realPath);
+	}
+
+	void addDirectory(const char* dir)
+	{
+		std::unordered_map<std::string, FileList>::iterator iDir = s_directoryCache.find(dir);
+		if (iDir == s_directoryCache.end())
+		{
+			FileList files;
+			FileUtil::readDirectoryFiles(dir, files);
+			iDir = s_directoryCache.insert({ dir, files }).first;
+		}
+
+		// Store the name as it exists on disk, so opening the file later does not need a case-insensitive search.
+		char fullPath[TFE_MAX_PATH];
+		const size_t count = iDir->second.size();
+		const std::string* files = iDir->second.data();
+		for (size_t i = 0; i < count; i++)
+		{
+			snprintf(fullPath, TFE_MAX_PATH, "%s%s", dir, files[i].c_str());
+			insertEntry(files[i].c_str(), nullptr, INVALID_FILE, fullPath);
+		}
+	}
+
+	void addArchive(Archive* archive)
+	{
+		if (!archive) { return; }
+
+		const u32 count = archive->getFileCount();
+		for (u32 i = 0; i < count; i++)
+		{
+			const char* name = archive->getFileName(i);
+			if (name)
+			{
+				insertEntry(name, archive, i, nullptr);
+			}
+		}
+	}
+
+	bool find(const char* fileName, FilePath* outPath)
+	{
+		std::string key;
+		toLower(fileName, key);
+
+		std::unordered_map<std::string, IndexEntry>::const_iterator iEntry = s_index.find(key);
+		if (iEntry == s_index.end())
+		{
+			return false;
+		}
+
+		const IndexEntry& entry = iEntry->second;
+		outPath->archive = entry.archive;
+		outPath->index = entry.index;
+		if (entry.archive)
+		{
+			outPath->path[0] = 0;
+		}
+		else
+		{
+			strncpy(outPath->path, entry.path.c_str(), TFE_MAX_PATH);
+		}
+		return true;
+	}
+
+	void clearDirectoryCache()
+	{
+		s_directoryCache.clear();
+	}
+
+	// Compare directories ignoring case and the type of slash, at worst a listing is read again needlessly.
+	static bool directoriesEqual(const char* a, const char* b)
+	{
+		for (; *a && *b; a++, b++)
+		{
+			const char ca = *a == '\\' ? '/' : (char)tolower((u8)*a);
+			const char cb = *b == '\\' ? '/' : (char)tolower((u8)*b);
+			if (ca != cb) { return false; }
+		}
+		return *a == *b;
+	}
+
+	bool clearDirectory(const char* dir)
+	{
+		std::unordered_map<std::string, FileList>::iterator iDir = s_directoryCache.begin();
+		for (; iDir != s_directoryCache.end(); ++iDir)
+		{
+			if (directoriesEqual(iDir->first.c_str(), dir))
+			{
+				s_directoryCache.erase(iDir);
+				return true;
+			}
+		}
+		return false;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Virtual file system index used by TFE_Paths::getFilePath().
+// All file mappings, loose files in the search paths and files in
+// the mounted archives are merged into a single table keyed by the
+// lowercase file name. The table is filled in priority order and the
+// first source to provide a name wins, so lookups resolve exactly as
+// the original mapping -> search path -> archive scan did.
+//
+// Directory listings are cached separately so that adding or removing
+// an archive (which happens frequently in menus and cutscenes) does
+// not require touching the disk again.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include "paths.h"
+
+namespace TFE_PathIndex
+{
+	// Build the index, sources must be added in priority order.
+	void beginBuild();
+	void addMapping(const char* fileName, const char* realPath);
+	void addDirectory(const char* dir);
+	void addArchive(Archive* archive);
+
+	// Returns false if the name is not found.
+	bool find(const char* fileName, FilePath* outPath);
+
+	// Drop cached directory listings, the next build will read the directories again.
+	void clearDirectoryCache();
+	// Drop the cached listing of a single directory, returns false if it was not cached.
+	bool clearDirectory(const char* dir);
+}
@@ -5,6 +5,9 @@
 #include "filestream.h"
 #include <TFE_System/system.h>
 #include <TFE_Archive/archive.h>
+#include "pathIndex.h"
+#include <atomic>
+#include <mutex>
 #include <algorithm>
 #include <deque>
 #include <string>
@@ -27,6 +30,8 @@ namespace TFE_Paths
 	static std::deque<std::string> s_searchPaths;
 	static std::deque<FileMapping> s_fileMappings;
 	static std::deque<std::string> s_systemPaths;	// TFE Support data paths
+	static std::atomic<bool> s_fileIndexDirty(true);
+	static std::mutex s_fileIndexMutex;
 
 	bool isPortableInstall();
 
@@ -209,6 +214,7 @@ namespace TFE_Paths
 			}
 		}
 		s_searchPaths.push_back(workpath);
+		s_fileIndexDirty = true;
 	}
 
 	void addSearchPathToHead(const char *fullPath)
@@ -227,12 +233,15 @@ namespace TFE_Paths
 			}
 		}
 		s_searchPaths.push_front(workpath);
+		s_fileIndexDirty = true;
 	}
 
 	void clearSearchPaths(void)
 	{
 		s_searchPaths.clear();
 		s_fileMappings.clear();
+		TFE_PathIndex::clearDirectoryCache();
+		s_fileIndexDirty = true;
 	}
 
 	void clearLocalArchives(void)
@@ -240,6 +249,7 @@ namespace TFE_Paths
 		std::for_each(s_localArchives.begin(), s_localArchives.end(),
 				[](Archive *a) { Archive::freeArchive(a); });
 		s_localArchives.clear();
+		s_fileIndexDirty = true;
 	}
 
 	// Add a single file that can be referenced by 'fileName' even though the real name may be different.
@@ -255,6 +265,7 @@ namespace TFE_Paths
 
 		FileMapping mapping = { fileNameLC, filePathFixed };
 		s_fileMappings.push_back(mapping);
+		s_fileIndexDirty = true;
 	}
 
 	void addLocalSearchPath(const char *locpath)
@@ -287,21 +298,60 @@ namespace TFE_Paths
 	void addLocalArchiveToFront(Archive *a)
 	{
 		s_localArchives.push_front(a);
+		s_fileIndexDirty = true;
 	}
 
 	void removeFirstArchive(void)
 	{
 		s_localArchives.pop_front();
+		s_fileIndexDirty = true;
 	}
 
 	void addLocalArchive(Archive *a)
 	{
 		s_localArchives.push_back(a);
+		s_fileIndexDirty = true;
 	}
 
 	void removeLastArchive(void)
 	{
 		s_localArchives.pop_back();
+		s_fileIndexDirty = true;
+	}
+
+	void invalidateFileIndex(void)
+	{
+		std::lock_guard<std::mutex> lock(s_fileIndexMutex);
+		TFE_PathIndex::clearDirectoryCache();
+		s_fileIndexDirty = true;
+	}
+
+	void invalidateFileIndex(const char *filePath)
+	{
+		char dir[TFE_MAX_PATH];
+		FileUtil::getFilePath(filePath, dir);
+
+		std::lock_guard<std::mutex> lock(s_fileIndexMutex);
+		if (TFE_PathIndex::clearDirectory(dir))
+			s_fileIndexDirty = true;
+	}
+
+	// Rebuild the file index using the same priority order as the
+	// search in getFilePath(): mappings, search paths, then archives.
+	// s_fileIndexMutex must be held.
+	static void updateFileIndex(void)
+	{
+		if (!s_fileIndexDirty)
+			return;
+
+		TFE_PathIndex::beginBuild();
+		for (auto it = s_fileMappings.begin(); it != s_fileMappings.end(); it++)
+			TFE_PathIndex::addMapping(it->fileName.c_str(), it->realPath.c_str());
+		for (auto it = s_searchPaths.begin(); it != s_searchPaths.end(); it++)
+			TFE_PathIndex::addDirectory(it->c_str());
+		for (auto it = s_localArchives.begin(); it != s_localArchives.end(); it++)
+			TFE_PathIndex::addArchive(*it);
+		s_fileIndexDirty = false;
 	}
 
 	bool getFilePath(const char *fileName, FilePath *outPath)
@@ -312,6 +362,30 @@ namespace TFE_Paths
 		outPath->index = INVALID_FILE;
 		outPath->path[0] = 0;
 
+		// Plain file names are resolved through the index, which also
+		// stores the on-disk case of loose files. Names that include a
+		// directory are searched for directly below.
+		if (!strpbrk(fileName, "/\\")) {
+			{
+				std::lock_guard<std::mutex> lock(s_fileIndexMutex);
+				updateFileIndex();
+				if (TFE_PathIndex::find(fileName, outPath))
+					return true;
+			}
+
+			// Files created outside of FileStream/FileUtil after the
+			// directories were listed are not indexed, so check the
+			// search paths directly before giving up.
+			for (auto it = s_searchPaths.begin(); it != s_searchPaths.end(); it++) {
+				sprintf(fullname, "%s%s", it->c_str(), fileName);
+				if (FileUtil::existsNoCase(fullname)) {
+					strncpy(outPath->path, fullname, TFE_MAX_PATH);
+					return true;
+				}
+			}
+			return false;
+		}
+
 		// Search for any filemappings.
 		// This is usually only used with mods and usually limited to 0-3 files.
 		for (auto it = s_fileMappings.begin(); it != s_fileMappings.end(); it++) {
@@ -4,6 +4,9 @@
 #include "filestream.h"
 #include <TFE_System/system.h>
 #include <TFE_Archive/archive.h>
+#include "pathIndex.h"
+#include <atomic>
+#include <mutex>
 #include <string>
 
 #ifdef _WIN32
@@ -31,6 +34,8 @@ namespace TFE_Paths
 	static std::vector<Archive*> s_localArchives;
 	static std::vector<std::string> s_searchPaths;
 	static std::vector<FileMapping> s_fileMappings;
+	static std::atomic<bool> s_fileIndexDirty(true);
+	static std::mutex s_fileIndexMutex;
 
 	bool insertString(char* text, const char* newFragment, const char* pattern);
 	bool isPortableInstall();
@@ -200,6 +205,7 @@ namespace TFE_Paths
 			}
 
 			s_searchPaths.push_back(fullPath);
+			s_fileIndexDirty = true;
 		}
 	}
 
@@ -219,6 +225,7 @@ namespace TFE_Paths
 			}
 
 			s_searchPaths.insert(s_searchPaths.begin(), fullPath);
+			s_fileIndexDirty = true;
 		}
 	}
 
@@ -226,6 +233,8 @@ namespace TFE_Paths
 	{
 		s_searchPaths.clear();
 		s_fileMappings.clear();
+		TFE_PathIndex::clearDirectoryCache();
+		s_fileIndexDirty = true;
 	}
 
 	void clearLocalArchives()
@@ -237,6 +246,7 @@ namespace TFE_Paths
 			Archive::freeArchive(archive[i]);
 		}
 		s_localArchives.clear();
+		s_fileIndexDirty = true;
 	}
 
 	// Add a single file that can be referenced by 'fileName' even though the real name may be different.
@@ -252,6 +262,7 @@ namespace TFE_Paths
 
 		FileMapping mapping = { fileNameLC, filePathFixed };
 		s_fileMappings.push_back(mapping);
+		s_fileIndexDirty = true;
 	}
 
 	void addLocalSearchPath(const char* localSearchPath)
@@ -284,21 +295,67 @@ namespace TFE_Paths
 	void addLocalArchiveToFront(Archive* archive)
 	{
 		s_localArchives.insert(s_localArchives.begin(), archive);
+		s_fileIndexDirty = true;
 	}
 
 	void removeFirstArchive()
 	{
 		s_localArchives.erase(s_localArchives.begin());
+		s_fileIndexDirty = true;
 	}
 
 	void addLocalArchive(Archive* archive)
 	{
 		s_localArchives.push_back(archive);
+		s_fileIndexDirty = true;
 	}
 
 	void removeLastArchive()
 	{
 		s_localArchives.pop_back();
+		s_fileIndexDirty = true;
+	}
+
+	void invalidateFileIndex()
+	{
+		std::lock_guard<std::mutex> lock(s_fileIndexMutex);
+		TFE_PathIndex::clearDirectoryCache();
+		s_fileIndexDirty = true;
+	}
+
+	void invalidateFileIndex(const char* filePath)
+	{
+		char dir[TFE_MAX_PATH];
+		FileUtil::getFilePath(filePath, dir);
+
+		std::lock_guard<std::mutex> lock(s_fileIndexMutex);
+		if (TFE_PathIndex::clearDirectory(dir))
+		{
+			s_fileIndexDirty = true;
+		}
+	}
+
+	// Rebuild the file index using the same priority order as the search in getFilePath():
+	// file mappings, then local search paths and finally archives.
+	// s_fileIndexMutex must be held.
+	static void updateFileIndex()
+	{
+		if (!s_fileIndexDirty) { return; }
+
+		TFE_PathIndex::beginBuild();
+		for (size_t i = 0; i < s_fileMappings.size(); i++)
+		{
+			TFE_PathIndex::addMapping(s_fileMappings[i].fileName.c_str(), s_fileMappings[i].realPath.c_str());
+		}
+		for (size_t i = 0; i < s_searchPaths.size(); i++)
+		{
+			TFE_PathIndex::addDirectory(s_searchPaths[i].c_str());
+		}
+		for (size_t i = 0; i < s_localArchives.size(); i++)
+		{
+			TFE_PathIndex::addArchive(s_localArchives[i]);
+		}
+		s_fileIndexDirty = false;
 	}
 
 	bool getFilePath(const char* fileName, FilePath* outPath)
@@ -307,6 +364,33 @@ namespace TFE_Paths
 		outPath->index = INVALID_FILE;
 		outPath->path[0] = 0;
 
+		// Plain file names are resolved through the index.
+		// Names that include a directory are searched for directly below.
+		if (!strpbrk(fileName, "/\\"))
+		{
+			{
+				std::lock_guard<std::mutex> lock(s_fileIndexMutex);
+				updateFileIndex();
+				if (TFE_PathIndex::find(fileName, outPath)) { return true; }
+			}
+
+			// Files created outside of FileStream/FileUtil after the directories were listed are not
+			// indexed, so check the search paths directly before giving up.
+			const size_t pathCount = s_searchPaths.size();
+			const std::string* localPath = s_searchPaths.data();
+			for (size_t i = 0; i < pathCount; i++, localPath++)
+			{
+				char fullName[TFE_MAX_PATH];
+				sprintf(fullName, "%s%s", localPath->c_str(), fileName);
+				if (FileUtil::exists(fullName))
+				{
+					strncpy(outPath->path, fullName, TFE_MAX_PATH);
+					return true;
+				}
+			}
+			return false;
+		}
+
 		// Search for any filemappings.
 		// This is usually only used with mods and usually limited to 0-3 files.
 		const size_t mappingCount  = s_fileMappings.size();
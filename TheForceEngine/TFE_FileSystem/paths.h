@@ -54,6 +54,12 @@ namespace TFE_Paths
 	void addLocalArchiveToFront(Archive* archive);
 	void removeFirstArchive();
 	bool getFilePath(const char* fileName, FilePath* path);
+	// Call after files are added to an archive so getFilePath() sees the change, all directories are read again.
+	void invalidateFileIndex();
+	// Call after 'filePath' is created or deleted. Only the listing of its directory is read again and the index is
+	// left alone if that directory is not a search path. FileStream, FileUtil::copyFile() and FileUtil::deleteFile()
+	// call this.
+	void invalidateFileIndex(const char* filePath);
 	void getAllFilesFromSearchPaths(const char* subdirectory, const char* ext, FileList& allFiles);
 
 	// Add a single file that can be referenced by 'fileName' even though the real name may be different.
@@ -1556,7 +1556,14 @@ namespace TFE_FrontEndUI
 
 	void updateSaveImage(s32 index)
 	{
-		s_saveImageView->update(s_saveDir[index].imageData, TFE_SaveSystem::SAVE_IMAGE_WIDTH * TFE_SaveSystem::SAVE_IMAGE_HEIGHT * 4);
+		// Thumbnails are only decoded once they are displayed.
+		static u32 s_saveImage[TFE_SaveSystem::SAVE_IMAGE_WIDTH * TFE_SaveSystem::SAVE_IMAGE_HEIGHT];
+		if (!TFE_SaveSystem::getSaveImage(&s_saveDir[index], s_saveImage))
+		{
+			clearSaveImage();
+			return;
+		}
+		s_saveImageView->update(s_saveImage, TFE_SaveSystem::SAVE_IMAGE_WIDTH * TFE_SaveSystem::SAVE_IMAGE_HEIGHT * 4);
 	}
 
 	void openLoadConfirmPopup()
@@ -2573,6 +2580,14 @@ namespace TFE_FrontEndUI
 			graphics->asyncFramebuffer = true;
 			graphics->gpuColorConvert = true;
 			ImGui::Checkbox("Extend Adjoin/Portal Limits", &graphics->extendAjoinLimits);
+			ImGui::Checkbox("Multithreaded Rendering", &graphics->multithreadedRender);
+			if (graphics->multithreadedRender)
+			{
+				ImGui::LabelText("##ConfigLabel", "Render Threads (0 = Auto)"); ImGui::SameLine(floorf(200 * s_uiScale));
+				ImGui::SetNextItemWidth(128 * s_uiScale);
+				ImGui::InputInt("##RenderThreads", &graphics->renderThreadCount, 1, 1);
+				graphics->renderThreadCount = clamp(graphics->renderThreadCount, 0, 16);
+			}
 		}
 		else if (graphics->rendererIndex == 1)
 		{
@@ -9,12 +9,141 @@
 #include <TFE_Ui/ui.h>
 #include <TFE_Ui/markdown.h>
 #include <TFE_System/parser.h>
+#include <TFE_Jedi/Task/task.h>
+#include <TFE_Audio/audioSystem.h>
+#include <TFE_Audio/midiPlayer.h>
 
 #include <algorithm>
 
 namespace TFE_ProfilerView
 {
 	static bool s_open = false;
+	static bool s_taskByFunction = false;
+	static std::vector<TaskProfile> s_taskProfile;
+	static char s_audioExportPath[TFE_MAX_PATH] = "";
+
+	// Column order of the task table, must match the table setup below.
+	static const TaskProfileSort c_taskColumnSort[] =
+	{
+		TASK_SORT_TIME,			// Ave ms
+		TASK_SORT_TIME_FRAME,	// Frame ms
+		TASK_SORT_TIME_MAX,		// Max ms
+		TASK_SORT_TIME_TOTAL,	// Total s
+		TASK_SORT_CALLS,		// Calls
+		TASK_SORT_SLEEPS,		// Sleeps
+		TASK_SORT_WAITS,		// Waits
+		TASK_SORT_WAKES,		// Wakes
+		TASK_SORT_NAME,			// Name
+	};
+
+	void drawTaskTable()
+	{
+		bool enabled = TFE_Jedi::task_isProfilingEnabled();
+		if (ImGui::Checkbox("Enable", &enabled))
+		{
+			TFE_Jedi::task_enableProfiling(enabled);
+		}
+		ImGui::SameLine();
+		ImGui::Checkbox("Group by function", &s_taskByFunction);
+		ImGui::SameLine();
+		if (ImGui::Button("Reset"))
+		{
+			TFE_Jedi::task_resetProfile();
+		}
+
+		const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit;
+		if (!ImGui::BeginTable("##TaskTable", 9, flags, ImVec2(0.0f, 300.0f)))
+		{
+			return;
+		}
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Ave ms", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending);
+		ImGui::TableSetupColumn("Frame ms", ImGuiTableColumnFlags_PreferSortDescending);
+		ImGui::TableSetupColumn("Max ms", ImGuiTableColumnFlags_PreferSortDescending);
+		ImGui::TableSetupColumn("Total s", ImGuiTableColumnFlags_PreferSortDescending);
+		ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_PreferSortDescending);
+		ImGui::TableSetupColumn("Sleeps", ImGuiTableColumnFlags_PreferSortDescending);
+		ImGui::TableSetupColumn("Waits", ImGuiTableColumnFlags_PreferSortDescending);
+		ImGui::TableSetupColumn("Wakes", ImGuiTableColumnFlags_PreferSortDescending);
+		ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableHeadersRow();
+
+		// The statistics change every frame, so always sort using the current sort specs.
+		TaskProfileSort sort = TASK_SORT_TIME;
+		bool descending = true;
+		ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs();
+		if (sortSpecs && sortSpecs->SpecsCount > 0)
+		{
+			sort = c_taskColumnSort[sortSpecs->Specs[0].ColumnIndex];
+			descending = sortSpecs->Specs[0].SortDirection == ImGuiSortDirection_Descending;
+			sortSpecs->SpecsDirty = false;
+		}
+		TFE_Jedi::task_getProfile(s_taskByFunction, s_taskProfile, sort, descending);
+
+		const size_t count = s_taskProfile.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			const TaskProfile& info = s_taskProfile[i];
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::Text("%0.3f", info.timeAve * 1000.0);
+			ImGui::TableNextColumn(); ImGui::Text("%0.3f", info.timeInFrame * 1000.0);
+			ImGui::TableNextColumn(); ImGui::Text("%0.3f", info.timeMax * 1000.0);
+			ImGui::TableNextColumn(); ImGui::Text("%0.3f", info.timeTotal);
+			ImGui::TableNextColumn(); ImGui::Text("%u", info.callsTotal);
+			if (s_taskByFunction)
+			{
+				// Sleep, wait and wake counts are tracked per task.
+				ImGui::TableNextColumn(); ImGui::TextUnformatted("-");
+				ImGui::TableNextColumn(); ImGui::TextUnformatted("-");
+				ImGui::TableNextColumn(); ImGui::TextUnformatted("-");
+				ImGui::TableNextColumn(); ImGui::Text("%s [%p]", info.name, (void*)info.func);
+			}
+			else
+			{
+				ImGui::TableNextColumn(); ImGui::Text("%u", info.sleeps);
+				ImGui::TableNextColumn(); ImGui::Text("%u", info.waits);
+				ImGui::TableNextColumn(); ImGui::Text("%u", info.wakes);
+				ImGui::TableNextColumn(); ImGui::TextUnformatted(info.name);
+			}
+		}
+		ImGui::EndTable();
+	}
+
+	void drawAudioStats()
+	{
+		if (ImGui::Button("Reset##Audio"))
+		{
+			TFE_Audio::resetThreadStats();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Export##Audio"))
+		{
+			char path[TFE_MAX_PATH];
+			TFE_Paths::appendPath(PATH_USER_DOCUMENTS, "audiostats.json", path);
+			if (TFE_Audio::writeThreadStats(path))
+			{
+				strcpy(s_audioExportPath, path);
+			}
+		}
+		if (s_audioExportPath[0])
+		{
+			ImGui::SameLine();
+			ImGui::Text("Wrote '%s'", s_audioExportPath);
+		}
+
+		AudioThreadStats stats;
+		TFE_Audio::getThreadStats(&stats);
+		ImGui::Text("Callbacks: %u, period %0.3fms, ave %0.3fms, max %0.3fms", stats.callbacks, stats.periodMs, stats.aveMs, stats.maxMs);
+		ImGui::Text("Deadline misses: %u, late callbacks: %u, midi underruns: %d", stats.deadlineMisses, stats.lateCallbacks, TFE_MidiPlayer::getUnderrunCount());
+		ImGui::Text("Ave breakdown: wave %0.3fms, voices %0.3fms, synth %0.3fms", stats.waveAveMs, stats.voiceAveMs, stats.synthAveMs);
+
+		f32 histogram[AUDIO_STATS_BUCKET_COUNT];
+		for (s32 i = 0; i < AUDIO_STATS_BUCKET_COUNT; i++)
+		{
+			histogram[i] = f32(stats.histogram[i]);
+		}
+		ImGui::PlotHistogram("Callback load, 0 - 100%+ of the period", histogram, AUDIO_STATS_BUCKET_COUNT, 0, nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 80.0f));
+	}
 
 	bool init()
 	{
@@ -80,6 +209,16 @@ namespace TFE_ProfilerView
 		ImGui::Unindent();
 		ImGui::Unindent();
 
+		ImGui::Spacing();
+		ImGui::LabelText("##Label", "Audio Thread");
+		ImGui::Separator();
+		drawAudioStats();
+
+		ImGui::Spacing();
+		ImGui::LabelText("##Label", "Tasks");
+		ImGui::Separator();
+		drawTaskTable();
+
 		ImGui::End();
 	}
 
@@ -0,0 +1,194 @@
+#include "audioRender.h"
+#include <TFE_System/system.h>
+#include <TFE_Audio/audioSystem.h>
+#include <TFE_FileSystem/filestream.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+
+namespace TFE_AudioRender
+{
+	enum
+	{
+		AREN_CHANNEL_COUNT = 2,
+		AREN_MAX_BLOCK = 4096,
+	};
+
+	static AudioRenderSettings s_settings =
+	{
+		"",				// level
+		"",				// outFile
+		60.0f,			// seconds
+		15.0f,			// stateTime
+		0xf444bb3b,		// seed, the Dark Forces default.
+	};
+	static bool s_enabled = false;
+
+	static std::vector<s16> s_samples;
+	static f32 s_block[AREN_MAX_BLOCK * AREN_CHANNEL_COUNT];
+	static u32 s_frameCount = 0;
+	static u64 s_renderTicks = 0;
+
+	/////////////////////////////////////////////
+	// Command line
+	/////////////////////////////////////////////
+	bool setLevelAndOutput(const char* level, const char* outFile)
+	{
+		if (!level || !outFile || !level[0] || !outFile[0]) { return false; }
+
+		strncpy(s_settings.level, level, TFE_MAX_PATH - 1);
+		// Levels are loaded by name, so strip the extension if present.
+		const size_t len = strlen(s_settings.level);
+		if (len > 4 && strcasecmp(&s_settings.level[len - 4], ".lev") == 0)
+		{
+			s_settings.level[len - 4] = 0;
+		}
+		strncpy(s_settings.outFile, outFile, TFE_MAX_PATH - 1);
+		s_enabled = true;
+		return true;
+	}
+
+	bool setSeconds(const char* seconds)
+	{
+		const f32 value = f32(atof(seconds));
+		if (value <= 0.0f)
+		{
+			TFE_System::logWrite(LOG_ERROR, "AudioRender", "Invalid length '%s'.", seconds);
+			return false;
+		}
+		s_settings.seconds = value;
+		return true;
+	}
+
+	bool setSeed(const char* seed)
+	{
+		char* end = nullptr;
+		const u32 value = u32(strtoul(seed, &end, 0));
+		if (!end || end == seed)
+		{
+			TFE_System::logWrite(LOG_ERROR, "AudioRender", "Invalid seed '%s'.", seed);
+			return false;
+		}
+		s_settings.seed = value;
+		return true;
+	}
+
+	bool setStateTime(const char* seconds)
+	{
+		const f32 value = f32(atof(seconds));
+		if (value < 0.0f)
+		{
+			TFE_System::logWrite(LOG_ERROR, "AudioRender", "Invalid state time '%s'.", seconds);
+			return false;
+		}
+		s_settings.stateTime = value;
+		return true;
+	}
+
+	bool isEnabled()
+	{
+		return s_enabled;
+	}
+
+	const AudioRenderSettings* getSettings()
+	{
+		return &s_settings;
+	}
+
+	/////////////////////////////////////////////
+	// Rendering
+	/////////////////////////////////////////////
+	void begin()
+	{
+		s_frameCount = u32(ceil(f64(s_settings.seconds) * f64(TFE_Audio::getOutputSampleRate())));
+		s_samples.clear();
+		s_samples.reserve(size_t(s_frameCount) * AREN_CHANNEL_COUNT);
+		s_renderTicks = 0;
+	}
+
+	u32 getFrameCount()
+	{
+		return s_frameCount;
+	}
+
+	u32 renderBlock(u32 frameCount)
+	{
+		const u32 written = u32(s_samples.size() / AREN_CHANNEL_COUNT);
+		frameCount = std::min(std::min(frameCount, u32(AREN_MAX_BLOCK)), s_frameCount - written);
+		if (!frameCount) { return 0; }
+
+		// Only the audio work is timed, not the game side simulation.
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		TFE_Audio::renderOffline(s_block, frameCount);
+		s_renderTicks += TFE_System::getCurrentTimeInTicks() - start;
+
+		const u32 sampleCount = frameCount * AREN_CHANNEL_COUNT;
+		for (u32 i = 0; i < sampleCount; i++)
+		{
+			const f32 value = std::max(-1.0f, std::min(1.0f, s_block[i]));
+			s_samples.push_back(s16(lroundf(value * 32767.0f)));
+		}
+		return frameCount;
+	}
+
+	bool writeResults()
+	{
+		const u32 frameCount = u32(s_samples.size() / AREN_CHANNEL_COUNT);
+		if (!frameCount) { return false; }
+
+		FileStream file;
+		if (!file.open(s_settings.outFile, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_ERROR, "AudioRender", "Cannot write audio to '%s'.", s_settings.outFile);
+			return false;
+		}
+
+		// Canonical 16-bit PCM WAV header.
+		const u32 sampleRate = TFE_Audio::getOutputSampleRate();
+		const u16 format = 1, channels = AREN_CHANNEL_COUNT, bitsPerSample = 16;
+		const u16 blockAlign = channels * bitsPerSample / 8;
+		const u32 byteRate = sampleRate * blockAlign;
+		const u32 dataSize = frameCount * blockAlign;
+		const u32 riffSize = 36 + dataSize;
+		const u32 fmtSize = 16;
+
+		file.writeBuffer("RIFF", 4);
+		file.write(&riffSize);
+		file.writeBuffer("WAVE", 4);
+		file.writeBuffer("fmt ", 4);
+		file.write(&fmtSize);
+		file.write(&format);
+		file.write(&channels);
+		file.write(&sampleRate);
+		file.write(&byteRate);
+		file.write(&blockAlign);
+		file.write(&bitsPerSample);
+		file.writeBuffer("data", 4);
+		file.write(&dataSize);
+		file.write(s_samples.data(), u32(s_samples.size()));
+		file.close();
+
+		// FNV-1a of the samples, so runs can be compared from the log alone.
+		u32 hash = 2166136261u;
+		const u8* bytes = (const u8*)s_samples.data();
+		for (size_t i = 0; i < s_samples.size() * sizeof(s16); i++)
+		{
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+
+		const f64 audioSec = f64(frameCount) / f64(sampleRate);
+		const f64 renderSec = TFE_System::convertFromTicksToSeconds(s_renderTicks);
+		TFE_System::logWrite(LOG_MSG, "AudioRender", "Wrote %.2f seconds of audio to '%s', hash %08x.", audioSec, s_settings.outFile, hash);
+		TFE_System::logWrite(LOG_MSG, "AudioRender", "Render time %.3f seconds, %.1fx real time.", renderSec, renderSec > 0.0 ? audioSec / renderSec : 0.0);
+		return true;
+	}
+
+	void destroy()
+	{
+		s_samples.clear();
+		s_samples.shrink_to_fit();
+		s_frameCount = 0;
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Audio Render
+// Headless tool mode that plays the level music and sound effects
+// through iMuse, the midi player and the mixer using a simulated
+// clock instead of the audio device, and writes the result to a
+// 16-bit stereo WAV file. With a fixed random seed the output is
+// identical between runs, so it can be used for regression tests and
+// to measure synthesis throughput faster than real time.
+//
+// Usage:
+//   --audiorender <level> <out.wav> [--seconds N] [--seed N]
+//                 [--statetime N]
+//
+// The level is given by name (secbase) or number (1). The music
+// switches between the stalk and fight states every 'statetime'
+// seconds to exercise the iMuse transitions.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <TFE_FileSystem/paths.h>
+
+struct AudioRenderSettings
+{
+	char level[TFE_MAX_PATH];
+	char outFile[TFE_MAX_PATH];
+	f32 seconds;
+	f32 stateTime;	// Seconds between music state changes, 0 stays in the stalk state.
+	u32 seed;
+};
+
+namespace TFE_AudioRender
+{
+	// Command line handling, returns false if the values are invalid.
+	bool setLevelAndOutput(const char* level, const char* outFile);
+	bool setSeconds(const char* seconds);
+	bool setSeed(const char* seed);
+	bool setStateTime(const char* seconds);
+
+	bool isEnabled();
+	const AudioRenderSettings* getSettings();
+
+	// Rendering, the game drives the simulation and renders the audio in blocks.
+	void begin();
+	// Total number of stereo frames to render.
+	u32  getFrameCount();
+	// Render the next block through TFE_Audio::renderOffline(), returns the number of frames rendered.
+	u32  renderBlock(u32 frameCount);
+	bool writeResults();
+	void destroy();
+}
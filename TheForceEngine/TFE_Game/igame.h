@@ -26,6 +26,10 @@ struct IGame
 	virtual void pauseSound(bool pause) = 0;
 	virtual void restartMusic() = 0;
 	virtual void loopGame() {};
+	// Run the headless time demo after runGame(), see timeDemo.h
+	virtual bool runTimeDemo() { return false; }
+	// Render the game audio offline after runGame(), see audioRender.h
+	virtual bool runAudioRender() { return false; }
 	virtual bool serializeGameState(Stream* stream, const char* filename, bool writeState) { return false; };
 	virtual bool canSave() { return false; }
 	virtual bool isPaused() { return false; }
@@ -3,11 +3,15 @@
 #include <TFE_System/system.h>
 #include <TFE_Settings/gameSourceData.h>
 #include <TFE_FileSystem/fileutil.h>
+#include <TFE_FileSystem/filewriterAsync.h>
+#include <TFE_FileSystem/memorystream.h>
+#include <TFE_Archive/zstdCompression.h>
 
 #include <TFE_RenderBackend/renderBackend.h>
 #include <TFE_Asset/imageAsset.h>
 #include <cassert>
 #include <cstring>
+#include <unordered_map>
 
 using namespace TFE_Input;
 
@@ -23,9 +27,31 @@ namespace TFE_SaveSystem
 	enum SaveMasterVersion
 	{
 		SVER_INIT = 1,
-		SVER_CUR = SVER_INIT
+		SVER_COMPRESSED,	// The header and game state are stored as separate compressed blocks.
+		SVER_CUR = SVER_COMPRESSED
 	};
 
+	enum SaveSystemInternalConst
+	{
+		SAVE_COMPRESSION_LEVEL = 4,
+	};
+
+	// The save directory index caches the headers so the save list doesn't have to open every save.
+	enum SaveIndexConst : u32
+	{
+		SAVE_INDEX_MAGIC   = 0x58444953,	// "SIDX"
+		SAVE_INDEX_VERSION = 1,
+	};
+	static const char* c_saveIndexName = "saveIndex.dat";
+
+	struct SaveIndexEntry
+	{
+		u64 fileSize;
+		u64 modifiedTime;
+		SaveHeader header;
+	};
+	typedef std::unordered_map<std::string, SaveIndexEntry> SaveIndex;
+
 	static SaveRequest s_req = SF_REQ_NONE;
 	static char s_reqFilename[TFE_MAX_PATH];
 	static char s_reqSavename[TFE_MAX_PATH];
@@ -36,6 +62,11 @@ namespace TFE_SaveSystem
 	static u32* s_imageBuffer[2] = { nullptr, nullptr };
 	static size_t s_imageBufferSize[2] = { 0 };
 
+	// Saves are serialized into memory, compressed and then written to disk on a background thread.
+	static MemoryStream s_headerStream;
+	static MemoryStream s_stateStream;
+	static std::vector<u8> s_compressedBuffer;
+
 	void saveHeader(Stream* stream, const char* saveName)
 	{
 		// Generate a screenshot.
@@ -63,10 +94,6 @@ namespace TFE_SaveSystem
 			png = (u8*)s_imageBuffer[0];
 		}
 
-		// Master version.
-		u32 version = SVER_CUR;
-		stream->write(&version);
-
 		// Save Name.
 		size_t saveNameLen = strlen(saveName);
 		if (saveNameLen > SAVE_MAX_NAME_LEN - 1) { saveNameLen = SAVE_MAX_NAME_LEN - 1; }
@@ -103,10 +130,6 @@ namespace TFE_SaveSystem
 
 	void loadHeader(Stream* stream, SaveHeader* header, const char* fileName)
 	{
-		// Master version.
-		u32 version;
-		stream->read(&version);
-
 		// Save Name.
 		u8 len;
 		stream->read(&len);
@@ -136,39 +159,263 @@ namespace TFE_SaveSystem
 		stream->readBuffer(header->modNames, len);
 		header->modNames[len] = 0;
 
-		// Image, re-use buffer 0 for the PNG.
-		u32 pngSize;
+		// Image, this stays compressed until it is displayed.
+		u32 pngSize = 0;
 		stream->read(&pngSize);
-		if (pngSize > s_imageBufferSize[0])
+		header->thumbnail.resize(pngSize);
+		if (pngSize && stream->readBuffer(header->thumbnail.data(), pngSize) != pngSize)
 		{
-			s_imageBuffer[0] = (u32*)realloc(s_imageBuffer[0], pngSize);
-			s_imageBufferSize[0] = pngSize;
+			header->thumbnail.clear();
 		}
-		stream->readBuffer(s_imageBuffer[0], pngSize);
+	}
+
+	bool getSaveImage(const SaveHeader* header, u32* pixels)
+	{
+		if (header->thumbnail.empty()) { return false; }
 
-		SDL_Surface* image;
-		TFE_Image::readImageFromMemory(&image, pngSize, s_imageBuffer[0]);
-		if (image)
+		SDL_Surface* image = nullptr;
+		TFE_Image::readImageFromMemory(&image, header->thumbnail.size(), (const u32*)header->thumbnail.data());
+		if (!image) { return false; }
+
+		const bool validSize = image->w == SAVE_IMAGE_WIDTH && image->h == SAVE_IMAGE_HEIGHT;
+		if (validSize)
 		{
 			const u32 sz = SAVE_IMAGE_WIDTH * SAVE_IMAGE_HEIGHT * sizeof(u32);
-			memcpy(header->imageData, image->pixels, sz);
-			TFE_Image::free(image);
+			memcpy(pixels, image->pixels, sz);
+		}
+		TFE_Image::free(image);
+		return validSize;
+	}
+
+	void writeIndexString(Stream* stream, const char* str)
+	{
+		u8 len = (u8)std::min(strlen(str), size_t(255));
+		stream->write(&len);
+		stream->writeBuffer(str, len);
+	}
+
+	// Returns false if the string does not fit in 'size' bytes (including the terminator) or the index is cut short,
+	// in either case the index is corrupt.
+	bool readIndexString(Stream* stream, char* str, size_t size)
+	{
+		str[0] = 0;
+		u8 len = 0;
+		if (stream->readBuffer(&len, 1) != 1 || len >= size) { return false; }
+		if (stream->readBuffer(str, len) != len) { return false; }
+		str[len] = 0;
+		return true;
+	}
+
+	bool readSaveIndex(SaveIndex& index)
+	{
+		char indexPath[TFE_MAX_PATH];
+		sprintf(indexPath, "%s%s", s_gameSavePath, c_saveIndexName);
+
+		FileStream stream;
+		if (!stream.open(indexPath, Stream::MODE_READ))
+		{
+			return false;
+		}
+
+		u32 magic = 0, version = 0, count = 0;
+		stream.read(&magic);
+		stream.read(&version);
+		stream.read(&count);
+		if (magic != SAVE_INDEX_MAGIC || version != SAVE_INDEX_VERSION)
+		{
+			stream.close();
+			return false;
+		}
+
+		bool ok = true;
+		for (u32 i = 0; i < count && ok; i++)
+		{
+			SaveIndexEntry entry;
+			stream.read(&entry.fileSize);
+			stream.read(&entry.modifiedTime);
+			ok = readIndexString(&stream, entry.header.fileName, sizeof(entry.header.fileName)) &&
+				 readIndexString(&stream, entry.header.saveName, sizeof(entry.header.saveName)) &&
+				 readIndexString(&stream, entry.header.dateTime, sizeof(entry.header.dateTime)) &&
+				 readIndexString(&stream, entry.header.levelName, sizeof(entry.header.levelName)) &&
+				 readIndexString(&stream, entry.header.modNames, sizeof(entry.header.modNames));
+
+			u32 thumbnailSize = 0;
+			stream.read(&thumbnailSize);
+			if (ok && thumbnailSize > stream.getSize() - stream.getLoc())
+			{
+				ok = false;
+			}
+			if (ok)
+			{
+				entry.header.thumbnail.resize(thumbnailSize);
+				ok = stream.readBuffer(entry.header.thumbnail.data(), thumbnailSize) == thumbnailSize;
+			}
+			if (ok)
+			{
+				index[entry.header.fileName] = std::move(entry);
+			}
+		}
+		stream.close();
+
+		if (!ok)
+		{
+			TFE_System::logWrite(LOG_WARNING, "SaveSystem", "Save index '%s' is corrupt and will be rebuilt.", indexPath);
+			index.clear();
+		}
+		return ok;
+	}
+
+	void writeSaveIndex(const std::vector<SaveIndexEntry>& entries)
+	{
+		char indexPath[TFE_MAX_PATH];
+		sprintf(indexPath, "%s%s", s_gameSavePath, c_saveIndexName);
+
+		MemoryStream stream;
+		if (!stream.open(Stream::MODE_WRITE)) { return; }
+
+		const u32 magic = SAVE_INDEX_MAGIC;
+		const u32 version = SAVE_INDEX_VERSION;
+		const u32 count = (u32)entries.size();
+		stream.write(&magic);
+		stream.write(&version);
+		stream.write(&count);
+		for (u32 i = 0; i < count; i++)
+		{
+			const SaveIndexEntry& entry = entries[i];
+			stream.write(&entry.fileSize);
+			stream.write(&entry.modifiedTime);
+			writeIndexString(&stream, entry.header.fileName);
+			writeIndexString(&stream, entry.header.saveName);
+			writeIndexString(&stream, entry.header.dateTime);
+			writeIndexString(&stream, entry.header.levelName);
+			writeIndexString(&stream, entry.header.modNames);
+
+			const u32 thumbnailSize = (u32)entry.header.thumbnail.size();
+			stream.write(&thumbnailSize);
+			stream.writeBuffer(entry.header.thumbnail.data(), thumbnailSize);
 		}
+		stream.close();
+		FileWriterAsync::writeFileToDisk(indexPath, (u8*)stream.data(), stream.getSize());
+	}
+
+	// Compress the contents of the memory stream and append it to the file data as a block:
+	// uncompressed size (u32), compressed size (u32), compressed data.
+	bool writeCompressedBlock(std::vector<u8>& fileData, MemoryStream* src)
+	{
+		const u32 size = (u32)src->getSize();
+		if (!zstd_compress(s_compressedBuffer, (const u8*)src->data(), size, SAVE_COMPRESSION_LEVEL))
+		{
+			return false;
+		}
+		const u32 compressedSize = (u32)s_compressedBuffer.size();
+
+		const size_t offset = fileData.size();
+		fileData.resize(offset + 2 * sizeof(u32) + compressedSize);
+		memcpy(&fileData[offset], &size, sizeof(u32));
+		memcpy(&fileData[offset + sizeof(u32)], &compressedSize, sizeof(u32));
+		memcpy(&fileData[offset + 2 * sizeof(u32)], s_compressedBuffer.data(), compressedSize);
+		return true;
+	}
+
+	// Read the next compressed block from the file and leave the memory stream open for reading.
+	bool readCompressedBlock(Stream* stream, MemoryStream* dst)
+	{
+		u32 size = 0, compressedSize = 0;
+		stream->read(&size);
+		stream->read(&compressedSize);
+		if (!size || !compressedSize) { return false; }
+
+		s_compressedBuffer.resize(compressedSize);
+		if (stream->readBuffer(s_compressedBuffer.data(), compressedSize) != compressedSize) { return false; }
+		if (!dst->allocate(size)) { return false; }
+		if (!zstd_decompress((u8*)dst->data(), size, s_compressedBuffer.data(), compressedSize)) { return false; }
+		return dst->open(Stream::MODE_READ);
+	}
+
+	// Read the master version and return the stream to read the header from, or null if the save is not valid.
+	Stream* openHeader(Stream* stream, const char* fileName)
+	{
+		u32 version = 0;
+		stream->read(&version);
+		if (version == SVER_INIT)
+		{
+			// Uncompressed saves store everything in the file directly.
+			return stream;
+		}
+		else if (version > SVER_CUR)
+		{
+			TFE_System::logWrite(LOG_ERROR, "SaveSystem", "Save '%s' has an unsupported version %u.", fileName, version);
+			return nullptr;
+		}
+
+		if (!readCompressedBlock(stream, &s_headerStream))
+		{
+			TFE_System::logWrite(LOG_ERROR, "SaveSystem", "Save '%s' header is corrupt.", fileName);
+			return nullptr;
+		}
+		return &s_headerStream;
 	}
 
 	void populateSaveDirectory(std::vector<SaveHeader>& dir)
 	{
+		// Make sure any pending saves show up.
+		FileWriterAsync::flush();
+
 		dir.clear();
+
+		SaveIndex index;
+		readSaveIndex(index);
+
 		FileList fileList;
 		FileUtil::readDirectory(s_gameSavePath, "tfe", fileList);
-		size_t saveCount = fileList.size();
-		dir.resize(saveCount);
-
+		const size_t saveCount = fileList.size();
 		const std::string* filenames = fileList.data();
-		SaveHeader* headers = dir.data();
+
+		// Only read the headers of saves that are new or have changed since the index was written.
+		std::vector<SaveIndexEntry> entries;
+		entries.reserve(saveCount);
+		size_t reusedCount = 0;
 		for (size_t i = 0; i < saveCount; i++)
 		{
-			loadGameHeader(filenames[i].c_str(), &headers[i]);
+			char filePath[TFE_MAX_PATH];
+			sprintf(filePath, "%s%s", s_gameSavePath, filenames[i].c_str());
+			const u64 fileSize = FileUtil::getFileSize(filePath);
+			const u64 modifiedTime = FileUtil::getModifiedTime(filePath);
+
+			SaveIndex::iterator iEntry = index.find(filenames[i]);
+			if (iEntry != index.end() && iEntry->second.fileSize == fileSize && iEntry->second.modifiedTime == modifiedTime)
+			{
+				entries.push_back(std::move(iEntry->second));
+				reusedCount++;
+				continue;
+			}
+
+			SaveIndexEntry entry;
+			entry.fileSize = fileSize;
+			entry.modifiedTime = modifiedTime;
+			if (!loadGameHeader(filenames[i].c_str(), &entry.header))
+			{
+				// Keep the save in the list so it can still be seen and overwritten, named after its file.
+				TFE_System::logWrite(LOG_WARNING, "SaveSystem", "Cannot read the header of save '%s', listing it by file name.", filenames[i].c_str());
+				entry.header = {};
+				strcpy(entry.header.fileName, filenames[i].c_str());
+				char name[TFE_MAX_PATH];
+				FileUtil::getFileNameFromPath(filenames[i].c_str(), name);
+				strncpy(entry.header.saveName, name, SAVE_MAX_NAME_LEN - 1);
+			}
+			entries.push_back(std::move(entry));
+		}
+
+		// Rewrite the index if any saves were added, changed or removed.
+		if (reusedCount != entries.size() || reusedCount != index.size())
+		{
+			writeSaveIndex(entries);
+		}
+
+		dir.resize(entries.size());
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			dir[i] = std::move(entries[i].header);
 		}
 	}
 
@@ -178,6 +425,8 @@ namespace TFE_SaveSystem
 
 	void destroy()
 	{
+		// Make sure the last save makes it to disk.
+		FileWriterAsync::flush();
 		for (s32 i = 0; i < 2; i++)
 		{
 			free(s_imageBuffer[i]);
@@ -191,13 +440,34 @@ namespace TFE_SaveSystem
 		char filePath[TFE_MAX_PATH];
 		sprintf(filePath, "%s%s", s_gameSavePath, filename);
 
-		bool ret = false;
-		FileStream stream;
-		if (stream.open(filePath, Stream::MODE_WRITE))
+		// Serialize to memory.
+		s_headerStream.clear();
+		s_stateStream.clear();
+		if (!s_headerStream.open(Stream::MODE_WRITE) || !s_stateStream.open(Stream::MODE_WRITE))
 		{
-			saveHeader(&stream, saveName);
-			ret = s_game->serializeGameState(&stream, filename, true);
-			stream.close();
+			return false;
+		}
+		saveHeader(&s_headerStream, saveName);
+		bool ret = s_game->serializeGameState(&s_stateStream, filename, true);
+		s_headerStream.close();
+		s_stateStream.close();
+
+		// Compress and hand the data off to be written in the background.
+		std::vector<u8> fileData;
+		if (ret)
+		{
+			const u32 version = SVER_CUR;
+			fileData.resize(sizeof(u32));
+			memcpy(fileData.data(), &version, sizeof(u32));
+			ret = writeCompressedBlock(fileData, &s_headerStream) && writeCompressedBlock(fileData, &s_stateStream);
+		}
+		if (ret)
+		{
+			ret = FileWriterAsync::writeFileToDisk(filePath, std::move(fileData));
+		}
+		if (!ret)
+		{
+			TFE_System::logWrite(LOG_ERROR, "SaveSystem", "Failed to save '%s'.", filePath);
 		}
 		return ret;
 	}
@@ -206,14 +476,27 @@ namespace TFE_SaveSystem
 	{
 		char filePath[TFE_MAX_PATH];
 		sprintf(filePath, "%s%s", s_gameSavePath, filename);
+		// The save may still be in the process of being written.
+		FileWriterAsync::flush();
 
 		bool ret = false;
 		FileStream stream;
 		if (stream.open(filePath, Stream::MODE_READ))
 		{
 			SaveHeader header;
-			loadHeader(&stream, &header, filename);
-			ret = s_game->serializeGameState(&stream, filename, false);
+			Stream* headerStream = openHeader(&stream, filename);
+			if (headerStream)
+			{
+				loadHeader(headerStream, &header, filename);
+				if (headerStream == &stream)
+				{
+					ret = s_game->serializeGameState(&stream, filename, false);
+				}
+				else if (readCompressedBlock(&stream, &s_stateStream))
+				{
+					ret = s_game->serializeGameState(&s_stateStream, filename, false);
+				}
+			}
 			stream.close();
 		}
 		return ret;
@@ -223,15 +506,20 @@ namespace TFE_SaveSystem
 	{
 		char filePath[TFE_MAX_PATH];
 		sprintf(filePath, "%s%s", s_gameSavePath, filename);
+		FileWriterAsync::flush();
 
 		bool ret = false;
 		FileStream stream;
 		if (stream.open(filePath, Stream::MODE_READ))
 		{
-			loadHeader(&stream, header, filename);
-			strcpy(header->fileName, filename);
+			Stream* headerStream = openHeader(&stream, filename);
+			if (headerStream)
+			{
+				loadHeader(headerStream, header, filename);
+				strcpy(header->fileName, filename);
+				ret = true;
+			}
 			stream.close();
-			ret = true;
 		}
 		return ret;
 	}
@@ -4,6 +4,7 @@
 //////////////////////////////////////////////////////////////////////
 #include "igame.h"
 #include <TFE_Asset/imageAsset.h>
+#include <vector>
 
 namespace TFE_SaveSystem
 {
@@ -21,7 +22,8 @@ namespace TFE_SaveSystem
 		char dateTime[256];
 		char levelName[256];
 		char modNames[256];
-		u32  imageData[SAVE_IMAGE_WIDTH * SAVE_IMAGE_HEIGHT];
+		// Compressed (PNG) thumbnail, use getSaveImage() to decode it when it is displayed.
+		std::vector<u8> thumbnail;
 	};
 
 	void init();
@@ -42,5 +44,9 @@ namespace TFE_SaveSystem
 
 	void getSaveFilenameFromIndex(s32 index, char* name);
 
+	// Fill in the save list, the headers are cached in an index file in the save directory
+	// and only saves that have changed since the last call are read.
 	void populateSaveDirectory(std::vector<SaveHeader>& dir);
+	// Decode the thumbnail into SAVE_IMAGE_WIDTH x SAVE_IMAGE_HEIGHT RGBA pixels.
+	bool getSaveImage(const SaveHeader* header, u32* pixels);
 }
\ No newline at end of file
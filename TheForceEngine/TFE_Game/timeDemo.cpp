@@ -0,0 +1,406 @@
+#include "timeDemo.h"
+#include <TFE_System/system.h>
+#include <TFE_System/profiler.h>
+#include <TFE_System/parser.h>
+#include <TFE_FileSystem/filestream.h>
+#include <TFE_Jedi/Renderer/virtualFramebuffer.h>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace TFE_TimeDemo
+{
+	struct FrameZone
+	{
+		u32 zone;
+		f64 time;
+	};
+
+	struct ZoneStats
+	{
+		std::string name;
+		f64 total;
+		f64 maxTime;
+		s32 frames;
+	};
+
+	static const char* c_rendererNames[TDEMO_RENDERER_COUNT] =
+	{
+		"float",	// TDEMO_RENDERER_FLOAT
+		"fixed",	// TDEMO_RENDERER_FIXED
+	};
+
+	static TimeDemoSettings s_settings =
+	{
+		"",						// level
+		"",						// pathFile
+		"",						// outFile
+		TDEMO_RENDERER_FLOAT,	// renderer
+		1920,					// width
+		1080,					// height
+		1000,					// frameCount
+	};
+	static bool s_enabled = false;
+
+	static std::vector<TimeDemoCamera> s_keys;
+
+	static u64 s_frameStart = 0;
+	static std::vector<f64> s_frameTimes;
+	static std::vector<FrameZone> s_frameZones;
+	static std::vector<u32> s_frameZoneStart;
+	static std::vector<ZoneStats> s_zones;
+	static std::map<std::string, u32> s_zoneMap;
+
+	void recordZones();
+	void writeEscaped(FileStream* file, const char* str);
+	f32 catmullRom(f32 p0, f32 p1, f32 p2, f32 p3, f32 t);
+
+	/////////////////////////////////////////////
+	// Command line
+	/////////////////////////////////////////////
+	bool setLevelAndPath(const char* level, const char* pathFile)
+	{
+		if (!level || !pathFile || !level[0] || !pathFile[0]) { return false; }
+
+		strncpy(s_settings.level, level, TFE_MAX_PATH - 1);
+		// Levels are loaded by name, so strip the extension if present.
+		const size_t len = strlen(s_settings.level);
+		if (len > 4 && strcasecmp(&s_settings.level[len - 4], ".lev") == 0)
+		{
+			s_settings.level[len - 4] = 0;
+		}
+		strncpy(s_settings.pathFile, pathFile, TFE_MAX_PATH - 1);
+		s_enabled = true;
+		return true;
+	}
+
+	bool setRenderer(const char* name)
+	{
+		for (s32 i = 0; i < TDEMO_RENDERER_COUNT; i++)
+		{
+			if (strcasecmp(name, c_rendererNames[i]) == 0)
+			{
+				s_settings.renderer = TimeDemoRenderer(i);
+				return true;
+			}
+		}
+		TFE_System::logWrite(LOG_ERROR, "TimeDemo", "Invalid renderer '%s', valid values are: float, fixed.", name);
+		return false;
+	}
+
+	bool setResolution(const char* res)
+	{
+		s32 width, height;
+		if (sscanf(res, "%dx%d", &width, &height) != 2 || width < 320 || height < 200)
+		{
+			TFE_System::logWrite(LOG_ERROR, "TimeDemo", "Invalid resolution '%s', expected WIDTHxHEIGHT (minimum 320x200).", res);
+			return false;
+		}
+		// The software renderer requires the width to be divisible by 4.
+		s_settings.width  = 4 * ((width + 3) >> 2);
+		s_settings.height = height;
+		return true;
+	}
+
+	bool setFrameCount(const char* count)
+	{
+		const s32 frameCount = atoi(count);
+		if (frameCount <= 0)
+		{
+			TFE_System::logWrite(LOG_ERROR, "TimeDemo", "Invalid frame count '%s'.", count);
+			return false;
+		}
+		s_settings.frameCount = frameCount;
+		return true;
+	}
+
+	void setOutputFile(const char* filename)
+	{
+		strncpy(s_settings.outFile, filename, TFE_MAX_PATH - 1);
+	}
+
+	bool isEnabled()
+	{
+		return s_enabled;
+	}
+
+	const TimeDemoSettings* getSettings()
+	{
+		return &s_settings;
+	}
+
+	/////////////////////////////////////////////
+	// Camera path
+	/////////////////////////////////////////////
+	bool loadPath()
+	{
+		s_keys.clear();
+
+		char* buffer = nullptr;
+		const u32 len = FileStream::readContents(s_settings.pathFile, (void**)&buffer);
+		if (!len || !buffer)
+		{
+			TFE_System::logWrite(LOG_ERROR, "TimeDemo", "Cannot read camera path '%s'.", s_settings.pathFile);
+			free(buffer);
+			return false;
+		}
+		buffer[len] = 0;
+
+		TFE_Parser parser;
+		parser.init(buffer, len);
+		parser.addCommentString("#");
+		parser.addCommentString("//");
+
+		size_t bufferPos = 0;
+		TokenList tokens;
+		while (const char* line = parser.readLine(bufferPos))
+		{
+			tokens.clear();
+			parser.tokenizeLine(line, tokens);
+			if (tokens.size() < 3)
+			{
+				TFE_System::logWrite(LOG_WARNING, "TimeDemo", "Skipping invalid camera key '%s'.", line);
+				continue;
+			}
+
+			TimeDemoCamera key;
+			key.pos.x = f32(atof(tokens[0].c_str()));
+			key.pos.y = f32(atof(tokens[1].c_str()));
+			key.pos.z = f32(atof(tokens[2].c_str()));
+			key.yaw   = tokens.size() > 3 ? f32(atof(tokens[3].c_str())) : 0.0f;
+			key.pitch = tokens.size() > 4 ? f32(atof(tokens[4].c_str())) : 0.0f;
+
+			// Unwrap the yaw so the camera always takes the shortest turn between keys.
+			if (!s_keys.empty())
+			{
+				const f32 prevYaw = s_keys.back().yaw;
+				while (key.yaw - prevYaw >  180.0f) { key.yaw -= 360.0f; }
+				while (key.yaw - prevYaw < -180.0f) { key.yaw += 360.0f; }
+			}
+			s_keys.push_back(key);
+		}
+		free(buffer);
+
+		if (s_keys.empty())
+		{
+			TFE_System::logWrite(LOG_ERROR, "TimeDemo", "Camera path '%s' has no keys.", s_settings.pathFile);
+			return false;
+		}
+		TFE_System::logWrite(LOG_MSG, "TimeDemo", "Loaded camera path '%s' with %d keys.", s_settings.pathFile, (s32)s_keys.size());
+		return true;
+	}
+
+	void getCamera(s32 frame, TimeDemoCamera* camera)
+	{
+		const s32 keyCount = (s32)s_keys.size();
+		if (keyCount < 2 || s_settings.frameCount < 2)
+		{
+			*camera = s_keys[0];
+			return;
+		}
+
+		// Spread the frames evenly over the segments.
+		const f32 t = f32(frame) * f32(keyCount - 1) / f32(s_settings.frameCount - 1);
+		const s32 seg = std::min((s32)t, keyCount - 2);
+		const f32 u = t - f32(seg);
+
+		// The end points are duplicated so the path passes through every key.
+		const TimeDemoCamera* k0 = &s_keys[std::max(seg - 1, 0)];
+		const TimeDemoCamera* k1 = &s_keys[seg];
+		const TimeDemoCamera* k2 = &s_keys[seg + 1];
+		const TimeDemoCamera* k3 = &s_keys[std::min(seg + 2, keyCount - 1)];
+
+		camera->pos.x = catmullRom(k0->pos.x, k1->pos.x, k2->pos.x, k3->pos.x, u);
+		camera->pos.y = catmullRom(k0->pos.y, k1->pos.y, k2->pos.y, k3->pos.y, u);
+		camera->pos.z = catmullRom(k0->pos.z, k1->pos.z, k2->pos.z, k3->pos.z, u);
+		camera->yaw   = catmullRom(k0->yaw,   k1->yaw,   k2->yaw,   k3->yaw,   u);
+		camera->pitch = catmullRom(k0->pitch, k1->pitch, k2->pitch, k3->pitch, u);
+	}
+
+	/////////////////////////////////////////////
+	// Recording
+	/////////////////////////////////////////////
+	void beginFrame()
+	{
+		// The profiler results of the previous frame become readable once the next frame begins.
+		TFE_FRAME_BEGIN();
+		if (!s_frameTimes.empty())
+		{
+			recordZones();
+		}
+		s_frameStart = TFE_System::getCurrentTimeInTicks();
+	}
+
+	void endFrame()
+	{
+		const u64 dt = TFE_System::getCurrentTimeInTicks() - s_frameStart;
+		s_frameTimes.push_back(TFE_System::convertFromTicksToSeconds(dt));
+		TFE_FRAME_END();
+	}
+
+	bool writeResults()
+	{
+		// Pick up the zones from the final frame.
+		TFE_FRAME_BEGIN();
+		recordZones();
+		TFE_FRAME_END();
+
+		const s32 frameCount = (s32)s_frameTimes.size();
+		if (!frameCount) { return false; }
+
+		char outPath[TFE_MAX_PATH];
+		if (s_settings.outFile[0])
+		{
+			strcpy(outPath, s_settings.outFile);
+		}
+		else
+		{
+			TFE_Paths::appendPath(PATH_USER_DOCUMENTS, "timedemo.json", outPath);
+		}
+
+		FileStream file;
+		if (!file.open(outPath, Stream::MODE_WRITE))
+		{
+			TFE_System::logWrite(LOG_ERROR, "TimeDemo", "Cannot write results to '%s'.", outPath);
+			return false;
+		}
+
+		std::vector<f64> sorted = s_frameTimes;
+		std::sort(sorted.begin(), sorted.end());
+		f64 total = 0.0;
+		for (s32 i = 0; i < frameCount; i++)
+		{
+			total += s_frameTimes[i];
+		}
+		const f64 aveTime = total / f64(frameCount);
+		const f64 p50 = sorted[(frameCount - 1) * 50 / 100];
+		const f64 p95 = sorted[(frameCount - 1) * 95 / 100];
+		const f64 p99 = sorted[(frameCount - 1) * 99 / 100];
+
+		file.writeString("{\n");
+		file.writeString("  \"version\": \"%s\",\n", TFE_System::getVersionString());
+		file.writeString("  \"level\": ");
+		writeEscaped(&file, s_settings.level);
+		file.writeString(",\n  \"path\": ");
+		writeEscaped(&file, s_settings.pathFile);
+		file.writeString(",\n  \"renderer\": \"%s\",\n", c_rendererNames[s_settings.renderer]);
+		// Report the resolution that was rendered, the fixed point renderer ignores --res.
+		u32 width, height;
+		TFE_Jedi::vfb_getResolution(&width, &height);
+		file.writeString("  \"width\": %u,\n  \"height\": %u,\n  \"frames\": %d,\n", width, height, frameCount);
+
+		file.writeString("  \"summary\": {\n");
+		file.writeString("    \"totalSec\": %.6f,\n", total);
+		file.writeString("    \"aveFps\": %.3f,\n", aveTime > 0.0 ? 1.0 / aveTime : 0.0);
+		file.writeString("    \"aveMs\": %.4f,\n", aveTime * 1000.0);
+		file.writeString("    \"minMs\": %.4f,\n", sorted.front() * 1000.0);
+		file.writeString("    \"maxMs\": %.4f,\n", sorted.back() * 1000.0);
+		file.writeString("    \"p50Ms\": %.4f,\n", p50 * 1000.0);
+		file.writeString("    \"p95Ms\": %.4f,\n", p95 * 1000.0);
+		file.writeString("    \"p99Ms\": %.4f\n", p99 * 1000.0);
+		file.writeString("  },\n");
+
+		file.writeString("  \"zones\": [\n");
+		const s32 zoneCount = (s32)s_zones.size();
+		for (s32 z = 0; z < zoneCount; z++)
+		{
+			const ZoneStats* zone = &s_zones[z];
+			file.writeString("    { \"name\": ");
+			writeEscaped(&file, zone->name.c_str());
+			file.writeString(", \"aveMs\": %.4f, \"maxMs\": %.4f, \"frames\": %d }%s\n", zone->total * 1000.0 / f64(frameCount),
+				zone->maxTime * 1000.0, zone->frames, z + 1 < zoneCount ? "," : "");
+		}
+		file.writeString("  ],\n");
+
+		file.writeString("  \"frameTimes\": [\n");
+		for (s32 f = 0; f < frameCount; f++)
+		{
+			file.writeString("    { \"frame\": %d, \"ms\": %.4f, \"zones\": {", f, s_frameTimes[f] * 1000.0);
+			const u32 start = s_frameZoneStart[f];
+			const u32 end = (f + 1 < frameCount) ? s_frameZoneStart[f + 1] : (u32)s_frameZones.size();
+			for (u32 i = start; i < end; i++)
+			{
+				file.writeString(i > start ? ", " : " ");
+				writeEscaped(&file, s_zones[s_frameZones[i].zone].name.c_str());
+				file.writeString(": %.4f", s_frameZones[i].time * 1000.0);
+			}
+			file.writeString(" } }%s\n", f + 1 < frameCount ? "," : "");
+		}
+		file.writeString("  ]\n");
+		file.writeString("}\n");
+		file.close();
+
+		TFE_System::logWrite(LOG_MSG, "TimeDemo", "%d frames, %.3f ms average (%.2f fps), p99 %.3f ms. Results written to '%s'.",
+			frameCount, aveTime * 1000.0, aveTime > 0.0 ? 1.0 / aveTime : 0.0, p99 * 1000.0, outPath);
+		return true;
+	}
+
+	void destroy()
+	{
+		s_keys.clear();
+		s_frameTimes.clear();
+		s_frameZones.clear();
+		s_frameZoneStart.clear();
+		s_zones.clear();
+		s_zoneMap.clear();
+	}
+
+	/////////////////////////////////////////////
+	// Internal
+	/////////////////////////////////////////////
+	void recordZones()
+	{
+		s_frameZoneStart.push_back((u32)s_frameZones.size());
+
+		const u32 count = TFE_Profiler::getZoneCount();
+		for (u32 i = 0; i < count; i++)
+		{
+			TFE_ZoneInfo info;
+			TFE_Profiler::getZoneInfo(i, &info);
+			if (info.timeInZone <= 0.0) { continue; }
+
+			u32 id;
+			std::map<std::string, u32>::iterator iZone = s_zoneMap.find(info.name);
+			if (iZone == s_zoneMap.end())
+			{
+				id = (u32)s_zones.size();
+				s_zones.push_back({ info.name, 0.0, 0.0, 0 });
+				s_zoneMap[info.name] = id;
+			}
+			else
+			{
+				id = iZone->second;
+			}
+
+			ZoneStats* zone = &s_zones[id];
+			zone->total += info.timeInZone;
+			zone->maxTime = std::max(zone->maxTime, info.timeInZone);
+			zone->frames++;
+			s_frameZones.push_back({ id, info.timeInZone });
+		}
+	}
+
+	void writeEscaped(FileStream* file, const char* str)
+	{
+		std::string out = "\"";
+		for (; *str; str++)
+		{
+			const char c = *str;
+			if (c == '"' || c == '\\') { out += '\\'; out += c; }
+			else if (c == '\n') { out += "\\n"; }
+			else if ((u8)c >= 32) { out += c; }
+		}
+		out += "\"";
+		file->writeString("%s", out.c_str());
+	}
+
+	f32 catmullRom(f32 p0, f32 p1, f32 p2, f32 p3, f32 t)
+	{
+		const f32 t2 = t * t;
+		const f32 t3 = t2 * t;
+		return 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f*p0 - 5.0f*p1 + 4.0f*p2 - p3) * t2 + (3.0f*p1 - p0 - 3.0f*p2 + p3) * t3);
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Time Demo
+// Headless benchmark mode, a level is loaded without a window or
+// audio device and the camera is flown along a scripted path while
+// the per-frame and per-zone timings are recorded.
+//
+// Usage:
+//   --timedemo <level> <path-file> [--renderer float|fixed]
+//              [--res 1920x1080] [--frames N] [--out file.json]
+//
+// Path files are plain text, one key per line (# starts a comment):
+//   x y z yaw pitch
+// Positions use the same units as the level data and the angles are
+// in degrees. The camera follows a Catmull-Rom spline through the
+// keys over the requested number of frames.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include <TFE_FileSystem/paths.h>
+
+enum TimeDemoRenderer
+{
+	TDEMO_RENDERER_FLOAT = 0,	// Floating point software renderer, any resolution.
+	TDEMO_RENDERER_FIXED,		// Original fixed point renderer, always 320x200.
+	TDEMO_RENDERER_COUNT
+};
+
+struct TimeDemoSettings
+{
+	char level[TFE_MAX_PATH];
+	char pathFile[TFE_MAX_PATH];
+	char outFile[TFE_MAX_PATH];
+	TimeDemoRenderer renderer;
+	s32 width;
+	s32 height;
+	s32 frameCount;
+};
+
+struct TimeDemoCamera
+{
+	Vec3f pos;
+	f32 yaw;	// degrees
+	f32 pitch;	// degrees
+};
+
+namespace TFE_TimeDemo
+{
+	// Command line handling, returns false if the values are invalid.
+	bool setLevelAndPath(const char* level, const char* pathFile);
+	bool setRenderer(const char* name);
+	bool setResolution(const char* res);
+	bool setFrameCount(const char* count);
+	void setOutputFile(const char* filename);
+
+	bool isEnabled();
+	const TimeDemoSettings* getSettings();
+
+	// Camera path
+	bool loadPath();
+	void getCamera(s32 frame, TimeDemoCamera* camera);
+
+	// Recording, begin/end wrap the rendering for a single frame.
+	void beginFrame();
+	void endFrame();
+	bool writeResults();
+	void destroy();
+}
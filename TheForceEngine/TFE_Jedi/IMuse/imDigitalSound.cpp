@@ -6,6 +6,8 @@
 #include "imList.h"
 #include <TFE_Jedi/Math/core_math.h>
 #include <TFE_System/system.h>
+#include <TFE_System/profiler.h>
+#include <TFE_System/spscQueue.h>
 #include <TFE_Audio/midi.h>
 #include <TFE_Audio/audioSystem.h>
 #include <cassert>
@@ -15,22 +17,31 @@ namespace TFE_Jedi
 {
 	#define MAX_SOUND_CHANNELS 16
 	#define DEFAULT_SOUND_CHANNELS 8
+	// TFE: more sounds can play than there are channels to mix them. Only the highest priority audible sounds,
+	// up to the mix count, are mixed - the rest are virtual voices that keep their playback position (and triggers)
+	// but are not mixed until they become audible and have a high enough priority again.
+	// This covers all game sound effects, including cued sounds (sound_playCued() -> sound_playPriority() -> ImStartSfx()).
+	#define MAX_WAVE_VOICES 32
+	// Sounds where the loudest side maps to a volume level (0 - 16) below this are inaudible.
+	#define WAVE_AUDIBLE_LEVEL 1
 	#define AUDIO_BUFFER_SIZE 512
 	
+	// Serializes the game and midi threads, the audio thread never takes it.
 	#define AUDIO_LOCK()   TFE_Audio::lock()
 	#define AUDIO_UNLOCK() TFE_Audio::unlock()
 
 	////////////////////////////////////////////////////
 	// Structures
 	////////////////////////////////////////////////////
-	struct ImWaveData;
-
+	// TFE: the iMuse API (game and midi threads) owns the wave sounds while the audio thread mixes its own copy, the wave voices.
+	// Changes to the sounds are posted to the audio thread through the audio command queue (see ImApplyWaveCommand()) and the
+	// audio thread posts finished sounds, markers and mailbox values back (see ImProcessWaveEvents()), so it never waits.
 	struct ImWaveSound
 	{
 		ImWaveSound* prev;
 		ImWaveSound* next;
-		ImWaveData* data;
 		ImSoundId soundId;
+		u32 generation;		// Incremented each time the sound is started, so commands and events for older sounds are ignored.
 
 		s32 marker;
 		s32 group;
@@ -48,26 +59,82 @@ namespace TFE_Jedi
 
 	struct ImWaveData
 	{
-		ImWaveSound* sound;
+		const u8* sndData;
+		ImSoundId soundId;
 		s32 offset;
 		s32 chunkSize;
 		s32 baseOffset;
 		s32 chunkIndex;
 	};
 
+	// Audio thread copy of a wave sound, the slot matches the sound in s_imWaveSound[].
+	struct ImWaveVoice
+	{
+		ImWaveVoice* prev;
+		ImWaveVoice* next;
+		ImWaveData data;
+		s32 slot;
+		u32 generation;
+		u32 flags;
+
+		s32 priority;
+		s32 volume;
+		s32 pan;
+	};
+
+	enum ImWaveVoiceFlags
+	{
+		IM_VOICE_PLAYING  = (1 << 0),
+		IM_VOICE_FINISHED = (1 << 1),	// Finished but the event has not been posted yet.
+	};
+
+	// Posted to the audio thread, see ImApplyWaveCommand().
+	enum ImWaveCommandType
+	{
+		IM_WAVE_CMD_START = 0,		// args: priority, volume, pan, offset, chunk size, base offset; data: sound data.
+		IM_WAVE_CMD_SET_PARAM,		// args: priority, volume, pan.
+		IM_WAVE_CMD_FREE,
+		IM_WAVE_CMD_FREE_ALL,
+		IM_WAVE_CMD_SET_MIX_COUNT,	// args: mix count.
+	};
+
+	// Posted by the audio thread, see ImProcessWaveEvents().
+	enum ImWaveEventType
+	{
+		IM_WAVE_EVT_FINISHED = 0,
+		IM_WAVE_EVT_MARKER,
+		IM_WAVE_EVT_MAILBOX,
+	};
+
+	struct ImWaveEvent
+	{
+		s32 type;
+		s32 slot;
+		u32 generation;
+		s32 mailbox;
+		const u8* marker;
+	};
+
 	/////////////////////////////////////////////////////
 	// Internal State
 	/////////////////////////////////////////////////////
 	atomic_s32 s_digitalPause;
 
+	// Game and midi threads.
 	static ImWaveSound* s_imWaveSoundList = nullptr;
-	static ImWaveSound  s_imWaveSound[MAX_SOUND_CHANNELS];
-	static ImWaveData   s_imWaveData[MAX_SOUND_CHANNELS];
-	static u8  s_imWaveChunkData[48];
-	static s32 s_imWaveMixCount = DEFAULT_SOUND_CHANNELS;
+	static ImWaveSound  s_imWaveSound[MAX_WAVE_VOICES];
 	static s32 s_imWaveNanosecsPerSample;
 	static iMuseInitData* s_imDigitalData;
 
+	// Audio thread.
+	static ImWaveVoice* s_imWaveVoiceList = nullptr;
+	static ImWaveVoice  s_imWaveVoice[MAX_WAVE_VOICES];
+	static s32 s_imWaveMixCount = DEFAULT_SOUND_CHANNELS;
+	static s32 s_imWaveRealVoices = 0;
+	static s32 s_imWaveVirtualVoices = 0;
+
+	static SpscQueue<ImWaveEvent, 256> s_imWaveEvents;	// audio thread -> iMuse.
+
 	// In DOS these are 8-bit outputs since that is what the driver is accepting.
 	// For TFE, floating-point audio output is used, so these convert to floating-point.
 	static f32  s_audioNormalizationMem[MAX_SOUND_CHANNELS * 256 + 4];
@@ -79,22 +146,29 @@ namespace TFE_Jedi
 	static f32* s_audioDriverOut;
 	static s16 s_audioOut[AUDIO_BUFFER_SIZE + IM_AUDIO_OVERSAMPLE*2];	// Add 2 stereo samples from the next frame for interpolation.
 	static s32 s_audioOutSize;
-	static u8* s_audioData;
+	static const u8* s_audioData;
 			
 	extern s32 ImWrapValue(s32 value, s32 a, s32 b);
 	extern s32 ImGetGroupVolume(s32 group);
 	extern u8* ImInternalGetSoundData(ImSoundId soundId);
 
-	ImWaveData* ImGetWaveData(s32 index);
 	void ImFreeWaveSound(ImWaveSound* sound);
+	void ImReleaseWaveSound(ImWaveSound* sound);
+	void ImPostWaveParams(ImWaveSound* sound);
 	s32 ImComputeAudioNormalizationInit(iMuseInitData* initData);
 	s32 ImComputeAudioNormalization(s32 waveMixCount);
 	s32 ImSetWaveParamInternal(ImSoundId soundId, s32 param, s32 value);
 	s32 ImGetWaveParamIntern(ImSoundId soundId, s32 param);
 	s32 ImFreeWaveSoundByIdIntern(ImSoundId soundId);
 	s32 ImStartDigitalSoundIntern(ImSoundId soundId, s32 priority, s32 chunkIndex);
-	s32 audioPlaySoundFrame(ImWaveSound* sound);
+	s32 ImSeekToNextChunk(ImWaveData* data, ImWaveSound* sound, ImWaveVoice* voice);
+	s32 audioPlaySoundFrame(ImWaveVoice* voice, bool mix);
 	s32 audioWriteToDriver(f32 systemVolume);
+	void ImInitWaveVoices();
+	void ImClearWaveVoices();
+	void ImApplyWaveCommand(const AudioThreadCommand* command);
+	void ImPostWaveFinished(ImWaveVoice* voice);
+	s32 ImGetWaveAudibleLevel(ImWaveVoice* voice);
 		
 	/////////////////////////////////////////////////////////// 
 	// API
@@ -124,20 +198,16 @@ namespace TFE_Jedi
 			s_imWaveNanosecsPerSample = 45454;
 		}
 
-		ImWaveSound* sound = s_imWaveSound;
-		for (s32 i = 0; i < s_imWaveMixCount; i++, sound++)
-		{
-			sound->prev = nullptr;
-			sound->next = nullptr;
-			ImWaveData* data = ImGetWaveData(i);
-			sound->data = data;
-			data->sound = sound;
-			sound->soundId = IM_NULL_SOUNDID;
-		}
-
-		TFE_Audio::setAudioThreadCallback(ImUpdateWave);
+		ImInitWaveVoices();
+		TFE_COUNTER(s_imWaveRealVoices, "iMuse Wave Voices Mixed");
+		TFE_COUNTER(s_imWaveVirtualVoices, "iMuse Wave Voices Virtual");
 
-		return ImComputeAudioNormalizationInit(initData);
+		// The audio thread does not touch the voices or the normalization table until the callback is registered,
+		// and the registration is applied in order with the commands posted after it.
+		ImClearWaveVoices();
+		const s32 res = ImComputeAudioNormalizationInit(initData);
+		TFE_Audio::setAudioThreadCallback(ImUpdateWave, ImApplyWaveCommand);
+		return res;
 	}
 
 	void ImTerminateDigitalAudio()
@@ -157,26 +227,23 @@ namespace TFE_Jedi
 
 		AUDIO_LOCK();
 		{
-			s_imWaveMixCount = count;
-			ImWaveSound* sound = s_imWaveSound;
-			for (s32 i = 0; i < s_imWaveMixCount; i++, sound++)
-			{
-				sound->prev = nullptr;
-				sound->next = nullptr;
-				ImWaveData* data = ImGetWaveData(i);
-				sound->data = data;
-				data->sound = sound;
-				sound->soundId = IM_NULL_SOUNDID;
-			}
+			ImInitWaveVoices();
+			// The mix count and normalization table belong to the audio thread, which rebuilds them.
+			AudioThreadCommand command = {};
+			command.type = IM_WAVE_CMD_SET_MIX_COUNT;
+			command.args[0] = count;
+			TFE_Audio::postAudioThreadCommand(command);
 		}
 		AUDIO_UNLOCK();
 
-		return ImComputeAudioNormalization(count);
+		return imSuccess;
 	}
 
 	s32 ImSetWaveParam(ImSoundId soundId, s32 param, s32 value)
 	{
+		AUDIO_LOCK();
 		s32 res = ImSetWaveParamInternal(soundId, param, value);
+		AUDIO_UNLOCK();
 		return res;
 	}
 
@@ -198,12 +265,58 @@ namespace TFE_Jedi
 		assert(bufferSize * 2 <= AUDIO_BUFFER_SIZE);
 		memset(s_audioOut, 0, 2*(bufferSize + IM_AUDIO_OVERSAMPLE) * sizeof(s16));
 
-		// Write sounds to s_audioOut.
-		ImWaveSound* sound = s_imWaveSoundList;
+		// Retry the finished events that did not fit in the queue.
+		ImWaveVoice* voice = s_imWaveVoice;
+		for (s32 i = 0; i < MAX_WAVE_VOICES; i++, voice++)
+		{
+			if (voice->flags & IM_VOICE_FINISHED)
+			{
+				ImPostWaveFinished(voice);
+			}
+		}
+
+		// Pick the sounds to mix: the highest priority audible sounds, louder first, up to the mix count.
+		ImWaveVoice* mixSound[MAX_SOUND_CHANNELS];
+		s32 mixLevel[MAX_SOUND_CHANNELS];
+		s32 mixCount = 0;
+		s32 soundCount = 0;
+		ImWaveVoice* sound = s_imWaveVoiceList;
+		for (; sound; sound = sound->next, soundCount++)
+		{
+			const s32 level = ImGetWaveAudibleLevel(sound);
+			if (level < WAVE_AUDIBLE_LEVEL) { continue; }
+
+			s32 index = mixCount;
+			while (index > 0 && (sound->priority > mixSound[index - 1]->priority ||
+				(sound->priority == mixSound[index - 1]->priority && level > mixLevel[index - 1])))
+			{
+				index--;
+			}
+			if (index >= s_imWaveMixCount) { continue; }
+
+			mixCount = min(mixCount + 1, s_imWaveMixCount);
+			for (s32 i = mixCount - 1; i > index; i--)
+			{
+				mixSound[i] = mixSound[i - 1];
+				mixLevel[i] = mixLevel[i - 1];
+			}
+			mixSound[index] = sound;
+			mixLevel[index] = level;
+		}
+		s_imWaveRealVoices = mixCount;
+		s_imWaveVirtualVoices = soundCount - mixCount;
+
+		// Write sounds to s_audioOut, virtual voices only advance.
+		sound = s_imWaveVoiceList;
 		while (sound)
 		{
-			ImWaveSound* next = sound->next;
-			audioPlaySoundFrame(sound);
+			ImWaveVoice* next = sound->next;
+			bool mix = false;
+			for (s32 i = 0; i < mixCount && !mix; i++)
+			{
+				mix = (mixSound[i] == sound);
+			}
+			audioPlaySoundFrame(sound, mix);
 			sound = next;
 		}
 
@@ -226,10 +339,169 @@ namespace TFE_Jedi
 	////////////////////////////////////
 	// Internal
 	////////////////////////////////////
-	ImWaveData* ImGetWaveData(s32 index)
+	void ImInitWaveVoices()
+	{
+		ImWaveSound* sound = s_imWaveSound;
+		for (s32 i = 0; i < MAX_WAVE_VOICES; i++, sound++)
+		{
+			// The generation is kept, so events posted for the previous sounds are ignored.
+			sound->prev = nullptr;
+			sound->next = nullptr;
+			sound->soundId = IM_NULL_SOUNDID;
+		}
+	}
+
+	// Audio thread (or before the audio thread callback is registered).
+	void ImClearWaveVoices()
+	{
+		ImWaveVoice* voice = s_imWaveVoice;
+		for (s32 i = 0; i < MAX_WAVE_VOICES; i++, voice++)
+		{
+			voice->prev = nullptr;
+			voice->next = nullptr;
+			voice->slot = i;
+			voice->flags = 0;
+		}
+		s_imWaveVoiceList = nullptr;
+	}
+
+	// Audio thread: apply a change to the wave sounds posted by the iMuse API.
+	void ImApplyWaveCommand(const AudioThreadCommand* command)
+	{
+		ImWaveVoice* voice = nullptr;
+		switch (command->type)
+		{
+			case IM_WAVE_CMD_START:
+			{
+				voice = &s_imWaveVoice[command->slot];
+				if (voice->flags & IM_VOICE_PLAYING)
+				{
+					IM_LIST_REM(s_imWaveVoiceList, voice);
+				}
+				voice->data.sndData = (const u8*)command->data;
+				voice->data.soundId = command->id;
+				voice->data.offset = command->args[3];
+				voice->data.chunkSize = command->args[4];
+				voice->data.baseOffset = command->args[5];
+				voice->data.chunkIndex = 0;
+				voice->generation = command->generation;
+				voice->flags = IM_VOICE_PLAYING;
+				voice->priority = command->args[0];
+				voice->volume = command->args[1];
+				voice->pan = command->args[2];
+				IM_LIST_ADD(s_imWaveVoiceList, voice);
+			} break;
+			case IM_WAVE_CMD_SET_PARAM:
+			case IM_WAVE_CMD_FREE:
+			{
+				voice = &s_imWaveVoice[command->slot];
+				// The voice may have finished or been restarted since the command was posted.
+				if (!(voice->flags & IM_VOICE_PLAYING) || voice->generation != command->generation)
+				{
+					break;
+				}
+				if (command->type == IM_WAVE_CMD_FREE)
+				{
+					IM_LIST_REM(s_imWaveVoiceList, voice);
+					voice->flags = 0;
+				}
+				else
+				{
+					voice->priority = command->args[0];
+					voice->volume = command->args[1];
+					voice->pan = command->args[2];
+				}
+			} break;
+			case IM_WAVE_CMD_FREE_ALL:
+			{
+				ImClearWaveVoices();
+			} break;
+			case IM_WAVE_CMD_SET_MIX_COUNT:
+			{
+				s_imWaveMixCount = command->args[0];
+				ImComputeAudioNormalization(s_imWaveMixCount);
+			} break;
+		}
+	}
+
+	// Audio thread: if the queue is full, the event is retried by the next ImUpdateWave().
+	void ImPostWaveFinished(ImWaveVoice* voice)
+	{
+		const ImWaveEvent finished = { IM_WAVE_EVT_FINISHED, voice->slot, voice->generation, 0, nullptr };
+		if (s_imWaveEvents.push(finished))
+		{
+			voice->flags = 0;
+		}
+	}
+
+	// Audio thread: the voice reached the end of its sound, which is freed by ImProcessWaveEvents().
+	void ImFinishWaveVoice(ImWaveVoice* voice)
+	{
+		IM_LIST_REM(s_imWaveVoiceList, voice);
+		voice->flags = IM_VOICE_FINISHED;
+		ImPostWaveFinished(voice);
+	}
+
+	// Markers and mailbox values found while seeking are applied to 'sound' directly on the game and midi threads,
+	// the audio thread posts them for 'voice' instead.
+	void ImSetWaveMarker(ImWaveSound* sound, ImWaveVoice* voice, const u8* marker)
+	{
+		if (sound)
+		{
+			ImSetSoundTrigger((ImSoundId)sound, (void*)marker);
+			return;
+		}
+		const ImWaveEvent event = { IM_WAVE_EVT_MARKER, voice->slot, voice->generation, 0, marker };
+		s_imWaveEvents.push(event);
+	}
+
+	void ImSetWaveMailbox(ImWaveSound* sound, ImWaveVoice* voice, s32 value)
 	{
-		assert(index < MAX_SOUND_CHANNELS);
-		return &s_imWaveData[index];
+		if (sound)
+		{
+			if (sound->mailbox == 0)
+			{
+				sound->mailbox = value;
+			}
+			return;
+		}
+		const ImWaveEvent event = { IM_WAVE_EVT_MAILBOX, voice->slot, voice->generation, value, nullptr };
+		s_imWaveEvents.push(event);
+	}
+
+	void ImProcessWaveEvents()
+	{
+		AUDIO_LOCK();
+		ImWaveEvent event;
+		while (s_imWaveEvents.pop(event))
+		{
+			ImWaveSound* sound = &s_imWaveSound[event.slot];
+			// Skip events for sounds that have been freed or restarted since.
+			if (!sound->soundId || sound->generation != event.generation)
+			{
+				continue;
+			}
+
+			switch (event.type)
+			{
+				case IM_WAVE_EVT_FINISHED:
+				{
+					ImFreeWaveSound(sound);
+				} break;
+				case IM_WAVE_EVT_MARKER:
+				{
+					ImSetSoundTrigger((ImSoundId)sound, (void*)event.marker);
+				} break;
+				case IM_WAVE_EVT_MAILBOX:
+				{
+					if (sound->mailbox == 0)
+					{
+						sound->mailbox = event.mailbox;
+					}
+				} break;
+			}
+		}
+		AUDIO_UNLOCK();
 	}
 
 	s32 ImComputeAudioNormalization(s32 waveMixCount)
@@ -270,6 +542,7 @@ namespace TFE_Jedi
 					}
 					sound->volume = ((sound->baseVolume + 1) * ImGetGroupVolume(value)) >> 7;
 					sound->group = value;
+					ImPostWaveParams(sound);
 					return imSuccess;
 				}
 				else if (param == soundPriority)
@@ -279,6 +552,7 @@ namespace TFE_Jedi
 						return imArgErr;
 					}
 					sound->priority = value;
+					ImPostWaveParams(sound);
 					return imSuccess;
 				}
 				else if (param == soundVol)
@@ -289,6 +563,7 @@ namespace TFE_Jedi
 					}
 					sound->baseVolume = value;
 					sound->volume = ((sound->baseVolume + 1) * ImGetGroupVolume(sound->group)) >> 7;
+					ImPostWaveParams(sound);
 					return imSuccess;
 				}
 				else if (param == soundPan)
@@ -298,6 +573,7 @@ namespace TFE_Jedi
 						return imArgErr;
 					}
 					sound->pan = value;
+					ImPostWaveParams(sound);
 					return imSuccess;
 				}
 				else if (param == soundDetune)
@@ -334,6 +610,19 @@ namespace TFE_Jedi
 		return imInvalidSound;
 	}
 
+	// Only the parameters used for mixing are sent to the audio thread.
+	void ImPostWaveParams(ImWaveSound* sound)
+	{
+		AudioThreadCommand command = {};
+		command.type = IM_WAVE_CMD_SET_PARAM;
+		command.slot = s32(sound - s_imWaveSound);
+		command.generation = sound->generation;
+		command.args[0] = sound->priority;
+		command.args[1] = sound->volume;
+		command.args[2] = sound->pan;
+		TFE_Audio::postAudioThreadCommand(command);
+	}
+
 	s32 ImGetWaveParamIntern(ImSoundId soundId, s32 param)
 	{
 		s32 soundCount = 0;
@@ -384,7 +673,8 @@ namespace TFE_Jedi
 				}
 				else if (param == waveStreamFlag)
 				{
-					return sound->data ? 1 : 0;
+					// Wave sounds always play from their sound data.
+					return 1;
 				}
 				else
 				{
@@ -400,7 +690,8 @@ namespace TFE_Jedi
 	{
 		ImWaveSound* sound = s_imWaveSound;
 		ImWaveSound* newSound = nullptr;
-		for (s32 i = 0; i < s_imWaveMixCount; i++, sound++)
+		// Sounds past the mix count become virtual voices, so only steal once all of the voices are in use.
+		for (s32 i = 0; i < MAX_WAVE_VOICES; i++, sound++)
 		{
 			if (!sound->soundId)
 			{
@@ -444,12 +735,14 @@ namespace TFE_Jedi
 		return nullptr;
 	}
 
-	s32 ImSeekToNextChunk(ImWaveData* data)
+	// Called on the game and midi threads with 'sound' when the sound starts, and on the audio thread with 'voice' while it plays.
+	s32 ImSeekToNextChunk(ImWaveData* data, ImWaveSound* sound, ImWaveVoice* voice)
 	{
 		while (1)
 		{
-			u8* chunkData = s_imWaveChunkData;
-			u8* sndData = nullptr;
+			u8 chunkBuffer[48];
+			u8* chunkData = chunkBuffer;
+			const u8* sndData = nullptr;
 
 			if (data->chunkIndex)
 			{
@@ -465,14 +758,10 @@ namespace TFE_Jedi
 			}
 			else  // chunkIndex == 0
 			{
-				ImWaveSound* sound = data->sound;
-				sndData = ImInternalGetSoundData(sound->soundId);
+				sndData = data->sndData;
 				if (!sndData)
 				{
-					if (sound->mailbox == 0)
-					{
-						sound->mailbox = 8;
-					}
+					ImSetWaveMailbox(sound, voice, 8);
 					IM_LOG_ERR("%s", "null sound addr in SeekToNextChunk()...");
 					return imFail;
 				}
@@ -497,11 +786,7 @@ namespace TFE_Jedi
 				data->chunkSize = chunkSize;
 				if (chunkSize > 220000)
 				{
-					ImWaveSound* sound = data->sound;
-					if (sound->mailbox == 0)
-					{
-						sound->mailbox = 9;
-					}
+					ImSetWaveMailbox(sound, voice, 9);
 				}
 
 				data->offset += (id == 1) ? 6 : 4;
@@ -514,8 +799,8 @@ namespace TFE_Jedi
 			}
 			else if (id == 4)
 			{
-				chunkData += 3;
-				ImSetSoundTrigger((ImSoundId)data->sound, chunkData);
+				// Pass the marker in the sound data rather than chunkBuffer, it may be handled after this returns.
+				ImSetWaveMarker(sound, voice, sndData + data->offset + 4);
 				data->offset += 6;
 			}
 			else if (id == 6)
@@ -541,7 +826,7 @@ namespace TFE_Jedi
 			{
 				if (chunkData[0] != 'r' || chunkData[1] != 'e' || chunkData[2] != 'a')
 				{
-					IM_LOG_ERR("ERR: Not a valid VOC sound %lu...", data->sound->soundId);
+					IM_LOG_ERR("ERR: Not a valid VOC sound %lu...", data->soundId);
 					return imFail;
 				}
 				data->offset += 26;
@@ -556,7 +841,7 @@ namespace TFE_Jedi
 				// dont warn on silence (3) and ascii text (5)
 				if ((id != 3) && (id != 5))
 				{
-					IM_LOG_ERR("ERR: Illegal chunk %d in sound %lu...", id, data->sound->soundId);
+					IM_LOG_ERR("ERR: Illegal chunk %d in sound %lu...", id, data->soundId);
 				}
 				return imFail;
 			}
@@ -564,9 +849,10 @@ namespace TFE_Jedi
 		return imSuccess;
 	}
 
-	s32 ImWaveSetupSoundData(ImWaveSound* sound, s32 chunkIndex)
+	s32 ImWaveSetupSoundData(ImWaveData* data, ImWaveSound* sound, s32 chunkIndex)
 	{
-		ImWaveData* data = sound->data;
+		data->sndData = ImInternalGetSoundData(sound->soundId);
+		data->soundId = sound->soundId;
 		data->offset = 0;
 		data->chunkSize = 0;
 		data->baseOffset = 0;
@@ -578,7 +864,7 @@ namespace TFE_Jedi
 		}
 
 		data->chunkIndex = 0;
-		return ImSeekToNextChunk(data);
+		return ImSeekToNextChunk(data, sound, nullptr);
 	}
 
 	s32 ImStartDigitalSoundIntern(ImSoundId soundId, s32 priority, s32 chunkIndex)
@@ -591,6 +877,7 @@ namespace TFE_Jedi
 		}
 
 		sound->soundId = soundId;
+		sound->generation++;
 		sound->marker = 0;
 		sound->group = 0;
 		sound->priority = priority;
@@ -601,23 +888,44 @@ namespace TFE_Jedi
 		sound->transpose = 0;
 		sound->detuneTrans = 0;
 		sound->mailbox = 0;
-		if (ImWaveSetupSoundData(sound, chunkIndex) != imSuccess)
+		ImWaveData data;
+		if (ImWaveSetupSoundData(&data, sound, chunkIndex) != imSuccess)
 		{
 			IM_LOG_ERR("Failed to setup wave player data - soundId: 0x%x, priority: %d", soundId, priority);
 			ImFreeWaveSound(sound);
 			return imFail;
 		}
 
+		s32 res = imSuccess;
 		AUDIO_LOCK();
 		{
 			IM_LIST_ADD(s_imWaveSoundList, sound);
+
+			AudioThreadCommand command = {};
+			command.type = IM_WAVE_CMD_START;
+			command.slot = s32(sound - s_imWaveSound);
+			command.generation = sound->generation;
+			command.args[0] = sound->priority;
+			command.args[1] = sound->volume;
+			command.args[2] = sound->pan;
+			command.args[3] = data.offset;
+			command.args[4] = data.chunkSize;
+			command.args[5] = data.baseOffset;
+			command.id = soundId;
+			command.data = data.sndData;
+			// The sound would never play or finish.
+			if (!TFE_Audio::postAudioThreadCommand(command))
+			{
+				ImFreeWaveSound(sound);
+				res = imFail;
+			}
 		}
 		AUDIO_UNLOCK();
 
-		return imSuccess;
+		return res;
 	}
 
-	void ImFreeWaveSound(ImWaveSound* sound)
+	void ImReleaseWaveSound(ImWaveSound* sound)
 	{
 		IM_LIST_REM(s_imWaveSoundList, sound);
 		ImClearSoundFaders(sound->soundId, -1);
@@ -625,6 +933,17 @@ namespace TFE_Jedi
 		sound->soundId = IM_NULL_SOUNDID;
 	}
 
+	void ImFreeWaveSound(ImWaveSound* sound)
+	{
+		ImReleaseWaveSound(sound);
+
+		AudioThreadCommand command = {};
+		command.type = IM_WAVE_CMD_FREE;
+		command.slot = s32(sound - s_imWaveSound);
+		command.generation = sound->generation;
+		TFE_Audio::postAudioThreadCommand(command);
+	}
+
 	s32 ImFreeWaveSoundById(ImSoundId soundId)
 	{
 		return ImFreeWaveSoundByIdIntern(soundId);
@@ -638,9 +957,13 @@ namespace TFE_Jedi
 			while (sound)
 			{
 				ImWaveSound* next = sound->next;
-				ImFreeWaveSound(sound);
+				ImReleaseWaveSound(sound);
 				sound = next;
 			}
+
+			AudioThreadCommand command = {};
+			command.type = IM_WAVE_CMD_FREE_ALL;
+			TFE_Audio::postAudioThreadCommand(command);
 		}
 		AUDIO_UNLOCK();
 		return imSuccess;
@@ -677,7 +1000,8 @@ namespace TFE_Jedi
 		}
 	}
 
-	void audioProcessFrame(u8* audioFrame, s32 size, s32 outOffset, s32 vol, s32 pan)
+	// Calculate the volume level (0 - 16) of each channel based on the volume and pan.
+	void audioGetChannelVolumes(s32 vol, s32 pan, s32* leftVolume, s32* rightVolume)
 	{
 		s32 vTop = vol >> 3;
 		if (vol)
@@ -696,8 +1020,21 @@ namespace TFE_Jedi
 		}
 		
 		// Calculate where the in panVolume mapping channel to read from for each channel.
-		s32 leftVolume  = s_audioPanVolumeTable[8 - panTop + vTop*17];
-		s32 rightVolume = s_audioPanVolumeTable[8 + panTop + vTop*17];
+		*leftVolume  = s_audioPanVolumeTable[8 - panTop + vTop*17];
+		*rightVolume = s_audioPanVolumeTable[8 + panTop + vTop*17];
+	}
+
+	s32 ImGetWaveAudibleLevel(ImWaveVoice* sound)
+	{
+		s32 leftVolume, rightVolume;
+		audioGetChannelVolumes(sound->volume, sound->pan, &leftVolume, &rightVolume);
+		return max(leftVolume, rightVolume);
+	}
+
+	void audioProcessFrame(const u8* audioFrame, s32 size, s32 outOffset, s32 vol, s32 pan)
+	{
+		s32 leftVolume, rightVolume;
+		audioGetChannelVolumes(vol, pan, &leftVolume, &rightVolume);
 		// Map [0,255] sample values to signed output values based on volume.
 		const s8* leftMapping  = (s8*)&s_audioVolumeToSignedMapping[leftVolume  << 8];
 		const s8* rightMapping = (s8*)&s_audioVolumeToSignedMapping[rightVolume << 8];
@@ -705,9 +1042,10 @@ namespace TFE_Jedi
 		digitalAudioOutput_Stereo(&s_audioOut[outOffset * 2], audioFrame, leftMapping, rightMapping, size);
 	}
 
-	s32 audioPlaySoundFrame(ImWaveSound* sound)
+	// Play the next frame of the sound, if 'mix' is false the sound is advanced without being mixed.
+	s32 audioPlaySoundFrame(ImWaveVoice* sound, bool mix)
 	{
-		ImWaveData* data = sound->data;
+		ImWaveData* data = &sound->data;
 		s32 bufferSize = s_audioOutSize;
 		s32 offset = 0;
 		s32 res = imSuccess;
@@ -716,12 +1054,12 @@ namespace TFE_Jedi
 			res = imSuccess;
 			if (!data->chunkSize)
 			{
-				res = ImSeekToNextChunk(data);
+				res = ImSeekToNextChunk(data, nullptr, sound);
 				if (res != imSuccess)
 				{
 					if (res == imFail)  // Sound has finished playing.
 					{
-						ImFreeWaveSound(sound);
+						ImFinishWaveVoice(sound);
 					}
 					break;
 				}
@@ -731,8 +1069,11 @@ namespace TFE_Jedi
 			// This is required since the results might be interpolated on upsample.
 			const s32 baseReadSize = min(bufferSize, data->chunkSize);
 			const s32 readSize = min(bufferSize+IM_AUDIO_OVERSAMPLE, data->chunkSize);
-			s_audioData = ImInternalGetSoundData(sound->soundId) + data->offset;
-			audioProcessFrame(s_audioData, readSize, offset, sound->volume, sound->pan);
+			if (mix)
+			{
+				s_audioData = data->sndData + data->offset;
+				audioProcessFrame(s_audioData, readSize, offset, sound->volume, sound->pan);
+			}
 
 			offset += baseReadSize;
 			bufferSize -= baseReadSize;
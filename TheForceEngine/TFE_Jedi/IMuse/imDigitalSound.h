@@ -33,6 +33,8 @@ namespace TFE_Jedi
 	s32 ImGetWaveParam(ImSoundId soundId, s32 param);
 	s32 ImStartDigitalSound(ImSoundId soundId, s32 priority);
 	void ImUpdateWave(f32* buffer, u32 bufferSize, f32 systemVolume);
+	// Handle the finished sounds, markers and mailbox values posted by the audio thread.
+	void ImProcessWaveEvents();
 
 	s32 ImFreeWaveSoundById(ImSoundId soundId);
 	s32 ImFreeAllWaveSounds();
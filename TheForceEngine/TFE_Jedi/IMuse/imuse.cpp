@@ -650,6 +650,7 @@ namespace TFE_Jedi
 
 		// Update Midi and Audio
 		ImUpdateMidi();
+		ImProcessWaveEvents();
 		if (s_imPause)
 		{
 			return;
@@ -52,6 +52,7 @@ namespace TFE_Jedi
 
 		s_levelState.controlSector = (RSector*)level_alloc(sizeof(RSector));
 		sector_clear(s_levelState.controlSector);
+		sector_invalidateGrid();
 
 		objData_clear();
 	}
@@ -1,5 +1,7 @@
 #include <climits>
 #include <cstring>
+#include <algorithm>
+#include <vector>
 
 #include "rsector.h"
 #include "rwall.h"
@@ -34,6 +36,39 @@ namespace TFE_Jedi
 	void sector_moveObjects(RSector* sector, u32 flags, fixed16_16 offsetX, fixed16_16 offsetZ);
 
 	f32 isLeft(Vec2f p0, Vec2f p1, Vec2f p2);
+
+	// Sector Grid
+	enum SectorGridConst
+	{
+		SECTOR_GRID_MAX_DIM  = 256,
+		SECTOR_GRID_MIN_CELL = 4 * ONE_16,
+	};
+
+	struct SectorGridRect
+	{
+		s32 x0, z0;
+		s32 x1, z1;
+	};
+
+	struct SectorGrid
+	{
+		JBool valid;
+		RSector* sectors;
+		u32 sectorCount;
+
+		fixed16_16 originX;
+		fixed16_16 originZ;
+		fixed16_16 cellSize;
+		s32 width;
+		s32 height;
+
+		std::vector<std::vector<u32>> cells;	// sector indices overlapping each cell, in ascending order.
+		std::vector<SectorGridRect> rects;		// cells currently covered by each sector.
+	};
+	static SectorGrid s_sectorGrid = {};
+
+	static void sectorGrid_update(RSector* sector);
+	static const u32* sectorGrid_getCandidates(fixed16_16 x, fixed16_16 z, s32* count);
 	
 	/////////////////////////////////////////////////
 	// API Implementation
@@ -213,6 +248,7 @@ namespace TFE_Jedi
 		sector->boundsMax.x = maxX;
 		sector->boundsMin.z = minZ;
 		sector->boundsMax.z = maxZ;
+		sectorGrid_update(sector);
 	}
 
 	fixed16_16 sector_getMaxObjectHeight(RSector* sector)
@@ -514,13 +550,16 @@ namespace TFE_Jedi
 		fixed16_16 iz = dz;
 		fixed16_16 y = dy;
 		
-		RSector* sector = s_levelState.sectors;
 		RSector* foundSector = nullptr;
 		s32 sectorUnitArea = 0;
 		s32 prevSectorUnitArea = INT_MAX;
 
-		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		// TFE: Only the sectors overlapping the grid cell are tested, in the same order as the original full scan.
+		s32 candidateCount;
+		const u32* candidates = sectorGrid_getCandidates(ix, iz, &candidateCount);
+		for (s32 i = 0; i < candidateCount; i++)
 		{
+			RSector* sector = &s_levelState.sectors[candidates[i]];
 			if (y >= sector->ceilingHeight && y <= sector->floorHeight)
 			{
 				const fixed16_16 sectorMaxX = sector->boundsMax.x;
@@ -553,13 +592,15 @@ namespace TFE_Jedi
 		fixed16_16 ix = dx;
 		fixed16_16 iz = dz;
 
-		RSector* sector = s_levelState.sectors;
 		RSector* foundSector = nullptr;
 		s32 sectorUnitArea = 0;
 		s32 prevSectorUnitArea = INT_MAX;
 
-		for (u32 i = 0; i < s_levelState.sectorCount; i++, sector++)
+		s32 candidateCount;
+		const u32* candidates = sectorGrid_getCandidates(ix, iz, &candidateCount);
+		for (s32 i = 0; i < candidateCount; i++)
 		{
+			RSector* sector = &s_levelState.sectors[candidates[i]];
 			if (sector->layer == layer)
 			{
 				const fixed16_16 sectorMaxX = sector->boundsMax.x;
@@ -587,6 +628,140 @@ namespace TFE_Jedi
 		return foundSector;
 	}
 
+	/////////////////////////////////////////////////
+	// Sector Grid
+	// TFE: Uniform 2D grid over the sector bounds used by the point queries above.
+	// Each cell lists every sector whose bounds overlap it in sector index order,
+	// so testing a single cell returns exactly the same sector as the full scan.
+	// Positions outside of the grid are clamped to the border cells, which also
+	// hold any sector that has grown past the original level bounds.
+	/////////////////////////////////////////////////
+	void sector_invalidateGrid()
+	{
+		s_sectorGrid.valid = JFALSE;
+	}
+
+	static s32 sectorGrid_cellCoord(fixed16_16 value, fixed16_16 origin, s32 count)
+	{
+		const s64 offset = s64(value) - s64(origin);
+		if (offset <= 0) { return 0; }
+		return s32(std::min(offset / s64(s_sectorGrid.cellSize), s64(count - 1)));
+	}
+
+	static SectorGridRect sectorGrid_getRect(const RSector* sector)
+	{
+		SectorGridRect rect;
+		rect.x0 = sectorGrid_cellCoord(sector->boundsMin.x, s_sectorGrid.originX, s_sectorGrid.width);
+		rect.z0 = sectorGrid_cellCoord(sector->boundsMin.z, s_sectorGrid.originZ, s_sectorGrid.height);
+		rect.x1 = sectorGrid_cellCoord(sector->boundsMax.x, s_sectorGrid.originX, s_sectorGrid.width);
+		rect.z1 = sectorGrid_cellCoord(sector->boundsMax.z, s_sectorGrid.originZ, s_sectorGrid.height);
+		return rect;
+	}
+
+	static void sectorGrid_insert(u32 index, const SectorGridRect& rect)
+	{
+		for (s32 z = rect.z0; z <= rect.z1; z++)
+		{
+			for (s32 x = rect.x0; x <= rect.x1; x++)
+			{
+				std::vector<u32>& cell = s_sectorGrid.cells[z * s_sectorGrid.width + x];
+				cell.insert(std::lower_bound(cell.begin(), cell.end(), index), index);
+			}
+		}
+	}
+
+	static void sectorGrid_remove(u32 index, const SectorGridRect& rect)
+	{
+		for (s32 z = rect.z0; z <= rect.z1; z++)
+		{
+			for (s32 x = rect.x0; x <= rect.x1; x++)
+			{
+				std::vector<u32>& cell = s_sectorGrid.cells[z * s_sectorGrid.width + x];
+				std::vector<u32>::iterator iter = std::lower_bound(cell.begin(), cell.end(), index);
+				if (iter != cell.end() && *iter == index)
+				{
+					cell.erase(iter);
+				}
+			}
+		}
+	}
+
+	static void sectorGrid_build()
+	{
+		const u32 sectorCount = s_levelState.sectorCount;
+		s_sectorGrid.sectors = s_levelState.sectors;
+		s_sectorGrid.sectorCount = sectorCount;
+		s_sectorGrid.valid = JTRUE;
+
+		fixed16_16 minX = INT_MAX, minZ = INT_MAX;
+		fixed16_16 maxX = INT_MIN, maxZ = INT_MIN;
+		RSector* sector = s_levelState.sectors;
+		for (u32 i = 0; i < sectorCount; i++, sector++)
+		{
+			if (sector->boundsMin.x > sector->boundsMax.x || sector->boundsMin.z > sector->boundsMax.z) { continue; }
+			minX = min(minX, sector->boundsMin.x);
+			minZ = min(minZ, sector->boundsMin.z);
+			maxX = max(maxX, sector->boundsMax.x);
+			maxZ = max(maxZ, sector->boundsMax.z);
+		}
+		if (minX > maxX)
+		{
+			minX = maxX = 0;
+			minZ = maxZ = 0;
+		}
+
+		// Aim for roughly one sector per cell along the longest axis.
+		const s64 extent = std::max(s64(maxX) - s64(minX), s64(maxZ) - s64(minZ)) + 1;
+		s32 dim = 1;
+		while (dim * dim < (s32)sectorCount && dim < SECTOR_GRID_MAX_DIM) { dim++; }
+		s_sectorGrid.cellSize = fixed16_16(std::max(extent / dim + 1, s64(SECTOR_GRID_MIN_CELL)));
+		s_sectorGrid.originX = minX;
+		s_sectorGrid.originZ = minZ;
+		s_sectorGrid.width  = s32((s64(maxX) - s64(minX)) / s_sectorGrid.cellSize) + 1;
+		s_sectorGrid.height = s32((s64(maxZ) - s64(minZ)) / s_sectorGrid.cellSize) + 1;
+
+		s_sectorGrid.cells.clear();
+		s_sectorGrid.cells.resize(s_sectorGrid.width * s_sectorGrid.height);
+		s_sectorGrid.rects.resize(sectorCount);
+
+		sector = s_levelState.sectors;
+		for (u32 i = 0; i < sectorCount; i++, sector++)
+		{
+			s_sectorGrid.rects[i] = sectorGrid_getRect(sector);
+			sectorGrid_insert(i, s_sectorGrid.rects[i]);
+		}
+	}
+
+	// Keep the grid in sync when INF moves or rotates walls, this is a no-op until the grid is built.
+	static void sectorGrid_update(RSector* sector)
+	{
+		if (!s_sectorGrid.valid || s_sectorGrid.sectors != s_levelState.sectors) { return; }
+		const s64 index = s64(sector - s_levelState.sectors);
+		if (index < 0 || index >= s64(s_sectorGrid.sectorCount)) { return; }
+
+		const SectorGridRect rect = sectorGrid_getRect(sector);
+		SectorGridRect& prevRect = s_sectorGrid.rects[index];
+		if (rect.x0 == prevRect.x0 && rect.z0 == prevRect.z0 && rect.x1 == prevRect.x1 && rect.z1 == prevRect.z1) { return; }
+
+		sectorGrid_remove(u32(index), prevRect);
+		sectorGrid_insert(u32(index), rect);
+		prevRect = rect;
+	}
+
+	static const u32* sectorGrid_getCandidates(fixed16_16 x, fixed16_16 z, s32* count)
+	{
+		if (!s_sectorGrid.valid || s_sectorGrid.sectors != s_levelState.sectors || s_sectorGrid.sectorCount != s_levelState.sectorCount)
+		{
+			sectorGrid_build();
+		}
+
+		const s32 cx = sectorGrid_cellCoord(x, s_sectorGrid.originX, s_sectorGrid.width);
+		const s32 cz = sectorGrid_cellCoord(z, s_sectorGrid.originZ, s_sectorGrid.height);
+		const std::vector<u32>& cell = s_sectorGrid.cells[cz * s_sectorGrid.width + cx];
+		*count = (s32)cell.size();
+		return cell.data();
+	}
+
 	enum PointSegSide
 	{
 		PS_INSIDE = -1,
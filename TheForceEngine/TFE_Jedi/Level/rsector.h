@@ -156,6 +156,8 @@ namespace TFE_Jedi
 	
 	RSector* sector_which3D(fixed16_16 dx, fixed16_16 dy, fixed16_16 dz);
 	RSector* sector_which3D_Map(fixed16_16 dx, fixed16_16 dz, s32 layer);
+	// TFE: The point queries use a grid over the sector bounds, rebuilt on the next query after the level data is cleared.
+	void sector_invalidateGrid();
 	bool sector_pointInside(RSector* sector, fixed16_16 x, fixed16_16 z);
 	JBool sector_pointInsideDF(RSector* sector, fixed16_16 x, fixed16_16 z);
 
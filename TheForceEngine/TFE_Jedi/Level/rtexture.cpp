@@ -333,21 +333,27 @@ namespace TFE_Jedi
 			return nullptr;
 		}
 
-		FileStream file;
-		if (!file.open(&filepath, Stream::MODE_READ))
+		// Parse directly from the archive when possible, the data is only read.
+		size_t size = 0;
+		const u8* data = FileStream::getDirectContents(&filepath, &size);
+		if (!data)
 		{
-			return nullptr;
-		}
+			FileStream file;
+			if (!file.open(&filepath, Stream::MODE_READ))
+			{
+				return nullptr;
+			}
 
-		size_t size = file.getSize();
-		s_buffer.resize(size);
-		file.readBuffer(s_buffer.data(), (u32)size);
-		file.close();
+			size = file.getSize();
+			s_buffer.resize(size);
+			file.readBuffer(s_buffer.data(), (u32)size);
+			file.close();
+			data = s_buffer.data();
+		}
 
 		TextureData* texture = (TextureData*)region_alloc(s_texState.memoryRegion, sizeof(TextureData));
 		memset(texture, 0, sizeof(TextureData));
 
-		const u8* data = s_buffer.data();
 		const u8* end = data + size;
 		const u8* fheader = data;
 		data += 3;
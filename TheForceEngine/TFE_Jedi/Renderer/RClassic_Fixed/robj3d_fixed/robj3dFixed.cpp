@@ -15,8 +15,8 @@
 namespace TFE_Jedi
 {
 
-extern s32 s_drawnObjCount;
-extern SecObject* s_drawnObj[];
+extern thread_local s32 s_drawnObjCount;
+extern thread_local SecObject* s_drawnObj[];
 
 namespace RClassic_Fixed
 {
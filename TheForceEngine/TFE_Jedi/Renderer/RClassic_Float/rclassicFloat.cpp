@@ -201,7 +201,13 @@ namespace RClassic_Float
 		s_rcfltState.skyTable = nullptr;
 
 		free(s_rcfltState.adjoinEdgeList);
+		free(s_rcfltState.flatEdgeList);
+		free(s_rcfltState.wallSegListDst);
+		free(s_rcfltState.wallSegListSrc);
 		s_rcfltState.adjoinEdgeList = nullptr;
+		s_rcfltState.flatEdgeList = nullptr;
+		s_rcfltState.wallSegListDst = nullptr;
+		s_rcfltState.wallSegListSrc = nullptr;
 	}
 
 	void buildProjectionTables(s32 xc, s32 yc, s32 w, s32 h)
@@ -213,6 +219,15 @@ namespace RClassic_Float
 		setupProjectionParameters(f32(halfWidth), xc, yc);
 		setWidthFraction(1.0f);
 
+		if (!s_rcfltState.flatEdgeList)
+		{
+			s_rcfltState.flatEdgeList   = (EdgePairFloat*)malloc(sizeof(EdgePairFloat) * MAX_SEG_EXT);
+			s_rcfltState.wallSegListDst = (RWallSegmentFloat*)malloc(sizeof(RWallSegmentFloat) * MAX_SEG_EXT);
+			s_rcfltState.wallSegListSrc = (RWallSegmentFloat*)malloc(sizeof(RWallSegmentFloat) * MAX_SEG_EXT);
+		}
+		s_rcfltState.stripX0 = s_minScreenX_Pixels;
+		s_rcfltState.stripX1 = s_maxScreenX_Pixels;
+
 		EdgePairFloat* flatEdge = &s_rcfltState.flatEdgeList[s_flatCount];
 		s_rcfltState.flatEdge = flatEdge;
 		flat_addEdges(s_screenWidth, s_minScreenX_Pixels, 0, s_rcfltState.windowMaxY, 0, s_rcfltState.windowMinY);
@@ -52,15 +52,21 @@ namespace TFE_Jedi
 		f32 windowMinY;
 		f32 windowMaxY;
 
+		// Strip, [stripX0, stripX1] is the inclusive range of screen columns written by the current thread.
+		s32 stripX0;
+		s32 stripX1;
+
 		// Flats
+		// Note: the lists are allocated separately (MAX_SEG_EXT entries) so the state itself stays small
+		// enough to be copied to each strip rendering thread.
 		EdgePairFloat* flatEdge;
-		EdgePairFloat  flatEdgeList[MAX_SEG_EXT];
+		EdgePairFloat* flatEdgeList;
 		EdgePairFloat* adjoinEdge;
 		EdgePairFloat* adjoinEdgeList;
 
-		RWallSegmentFloat   wallSegListDst[MAX_SEG_EXT];
-		RWallSegmentFloat   wallSegListSrc[MAX_SEG_EXT];
+		RWallSegmentFloat*  wallSegListDst;
+		RWallSegmentFloat*  wallSegListSrc;
 		RWallSegmentFloat** adjoinSegment;
 	};
-	extern RClassicFloatState s_rcfltState;
+	extern thread_local RClassicFloatState s_rcfltState;
 }  // TFE_Jedi
\ No newline at end of file
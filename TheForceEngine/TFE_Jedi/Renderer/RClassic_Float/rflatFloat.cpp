@@ -6,6 +6,8 @@
 #include "redgePairFloat.h"
 #include "rclassicFloat.h"
 #include "rclassicFloatSharedState.h"
+#include "rstripRenderFloat.h"
+#include "rkernelsFloat.h"
 #include "fixedPoint20.h"
 #include "../rscanline.h"
 #include "../rsectorRender.h"
@@ -18,23 +20,23 @@ namespace TFE_Jedi
 
 namespace RClassic_Float
 {
-	static s32 s_scanlineX0;
-
-	static fixed44_20 s_scanlineU0;
-	static fixed44_20 s_scanlineV0;
-	static fixed44_20 s_scanline_dUdX;
-	static fixed44_20 s_scanline_dVdX;
-
-	static s32 s_scanlineWidth;
-	static const u8* s_scanlineLight;
-	static u8* s_scanlineOut;
-
-	static u8* s_ftexImage;
-	static s32 s_ftexDataEnd;
-	static s32 s_ftexHeight;
-	static s32 s_ftexWidthMask;
-	static s32 s_ftexHeightMask;
-	static s32 s_ftexHeightLog2;
+	static thread_local s32 s_scanlineX0;
+
+	static thread_local fixed44_20 s_scanlineU0;
+	static thread_local fixed44_20 s_scanlineV0;
+	static thread_local fixed44_20 s_scanline_dUdX;
+	static thread_local fixed44_20 s_scanline_dVdX;
+
+	static thread_local s32 s_scanlineWidth;
+	static thread_local const u8* s_scanlineLight;
+	static thread_local u8* s_scanlineOut;
+
+	static thread_local u8* s_ftexImage;
+	static thread_local s32 s_ftexDataEnd;
+	static thread_local s32 s_ftexHeight;
+	static thread_local s32 s_ftexWidthMask;
+	static thread_local s32 s_ftexHeightMask;
+	static thread_local s32 s_ftexHeightLog2;
 		
 	void flat_addEdges(s32 length, s32 x0, f32 dyFloor_dx, f32 yFloor, f32 dyCeil_dx, f32 yCeil)
 	{
@@ -78,73 +80,44 @@ namespace RClassic_Float
 	}
 				
 	// This produces functionally identical results to the original but splits apart the U/V and dUdx/dVdx into seperate variables
-	// to account for C vs ASM differences.
+	// to account for C vs ASM differences. The inner loops live in rkernelsFloat.cpp, which selects the SIMD version for the current CPU.
 	void drawScanline()
 	{
-		const fixed44_20 dVdX = s_scanline_dVdX;
-		const fixed44_20 dUdX = s_scanline_dUdX;
-		fixed44_20 V = s_scanlineV0;
-		fixed44_20 U = s_scanlineU0;
-
-		// Note this produces a distorted mapping if the texture is not 64x64.
-		// This behavior matches the original.
-		for (s32 i = s_scanlineWidth - 1; i >= 0; i--, U += dUdX, V += dVdX)
-		{
-			const u32 texel = ((floor20(U) & 63) * 64 + (floor20(V) & 63)) & s_ftexDataEnd;
-			s_scanlineOut[i] = s_scanlineLight[s_ftexImage[texel]];
-		}
+		s_drawKernels.scanline[KERNEL_LIT](s_scanlineOut, s_scanlineWidth, s_scanlineU0, s_scanlineV0, s_scanline_dUdX, s_scanline_dVdX, s_ftexImage, u32(s_ftexDataEnd), s_scanlineLight);
 	}
 
 	void drawScanline_Fullbright()
 	{
-		const fixed44_20 dVdX = s_scanline_dVdX;
-		const fixed44_20 dUdX = s_scanline_dUdX;
-		fixed44_20 V = s_scanlineV0;
-		fixed44_20 U = s_scanlineU0;
-
-		// Note this produces a distorted mapping if the texture is not 64x64.
-		// This behavior matches the original.
-		for (s32 i = s_scanlineWidth - 1; i >= 0; i--, U += dUdX, V += dVdX)
-		{
-			const u32 texel = ((floor20(U) & 63) * 64 + (floor20(V) & 63)) & s_ftexDataEnd;
-			s_scanlineOut[i] = s_ftexImage[texel];
-		}
+		s_drawKernels.scanline[KERNEL_FULLBRIGHT](s_scanlineOut, s_scanlineWidth, s_scanlineU0, s_scanlineV0, s_scanline_dUdX, s_scanline_dVdX, s_ftexImage, u32(s_ftexDataEnd), nullptr);
 	}
 
 	void drawScanline_Trans()
 	{
-		const fixed44_20 dVdX = s_scanline_dVdX;
-		const fixed44_20 dUdX = s_scanline_dUdX;
-		fixed44_20 V = s_scanlineV0;
-		fixed44_20 U = s_scanlineU0;
-
-		// Note this produces a distorted mapping if the texture is not 64x64.
-		// This behavior matches the original.
-		for (s32 i = s_scanlineWidth - 1; i >= 0; i--, U += dUdX, V += dVdX)
-		{
-			const u32 texel = ((floor20(U) & 63) * 64 + (floor20(V) & 63)) & s_ftexDataEnd;
-			const u8 baseColor = s_ftexImage[texel];
-
-			if (baseColor) { s_scanlineOut[i] = s_scanlineLight[baseColor]; }
-		}
+		s_drawKernels.scanline[KERNEL_LIT_TRANS](s_scanlineOut, s_scanlineWidth, s_scanlineU0, s_scanlineV0, s_scanline_dUdX, s_scanline_dVdX, s_ftexImage, u32(s_ftexDataEnd), s_scanlineLight);
 	}
 
 	void drawScanline_Fullbright_Trans()
 	{
-		const fixed44_20 dVdX = s_scanline_dVdX;
-		const fixed44_20 dUdX = s_scanline_dUdX;
-		fixed44_20 V = s_scanlineV0;
-		fixed44_20 U = s_scanlineU0;
-
-		// Note this produces a distorted mapping if the texture is not 64x64.
-		// This behavior matches the original.
-		for (s32 i = s_scanlineWidth - 1; i >= 0; i--, U += dUdX, V += dVdX)
-		{
-			const u32 texel = ((floor20(U) & 63) * 64 + (floor20(V) & 63)) & s_ftexDataEnd;
-			const u8 baseColor = s_ftexImage[texel];
+		s_drawKernels.scanline[KERNEL_FULLBRIGHT_TRANS](s_scanlineOut, s_scanlineWidth, s_scanlineU0, s_scanlineV0, s_scanline_dUdX, s_scanline_dVdX, s_ftexImage, u32(s_ftexDataEnd), nullptr);
+	}
 
-			if (baseColor) { s_scanlineOut[i] = baseColor; }
-		}
+	// Clip the current scanline to the columns owned by this thread, returns false if nothing is left to draw.
+	// Scanlines are drawn from right to left, so U and V are advanced by the number of columns removed on the right;
+	// this is exact in fixed point and matches the unclipped scanline.
+	bool flat_clipScanlineToStrip()
+	{
+		const s32 x1 = s_scanlineX0 + s_scanlineWidth - 1;
+		const s32 clipX0 = max(s_scanlineX0, s_rcfltState.stripX0);
+		const s32 clipX1 = min(x1, s_rcfltState.stripX1);
+		if (clipX0 > clipX1) { return false; }
+
+		const s32 rightClip = x1 - clipX1;
+		s_scanlineU0 += rightClip * s_scanline_dUdX;
+		s_scanlineV0 += rightClip * s_scanline_dVdX;
+		s_scanlineOut += clipX0 - s_scanlineX0;
+		s_scanlineX0 = clipX0;
+		s_scanlineWidth = clipX1 - clipX0 + 1;
+		return true;
 	}
 			   
 	bool flat_setTexture(TextureData* tex)
@@ -211,7 +184,8 @@ namespace RClassic_Float
 					s_scanline_dVdX =  floatToFixed20(negSinRelCeil * worldTexelScaleAspect);
 					s_scanline_dUdX = -floatToFixed20(negCosRelCeil * worldTexelScaleAspect);
 					s_scanlineLight =  computeLighting(z, 0);
-					
+					if (!flat_clipScanlineToStrip()) { continue; }
+
 					if (s_scanlineLight)
 					{
 						drawScanline();
@@ -278,6 +252,7 @@ namespace RClassic_Float
 					s_scanline_dVdX =  floatToFixed20(negSinRelFloor * worldTexelScaleAspect);
 					s_scanline_dUdX = -floatToFixed20(negCosRelFloor * worldTexelScaleAspect);
 					s_scanlineLight = computeLighting(z, 0);
+					if (!flat_clipScanlineToStrip()) { continue; }
 
 					if (s_scanlineLight)
 					{
@@ -304,15 +279,15 @@ namespace RClassic_Float
 		drawScanline_Fullbright_Trans
 	};
 
-	static f32 s_poly_offsetX;
-	static f32 s_poly_offsetZ;
+	static thread_local f32 s_poly_offsetX;
+	static thread_local f32 s_poly_offsetZ;
 
-	static f32 s_poly_scaledHOffset;
-	static f32 s_poly_sinYawHOffset;
-	static f32 s_poly_cosYawHOffset;
+	static thread_local f32 s_poly_scaledHOffset;
+	static thread_local f32 s_poly_sinYawHOffset;
+	static thread_local f32 s_poly_cosYawHOffset;
 
-	static f32 s_poly_cosYawScaledHOffset;
-	static f32 s_poly_sinYawScaledHOffset;
+	static thread_local f32 s_poly_cosYawScaledHOffset;
+	static thread_local f32 s_poly_sinYawScaledHOffset;
 		
 	void flat_preparePolygon(f32 heightOffset, f32 offsetX, f32 offsetZ, TextureData* texture)
 	{
@@ -360,6 +335,8 @@ namespace RClassic_Float
 		s_scanline_dUdX =  floatToFixed20(s_poly_cosYawHOffset*worldTexelScaleAspect);
 
 		s_scanlineLight = computeLighting(z, 0);
+		if (!flat_clipScanlineToStrip()) { return; }
+
 		const s32 index = (!s_scanlineLight) + trans*2;
 		c_scanlineDrawFunc[index]();
 	}
@@ -0,0 +1,449 @@
+#include <cstring>
+
+#include <SDL_cpuinfo.h>
+#include <TFE_System/system.h>
+#include "rkernelsFloat.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define KERNELS_X86 1
+	#include <emmintrin.h>
+	#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+	#define KERNELS_NEON 1
+	#include <arm_neon.h>
+#endif
+
+// MSVC allows any instruction set to be used in a function, GCC and Clang have to be told per function
+// so that the rest of the code can still run on the baseline CPU.
+#if defined(KERNELS_X86) && !defined(_MSC_VER)
+	#define TARGET_SSE2 __attribute__((target("sse2")))
+	#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define TARGET_SSE2
+	#define TARGET_AVX2
+#endif
+
+namespace TFE_Jedi
+{
+
+namespace RClassic_Float
+{
+	static DrawKernelSet s_kernelSet = KERNELS_SCALAR;
+
+	static const char* c_kernelSetName[KERNELS_COUNT] =
+	{
+		"Scalar",	// KERNELS_SCALAR
+		"SSE2",		// KERNELS_SSE2
+		"AVX2",		// KERNELS_AVX2
+		"NEON",		// KERNELS_NEON
+	};
+
+	// Per-pixel output shared by every kernel, the vector code only computes the texel indices.
+	template<bool LIT, bool TRANS>
+	inline void writePixel(u8* dst, u8 c, const u8* light)
+	{
+		if (TRANS && !c) { return; }
+		*dst = LIT ? light[c] : c;
+	}
+
+	//////////////////////////////////////////////////////////////////////
+	// Scalar - this is the reference for all other versions.
+	//////////////////////////////////////////////////////////////////////
+	template<bool LIT, bool TRANS>
+	void column_scalar(u8* out, s32 stride, s32 count, fixed44_20 v, fixed44_20 dv, const u8* tex, s32 texMask, const u8* light)
+	{
+		const s32 end = count - 1;
+		s32 offset = end * stride;
+		for (s32 i = end; i >= 0; i--, offset -= stride, v += dv)
+		{
+			const s32 texel = floor20(v) & texMask;
+			writePixel<LIT, TRANS>(&out[offset], tex[texel], light);
+		}
+	}
+
+	// Note this produces a distorted mapping if the texture is not 64x64.
+	// This behavior matches the original.
+	template<bool LIT, bool TRANS>
+	void scanline_scalar(u8* out, s32 width, fixed44_20 u, fixed44_20 v, fixed44_20 du, fixed44_20 dv, const u8* tex, u32 texMask, const u8* light)
+	{
+		for (s32 i = width - 1; i >= 0; i--, u += du, v += dv)
+		{
+			const u32 texel = ((floor20(u) & 63) * 64 + (floor20(v) & 63)) & texMask;
+			writePixel<LIT, TRANS>(&out[i], tex[texel], light);
+		}
+	}
+
+	// Scalar kernels are used until kernels_init() is called.
+	DrawKernels s_drawKernels =
+	{
+		{ column_scalar<true, false>, column_scalar<false, false>, column_scalar<true, true>, column_scalar<false, true> },
+		{ scanline_scalar<true, false>, scanline_scalar<false, false>, scanline_scalar<true, true>, scanline_scalar<false, true> },
+	};
+
+	// The vector versions step 64-bit fixed point coordinates in parallel and only keep the low bits after the shift.
+	// Since the masks are always much smaller than 2^44, (x >> 20) & mask is the same for arithmetic and logical shifts,
+	// and stepping lane 'k' from v + k*dv by n*dv gives the same (wrapped) result as n sequential adds.
+
+#ifdef KERNELS_X86
+	//////////////////////////////////////////////////////////////////////
+	// SSE2 - 4 pixels per iteration.
+	//////////////////////////////////////////////////////////////////////
+	struct Step4_SSE2
+	{
+		__m128i lane01;
+		__m128i lane23;
+		__m128i step;
+	};
+
+	TARGET_SSE2 inline void step4_init(Step4_SSE2* s, fixed44_20 v, fixed44_20 dv)
+	{
+		s->lane01 = _mm_set_epi64x(v + dv, v);
+		s->lane23 = _mm_set_epi64x(v + 3*dv, v + 2*dv);
+		s->step   = _mm_set1_epi64x(4*dv);
+	}
+
+	// Returns (lane >> 20) & mask as 4 x 32-bit values and advances each lane.
+	TARGET_SSE2 inline __m128i step4_next(Step4_SSE2* s, __m128i mask)
+	{
+		const __m128i i01 = _mm_and_si128(_mm_srli_epi64(s->lane01, FRAC_BITS_20), mask);
+		const __m128i i23 = _mm_and_si128(_mm_srli_epi64(s->lane23, FRAC_BITS_20), mask);
+		s->lane01 = _mm_add_epi64(s->lane01, s->step);
+		s->lane23 = _mm_add_epi64(s->lane23, s->step);
+		return _mm_unpacklo_epi64(_mm_shuffle_epi32(i01, _MM_SHUFFLE(3, 1, 2, 0)), _mm_shuffle_epi32(i23, _MM_SHUFFLE(3, 1, 2, 0)));
+	}
+
+	template<bool LIT, bool TRANS>
+	TARGET_SSE2 void column_sse2(u8* out, s32 stride, s32 count, fixed44_20 v, fixed44_20 dv, const u8* tex, s32 texMask, const u8* light)
+	{
+		s32 i = 0;
+		s32 offset = (count - 1) * stride;
+		if (count >= 4)
+		{
+			Step4_SSE2 step;
+			step4_init(&step, v, dv);
+			const __m128i mask = _mm_set1_epi64x(texMask);
+
+			alignas(16) s32 texel[4];
+			for (; i <= count - 4; i += 4)
+			{
+				_mm_store_si128((__m128i*)texel, step4_next(&step, mask));
+				writePixel<LIT, TRANS>(&out[offset], tex[texel[0]], light); offset -= stride;
+				writePixel<LIT, TRANS>(&out[offset], tex[texel[1]], light); offset -= stride;
+				writePixel<LIT, TRANS>(&out[offset], tex[texel[2]], light); offset -= stride;
+				writePixel<LIT, TRANS>(&out[offset], tex[texel[3]], light); offset -= stride;
+			}
+			v += fixed44_20(i) * dv;
+		}
+		for (; i < count; i++, offset -= stride, v += dv)
+		{
+			writePixel<LIT, TRANS>(&out[offset], tex[floor20(v) & texMask], light);
+		}
+	}
+
+	template<bool LIT, bool TRANS>
+	TARGET_SSE2 void scanline_sse2(u8* out, s32 width, fixed44_20 u, fixed44_20 v, fixed44_20 du, fixed44_20 dv, const u8* tex, u32 texMask, const u8* light)
+	{
+		s32 i = width - 1;
+		if (width >= 4)
+		{
+			Step4_SSE2 stepU, stepV;
+			step4_init(&stepU, u, du);
+			step4_init(&stepV, v, dv);
+			const __m128i mask63 = _mm_set1_epi64x(63);
+			const __m128i mask = _mm_set1_epi32(s32(texMask));
+
+			alignas(16) u32 texel[4];
+			for (; i >= 3; i -= 4)
+			{
+				const __m128i tu = step4_next(&stepU, mask63);
+				const __m128i tv = step4_next(&stepV, mask63);
+				_mm_store_si128((__m128i*)texel, _mm_and_si128(_mm_or_si128(_mm_slli_epi32(tu, 6), tv), mask));
+
+				writePixel<LIT, TRANS>(&out[i],     tex[texel[0]], light);
+				writePixel<LIT, TRANS>(&out[i - 1], tex[texel[1]], light);
+				writePixel<LIT, TRANS>(&out[i - 2], tex[texel[2]], light);
+				writePixel<LIT, TRANS>(&out[i - 3], tex[texel[3]], light);
+			}
+			const fixed44_20 done = fixed44_20(width - 1 - i);
+			u += done * du;
+			v += done * dv;
+		}
+		for (; i >= 0; i--, u += du, v += dv)
+		{
+			const u32 texel = ((floor20(u) & 63) * 64 + (floor20(v) & 63)) & texMask;
+			writePixel<LIT, TRANS>(&out[i], tex[texel], light);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////
+	// AVX2 - 8 pixels per iteration.
+	//////////////////////////////////////////////////////////////////////
+	struct Step8_AVX2
+	{
+		__m256i lane0123;
+		__m256i lane4567;
+		__m256i step;
+	};
+
+	TARGET_AVX2 inline void step8_init(Step8_AVX2* s, fixed44_20 v, fixed44_20 dv)
+	{
+		s->lane0123 = _mm256_set_epi64x(v + 3*dv, v + 2*dv, v + dv, v);
+		s->lane4567 = _mm256_set_epi64x(v + 7*dv, v + 6*dv, v + 5*dv, v + 4*dv);
+		s->step     = _mm256_set1_epi64x(8*dv);
+	}
+
+	// Returns (lane >> 20) & mask as 8 x 32-bit values and advances each lane.
+	TARGET_AVX2 inline __m256i step8_next(Step8_AVX2* s, __m256i mask)
+	{
+		const __m256i lowDwords = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+		const __m256i i0123 = _mm256_permutevar8x32_epi32(_mm256_and_si256(_mm256_srli_epi64(s->lane0123, FRAC_BITS_20), mask), lowDwords);
+		const __m256i i4567 = _mm256_permutevar8x32_epi32(_mm256_and_si256(_mm256_srli_epi64(s->lane4567, FRAC_BITS_20), mask), lowDwords);
+		s->lane0123 = _mm256_add_epi64(s->lane0123, s->step);
+		s->lane4567 = _mm256_add_epi64(s->lane4567, s->step);
+		return _mm256_permute2x128_si256(i0123, i4567, 0x20);
+	}
+
+	template<bool LIT, bool TRANS>
+	TARGET_AVX2 void column_avx2(u8* out, s32 stride, s32 count, fixed44_20 v, fixed44_20 dv, const u8* tex, s32 texMask, const u8* light)
+	{
+		s32 i = 0;
+		s32 offset = (count - 1) * stride;
+		if (count >= 8)
+		{
+			Step8_AVX2 step;
+			step8_init(&step, v, dv);
+			const __m256i mask = _mm256_set1_epi64x(texMask);
+
+			alignas(32) s32 texel[8];
+			for (; i <= count - 8; i += 8)
+			{
+				_mm256_store_si256((__m256i*)texel, step8_next(&step, mask));
+				for (s32 k = 0; k < 8; k++, offset -= stride)
+				{
+					writePixel<LIT, TRANS>(&out[offset], tex[texel[k]], light);
+				}
+			}
+			v += fixed44_20(i) * dv;
+		}
+		for (; i < count; i++, offset -= stride, v += dv)
+		{
+			writePixel<LIT, TRANS>(&out[offset], tex[floor20(v) & texMask], light);
+		}
+	}
+
+	template<bool LIT, bool TRANS>
+	TARGET_AVX2 void scanline_avx2(u8* out, s32 width, fixed44_20 u, fixed44_20 v, fixed44_20 du, fixed44_20 dv, const u8* tex, u32 texMask, const u8* light)
+	{
+		s32 i = width - 1;
+		if (width >= 8)
+		{
+			Step8_AVX2 stepU, stepV;
+			step8_init(&stepU, u, du);
+			step8_init(&stepV, v, dv);
+			const __m256i mask63 = _mm256_set1_epi64x(63);
+			const __m256i mask = _mm256_set1_epi32(s32(texMask));
+
+			alignas(32) u32 texel[8];
+			for (; i >= 7; i -= 8)
+			{
+				const __m256i tu = step8_next(&stepU, mask63);
+				const __m256i tv = step8_next(&stepV, mask63);
+				_mm256_store_si256((__m256i*)texel, _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi32(tu, 6), tv), mask));
+				for (s32 k = 0; k < 8; k++)
+				{
+					writePixel<LIT, TRANS>(&out[i - k], tex[texel[k]], light);
+				}
+			}
+			const fixed44_20 done = fixed44_20(width - 1 - i);
+			u += done * du;
+			v += done * dv;
+		}
+		for (; i >= 0; i--, u += du, v += dv)
+		{
+			const u32 texel = ((floor20(u) & 63) * 64 + (floor20(v) & 63)) & texMask;
+			writePixel<LIT, TRANS>(&out[i], tex[texel], light);
+		}
+	}
+#endif  // KERNELS_X86
+
+#ifdef KERNELS_NEON
+	//////////////////////////////////////////////////////////////////////
+	// NEON - 4 pixels per iteration.
+	//////////////////////////////////////////////////////////////////////
+	struct Step4_NEON
+	{
+		int64x2_t lane01;
+		int64x2_t lane23;
+		int64x2_t step;
+	};
+
+	inline void step4_init(Step4_NEON* s, fixed44_20 v, fixed44_20 dv)
+	{
+		const s64 l01[] = { v, v + dv };
+		const s64 l23[] = { v + 2*dv, v + 3*dv };
+		s->lane01 = vld1q_s64(l01);
+		s->lane23 = vld1q_s64(l23);
+		s->step   = vdupq_n_s64(4*dv);
+	}
+
+	// Returns (lane >> 20) & mask as 4 x 32-bit values and advances each lane.
+	inline uint32x4_t step4_next(Step4_NEON* s, uint64x2_t mask)
+	{
+		const uint64x2_t i01 = vandq_u64(vshrq_n_u64(vreinterpretq_u64_s64(s->lane01), FRAC_BITS_20), mask);
+		const uint64x2_t i23 = vandq_u64(vshrq_n_u64(vreinterpretq_u64_s64(s->lane23), FRAC_BITS_20), mask);
+		s->lane01 = vaddq_s64(s->lane01, s->step);
+		s->lane23 = vaddq_s64(s->lane23, s->step);
+		return vcombine_u32(vmovn_u64(i01), vmovn_u64(i23));
+	}
+
+	template<bool LIT, bool TRANS>
+	void column_neon(u8* out, s32 stride, s32 count, fixed44_20 v, fixed44_20 dv, const u8* tex, s32 texMask, const u8* light)
+	{
+		s32 i = 0;
+		s32 offset = (count - 1) * stride;
+		if (count >= 4)
+		{
+			Step4_NEON step;
+			step4_init(&step, v, dv);
+			const uint64x2_t mask = vdupq_n_u64(u64(texMask));
+
+			u32 texel[4];
+			for (; i <= count - 4; i += 4)
+			{
+				vst1q_u32(texel, step4_next(&step, mask));
+				writePixel<LIT, TRANS>(&out[offset], tex[texel[0]], light); offset -= stride;
+				writePixel<LIT, TRANS>(&out[offset], tex[texel[1]], light); offset -= stride;
+				writePixel<LIT, TRANS>(&out[offset], tex[texel[2]], light); offset -= stride;
+				writePixel<LIT, TRANS>(&out[offset], tex[texel[3]], light); offset -= stride;
+			}
+			v += fixed44_20(i) * dv;
+		}
+		for (; i < count; i++, offset -= stride, v += dv)
+		{
+			writePixel<LIT, TRANS>(&out[offset], tex[floor20(v) & texMask], light);
+		}
+	}
+
+	template<bool LIT, bool TRANS>
+	void scanline_neon(u8* out, s32 width, fixed44_20 u, fixed44_20 v, fixed44_20 du, fixed44_20 dv, const u8* tex, u32 texMask, const u8* light)
+	{
+		s32 i = width - 1;
+		if (width >= 4)
+		{
+			Step4_NEON stepU, stepV;
+			step4_init(&stepU, u, du);
+			step4_init(&stepV, v, dv);
+			const uint64x2_t mask63 = vdupq_n_u64(63);
+			const uint32x4_t mask = vdupq_n_u32(texMask);
+
+			u32 texel[4];
+			for (; i >= 3; i -= 4)
+			{
+				const uint32x4_t tu = step4_next(&stepU, mask63);
+				const uint32x4_t tv = step4_next(&stepV, mask63);
+				vst1q_u32(texel, vandq_u32(vorrq_u32(vshlq_n_u32(tu, 6), tv), mask));
+
+				writePixel<LIT, TRANS>(&out[i],     tex[texel[0]], light);
+				writePixel<LIT, TRANS>(&out[i - 1], tex[texel[1]], light);
+				writePixel<LIT, TRANS>(&out[i - 2], tex[texel[2]], light);
+				writePixel<LIT, TRANS>(&out[i - 3], tex[texel[3]], light);
+			}
+			const fixed44_20 done = fixed44_20(width - 1 - i);
+			u += done * du;
+			v += done * dv;
+		}
+		for (; i >= 0; i--, u += du, v += dv)
+		{
+			const u32 texel = ((floor20(u) & 63) * 64 + (floor20(v) & 63)) & texMask;
+			writePixel<LIT, TRANS>(&out[i], tex[texel], light);
+		}
+	}
+#endif  // KERNELS_NEON
+
+	//////////////////////////////////////////////////////////////////////
+	// Selection
+	//////////////////////////////////////////////////////////////////////
+	#define SET_KERNELS(suffix) \
+		s_drawKernels.column[KERNEL_LIT]                = column_##suffix<true,  false>; \
+		s_drawKernels.column[KERNEL_FULLBRIGHT]         = column_##suffix<false, false>; \
+		s_drawKernels.column[KERNEL_LIT_TRANS]          = column_##suffix<true,  true>;  \
+		s_drawKernels.column[KERNEL_FULLBRIGHT_TRANS]   = column_##suffix<false, true>;  \
+		s_drawKernels.scanline[KERNEL_LIT]              = scanline_##suffix<true,  false>; \
+		s_drawKernels.scanline[KERNEL_FULLBRIGHT]       = scanline_##suffix<false, false>; \
+		s_drawKernels.scanline[KERNEL_LIT_TRANS]        = scanline_##suffix<true,  true>;  \
+		s_drawKernels.scanline[KERNEL_FULLBRIGHT_TRANS] = scanline_##suffix<false, true>
+
+	bool kernels_isSupported(DrawKernelSet set)
+	{
+		switch (set)
+		{
+			case KERNELS_SCALAR:
+				return true;
+		#ifdef KERNELS_X86
+			case KERNELS_SSE2:
+				return SDL_HasSSE2() == SDL_TRUE;
+			case KERNELS_AVX2:
+				return SDL_HasAVX2() == SDL_TRUE;
+		#endif
+		#ifdef KERNELS_NEON
+			case KERNELS_NEON:
+				return SDL_HasNEON() == SDL_TRUE;
+		#endif
+			default:
+				break;
+		}
+		return false;
+	}
+
+	bool kernels_select(DrawKernelSet set)
+	{
+		if (!kernels_isSupported(set)) { return false; }
+
+		switch (set)
+		{
+			case KERNELS_SCALAR:
+				SET_KERNELS(scalar);
+				break;
+		#ifdef KERNELS_X86
+			case KERNELS_SSE2:
+				SET_KERNELS(sse2);
+				break;
+			case KERNELS_AVX2:
+				SET_KERNELS(avx2);
+				break;
+		#endif
+		#ifdef KERNELS_NEON
+			case KERNELS_NEON:
+				SET_KERNELS(neon);
+				break;
+		#endif
+			default:
+				return false;
+		}
+		s_kernelSet = set;
+		return true;
+	}
+
+	void kernels_init()
+	{
+		const DrawKernelSet order[] = { KERNELS_AVX2, KERNELS_NEON, KERNELS_SSE2, KERNELS_SCALAR };
+		for (s32 i = 0; i < (s32)TFE_ARRAYSIZE(order); i++)
+		{
+			if (kernels_select(order[i])) { break; }
+		}
+		TFE_System::logWrite(LOG_MSG, "Renderer", "Software renderer kernels: %s", c_kernelSetName[s_kernelSet]);
+	}
+
+	DrawKernelSet kernels_getCurrent()
+	{
+		return s_kernelSet;
+	}
+
+	const char* kernels_getName(DrawKernelSet set)
+	{
+		if (set < 0 || set >= KERNELS_COUNT) { return "Invalid"; }
+		return c_kernelSetName[set];
+	}
+}  // RClassic_Float
+
+}  // TFE_Jedi
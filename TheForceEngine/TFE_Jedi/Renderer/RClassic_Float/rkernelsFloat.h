@@ -0,0 +1,56 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Inner loop kernels
+// Dark Forces Derived Renderer - wall column and flat scanline loops.
+//
+// The kernels are selected once at startup based on the CPU, every
+// version produces bit-identical output to the scalar code.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include "fixedPoint20.h"
+
+namespace TFE_Jedi
+{
+	namespace RClassic_Float
+	{
+		enum DrawKernelId
+		{
+			KERNEL_LIT = 0,
+			KERNEL_FULLBRIGHT,
+			KERNEL_LIT_TRANS,
+			KERNEL_FULLBRIGHT_TRANS,
+			KERNEL_COUNT
+		};
+
+		enum DrawKernelSet
+		{
+			KERNELS_SCALAR = 0,
+			KERNELS_SSE2,
+			KERNELS_AVX2,
+			KERNELS_NEON,
+			KERNELS_COUNT
+		};
+
+		// Draws 'count' pixels from the bottom of the column up, 'out' points at the top pixel.
+		// pixel(i) = tex[floor20(v + i*dv) & texMask], written to out[(count - 1 - i) * stride].
+		typedef void(*ColumnKernel)(u8* out, s32 stride, s32 count, fixed44_20 v, fixed44_20 dv, const u8* tex, s32 texMask, const u8* light);
+		// Draws 'width' pixels from right to left using the 64x64 flat texture mapping.
+		// pixel(i) = tex[((floor20(u) & 63) * 64 + (floor20(v) & 63)) & texMask], written to out[width - 1 - i].
+		typedef void(*ScanlineKernel)(u8* out, s32 width, fixed44_20 u, fixed44_20 v, fixed44_20 du, fixed44_20 dv, const u8* tex, u32 texMask, const u8* light);
+
+		struct DrawKernels
+		{
+			ColumnKernel   column[KERNEL_COUNT];
+			ScanlineKernel scanline[KERNEL_COUNT];
+		};
+		extern DrawKernels s_drawKernels;
+
+		// Select the fastest kernel set supported by the CPU.
+		void kernels_init();
+		// Force a specific kernel set, returns false if it is not supported (the current set is kept).
+		bool kernels_select(DrawKernelSet set);
+		bool kernels_isSupported(DrawKernelSet set);
+		DrawKernelSet kernels_getCurrent();
+		const char* kernels_getName(DrawKernelSet set);
+	}
+}  // TFE_Jedi
@@ -12,12 +12,13 @@
 #include "robj3dFloat_Clipping.h"
 #include "robj3dFloat_PolygonDraw.h"
 #include "../rclassicFloatSharedState.h"
+#include "../rstripRenderFloat.h"
 #include "../../rcommon.h"
 
 namespace TFE_Jedi
 {
-extern s32 s_drawnObjCount;
-extern SecObject* s_drawnObj[];
+extern thread_local s32 s_drawnObjCount;
+extern thread_local SecObject* s_drawnObj[];
 
 namespace RClassic_Float
 {
@@ -111,6 +112,7 @@ namespace RClassic_Float
 			{
 				const s32 x = clamp(pixel_x - halfSize + (i % size), s_minScreenX_Pixels, s_maxScreenX_Pixels);
 				const s32 y = clamp(pixel_y - halfSize + (i / size), s_windowMinY_Pixels, s_windowMaxY_Pixels);
+				if (!strip_ownsColumn(x)) { continue; }
 				s_display[y*s_width + x] = color;
 			}
 		}
@@ -132,7 +134,7 @@ namespace RClassic_Float
 	{
 		JmPolygon* p0 = *((JmPolygon**)r0);
 		JmPolygon* p1 = *((JmPolygon**)r1);
-		return signZero(p1->zAvef - p0->zAvef);
+		return signZero(s_polygonZAve[p1->index] - s_polygonZAve[p0->index]);
 	}
 
 }}  // TFE_Jedi
\ No newline at end of file
@@ -19,7 +19,10 @@ namespace RClassic_Float
 	};
 
 	// List of potentially visible polygons (after backface culling).
-	std::vector<JmPolygon*> s_visPolygons;
+	thread_local std::vector<JmPolygon*> s_visPolygons;
+	// Average view space depth of each visible polygon, indexed by polygon index.
+	// This is kept outside of the model so that several threads may draw the same model.
+	thread_local std::vector<f32> s_polygonZAve;
 
 	s32 getPolygonFacing(const vec3_float* normal, const vec3_float* pos)
 	{
@@ -43,6 +46,7 @@ namespace RClassic_Float
 		if (polygonCount > s_visPolygons.size())
 		{
 			s_visPolygons.resize(polygonCount * 2);
+			s_polygonZAve.resize(polygonCount * 2);
 		}
 
 		JmPolygon** visPolygon = s_visPolygons.data();
@@ -66,7 +70,7 @@ namespace RClassic_Float
 				zAve += s_verticesVS[indices[v]].z;
 			}
 
-			polygon->zAvef = zAve / f32(vertexCount);
+			s_polygonZAve[polygon->index] = zAve / f32(vertexCount);
 			*visPolygon = polygon;
 			visPolygon++;
 		}
@@ -10,7 +10,8 @@ namespace TFE_Jedi
 {
 	namespace RClassic_Float
 	{
-		extern std::vector<JmPolygon*> s_visPolygons;
+		extern thread_local std::vector<JmPolygon*> s_visPolygons;
+		extern thread_local std::vector<f32> s_polygonZAve;
 		s32 robj3d_backfaceCull(JediModel* model);
 	}
 }
@@ -376,7 +376,7 @@ void robj3d_drawFlatColorPolygon(vec3_float* projVertices, s32 vertexCount, u8 c
 			}
 
 			s_columnHeight = y0_Bot - y0_Top + 1;
-			if (s_columnHeight > 0)
+			if (s_columnHeight > 0 && strip_ownsColumn(s_columnX))
 			{
 				const f32 height = f32(s_edgeBotY0_Pixel - s_edgeTopY0_Pixel + 1);
 				s_pcolumnOut = &s_display[y0_Top*s_width + s_columnX];
@@ -17,6 +17,7 @@
 #include "rlightingFloat.h"
 #include "redgePairFloat.h"
 #include "rclassicFloatSharedState.h"
+#include "rstripRenderFloat.h"
 #include "robj3d_float/robj3dFloat.h"
 #include "../rcommon.h"
 
@@ -27,7 +28,7 @@ namespace TFE_Jedi
 {
 	namespace
 	{
-		static TFE_Sectors_Float* s_ctx = nullptr;
+		static thread_local TFE_Sectors_Float* s_ctx = nullptr;
 
 		s32 wallSortX(const void* r0, const void* r1)
 		{
@@ -169,12 +170,20 @@ namespace TFE_Jedi
 
 	void TFE_Sectors_Float::destroy()
 	{
+		if (!m_stripWorker)
+		{
+			strip_destroy();
+		}
 	}
 
 	void TFE_Sectors_Float::reset()
 	{
 		m_cachedSectors = nullptr;
 		m_cachedSectorCount = 0;
+		if (!m_stripWorker)
+		{
+			strip_reset();
+		}
 	}
 
 	void TFE_Sectors_Float::prepare()
@@ -200,6 +209,17 @@ namespace TFE_Jedi
 	}
 	
 	void TFE_Sectors_Float::draw(RSector* sector)
+	{
+		// TFE: Optionally split the view into vertical strips that are drawn in parallel.
+		if (strip_isEnabled())
+		{
+			strip_draw(this, sector);
+			return;
+		}
+		drawSector(sector);
+	}
+
+	void TFE_Sectors_Float::drawSector(RSector* sector)
 	{
 		s_ctx = this;
 		s_curSector = sector;
@@ -217,8 +237,9 @@ namespace TFE_Jedi
 
 		s_rcfltState.depth1d = &s_rcfltState.depth1d_all[(s_adjoinDepth - 1) * s_width];
 
-		s32 startWall = s_curSector->startWall;
-		s32 drawWallCount = s_curSector->drawWallCnt;
+		SectorCached* cachedSector = &m_cachedSectors[s_curSector->index];
+		s32 startWall = cachedSector->startWall;
+		s32 drawWallCount = cachedSector->drawWallCnt;
 
 		if (s_flatLighting)
 		{
@@ -242,13 +263,16 @@ namespace TFE_Jedi
 
 		s_wallMaxCeilY  = s_windowMinY_Pixels;
 		s_wallMinFloorY = s_windowMaxY_Pixels;
-		SectorCached* cachedSector = &m_cachedSectors[s_curSector->index];
 
-		if (s_drawFrame != s_curSector->prevDrawFrame)
+		if (s_drawFrame != cachedSector->prevDrawFrame)
 		{
-			TFE_ZONE_BEGIN(secUpdateCache, "Update Sector Cache");
-				updateCachedSector(cachedSector, s_curSector->dirtyFlags);
-			TFE_ZONE_END(secUpdateCache);
+			// Strip worker caches are updated on the main thread before drawing.
+			if (!m_stripWorker)
+			{
+				TFE_ZONE_BEGIN(secUpdateCache, "Update Sector Cache");
+					updateCachedSector(cachedSector, s_curSector->dirtyFlags);
+				TFE_ZONE_END(secUpdateCache);
+			}
 
 			TFE_ZONE_BEGIN(secXform, "Sector Vertex Transform");
 				vec2_fixed* vtxWS = s_curSector->verticesWS;
@@ -293,9 +317,9 @@ namespace TFE_Jedi
 				}
 				drawWallCount = s_nextWall - startWall;
 
-				s_curSector->startWall = startWall;
-				s_curSector->drawWallCnt = drawWallCount;
-				s_curSector->prevDrawFrame = s_drawFrame;
+				cachedSector->startWall = startWall;
+				cachedSector->drawWallCnt = drawWallCount;
+				cachedSector->prevDrawFrame = s_drawFrame;
 			TFE_ZONE_END(wallProcess);
 		}
 
@@ -442,7 +466,8 @@ namespace TFE_Jedi
 				prevAdjoinSeg = curAdjoinSeg;
 				curAdjoinSeg = *seg;
 
-				RWall* srcWall = curAdjoinSeg->srcWall->wall;
+				WallCached* srcWallCached = curAdjoinSeg->srcWall;
+				RWall* srcWall = srcWallCached->wall;
 				RWallSegmentFloat* nextAdjoin = (i < adjoinEnd) ? *(seg + 1) : nullptr;
 				RSector* nextSector = srcWall->nextSector;
 				if (s_adjoinDepth < s_maxAdjoinDepthRecursion && s_adjoinDepth < s_maxDepthCount)
@@ -457,7 +482,7 @@ namespace TFE_Jedi
 						s_maxAdjoinDepth = s_adjoinDepth;
 					}
 
-					srcWall->drawFrame = s_drawFrame;
+					srcWallCached->drawFrame = s_drawFrame;
 					s_windowTop = winTopNext;
 					s_windowBot = winBotNext;
 					if (prevAdjoinSeg != 0)
@@ -476,7 +501,7 @@ namespace TFE_Jedi
 					}
 
 					s_rcfltState.windowMinZ = min(curAdjoinSeg->z0, curAdjoinSeg->z1);
-					draw(nextSector);
+					drawSector(nextSector);
 					
 					if (s_adjoinDepth)
 					{
@@ -484,7 +509,7 @@ namespace TFE_Jedi
 						s_adjoinDepth--;
 						restoreValues(index);
 					}
-					srcWall->drawFrame = 0;
+					srcWallCached->drawFrame = 0;
 					if (srcWall->flags1 & WF1_ADJ_MID_TEX)
 					{
 						TFE_ZONE("Draw Transparent Walls");
@@ -494,7 +519,7 @@ namespace TFE_Jedi
 			}
 		}
 
-		if (!(s_curSector->flags1 & SEC_FLAGS1_SUBSECTOR) && depthPrev && s_drawFrame != s_prevSector->prevDrawFrame2)
+		if (!(s_curSector->flags1 & SEC_FLAGS1_SUBSECTOR) && depthPrev && s_drawFrame != m_cachedSectors[s_prevSector->index].prevDrawFrame2)
 		{
 			memcpy(&depthPrev[s_windowMinX_Pixels], &s_rcfltState.depth1d[s_windowMinX_Pixels], (s_windowMaxX_Pixels - s_windowMinX_Pixels + 1) * sizeof(f32));
 		}
@@ -557,8 +582,18 @@ namespace TFE_Jedi
 		}
 		TFE_ZONE_END(secDrawObjects);
 
-		s_curSector->flags1 |= SEC_FLAGS1_RENDERED;
-		s_curSector->prevDrawFrame2 = s_drawFrame;
+		if (m_stripWorker || m_deferRendered)
+		{
+			if (cachedSector->prevDrawFrame2 != s_drawFrame)
+			{
+				m_renderedSectors.push_back(s_curSector);
+			}
+		}
+		else
+		{
+			s_curSector->flags1 |= SEC_FLAGS1_RENDERED;
+		}
+		cachedSector->prevDrawFrame2 = s_drawFrame;
 	}
 		
 	void TFE_Sectors_Float::adjoin_setupAdjoinWindow(s32* winBot, s32* winBotNext, s32* winTop, s32* winTopNext, EdgePairFloat* adjoinEdges, s32 adjoinCount)
@@ -776,7 +811,11 @@ namespace TFE_Jedi
 		}
 
 		updateCachedWalls(cached, flags);
-		srcSector->dirtyFlags = 0;
+		// The main cache clears the flags once every strip worker cache has been updated.
+		if (!m_stripWorker)
+		{
+			srcSector->dirtyFlags = 0;
+		}
 	}
 
 	void TFE_Sectors_Float::allocateCachedData()
@@ -800,9 +839,42 @@ namespace TFE_Jedi
 		}
 	}
 
+	void TFE_Sectors_Float::updateStripCaches(TFE_Sectors_Float** workers, s32 workerCount)
+	{
+		for (s32 w = 0; w < workerCount; w++)
+		{
+			workers[w]->allocateCachedData();
+		}
+
+		// Sector changes are applied to every cache here, so the worker threads only read shared sector data.
+		for (u32 i = 0; i < m_cachedSectorCount; i++)
+		{
+			RSector* sector = &s_levelState.sectors[i];
+			const u32 flags = sector->dirtyFlags;
+			for (s32 w = 0; w < workerCount; w++)
+			{
+				SectorCached* cached = &workers[w]->m_cachedSectors[i];
+				if (flags || cached->objectCapacity < sector->objectCapacity)
+				{
+					workers[w]->updateCachedSector(cached, flags);
+				}
+			}
+
+			SectorCached* cached = &m_cachedSectors[i];
+			if (flags || cached->objectCapacity < sector->objectCapacity)
+			{
+				updateCachedSector(cached, flags);
+			}
+		}
+	}
+
 	// Switch from float to fixed.
 	void TFE_Sectors_Float::subrendererChanged()
 	{
 		freeCachedData();
+		if (!m_stripWorker)
+		{
+			strip_freeCachedData();
+		}
 	}
 }
\ No newline at end of file
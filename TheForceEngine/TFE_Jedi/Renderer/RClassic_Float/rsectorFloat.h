@@ -9,6 +9,7 @@
 #include "rwallFloat.h"
 #include "rflatFloat.h"
 #include "../rsectorRender.h"
+#include <vector>
 
 struct RWall;
 struct SecObject;
@@ -30,12 +31,17 @@ namespace TFE_Jedi
 		// Cached Texture offsets
 		vec2_float floorOffset;
 		vec2_float ceilOffset;
+		// Per-frame traversal state, this is per-cache rather than on RSector so that strip threads do not share it.
+		s32 prevDrawFrame;
+		s32 prevDrawFrame2;
+		s32 startWall;
+		s32 drawWallCnt;
 	};
 
 	class TFE_Sectors_Float : public TFE_Sectors
 	{
 	public:
-		TFE_Sectors_Float() : m_cachedSectors(nullptr), m_cachedSectorCount(0) {}
+		TFE_Sectors_Float(bool stripWorker = false) : m_cachedSectors(nullptr), m_cachedSectorCount(0), m_stripWorker(stripWorker) {}
 
 		// Sub-Renderer specific
 		void destroy() override;
@@ -44,6 +50,12 @@ namespace TFE_Jedi
 		void draw(RSector* sector) override;
 		void subrendererChanged() override;
 
+		// Strip rendering (see rstripRenderFloat.h)
+		// Applies pending sector changes to this cache and the worker caches, called on the main thread before the strips are drawn.
+		void updateStripCaches(TFE_Sectors_Float** workers, s32 workerCount);
+		// Draws the view from 'sector', only writing the columns owned by the current thread.
+		void drawSector(RSector* sector);
+
 	private:
 		void saveValues(s32 index);
 		void restoreValues(s32 index);
@@ -58,5 +70,11 @@ namespace TFE_Jedi
 	public:
 		SectorCached* m_cachedSectors = nullptr;
 		u32 m_cachedSectorCount = 0;
+		// Strip workers draw from a cache updated by the main thread and leave shared sector state alone.
+		bool m_stripWorker = false;
+		// While strips are drawn, sector flags are not written since other strips read them. The drawn sectors
+		// are recorded instead and flagged as rendered by strip_draw() once all of the strips are done.
+		bool m_deferRendered = false;
+		std::vector<RSector*> m_renderedSectors;
 	};
 }  // TFE_Jedi
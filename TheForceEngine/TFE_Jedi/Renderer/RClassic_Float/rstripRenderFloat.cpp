@@ -0,0 +1,433 @@
+#include <cstring>
+#include <cstdio>
+
+#include <SDL_thread.h>
+#include <SDL_cpuinfo.h>
+#include <TFE_System/system.h>
+#include <TFE_System/profiler.h>
+#include <TFE_Settings/settings.h>
+#include <TFE_Jedi/Math/core_math.h>
+
+#include "rstripRenderFloat.h"
+#include "rsectorFloat.h"
+#include "redgePairFloat.h"
+#include "rclassicFloatSharedState.h"
+#include "../rcommon.h"
+#include "../jediRenderer.h"
+
+namespace TFE_Jedi
+{
+
+namespace RClassic_Float
+{
+	enum StripConstants
+	{
+		MAX_STRIP_THREADS = 16,
+		MIN_STRIP_WIDTH = 16,
+	};
+
+	// Per-thread buffers and state, the main thread draws strip 0 using the regular renderer state.
+	struct StripWorker
+	{
+		SDL_Thread* thread;
+		SDL_sem* startSem;
+		SDL_sem* doneSem;
+		TFE_Sectors_Float* sectors;
+
+		s32 x0;
+		s32 x1;
+		bool active;
+		u64 drawTicks;
+
+		s32 width;
+		s32* columnTop;
+		s32* columnBot;
+		s32* windowTopAll;
+		s32* windowBotAll;
+		f32* depthAll;
+		EdgePairFloat* flatEdgeList;
+		EdgePairFloat* adjoinEdgeList;
+		RWallSegmentFloat* wallSegListSrc;
+		RWallSegmentFloat* wallSegListDst;
+	};
+
+	// Renderer state at the start of the frame, copied into each worker thread before it starts drawing.
+	struct StripFrame
+	{
+		RClassicFloatState state;
+		RSector* root;
+
+		s32 windowMinX_Pixels;
+		s32 windowMaxX_Pixels;
+		s32 windowMinY_Pixels;
+		s32 windowMaxY_Pixels;
+		s32 windowMaxCeil;
+		s32 windowMinFloor;
+		s32 windowX0;
+		s32 windowX1;
+
+		RSector* prevSector;
+		s32 sectorIndex;
+		s32 maxAdjoinIndex;
+		s32 adjoinIndex;
+		s32 maxAdjoinDepth;
+
+		s32 nextWall;
+		s32 curWallSeg;
+		s32 adjoinSegCount;
+		s32 adjoinDepth;
+		s32 flatCount;
+		s32 wallMaxCeilY;
+		s32 wallMinFloorY;
+
+		s32 sectorAmbient;
+		s32 scaledAmbient;
+		s32 sectorAmbientFraction;
+	};
+
+	thread_local bool s_stripWorkerThread = false;
+
+	static StripWorker s_workers[MAX_STRIP_THREADS - 1];
+	static TFE_Sectors_Float* s_workerSectors[MAX_STRIP_THREADS - 1];
+	static s32 s_workerCount = 0;
+	static volatile bool s_stripQuit = false;
+	static StripFrame s_stripFrame;
+	static char s_stripZoneName[MAX_STRIP_THREADS][16];
+
+	void strip_freeBuffers(StripWorker* worker);
+	void strip_destroyWorkers();
+
+	s32 strip_getThreadCount()
+	{
+		TFE_Settings_Graphics* graphics = TFE_Settings::getGraphicsSettings();
+		s32 count = graphics->renderThreadCount > 0 ? graphics->renderThreadCount : SDL_GetCPUCount();
+		// Very narrow strips cost more in traversal than they save in drawing.
+		count = min(count, s_width / MIN_STRIP_WIDTH);
+		return clamp(count, 1, (s32)MAX_STRIP_THREADS);
+	}
+
+	bool strip_isEnabled()
+	{
+		return TFE_Settings::getGraphicsSettings()->multithreadedRender && strip_getThreadCount() > 1;
+	}
+
+	void strip_drawWorker(StripWorker* worker)
+	{
+		const StripFrame* frame = &s_stripFrame;
+
+		// Start from the main thread state and then point to the worker buffers.
+		s_rcfltState = frame->state;
+		s_rcfltState.depth1d_all    = worker->depthAll;
+		s_rcfltState.depth1d        = worker->depthAll;
+		s_rcfltState.flatEdgeList   = worker->flatEdgeList;
+		s_rcfltState.flatEdge       = worker->flatEdgeList + frame->flatCount;
+		s_rcfltState.adjoinEdgeList = worker->adjoinEdgeList;
+		s_rcfltState.adjoinEdge     = worker->adjoinEdgeList;
+		s_rcfltState.adjoinSegment  = nullptr;
+		s_rcfltState.wallSegListSrc = worker->wallSegListSrc;
+		s_rcfltState.wallSegListDst = worker->wallSegListDst;
+		s_rcfltState.stripX0 = worker->x0;
+		s_rcfltState.stripX1 = worker->x1;
+
+		s_windowMinX_Pixels = frame->windowMinX_Pixels;
+		s_windowMaxX_Pixels = frame->windowMaxX_Pixels;
+		s_windowMinY_Pixels = frame->windowMinY_Pixels;
+		s_windowMaxY_Pixels = frame->windowMaxY_Pixels;
+		s_windowMaxCeil  = frame->windowMaxCeil;
+		s_windowMinFloor = frame->windowMinFloor;
+		s_windowX0 = frame->windowX0;
+		s_windowX1 = frame->windowX1;
+
+		s_prevSector = frame->prevSector;
+		s_sectorIndex = frame->sectorIndex;
+		s_maxAdjoinIndex = frame->maxAdjoinIndex;
+		s_adjoinIndex = frame->adjoinIndex;
+		s_maxAdjoinDepth = frame->maxAdjoinDepth;
+
+		s_nextWall = frame->nextWall;
+		s_curWallSeg = frame->curWallSeg;
+		s_adjoinSegCount = frame->adjoinSegCount;
+		s_adjoinDepth = frame->adjoinDepth;
+		s_flatCount = frame->flatCount;
+		s_wallMaxCeilY = frame->wallMaxCeilY;
+		s_wallMinFloorY = frame->wallMinFloorY;
+
+		s_sectorAmbient = frame->sectorAmbient;
+		s_scaledAmbient = frame->scaledAmbient;
+		s_sectorAmbientFraction = frame->sectorAmbientFraction;
+		s_drawnObjCount = 0;
+
+		s_columnTop = worker->columnTop;
+		s_columnBot = worker->columnBot;
+		s_windowTop_all = worker->windowTopAll;
+		s_windowBot_all = worker->windowBotAll;
+		s_windowTop = s_windowTop_all;
+		s_windowBot = s_windowBot_all;
+		s_windowTopPrev = s_windowTop_all;
+		s_windowBotPrev = s_windowBot_all;
+		s_objWindowTop = s_windowTop_all;
+		s_objWindowBot = s_windowBot_all;
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		worker->sectors->drawSector(frame->root);
+		worker->drawTicks = TFE_System::getCurrentTimeInTicks() - start;
+	}
+
+	int strip_threadFunc(void* userData)
+	{
+		StripWorker* worker = (StripWorker*)userData;
+		// The profiler is not thread safe, strip timings are reported by the main thread.
+		TFE_Profiler::setThreadEnabled(false);
+		s_stripWorkerThread = true;
+
+		while (1)
+		{
+			SDL_SemWait(worker->startSem);
+			if (s_stripQuit)
+			{
+				break;
+			}
+			strip_drawWorker(worker);
+			SDL_SemPost(worker->doneSem);
+		}
+		return 0;
+	}
+
+	bool strip_createWorkers(s32 workerCount)
+	{
+		s_stripQuit = false;
+		for (s32 i = 0; i < MAX_STRIP_THREADS; i++)
+		{
+			sprintf(s_stripZoneName[i], "Strip %d", i);
+		}
+
+		for (s32 i = 0; i < workerCount; i++)
+		{
+			StripWorker* worker = &s_workers[i];
+			memset(worker, 0, sizeof(StripWorker));
+			worker->sectors = new TFE_Sectors_Float(true);
+			worker->startSem = SDL_CreateSemaphore(0);
+			worker->doneSem = SDL_CreateSemaphore(0);
+			s_workerSectors[i] = worker->sectors;
+			s_workerCount = i + 1;
+
+			char name[32];
+			sprintf(name, "TFE_RenderStrip%d", i + 1);
+			worker->thread = SDL_CreateThread(strip_threadFunc, name, worker);
+			if (!worker->thread)
+			{
+				TFE_System::logWrite(LOG_ERROR, "Renderer", "Cannot create strip render thread: %s", SDL_GetError());
+				strip_destroyWorkers();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void strip_destroyWorkers()
+	{
+		s_stripQuit = true;
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			StripWorker* worker = &s_workers[i];
+			if (worker->thread)
+			{
+				SDL_SemPost(worker->startSem);
+				SDL_WaitThread(worker->thread, nullptr);
+			}
+			SDL_DestroySemaphore(worker->startSem);
+			SDL_DestroySemaphore(worker->doneSem);
+
+			worker->sectors->subrendererChanged();
+			delete worker->sectors;
+			strip_freeBuffers(worker);
+			memset(worker, 0, sizeof(StripWorker));
+			s_workerSectors[i] = nullptr;
+		}
+		s_workerCount = 0;
+		s_stripQuit = false;
+	}
+
+	void strip_freeBuffers(StripWorker* worker)
+	{
+		free(worker->columnTop);
+		free(worker->columnBot);
+		free(worker->windowTopAll);
+		free(worker->windowBotAll);
+		free(worker->depthAll);
+		free(worker->flatEdgeList);
+		free(worker->adjoinEdgeList);
+		free(worker->wallSegListSrc);
+		free(worker->wallSegListDst);
+
+		worker->columnTop = nullptr;
+		worker->columnBot = nullptr;
+		worker->windowTopAll = nullptr;
+		worker->windowBotAll = nullptr;
+		worker->depthAll = nullptr;
+		worker->flatEdgeList = nullptr;
+		worker->adjoinEdgeList = nullptr;
+		worker->wallSegListSrc = nullptr;
+		worker->wallSegListDst = nullptr;
+		worker->width = 0;
+	}
+
+	void strip_allocateBuffers(StripWorker* worker)
+	{
+		if (worker->width == s_width) { return; }
+		strip_freeBuffers(worker);
+
+		worker->width = s_width;
+		worker->columnTop = (s32*)malloc(s_width * sizeof(s32));
+		worker->columnBot = (s32*)malloc(s_width * sizeof(s32));
+		worker->windowTopAll = (s32*)malloc(s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH_EXT + 1));
+		worker->windowBotAll = (s32*)malloc(s_width * sizeof(s32) * (MAX_ADJOIN_DEPTH_EXT + 1));
+		worker->depthAll = (f32*)malloc(s_width * sizeof(f32) * (MAX_ADJOIN_DEPTH_EXT + 1));
+		worker->flatEdgeList = (EdgePairFloat*)malloc(sizeof(EdgePairFloat) * MAX_SEG_EXT);
+		worker->wallSegListSrc = (RWallSegmentFloat*)malloc(sizeof(RWallSegmentFloat) * MAX_SEG_EXT);
+		worker->wallSegListDst = (RWallSegmentFloat*)malloc(sizeof(RWallSegmentFloat) * MAX_SEG_EXT);
+		// Unlike the main list, the adjoin segment count is limited per frame rather than per depth level.
+		worker->adjoinEdgeList = (EdgePairFloat*)malloc(sizeof(EdgePairFloat) * (MAX_ADJOIN_SEG_EXT + 1));
+	}
+
+	void strip_captureFrame(RSector* root)
+	{
+		StripFrame* frame = &s_stripFrame;
+		frame->state = s_rcfltState;
+		frame->root = root;
+
+		frame->windowMinX_Pixels = s_windowMinX_Pixels;
+		frame->windowMaxX_Pixels = s_windowMaxX_Pixels;
+		frame->windowMinY_Pixels = s_windowMinY_Pixels;
+		frame->windowMaxY_Pixels = s_windowMaxY_Pixels;
+		frame->windowMaxCeil = s_windowMaxCeil;
+		frame->windowMinFloor = s_windowMinFloor;
+		frame->windowX0 = s_windowX0;
+		frame->windowX1 = s_windowX1;
+
+		frame->prevSector = s_prevSector;
+		frame->sectorIndex = s_sectorIndex;
+		frame->maxAdjoinIndex = s_maxAdjoinIndex;
+		frame->adjoinIndex = s_adjoinIndex;
+		frame->maxAdjoinDepth = s_maxAdjoinDepth;
+
+		frame->nextWall = s_nextWall;
+		frame->curWallSeg = s_curWallSeg;
+		frame->adjoinSegCount = s_adjoinSegCount;
+		frame->adjoinDepth = s_adjoinDepth;
+		frame->flatCount = s_flatCount;
+		frame->wallMaxCeilY = s_wallMaxCeilY;
+		frame->wallMinFloorY = s_wallMinFloorY;
+
+		frame->sectorAmbient = s_sectorAmbient;
+		frame->scaledAmbient = s_scaledAmbient;
+		frame->sectorAmbientFraction = s_sectorAmbientFraction;
+	}
+
+	static void strip_flagRendered(TFE_Sectors_Float* sectors)
+	{
+		const size_t count = sectors->m_renderedSectors.size();
+		RSector** list = sectors->m_renderedSectors.data();
+		for (size_t i = 0; i < count; i++)
+		{
+			list[i]->flags1 |= SEC_FLAGS1_RENDERED;
+		}
+		sectors->m_renderedSectors.clear();
+	}
+
+	void strip_draw(TFE_Sectors_Float* sectors, RSector* sector)
+	{
+		const s32 threadCount = strip_getThreadCount();
+		if (threadCount - 1 != s_workerCount)
+		{
+			strip_destroyWorkers();
+			if (!strip_createWorkers(threadCount - 1))
+			{
+				TFE_Settings::getGraphicsSettings()->multithreadedRender = false;
+				sectors->drawSector(sector);
+				return;
+			}
+		}
+
+		// Bring all of the sector caches up to date before any thread starts reading them.
+		sectors->updateStripCaches(s_workerSectors, s_workerCount);
+		strip_captureFrame(sector);
+
+		const s32 x0 = s_minScreenX_Pixels;
+		const s32 x1 = s_maxScreenX_Pixels;
+		const s32 stripWidth = (x1 - x0 + 1 + threadCount - 1) / threadCount;
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			StripWorker* worker = &s_workers[i];
+			worker->x0 = x0 + (i + 1) * stripWidth;
+			worker->x1 = min(worker->x0 + stripWidth - 1, x1);
+			worker->active = worker->x0 <= x1;
+			worker->drawTicks = 0;
+			if (!worker->active) { continue; }
+
+			strip_allocateBuffers(worker);
+			memcpy(worker->columnTop, s_columnTop, s_width * sizeof(s32));
+			memcpy(worker->columnBot, s_columnBot, s_width * sizeof(s32));
+			memcpy(worker->windowTopAll, s_windowTop_all, s_width * sizeof(s32));
+			memcpy(worker->windowBotAll, s_windowBot_all, s_width * sizeof(s32));
+			memcpy(worker->depthAll, s_rcfltState.depth1d_all, s_width * sizeof(f32));
+			memcpy(worker->flatEdgeList, s_rcfltState.flatEdgeList, s_flatCount * sizeof(EdgePairFloat));
+
+			SDL_SemPost(worker->startSem);
+		}
+
+		// Strip 0
+		{
+			const u64 start = TFE_System::getCurrentTimeInTicks();
+			const u32 zoneId = TFE_Profiler::beginZone(s_stripZoneName[0], __FUNCTION__, __LINE__);
+			s_rcfltState.stripX0 = x0;
+			s_rcfltState.stripX1 = min(x0 + stripWidth - 1, x1);
+			sectors->m_deferRendered = true;
+			sectors->drawSector(sector);
+			sectors->m_deferRendered = false;
+			s_rcfltState.stripX0 = x0;
+			s_rcfltState.stripX1 = x1;
+			TFE_Profiler::endZone(zoneId, TFE_System::getCurrentTimeInTicks() - start);
+		}
+
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			StripWorker* worker = &s_workers[i];
+			if (!worker->active) { continue; }
+
+			SDL_SemWait(worker->doneSem);
+			const u32 zoneId = TFE_Profiler::beginZone(s_stripZoneName[i + 1], __FUNCTION__, __LINE__);
+			TFE_Profiler::endZone(zoneId, worker->drawTicks);
+		}
+
+		// All of the strips are done, so the sectors drawn by any of them can be flagged.
+		strip_flagRendered(sectors);
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			strip_flagRendered(s_workers[i].sectors);
+		}
+	}
+
+	void strip_reset()
+	{
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			s_workers[i].sectors->reset();
+		}
+	}
+
+	void strip_freeCachedData()
+	{
+		for (s32 i = 0; i < s_workerCount; i++)
+		{
+			s_workers[i].sectors->subrendererChanged();
+		}
+	}
+
+	void strip_destroy()
+	{
+		strip_destroyWorkers();
+	}
+}  // RClassic_Float
+
+}  // TFE_Jedi
@@ -0,0 +1,47 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// Strip Rendering
+// TFE: Optionally splits the floating point software view into
+// vertical strips that are drawn in parallel.
+//
+// Every strip thread runs the full sector traversal with its own
+// thread local state and sector cache, so the visibility results
+// and interpolation are identical to the single-threaded renderer.
+// Only the pixel writes are limited to the columns owned by the
+// thread, the main thread draws the first strip.
+//////////////////////////////////////////////////////////////////////
+#include <TFE_System/types.h>
+#include "rclassicFloatSharedState.h"
+
+struct RSector;
+
+namespace TFE_Jedi
+{
+	class TFE_Sectors_Float;
+
+	namespace RClassic_Float
+	{
+		extern thread_local bool s_stripWorkerThread;
+
+		// Returns true if strip rendering is enabled and more than one thread is available.
+		bool strip_isEnabled();
+		// Draws the view from 'sector' using the strip threads, called from the main thread.
+		void strip_draw(TFE_Sectors_Float* sectors, RSector* sector);
+
+		void strip_reset();
+		void strip_freeCachedData();
+		void strip_destroy();
+
+		// Returns true if screen column 'x' is drawn by the current thread.
+		inline bool strip_ownsColumn(s32 x)
+		{
+			return x >= s_rcfltState.stripX0 && x <= s_rcfltState.stripX1;
+		}
+
+		// Worker threads only write to their own state, shared level data is written by the main thread.
+		inline bool strip_isWorkerThread()
+		{
+			return s_stripWorkerThread;
+		}
+	}
+}  // TFE_Jedi
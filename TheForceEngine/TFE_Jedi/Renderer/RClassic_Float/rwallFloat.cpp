@@ -12,6 +12,8 @@
 #include "rsectorFloat.h"
 #include "redgePairFloat.h"
 #include "rclassicFloatSharedState.h"
+#include "rstripRenderFloat.h"
+#include "rkernelsFloat.h"
 #include "../rcommon.h"
 #include "../jediRenderer.h"
 
@@ -28,15 +30,15 @@ namespace RClassic_Float
 		BACK = 0,
 	};
 
-	static f32 s_segmentCross;
-	static s32 s_texHeightMask;
-	static s32 s_yPixelCount;
-	static fixed44_20 s_vCoordStep;
-	static fixed44_20 s_vCoordFixed;
-	static const u8* s_columnLight;
-	static u8* s_texImage;
-	static u8* s_columnOut;
-	static u8  s_workBuffer[WAX_DECOMPRESS_SIZE];
+	static thread_local f32 s_segmentCross;
+	static thread_local s32 s_texHeightMask;
+	static thread_local s32 s_yPixelCount;
+	static thread_local fixed44_20 s_vCoordStep;
+	static thread_local fixed44_20 s_vCoordFixed;
+	static thread_local const u8* s_columnLight;
+	static thread_local u8* s_texImage;
+	static thread_local u8* s_columnOut;
+	static thread_local u8  s_workBuffer[WAX_DECOMPRESS_SIZE];
 
 	s32 segmentCrossesLine(f32 ax0, f32 ay0, f32 ax1, f32 ay1, f32 bx0, f32 by0, f32 bx1, f32 by1);
 	f32 solveForZ_Numerator(RWallSegmentFloat* wallSegment);
@@ -66,6 +68,18 @@ namespace RClassic_Float
 		drawColumn_Lit_Trans,			// COLFUNC_LIT_TRANS
 	};
 
+	// Strip worker threads repeat the main thread traversal, so only the main thread writes to the shared wall state.
+	// This keeps the results identical to single-threaded rendering.
+	inline void wall_setVisible(RWall* wall, s32 visible)
+	{
+		if (!strip_isWorkerThread()) { wall->visible = visible; }
+	}
+
+	inline void wall_setSeen(RWall* wall)
+	{
+		if (!strip_isWorkerThread()) { wall->seen = JTRUE; }
+	}
+
 	// Computes the intersection of line segment (x0,z0),(x1,z1) with frustum line (fx0, fz0),(fx1, fz1)
 	f32 frustumIntersectParam(f32 x0, f32 z0, f32 x1, f32 z1, f32 fx0, f32 fz0, f32 fx1, f32 fz1)
 	{
@@ -299,13 +313,13 @@ namespace RClassic_Float
 		// Cull the wall if it is completely beyind the camera.
 		if (z0 < 0.0f && z1 < 0.0f)
 		{
-			wall->visible = 0;
+			wall_setVisible(wall, 0);
 			return;
 		}
 		// Cull the wall if it is completely outside the view
 		if ((x0 < left0 && x1 < left1) || (x0 > right0 && x1 > right1))
 		{
-			wall->visible = 0;
+			wall_setVisible(wall, 0);
 			return;
 		}
 
@@ -316,7 +330,7 @@ namespace RClassic_Float
 		const f32 side = (z0 * dx) - (x0 * dz);
 		if (side < 0.0f)
 		{
-			wall->visible = 0;
+			wall_setVisible(wall, 0);
 			return;
 		}
 
@@ -335,7 +349,7 @@ namespace RClassic_Float
 		//////////////////////////////////////////////
 		if (!wall_clipToFrustum(x0, z0, x1, z1, dx, dz, curU, texelLen, texelLenRem, clipX0_Near, clipX1_Near, left0, right0, left1, right1))
 		{
-			wall->visible = 0;
+			wall_setVisible(wall, 0);
 			return;
 		}
 		
@@ -363,19 +377,19 @@ namespace RClassic_Float
 		// The wall is backfacing if x0 > x1
 		if (x0pixel > x1pixel)
 		{
-			wall->visible = 0;
+			wall_setVisible(wall, 0);
 			return;
 		}
 		// The wall is completely outside of the screen.
 		if (x0pixel > s_maxScreenX_Pixels || x1pixel < s_minScreenX_Pixels)
 		{
-			wall->visible = 0;
+			wall_setVisible(wall, 0);
 			return;
 		}
 		if (s_nextWall == s_maxSegCount)
 		{
 			TFE_System::logWrite(LOG_ERROR, "ClassicRenderer", "Wall_Process : Maximum processed walls exceeded!");
-			wall->visible = 0;
+			wall_setVisible(wall, 0);
 			return;
 		}
 	
@@ -419,7 +433,7 @@ namespace RClassic_Float
 		wallSeg->slope = slope;
 		wallSeg->uScale = texelLenRem / den;
 		wallSeg->orient = orient;
-		wall->visible = 1;
+		wall_setVisible(wall, 1);
 	}
 
 	s32 wall_mergeSort(RWallSegmentFloat* segOutList, s32 availSpace, s32 start, s32 count)
@@ -444,7 +458,7 @@ namespace RClassic_Float
 		while (1)
 		{
 			WallCached* srcWall = srcSeg->srcWall;
-			JBool processed = (s_drawFrame == srcWall->wall->drawFrame) ? JTRUE : JFALSE;
+			JBool processed = (s_drawFrame == srcWall->drawFrame) ? JTRUE : JFALSE;
 			JBool insideWindow = ((srcSeg->z0 >= s_rcfltState.windowMinZ || srcSeg->z1 >= s_rcfltState.windowMinZ) && srcSeg->wallX0 <= s_windowMaxX_Pixels && srcSeg->wallX1 >= s_windowMinX_Pixels) ? JTRUE : JFALSE;
 			if (!processed && insideWindow)
 			{
@@ -784,7 +798,7 @@ namespace RClassic_Float
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
 
-			srcWall->visible = 0;
+			wall_setVisible(srcWall, 0);
 			return;
 		}
 
@@ -832,7 +846,7 @@ namespace RClassic_Float
 			f32 uCoord0 = wallSegment->uCoord0 + cachedWall->midOffset.x;
 			f32 uCoord = uCoord0 + ((wallSegment->orient == WORIENT_DZ_DX) ? dxView*uScale : (z - z0)*uScale);
 
-			if (s_yPixelCount > 0)
+			if (s_yPixelCount > 0 && strip_ownsColumn(x))
 			{
 				// texture wrapping, assumes texWidth is a power of 2.
 				s32 texelU = floorFloat(uCoord) & (texWidth - 1);
@@ -905,7 +919,7 @@ namespace RClassic_Float
 			y0F += dYdXbot;
 		}
 
-		srcWall->seen = JTRUE;
+		wall_setSeen(srcWall);
 	}
 
 	void wall_drawTransparent(RWallSegmentFloat* wallSegment, EdgePairFloat* edge)
@@ -960,15 +974,18 @@ namespace RClassic_Float
 
 				s_columnOut = &s_display[yC_pixel*s_width + x];
 				s_rcfltState.depth1d[x] = z;
-				s_columnLight = computeLighting(z, floor16(srcWall->wallLight));
 
-				if (s_columnLight)
+				if (strip_ownsColumn(x))
 				{
-					drawColumn_Lit_Trans();
-				}
-				else
-				{
-					drawColumn_Fullbright_Trans();
+					s_columnLight = computeLighting(z, floor16(srcWall->wallLight));
+					if (s_columnLight)
+					{
+						drawColumn_Lit_Trans();
+					}
+					else
+					{
+						drawColumn_Fullbright_Trans();
+					}
 				}
 			}
 
@@ -1017,8 +1034,8 @@ namespace RClassic_Float
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
 
-			srcWall->visible = 0;
-			srcWall->seen = JTRUE;
+			wall_setVisible(srcWall, 0);
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1048,8 +1065,8 @@ namespace RClassic_Float
 				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, numerator);
 				s_columnBot[x] = s_windowMinY_Pixels;
 			}
-			srcWall->visible = 0;
-			srcWall->seen = JTRUE;
+			wall_setVisible(srcWall, 0);
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1097,7 +1114,7 @@ namespace RClassic_Float
 			}
 		}
 
-		srcWall->seen = JTRUE;
+		wall_setSeen(srcWall);
 	}
 
 	void wall_drawBottom(RWallSegmentFloat* wallSegment)
@@ -1131,7 +1148,7 @@ namespace RClassic_Float
 		s32 cy1 = roundFloat(cProj1);
 		if (cy0 > s_windowMaxY_Pixels && cy1 >= s_windowMaxY_Pixels)
 		{
-			srcWall->visible = 0;
+			wall_setVisible(srcWall, 0);
 			s32 x = wallSegment->wallX0;
 			s32 length = wallSegment->wallX1 - x + 1;
 
@@ -1143,7 +1160,7 @@ namespace RClassic_Float
 				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1156,7 +1173,7 @@ namespace RClassic_Float
 		if (fy0 < s_windowMinY_Pixels && fy1 < s_windowMinY_Pixels)
 		{
 			// Wall is above the top of the screen.
-			srcWall->visible = 0;
+			wall_setVisible(srcWall, 0);
 			s32 x = wallSegment->wallX0;
 			s32 length = wallSegment->wallX1 - x + 1;
 
@@ -1168,7 +1185,7 @@ namespace RClassic_Float
 				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnBot[x] = s_windowMinY_Pixels;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1222,7 +1239,7 @@ namespace RClassic_Float
 				s_columnBot[x] = bot;
 				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1273,7 +1290,7 @@ namespace RClassic_Float
 					uCoord = u0 + (dz*wallSegment->uScale) + cachedWall->botOffset.x;
 				}
 				s_rcfltState.depth1d[x] = z;
-				if (s_yPixelCount > 0)
+				if (s_yPixelCount > 0 && strip_ownsColumn(x))
 				{
 					s32 widthMask = tex->width - 1;
 					s32 texelU = floorFloat(uCoord) & widthMask;
@@ -1333,7 +1350,7 @@ namespace RClassic_Float
 				yC += ceil_dYdX;
 			}
 		}
-		srcWall->seen = JTRUE;
+		wall_setSeen(srcWall);
 	}
 
 	void wall_drawTop(RWallSegmentFloat* wallSegment)
@@ -1365,7 +1382,7 @@ namespace RClassic_Float
 
 		if (yC0_pixel > s_windowMaxY_Pixels && yC1_pixel > s_windowMaxY_Pixels)
 		{
-			srcWall->visible = 0;
+			wall_setVisible(srcWall, 0);
 			for (s32 i = 0; i < lengthInPixels; i++) { s_columnTop[x0 + i] = s_windowMaxY_Pixels; }
 			flat_addEdges(lengthInPixels, x0, 0, f32(s_windowMaxY_Pixels + 1), 0, f32(s_windowMaxY_Pixels + 1));
 			for (s32 i = 0, x = x0; i < lengthInPixels; i++, x++)
@@ -1373,7 +1390,7 @@ namespace RClassic_Float
 				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1393,7 +1410,7 @@ namespace RClassic_Float
 		s32 yF1_pixel = roundFloat(yF1);
 		if (yF0_pixel < s_windowMinY_Pixels && yF1_pixel < s_windowMinY_Pixels)
 		{
-			srcWall->visible = 0;
+			wall_setVisible(srcWall, 0);
 			for (s32 i = 0; i < lengthInPixels; i++) { s_columnBot[x0 + i] = s_windowMinY_Pixels; }
 			flat_addEdges(lengthInPixels, x0, 0, f32(s_windowMinY_Pixels - 1), 0, f32(s_windowMinY_Pixels - 1));
 			for (s32 i = 0, x = x0; i < lengthInPixels; i++, x++)
@@ -1401,7 +1418,7 @@ namespace RClassic_Float
 				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnBot[x] = s_windowMinY_Pixels;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1450,7 +1467,7 @@ namespace RClassic_Float
 				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
 				yF0 += floor_dYdX;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1491,7 +1508,7 @@ namespace RClassic_Float
 			f32 uCoord = uCoord0 + ((wallSegment->orient == WORIENT_DZ_DX) ? dxView*uScale : (z - z0)*uScale);
 
 			s_rcfltState.depth1d[x] = z;
-			if (s_yPixelCount > 0)
+			if (s_yPixelCount > 0 && strip_ownsColumn(x))
 			{
 				s32 widthMask = texture->width - 1;
 				s32 texelU = floorFloat(uCoord) & widthMask;
@@ -1552,7 +1569,7 @@ namespace RClassic_Float
 			yF0 += floor_dYdX;
 		}
 		
-		srcWall->seen = JTRUE;
+		wall_setSeen(srcWall);
 	}
 
 	void wall_drawTopAndBottom(RWallSegmentFloat* wallSegment)
@@ -1580,7 +1597,7 @@ namespace RClassic_Float
 
 		if (c0_pixel > s_windowMaxY_Pixels && c1_pixel > s_windowMaxY_Pixels)
 		{
-			srcWall->visible = 0;
+			wall_setVisible(srcWall, 0);
 			for (s32 i = 0; i < length; i++) { s_columnTop[x0 + i] = s_windowMaxY_Pixels; }
 
 			flat_addEdges(length, x0, 0, f32(s_windowMaxY_Pixels + 1), 0, f32(s_windowMaxY_Pixels + 1));
@@ -1590,7 +1607,7 @@ namespace RClassic_Float
 				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnTop[x] = s_windowMaxY_Pixels;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1602,7 +1619,7 @@ namespace RClassic_Float
 		s32 f1_pixel = roundFloat(fProj1);
 		if (f0_pixel < s_windowMinY_Pixels && f1_pixel < s_windowMinY_Pixels)
 		{
-			srcWall->visible = 0;
+			wall_setVisible(srcWall, 0);
 			for (s32 i = 0; i < length; i++) { s_columnBot[x0 + i] = s_windowMinY_Pixels; }
 
 			flat_addEdges(length, x0, 0, f32(s_windowMinY_Pixels - 1), 0, f32(s_windowMinY_Pixels - 1));
@@ -1613,7 +1630,7 @@ namespace RClassic_Float
 				s_rcfltState.depth1d[x] = solveForZ(wallSegment, x, num);
 				s_columnBot[x] = s_windowMinY_Pixels;
 			}
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
@@ -1678,7 +1695,7 @@ namespace RClassic_Float
 					u = u0 + (dz*wallSegment->uScale) + cachedWall->topOffset.x;
 				}
 				s_rcfltState.depth1d[x] = z;
-				if (s_yPixelCount > 0)
+				if (s_yPixelCount > 0 && strip_ownsColumn(x))
 				{
 					s32 widthMask = topTex->width - 1;
 					s32 texelU = floorFloat(u) & widthMask;
@@ -1782,7 +1799,7 @@ namespace RClassic_Float
 						uCoord = u0 + (dz*wallSegment->uScale) + cachedWall->botOffset.x;
 					}
 					s_rcfltState.depth1d[x] = z;
-					if (s_yPixelCount > 0)
+					if (s_yPixelCount > 0 && strip_ownsColumn(x))
 					{
 						s32 widthMask = botTex->width - 1;
 						s32 texelU = floorFloat(uCoord) & widthMask;
@@ -1853,12 +1870,12 @@ namespace RClassic_Float
 		s32 next_c1_pixel = roundFloat(next_cProj1);
 		if ((next_f0_pixel <= s_windowMinY_Pixels && next_f1_pixel <= s_windowMinY_Pixels) || (next_c0_pixel >= s_windowMaxY_Pixels && next_c1_pixel >= s_windowMaxY_Pixels) || (nextSector->floorHeight <= nextSector->ceilingHeight))
 		{
-			srcWall->seen = JTRUE;
+			wall_setSeen(srcWall);
 			return;
 		}
 
 		wall_addAdjoinSegment(length, x0, next_floor_dYdX, next_fProj0 - 1.0f, next_ceil_dYdX, next_cProj0 + 1.0f, wallSegment);
-		srcWall->seen = JTRUE;
+		wall_setSeen(srcWall);
 	}
 
 	// Parts of the code inside 's_height == SKY_BASE_HEIGHT' are based on the original DOS exe.
@@ -1896,7 +1913,7 @@ namespace RClassic_Float
 			const s32 y1 = min(s_columnTop[x], s_windowBot[x]);
 
 			s_yPixelCount = y1 - y0 + 1;
-			if (s_yPixelCount > 0)
+			if (s_yPixelCount > 0 && strip_ownsColumn(x))
 			{
 				if (s_height == SKY_BASE_HEIGHT)
 				{
@@ -1944,7 +1961,7 @@ namespace RClassic_Float
 			const s32 y1 = min(s_screenYMidFlt - 1, s_windowBot[x]);
 
 			s_yPixelCount = y1 - y0 + 1;
-			if (s_yPixelCount > 0)
+			if (s_yPixelCount > 0 && strip_ownsColumn(x))
 			{
 				if (s_height == SKY_BASE_HEIGHT)
 				{
@@ -2000,7 +2017,7 @@ namespace RClassic_Float
 			const s32 y1 = s_windowBot[x];
 
 			s_yPixelCount = y1 - y0 + 1;
-			if (s_yPixelCount > 0)
+			if (s_yPixelCount > 0 && strip_ownsColumn(x))
 			{
 				if (s_height == SKY_BASE_HEIGHT)
 				{
@@ -2048,7 +2065,7 @@ namespace RClassic_Float
 			const s32 y1 = s_windowBot[x];
 
 			s_yPixelCount = y1 - y0 + 1;
-			if (s_yPixelCount > 0)
+			if (s_yPixelCount > 0 && strip_ownsColumn(x))
 			{
 				if (s_height == SKY_BASE_HEIGHT)
 				{
@@ -2140,62 +2157,25 @@ namespace RClassic_Float
 		return z;
 	}
 
+	// The inner loops live in rkernelsFloat.cpp, which selects the SIMD version for the current CPU.
 	void drawColumn_Fullbright()
 	{
-		fixed44_20 vCoordFixed = s_vCoordFixed;
-		const u8* tex = s_texImage;
-		const s32 end = s_yPixelCount - 1;
-
-		s32 offset = end * s_width;
-		for (s32 i = end; i >= 0; i--, offset -= s_width, vCoordFixed += s_vCoordStep)
-		{
-			const s32 v = floor20(vCoordFixed) & s_texHeightMask;
-			s_columnOut[offset] = tex[v];
-		}
+		s_drawKernels.column[KERNEL_FULLBRIGHT](s_columnOut, s_width, s_yPixelCount, s_vCoordFixed, s_vCoordStep, s_texImage, s_texHeightMask, nullptr);
 	}
 
 	void drawColumn_Lit()
 	{
-		fixed44_20 vCoordFixed = s_vCoordFixed;
-		const u8* tex = s_texImage;
-		const s32 end = s_yPixelCount - 1;
-
-		s32 offset = end * s_width;
-		for (s32 i = end; i >= 0; i--, offset -= s_width, vCoordFixed += s_vCoordStep)
-		{
-			const s32 v = floor20(vCoordFixed) & s_texHeightMask;
-			s_columnOut[offset] = s_columnLight[tex[v]];
-		}
+		s_drawKernels.column[KERNEL_LIT](s_columnOut, s_width, s_yPixelCount, s_vCoordFixed, s_vCoordStep, s_texImage, s_texHeightMask, s_columnLight);
 	}
 
 	void drawColumn_Fullbright_Trans()
 	{
-		fixed44_20 vCoordFixed = s_vCoordFixed;
-		const u8* tex = s_texImage;
-		const s32 end = s_yPixelCount - 1;
-
-		s32 offset = end * s_width;
-		for (s32 i = end; i >= 0; i--, offset -= s_width, vCoordFixed += s_vCoordStep)
-		{
-			const s32 v = floor20(vCoordFixed) & s_texHeightMask;
-			const u8 c = tex[v];
-			if (c) { s_columnOut[offset] = c; }
-		}
+		s_drawKernels.column[KERNEL_FULLBRIGHT_TRANS](s_columnOut, s_width, s_yPixelCount, s_vCoordFixed, s_vCoordStep, s_texImage, s_texHeightMask, nullptr);
 	}
 
 	void drawColumn_Lit_Trans()
 	{
-		fixed44_20 vCoordFixed = s_vCoordFixed;
-		const u8* tex = s_texImage;
-		const s32 end = s_yPixelCount - 1;
-
-		s32 offset = end * s_width;
-		for (s32 i = end; i >= 0; i--, offset -= s_width, vCoordFixed += s_vCoordStep)
-		{
-			const s32 v = floor20(vCoordFixed) & s_texHeightMask;
-			const u8 c = tex[v];
-			if (c) { s_columnOut[offset] = s_columnLight[c]; }
-		}
+		s_drawKernels.column[KERNEL_LIT_TRANS](s_columnOut, s_width, s_yPixelCount, s_vCoordFixed, s_vCoordStep, s_texImage, s_texHeightMask, s_columnLight);
 	}
 
 	void wall_addAdjoinSegment(s32 length, s32 x0, f32 top_dydx, f32 y1, f32 bot_dydx, f32 y0, RWallSegmentFloat* wallSegment)
@@ -2349,7 +2329,10 @@ namespace RClassic_Float
 				}
 
 				s_yPixelCount = y1 - y0 + 1;
-				if (s_yPixelCount > 0)
+				// The sprite counts as drawn even if the column belongs to another strip thread, so that
+				// the drawn object list matches the single threaded renderer.
+				if (s_yPixelCount > 1) { drawn = JTRUE; }
+				if (s_yPixelCount > 0 && strip_ownsColumn(x))
 				{
 					const f32 vOffset = f32(y1_pixel - y1);
 					s_vCoordFixed = floatToFixed20(vOffset*vCoordStep);
@@ -2377,7 +2360,6 @@ namespace RClassic_Float
 					s_columnOut = &s_display[y0 * s_width + x];
 					// Draw the column.
 					spriteColumnFunc();
-					if (s_yPixelCount > 1) { drawn = JTRUE; }
 				}
 			}
 		}
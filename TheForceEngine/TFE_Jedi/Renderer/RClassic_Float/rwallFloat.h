@@ -43,6 +43,10 @@ namespace TFE_Jedi
 		// Direction and length.
 		vec2_float wallDir;
 		f32 length;
+
+		// Set while drawing through this wall as an adjoin.
+		// This is per-cache rather than on RWall so that strip threads do not share it.
+		s32 drawFrame;
 	};
 
 	namespace RClassic_Float
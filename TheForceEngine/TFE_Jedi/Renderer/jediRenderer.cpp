@@ -12,6 +12,7 @@
 #include "RClassic_Float/rclassicFloat.h"
 #include "RClassic_Float/rsectorFloat.h"
 #include "RClassic_Float/rclassicFloatSharedState.h"
+#include "RClassic_Float/rkernelsFloat.h"
 
 #include "RClassic_GPU/rclassicGPU.h"
 #include "RClassic_GPU/rsectorGPU.h"
@@ -45,6 +46,8 @@ namespace TFE_Jedi
 	void clear1dDepth();
 	void console_setSubRenderer(const std::vector<std::string>& args);
 	void console_getSubRenderer(const std::vector<std::string>& args);
+	void console_setDrawKernels(const std::vector<std::string>& args);
+	void console_getDrawKernels(const std::vector<std::string>& args);
 
 	/////////////////////////////////////////////
 	// Implementation
@@ -120,6 +123,11 @@ namespace TFE_Jedi
 		// Remove temporarily until they do something useful again.
 		CCMD("rsetSubRenderer", console_setSubRenderer, 1, "Set the sub-renderer - valid values are: Classic_Fixed, Classic_Float, Classic_GPU.");
 		CCMD("rgetSubRenderer", console_getSubRenderer, 0, "Get the current sub-renderer.");
+		CCMD("rsetDrawKernels", console_setDrawKernels, 1, "Set the software column/scanline kernels - valid values are: Scalar, SSE2, AVX2, NEON.");
+		CCMD("rgetDrawKernels", console_getDrawKernels, 0, "Get the current software column/scanline kernels.");
+
+		// Select the inner loop kernels for the current CPU.
+		RClassic_Float::kernels_init();
 
 		// Setup performance counters.
 		TFE_COUNTER(s_maxAdjoinDepth, "Maximum Adjoin Depth");
@@ -234,6 +242,30 @@ namespace TFE_Jedi
 		TFE_Console::addToHistory(c_subRenderers[s_subRenderer]);
 	}
 
+	void console_setDrawKernels(const std::vector<std::string>& args)
+	{
+		if (args.size() < 2) { return; }
+		const char* value = args[1].c_str();
+
+		for (s32 i = 0; i < RClassic_Float::KERNELS_COUNT; i++)
+		{
+			const RClassic_Float::DrawKernelSet set = RClassic_Float::DrawKernelSet(i);
+			if (strcasecmp(value, RClassic_Float::kernels_getName(set)) == 0)
+			{
+				if (!RClassic_Float::kernels_select(set))
+				{
+					TFE_Console::addToHistory("Kernels are not supported by this CPU.");
+				}
+				return;
+			}
+		}
+	}
+
+	void console_getDrawKernels(const std::vector<std::string>& args)
+	{
+		TFE_Console::addToHistory(RClassic_Float::kernels_getName(RClassic_Float::kernels_getCurrent()));
+	}
+
 	static s32 s_fov = -1;
 	static bool s_clearCachedTextures = false;
 
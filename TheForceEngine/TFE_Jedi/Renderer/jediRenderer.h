@@ -91,7 +91,7 @@ namespace TFE_Jedi
 	// Add a hud texture callback, these will be called when setting up the GPU renderer
 	void renderer_addHudTextureCallback(TextureListCallback hudTextureCallback);
 
-	extern s32 s_drawnObjCount;
+	extern thread_local s32 s_drawnObjCount;
 	extern bool s_showWireframe;
-	extern SecObject* s_drawnObj[];
+	extern thread_local SecObject* s_drawnObj[];
 }
\ No newline at end of file
@@ -7,6 +7,10 @@ struct ColorMap;
 
 namespace TFE_Jedi
 {
+	// Note: the per-frame window, column and traversal state is thread local so that
+	// the floating point sub-renderer can draw vertical strips on worker threads.
+	// See RClassic_Float/rstripRenderFloat.h
+
 	// Resolution
 	extern s32 s_width;
 	extern s32 s_height;
@@ -20,61 +24,61 @@ namespace TFE_Jedi
 	// Window
 	extern s32 s_minScreenX_Pixels;
 	extern s32 s_maxScreenX_Pixels;
-	extern s32 s_windowMinX_Pixels;
-	extern s32 s_windowMaxX_Pixels;
-	extern s32 s_windowMinY_Pixels;
-	extern s32 s_windowMaxY_Pixels;
-	extern s32 s_windowMaxCeil;
-	extern s32 s_windowMinFloor;
+	extern thread_local s32 s_windowMinX_Pixels;
+	extern thread_local s32 s_windowMaxX_Pixels;
+	extern thread_local s32 s_windowMinY_Pixels;
+	extern thread_local s32 s_windowMaxY_Pixels;
+	extern thread_local s32 s_windowMaxCeil;
+	extern thread_local s32 s_windowMinFloor;
 	extern s32 s_screenWidth;
 	
 	// Display
 	extern u8* s_display;
 
 	// Render
-	extern RSector* s_prevSector;
-	extern s32 s_sectorIndex;
-	extern s32 s_maxAdjoinIndex;
-	extern s32 s_adjoinIndex;
-	extern s32 s_maxAdjoinDepth;
-	extern s32 s_windowX0;
-	extern s32 s_windowX1;
+	extern thread_local RSector* s_prevSector;
+	extern thread_local s32 s_sectorIndex;
+	extern thread_local s32 s_maxAdjoinIndex;
+	extern thread_local s32 s_adjoinIndex;
+	extern thread_local s32 s_maxAdjoinDepth;
+	extern thread_local s32 s_windowX0;
+	extern thread_local s32 s_windowX1;
 
 	// Column Heights
-	extern s32* s_columnTop;
-	extern s32* s_columnBot;
-	extern s32* s_windowTop_all;
-	extern s32* s_windowBot_all;
-	extern s32* s_windowTop;
-	extern s32* s_windowBot;
-	extern s32* s_windowTopPrev;
-	extern s32* s_windowBotPrev;
+	extern thread_local s32* s_columnTop;
+	extern thread_local s32* s_columnBot;
+	extern thread_local s32* s_windowTop_all;
+	extern thread_local s32* s_windowBot_all;
+	extern thread_local s32* s_windowTop;
+	extern thread_local s32* s_windowBot;
+	extern thread_local s32* s_windowTopPrev;
+	extern thread_local s32* s_windowBotPrev;
 
-	extern s32* s_objWindowTop;
-	extern s32* s_objWindowBot;
+	extern thread_local s32* s_objWindowTop;
+	extern thread_local s32* s_objWindowBot;
 	
 	// WallSegments
-	extern s32 s_nextWall;
-	extern s32 s_curWallSeg;
-	extern s32 s_adjoinSegCount;
-	extern s32 s_adjoinDepth;
+	extern thread_local s32 s_nextWall;
+	extern thread_local s32 s_curWallSeg;
+	extern thread_local s32 s_adjoinSegCount;
+	extern thread_local s32 s_adjoinDepth;
 	extern s32 s_drawFrame;
 		
 	// Flats
-	extern s32 s_flatCount;
-	extern s32 s_wallMaxCeilY;
-	extern s32 s_wallMinFloorY;
+	extern thread_local s32 s_flatCount;
+	extern thread_local s32 s_wallMaxCeilY;
+	extern thread_local s32 s_wallMinFloorY;
 	
 	// Lighting
 	extern const u8* s_colorMap;
 	extern const u8* s_lightSourceRamp;
 	extern s32 s_flatAmbient;
-	extern s32 s_sectorAmbient;
-	extern s32 s_scaledAmbient;
+	extern thread_local s32 s_sectorAmbient;
+	extern thread_local s32 s_scaledAmbient;
 	extern s32 s_cameraLightSource;
 	extern JBool s_enableFlatShading;
 	extern s32 s_worldAmbient;
-	extern s32 s_sectorAmbientFraction;
+	extern thread_local s32 s_sectorAmbientFraction;
 	extern s32 s_lightCount;	// Number of directional lights that affect 3D objects.
 
 	extern JBool s_flatLighting;
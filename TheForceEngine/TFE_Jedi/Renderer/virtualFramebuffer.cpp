@@ -27,6 +27,7 @@ namespace TFE_Jedi
 
 	static FramebufferMode s_mode = VFB_TEXTURE;
 	static FramebufferMode s_nextMode = VFB_TEXTURE;
+	static bool s_headless = false;
 
 	void vfb_createVirtualDisplay(u32 width, u32 height);
 		
@@ -130,9 +131,15 @@ namespace TFE_Jedi
 	void vfb_setPalette(const u32* palette)
 	{
 		memcpy(s_palette, palette, sizeof(u32) * 256);
+		if (s_headless) { return; }
 		TFE_RenderBackend::setPalette(palette);
 	}
 
+	void vfb_setHeadless(bool headless)
+	{
+		s_headless = headless;
+	}
+
 	void vfb_setMode(FramebufferMode mode)
 	{
 		s_nextMode = mode;
@@ -192,6 +199,7 @@ namespace TFE_Jedi
 	// Frame rendering is done, copy the results to GPU memory.
 	void vfb_swap()
 	{
+		if (s_headless) { return; }
 		TFE_RenderBackend::updateVirtualDisplay(s_curFrameBuffer, s_width * s_height);
 	}
 
@@ -240,6 +248,8 @@ namespace TFE_Jedi
 	////////////////////////////
 	void vfb_createVirtualDisplay(u32 width, u32 height)
 	{
+		if (s_headless) { return; }
+
 		// Setup or update the virtual display.
 		TFE_Settings_Graphics* graphics = TFE_Settings::getGraphicsSettings();
 		u32 vdispFlags = 0;
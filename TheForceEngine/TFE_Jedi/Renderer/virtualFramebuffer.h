@@ -43,6 +43,8 @@ namespace TFE_Jedi
 	void vfb_setPalette(const u32* palette);
 	void vfb_setMode(FramebufferMode mode = VFB_TEXTURE);
 	u32* vfb_getPalette();
+	// Headless mode keeps the CPU buffer but never touches the render backend (see TFE_Game/timeDemo.h).
+	void vfb_setHeadless(bool headless);
 
 	////////////////////////////
 	// Get Scale Factors
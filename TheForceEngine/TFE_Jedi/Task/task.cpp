@@ -9,6 +9,9 @@
 #include <TFE_FrontEndUI/console.h>
 #include <TFE_Jedi/Serialization/serialization.h>
 #include <stdarg.h>
+#include <algorithm>
+#include <map>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -63,6 +66,14 @@ struct Task
 
 	// Timing.
 	Tick nextTick;
+
+	// Scheduling.
+	u64 order;			// Position in execution order, see the scheduler below.
+	u32 schedState;		// TaskScheduleState
+	u32 timerId;		// Matches the pending timer entry while waiting.
+
+	// Profiling.
+	s32 profileId;		// Index of the per-name profile entry, -1 until first run while profiling.
 };
 
 namespace TFE_Jedi
@@ -96,15 +107,497 @@ namespace TFE_Jedi
 
 	void selectNextTask();
 
-	void createRootTask()
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// Scheduler
+	// Tasks run in list order: for each task in the root list, its sub-tasks run first (recursively)
+	// followed by the task itself. Rather than walking the whole list every frame and testing every
+	// task, each task is given an order key that matches its position in this sequence and only
+	// tasks that can run are kept in 'ready' (sorted by that key).
+	// Tasks waiting for a future tick are kept in a min-heap until that tick is reached and
+	// sleeping tasks are not tracked at all until they are woken up by task_makeActive() or
+	// task_setNextTick(). This keeps the execution order exactly the same while only visiting
+	// tasks that actually run.
+	//////////////////////////////////////////////////////////////////////////////////////////
+	enum TaskScheduleState
 	{
-		s_tasks = createChunkedArray(sizeof(Task), TASK_CHUNK_SIZE, TASK_PREALLOCATED_CHUNKS, s_gameRegion);
-		s_stackBlocks = createChunkedArray(TASK_STACK_SIZE, TASK_STACK_CHUNK_SIZE, TASK_PREALLOCATED_CHUNKS, s_gameRegion);
+		TSCHED_NONE = 0,	// Sleeping or freed.
+		TSCHED_READY,		// In s_readyTasks.
+		TSCHED_TIMER,		// In s_timers.
+	};
+
+	struct TaskTimer
+	{
+		Tick tick;
+		u32 id;
+		Task* task;
+	};
+
+	// New tasks are inserted at the start of the sequence, so leave plenty of room before the first key.
+	static const u64 c_orderSpacing = 1ull << 24;
+	static const u64 c_orderStart = 1ull << 61;
+	static const u64 c_rootOrder = 1ull << 62;
+
+	static std::map<u64, Task*> s_readyTasks;
+	static std::vector<TaskTimer> s_timers;
+	static u32 s_timerId = 0;
+	static s32 s_timerCount = 0;
+
+	// std heap functions build a max-heap, so reverse the comparison.
+	static bool timerLater(const TaskTimer& a, const TaskTimer& b)
+	{
+		return a.tick > b.tick || (a.tick == b.tick && a.id > b.id);
+	}
+
+	static void sched_clear()
+	{
+		s_readyTasks.clear();
+		s_timers.clear();
+		s_timerId = 0;
+	}
+
+	static void sched_remove(Task* task)
+	{
+		if (task->schedState == TSCHED_READY)
+		{
+			s_readyTasks.erase(task->order);
+		}
+		// Timer entries are removed lazily, a stale entry no longer matches the task timer id.
+		task->schedState = TSCHED_NONE;
+	}
+
+	static void sched_compactTimers()
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < s_timers.size(); i++)
+		{
+			const TaskTimer& timer = s_timers[i];
+			if (timer.task->schedState == TSCHED_TIMER && timer.task->timerId == timer.id)
+			{
+				s_timers[count++] = timer;
+			}
+		}
+		s_timers.resize(count);
+		std::make_heap(s_timers.begin(), s_timers.end(), timerLater);
+	}
 
+	// Place the task in the correct structure based on its current nextTick.
+	static void sched_update(Task* task)
+	{
+		// The root task never runs.
+		if (task == &s_rootTask) { return; }
+
+		if (task->framebreak || task->nextTick <= s_curTick)
+		{
+			if (task->schedState != TSCHED_READY)
+			{
+				task->schedState = TSCHED_READY;
+				s_readyTasks[task->order] = task;
+			}
+			return;
+		}
+
+		sched_remove(task);
+		if (task->nextTick != TASK_SLEEP)
+		{
+			task->schedState = TSCHED_TIMER;
+			task->timerId = ++s_timerId;
+			s_timers.push_back({ task->nextTick, task->timerId, task });
+			std::push_heap(s_timers.begin(), s_timers.end(), timerLater);
+
+			// Tasks that are rescheduled before their timer expires leave stale entries behind.
+			if (s_timers.size() > 2 * size_t(s_taskCount) + 64)
+			{
+				sched_compactTimers();
+			}
+		}
+	}
+
+	// Move tasks whose timers have expired to the ready set.
+	static void sched_updateTimers()
+	{
+		while (!s_timers.empty() && s_timers.front().tick <= s_curTick)
+		{
+			const TaskTimer timer = s_timers.front();
+			std::pop_heap(s_timers.begin(), s_timers.end(), timerLater);
+			s_timers.pop_back();
+
+			Task* task = timer.task;
+			if (task->schedState == TSCHED_TIMER && task->timerId == timer.id)
+			{
+				task->schedState = TSCHED_READY;
+				s_readyTasks[task->order] = task;
+			}
+		}
+		s_timerCount = s32(s_timers.size());
+	}
+
+	static Task* sched_firstLeaf(Task* task)
+	{
+		while (task->subtaskNext)
+		{
+			task = task->subtaskNext;
+		}
+		return task;
+	}
+
+	// The next task in execution order, this matches the list walk in the original selectNextTask().
+	static Task* sched_nextInOrder(Task* task)
+	{
+		if (task->next)
+		{
+			return sched_firstLeaf(task->next);
+		}
+		return task->subtaskParent;
+	}
+
+	// Order key of the task that runs right before any task in the sub-tree of 'task', 0 if it is first.
+	// The root task runs last, so the sequence starts with the task after the root.
+	static u64 sched_orderBefore(Task* task)
+	{
+		while (task->subtaskParent && !task->prev)
+		{
+			task = task->subtaskParent;
+		}
+		if (task->subtaskParent)
+		{
+			return task->prev->order;
+		}
+		return (task->prev == &s_rootTask || task->prev == task) ? 0 : task->prev->order;
+	}
+
+	// Re-assign all order keys with even spacing, only needed when keys have been split too many times.
+	static void sched_reorder()
+	{
+		std::vector<Task*> ready;
+		ready.reserve(s_readyTasks.size());
+		for (std::map<u64, Task*>::iterator iTask = s_readyTasks.begin(); iTask != s_readyTasks.end(); ++iTask)
+		{
+			ready.push_back(iTask->second);
+		}
+
+		u64 order = c_orderStart;
+		for (Task* task = sched_nextInOrder(&s_rootTask); task && task != &s_rootTask; task = sched_nextInOrder(task))
+		{
+			task->order = order;
+			order += c_orderSpacing;
+		}
+		s_rootTask.order = std::max(order, c_rootOrder);
+
+		s_readyTasks.clear();
+		for (size_t i = 0; i < ready.size(); i++)
+		{
+			s_readyTasks[ready[i]->order] = ready[i];
+		}
+	}
+
+	// Assign the order key of a newly linked task, which has no sub-tasks yet.
+	static void sched_insert(Task* task)
+	{
+		const u64 before = sched_orderBefore(task);
+		const u64 after = sched_nextInOrder(task)->order;
+		if (after > before + 1)
+		{
+			// Step back from the first key rather than splitting the (huge) range in half.
+			const u64 step = (after - before) / 2;
+			task->order = before ? before + step : after - std::min(step, c_orderSpacing);
+		}
+		else
+		{
+			sched_reorder();
+		}
+		task->schedState = TSCHED_NONE;
+		task->timerId = 0;
+		sched_update(task);
+	}
+
+	static void sched_resetRoot()
+	{
 		s_rootTask = { 0 };
 		s_rootTask.prev = &s_rootTask;
 		s_rootTask.next = &s_rootTask;
 		s_rootTask.nextTick = TASK_SLEEP;
+		s_rootTask.order = c_rootOrder;
+		sched_clear();
+	}
+
+	//////////////////////////////////////////////////////////////////////////////////////////
+	// Profiling
+	// Per-task and per-function timing, gathered in task_run() while d_taskProfile is enabled.
+	// Entries are never removed (only reset), so tasks can cache their entry index.
+	//////////////////////////////////////////////////////////////////////////////////////////
+	enum TaskProfileGroup
+	{
+		TPROF_BY_NAME = 0,
+		TPROF_BY_FUNC,
+		TPROF_GROUP_COUNT
+	};
+
+	struct TaskProfileEntry
+	{
+		TaskProfile info;
+		// Accumulated during the current frame.
+		u32 calls;
+		f64 time;
+	};
+
+	static bool s_taskProfile = false;
+	static std::vector<TaskProfileEntry> s_profileEntries[TPROF_GROUP_COUNT];
+	static std::map<std::string, s32> s_profileByName;
+	static std::map<TaskFunc, s32> s_profileByFunc;
+
+	static const char* c_profileSortNames[TASK_SORT_COUNT] =
+	{
+		"time",		// TASK_SORT_TIME
+		"frame",	// TASK_SORT_TIME_FRAME
+		"max",		// TASK_SORT_TIME_MAX
+		"total",	// TASK_SORT_TIME_TOTAL
+		"calls",	// TASK_SORT_CALLS
+		"sleeps",	// TASK_SORT_SLEEPS
+		"waits",	// TASK_SORT_WAITS
+		"wakes",	// TASK_SORT_WAKES
+		"name",		// TASK_SORT_NAME
+	};
+
+	static s32 profile_addEntry(TaskProfileGroup group, const char* name, TaskFunc func)
+	{
+		TaskProfileEntry entry = {};
+		strncpy(entry.info.name, name, sizeof(entry.info.name) - 1);
+		entry.info.func = func;
+
+		s_profileEntries[group].push_back(entry);
+		return s32(s_profileEntries[group].size()) - 1;
+	}
+
+	static s32 profile_getTaskEntry(Task* task)
+	{
+		if (task->profileId < 0)
+		{
+			std::map<std::string, s32>::iterator iEntry = s_profileByName.find(task->name);
+			if (iEntry == s_profileByName.end())
+			{
+				iEntry = s_profileByName.insert({ task->name, profile_addEntry(TPROF_BY_NAME, task->name, nullptr) }).first;
+			}
+			task->profileId = iEntry->second;
+		}
+		return task->profileId;
+	}
+
+	static s32 profile_getFuncEntry(TaskFunc func, const char* taskName)
+	{
+		std::map<TaskFunc, s32>::iterator iEntry = s_profileByFunc.find(func);
+		if (iEntry == s_profileByFunc.end())
+		{
+			iEntry = s_profileByFunc.insert({ func, profile_addEntry(TPROF_BY_FUNC, taskName, func) }).first;
+		}
+		return iEntry->second;
+	}
+
+	static void profile_addTime(TaskProfileEntry* entry, f64 time)
+	{
+		entry->calls++;
+		entry->time += time;
+		entry->info.callsTotal++;
+		entry->info.timeTotal += time;
+		entry->info.timeMax = std::max(entry->info.timeMax, time);
+	}
+
+	// Called at the start of each task frame, to move the accumulated values into the visible statistics.
+	static void profile_frameBegin()
+	{
+		const f64 expBlend = 0.99;
+		for (s32 g = 0; g < TPROF_GROUP_COUNT; g++)
+		{
+			const size_t count = s_profileEntries[g].size();
+			TaskProfileEntry* entry = s_profileEntries[g].data();
+			for (size_t i = 0; i < count; i++, entry++)
+			{
+				entry->info.callsInFrame = entry->calls;
+				entry->info.timeInFrame = entry->time;
+				entry->info.timeAve = expBlend * entry->info.timeAve + (1.0 - expBlend) * entry->time;
+				entry->calls = 0;
+				entry->time = 0.0;
+			}
+		}
+	}
+
+	static void profile_yield(Task* task, Tick delay)
+	{
+		if (!s_taskProfile) { return; }
+		TaskProfile* info = &s_profileEntries[TPROF_BY_NAME][profile_getTaskEntry(task)].info;
+		if (delay == TASK_SLEEP)
+		{
+			info->sleeps++;
+		}
+		else if (delay != TASK_NO_DELAY)
+		{
+			info->waits++;
+		}
+	}
+
+	static void profile_wake(Task* task, Tick nextTick)
+	{
+		if (!s_taskProfile || task->nextTick != TASK_SLEEP || nextTick == TASK_SLEEP) { return; }
+		s_profileEntries[TPROF_BY_NAME][profile_getTaskEntry(task)].info.wakes++;
+	}
+
+	// Run the current task, recording its time if profiling is enabled.
+	static void runCurrentTask(TaskFunc runFunc)
+	{
+		if (!s_taskProfile)
+		{
+			runFunc(s_currentMsg);
+			return;
+		}
+
+		// The task may be freed while running, so get the entries first.
+		// Entries may also be added while running, so only use the indices.
+		const s32 taskEntry = profile_getTaskEntry(s_curTask);
+		const s32 funcEntry = profile_getFuncEntry(runFunc, s_curTask->name);
+
+		const u64 start = TFE_System::getCurrentTimeInTicks();
+		runFunc(s_currentMsg);
+		const f64 time = TFE_System::convertFromTicksToSeconds(TFE_System::getCurrentTimeInTicks() - start);
+
+		profile_addTime(&s_profileEntries[TPROF_BY_NAME][taskEntry], time);
+		profile_addTime(&s_profileEntries[TPROF_BY_FUNC][funcEntry], time);
+	}
+
+	void task_enableProfiling(bool enable)
+	{
+		s_taskProfile = enable;
+	}
+
+	bool task_isProfilingEnabled()
+	{
+		return s_taskProfile;
+	}
+
+	void task_resetProfile()
+	{
+		for (s32 g = 0; g < TPROF_GROUP_COUNT; g++)
+		{
+			const size_t count = s_profileEntries[g].size();
+			TaskProfileEntry* entry = s_profileEntries[g].data();
+			for (size_t i = 0; i < count; i++, entry++)
+			{
+				TaskProfileEntry cleared = {};
+				memcpy(cleared.info.name, entry->info.name, sizeof(cleared.info.name));
+				cleared.info.func = entry->info.func;
+				*entry = cleared;
+			}
+		}
+	}
+
+	static f64 profile_getSortValue(const TaskProfile& info, TaskProfileSort sort)
+	{
+		switch (sort)
+		{
+			case TASK_SORT_TIME:       return info.timeAve;
+			case TASK_SORT_TIME_FRAME: return info.timeInFrame;
+			case TASK_SORT_TIME_MAX:   return info.timeMax;
+			case TASK_SORT_TIME_TOTAL: return info.timeTotal;
+			case TASK_SORT_CALLS:      return f64(info.callsTotal);
+			case TASK_SORT_SLEEPS:     return f64(info.sleeps);
+			case TASK_SORT_WAITS:      return f64(info.waits);
+			case TASK_SORT_WAKES:      return f64(info.wakes);
+			default:                   break;
+		}
+		return 0.0;
+	}
+
+	void task_getProfile(bool byFunction, std::vector<TaskProfile>& entries, TaskProfileSort sort, bool descending)
+	{
+		const std::vector<TaskProfileEntry>& src = s_profileEntries[byFunction ? TPROF_BY_FUNC : TPROF_BY_NAME];
+		entries.resize(src.size());
+		for (size_t i = 0; i < src.size(); i++)
+		{
+			entries[i] = src[i].info;
+		}
+
+		std::stable_sort(entries.begin(), entries.end(), [sort, descending](const TaskProfile& a, const TaskProfile& b)
+		{
+			if (sort == TASK_SORT_NAME)
+			{
+				const s32 cmp = strcasecmp(a.name, b.name);
+				return descending ? cmp > 0 : cmp < 0;
+			}
+			const f64 va = profile_getSortValue(a, sort);
+			const f64 vb = profile_getSortValue(b, sort);
+			return descending ? va > vb : va < vb;
+		});
+	}
+
+	// taskProfile [on|off|reset] [func] [time|frame|max|total|calls|sleeps|waits|wakes|name] [count]
+	static void console_taskProfile(const ConsoleArgList& args)
+	{
+		bool byFunction = false;
+		TaskProfileSort sort = TASK_SORT_TIME;
+		s32 count = 20;
+		for (size_t a = 1; a < args.size(); a++)
+		{
+			const char* arg = args[a].c_str();
+			if (strcasecmp(arg, "on") == 0 || strcasecmp(arg, "off") == 0)
+			{
+				s_taskProfile = strcasecmp(arg, "on") == 0;
+				TFE_Console::addToHistory(s_taskProfile ? "Task profiling enabled." : "Task profiling disabled.");
+				return;
+			}
+			else if (strcasecmp(arg, "reset") == 0)
+			{
+				task_resetProfile();
+				return;
+			}
+			else if (strcasecmp(arg, "func") == 0)
+			{
+				byFunction = true;
+			}
+			else if (arg[0] >= '0' && arg[0] <= '9')
+			{
+				count = atoi(arg);
+			}
+			else
+			{
+				for (s32 s = 0; s < TASK_SORT_COUNT; s++)
+				{
+					if (strcasecmp(arg, c_profileSortNames[s]) == 0) { sort = TaskProfileSort(s); }
+				}
+			}
+		}
+
+		if (!s_taskProfile)
+		{
+			TFE_Console::addToHistory("Task profiling is disabled, use \"taskProfile on\" or set d_taskProfile to enable it.");
+		}
+
+		std::vector<TaskProfile> entries;
+		task_getProfile(byFunction, entries, sort, sort != TASK_SORT_NAME);
+
+		char line[256];
+		TFE_Console::addToHistory("  ave ms    max ms    total s      calls   sleeps  waits   wakes   name");
+		count = std::min(count, s32(entries.size()));
+		for (s32 i = 0; i < count; i++)
+		{
+			const TaskProfile& info = entries[i];
+			if (byFunction)
+			{
+				snprintf(line, sizeof(line), "%8.3f  %8.3f  %9.3f  %9u  -       -       -       %s [%p]", info.timeAve * 1000.0, info.timeMax * 1000.0,
+					info.timeTotal, info.callsTotal, info.name, (void*)info.func);
+			}
+			else
+			{
+				snprintf(line, sizeof(line), "%8.3f  %8.3f  %9.3f  %9u  %-6u  %-6u  %-6u  %s", info.timeAve * 1000.0, info.timeMax * 1000.0,
+					info.timeTotal, info.callsTotal, info.sleeps, info.waits, info.wakes, info.name);
+			}
+			TFE_Console::addToHistory(line);
+		}
+	}
+
+	void createRootTask()
+	{
+		s_tasks = createChunkedArray(sizeof(Task), TASK_CHUNK_SIZE, TASK_PREALLOCATED_CHUNKS, s_gameRegion);
+		s_stackBlocks = createChunkedArray(TASK_STACK_SIZE, TASK_STACK_CHUNK_SIZE, TASK_PREALLOCATED_CHUNKS, s_gameRegion);
+
+		sched_resetRoot();
 
 		s_taskIter = &s_rootTask;
 		s_curTask = &s_rootTask;
@@ -112,6 +605,8 @@ namespace TFE_Jedi
 		s_frameActiveTaskCount = 0;
 
 		CVAR_BOOL(s_enableTimeLimiter, "d_enableTaskTimeLimiter", CVFLAG_DO_NOT_SERIALIZE, "Enable the task time limiter.");
+		CVAR_BOOL(s_taskProfile, "d_taskProfile", CVFLAG_DO_NOT_SERIALIZE, "Collect per-task timing, shown in the profiler view and by taskProfile.");
+		CCMD("taskProfile", console_taskProfile, 0, "Show per-task timing - taskProfile [on|off|reset] [func] [time|frame|max|total|calls|sleeps|waits|wakes|name] [count]");
 	}
 
 	Task* createSubTask(const char* name, TaskFunc func, TaskFunc localRunFunc)
@@ -150,6 +645,9 @@ namespace TFE_Jedi
 		newTask->context.callstack[0] = func;
 		newTask->localRunFunc = localRunFunc;
 		newTask->context.level = TASK_INIT_LEVEL;
+		newTask->profileId = -1;
+
+		sched_insert(newTask);
 		return newTask;
 	}
 
@@ -186,7 +684,9 @@ namespace TFE_Jedi
 		newTask->localRunFunc = localRunFunc;
 		newTask->context.level = TASK_INIT_LEVEL;
 		newTask->nextTick = s_curTick;
+		newTask->profileId = -1;
 
+		sched_insert(newTask);
 		return newTask;
 	}
 	
@@ -195,6 +695,7 @@ namespace TFE_Jedi
 		SERIALIZE(SaveVersionInit, task->context.ip[0], 0);
 		SERIALIZE(SaveVersionInit, task->context.stackSize[0], 0);
 		SERIALIZE(SaveVersionInit, task->nextTick, 0);
+		sched_update(task);
 		if (serialization_getMode() == SMODE_READ && !task->context.stackMem)
 		{
 			task->context.stackMem = (u8*)allocFromChunkedArray(s_stackBlocks);
@@ -238,6 +739,7 @@ namespace TFE_Jedi
 			selectNextTask();
 		}
 		// Then remove the task.
+		sched_remove(task);
 		if (task->prev)
 		{
 			task->prev->next = task->next;
@@ -268,10 +770,7 @@ namespace TFE_Jedi
 
 	void task_reset()
 	{
-		s_rootTask = { 0 };
-		s_rootTask.prev = &s_rootTask;
-		s_rootTask.next = &s_rootTask;
-		s_rootTask.nextTick = TASK_SLEEP;
+		sched_resetRoot();
 
 		s_taskIter = &s_rootTask;
 		s_curTask = &s_rootTask;
@@ -286,6 +785,7 @@ namespace TFE_Jedi
 	{
 		chunkedArrayClear(s_tasks);
 		chunkedArrayClear(s_stackBlocks);
+		sched_clear();
 
 		s_curTask    = nullptr;
 		s_curContext = nullptr;
@@ -296,6 +796,9 @@ namespace TFE_Jedi
 	{
 		freeChunkedArray(s_tasks);
 		freeChunkedArray(s_stackBlocks);
+		sched_clear();
+		s_readyTasks = std::map<u64, Task*>();
+		s_timers = std::vector<TaskTimer>();
 
 		s_curTask     = nullptr;
 		s_taskIter    = nullptr;
@@ -313,12 +816,16 @@ namespace TFE_Jedi
 
 	void task_makeActive(Task* task)
 	{
+		profile_wake(task, 0);
 		task->nextTick = 0;
+		sched_update(task);
 	}
 
 	void task_setNextTick(Task* task, Tick tick)
 	{
+		profile_wake(task, tick);
 		task->nextTick = tick;
+		sched_update(task);
 	}
 
 	void task_setUserData(Task* task, void* data)
@@ -400,50 +907,28 @@ namespace TFE_Jedi
 	void selectNextTask()
 	{
 		// Find the next task to run.
-		Task* task = s_curTask;
-		while (1)
-		{
-			//////////////////////////////////////////////////////////////////////////////////////////
-			// Execution:
-			//  * Go to the next task
-			//  * Check to see if there are sub-tasks
-			//  * If so, the assign current to the sub-task.
-			//  * Execute the task.
-			//  * Once we are on the last sub-task, then go back to the parent.
-			//  * Once the parent executes, then we move on to parent->next and start all over.
-			if (task->next)
-			{
-				// Move the to the next task.
-				task = task->next;
-				// If the task has sub-tasks, loop until we find the last one.
-				// This is usually only one deep.
-				while (task->subtaskNext)
-				{
-					task = task->subtaskNext;
-				}
-				// Then execute the task.
-				if (task->nextTick <= s_curTick || task->framebreak)
-				{
-					s_currentMsg = MSG_RUN_TASK;
-					s_curTask = task;
-					return;
-				}
-			}
-			else if (task->subtaskParent)
+		//  * Tasks run in order, sub-tasks run before their parent and once the parent executes we move on to parent->next.
+		//  * A task can run if it is the "framebreak" task or its nextTick has been reached.
+		//  * Once the end of the list is reached, wrap around to the beginning (which may be the current task).
+		sched_updateTimers();
+		std::map<u64, Task*>::iterator iTask = s_readyTasks.upper_bound(s_curTask ? s_curTask->order : 0);
+		while (!s_readyTasks.empty())
+		{
+			if (iTask == s_readyTasks.end())
 			{
-				// Otherwise, try to execute the parent.
-				task = task->subtaskParent;
-				if (task->nextTick <= s_curTick || task->framebreak)
-				{
-					s_currentMsg = MSG_RUN_TASK;
-					s_curTask = task;
-					return;
-				}
+				iTask = s_readyTasks.begin();
 			}
-			else
+
+			Task* task = iTask->second;
+			if (task->nextTick <= s_curTick || task->framebreak)
 			{
-				break;
+				s_currentMsg = MSG_RUN_TASK;
+				s_curTask = task;
+				return;
 			}
+			// The current tick moved backwards (level load or restart), so the task has to wait again.
+			++iTask;
+			sched_update(task);
 		}
 
 		// If no selection is possible, assign the first task.
@@ -512,7 +997,9 @@ namespace TFE_Jedi
 		}
 
 		// Update the current tick based on the delay.
+		profile_yield(s_curTask, delay);
 		s_curTask->nextTick = (delay < TASK_SLEEP) ? s_curTick + delay : delay;
+		sched_update(s_curTask);
 		
 		// Find the next task to run.
 		selectNextTask();
@@ -564,6 +1051,10 @@ namespace TFE_Jedi
 		s_prevTime = time;
 		s_currentMsg = MSG_RUN_TASK;
 		s_frameActiveTaskCount = 0;
+		if (s_taskProfile)
+		{
+			profile_frameBegin();
+		}
 
 		// Return if the task system is paused.
 		if (s_taskSystemPaused)
@@ -582,7 +1073,7 @@ namespace TFE_Jedi
 
 					if (runFunc)
 					{
-						runFunc(s_currentMsg);
+						runCurrentTask(runFunc);
 					}
 				}
 			}
@@ -610,7 +1101,7 @@ namespace TFE_Jedi
 
 				if (runFunc)
 				{
-					runFunc(s_currentMsg);
+					runCurrentTask(runFunc);
 				}
 			}
 			else
@@ -633,6 +1124,7 @@ namespace TFE_Jedi
 
 		TFE_COUNTER(s_taskCount, "Task Count");
 		TFE_COUNTER(s_frameActiveTaskCount, "Active Tasks");
+		TFE_COUNTER(s_timerCount, "Task Timers");
 	}
 
 	s32 task_getCount()
@@ -15,6 +15,7 @@
 #include <TFE_FileSystem/filestream.h>
 #include <TFE_DarkForces/time.h>
 #include <TFE_Jedi/InfSystem/message.h>
+#include <vector>
 
 struct Task;
 #include "taskMacros.h"
@@ -30,6 +31,37 @@ typedef void(*LocalMemorySerCallback)(Stream* stream, void* userData, void* mem)
 // Task System API
 namespace TFE_Jedi
 {
+	enum TaskProfileSort
+	{
+		TASK_SORT_TIME = 0,		// Average time per frame.
+		TASK_SORT_TIME_FRAME,	// Time during the last frame.
+		TASK_SORT_TIME_MAX,
+		TASK_SORT_TIME_TOTAL,
+		TASK_SORT_CALLS,
+		TASK_SORT_SLEEPS,
+		TASK_SORT_WAITS,
+		TASK_SORT_WAKES,
+		TASK_SORT_NAME,
+		TASK_SORT_COUNT
+	};
+
+	struct TaskProfile
+	{
+		char name[32];		// Task name, for functions this is the first task seen running it.
+		TaskFunc func;		// Task function, null when grouped by task name.
+
+		u32 callsInFrame;	// Invocations during the last frame.
+		u32 callsTotal;
+		f64 timeInFrame;	// Time in seconds spent during the last frame.
+		f64 timeAve;		// Smoothed time per frame.
+		f64 timeMax;		// Longest single invocation.
+		f64 timeTotal;
+
+		u32 sleeps;			// Number of task_yield(TASK_SLEEP).
+		u32 waits;			// Number of task_yield(delay) with a delay.
+		u32 wakes;			// Number of times woken up from sleep.
+	};
+
 	// Create a "main" task. Generally, main tasks are executed in the order created.
 	Task* createTask(const char* name, TaskFunc func, JBool framebreak = JFALSE, TaskFunc localRunFunc = nullptr);
 	// Create a "subtask" under the current task. All sub-tasks under a main task are executed *before* that main task.
@@ -76,6 +108,13 @@ namespace TFE_Jedi
 
 	void task_updateTime();
 	s32 task_getCount();
+
+	// Per-task CPU accounting, collected by task_run() while enabled (d_taskProfile).
+	// Statistics are grouped either by task name (all instances of a task) or by task function.
+	void task_enableProfiling(bool enable);
+	bool task_isProfilingEnabled();
+	void task_resetProfile();
+	void task_getProfile(bool byFunction, std::vector<TaskProfile>& entries, TaskProfileSort sort = TASK_SORT_TIME, bool descending = true);
 }
 ////////////////////////////////////////////////////////////////////////
 // Task Function API:
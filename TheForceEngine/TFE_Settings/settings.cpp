@@ -409,6 +409,8 @@ namespace TFE_Settings
 		writeKeyValue_Bool(settings, "colorCorrection", s_graphicsSettings.colorCorrection);
 		writeKeyValue_Bool(settings, "perspectiveCorrect3DO", s_graphicsSettings.perspectiveCorrectTexturing);
 		writeKeyValue_Bool(settings, "extendAjoinLimits", s_graphicsSettings.extendAjoinLimits);
+		writeKeyValue_Bool(settings, "multithreadedRender", s_graphicsSettings.multithreadedRender);
+		writeKeyValue_Int(settings, "renderThreadCount", s_graphicsSettings.renderThreadCount);
 		writeKeyValue_Bool(settings, "vsync", s_graphicsSettings.vsync);
 		writeKeyValue_Bool(settings, "show_fps", s_graphicsSettings.showFps);
 		writeKeyValue_Bool(settings, "3doNormalFix", s_graphicsSettings.fix3doNormalOverflow);
@@ -474,6 +476,8 @@ namespace TFE_Settings
 		writeKeyValue_Int(settings, "audioDevice", s_soundSettings.audioDevice);
 		writeKeyValue_Int(settings, "midiOutput", s_soundSettings.midiOutput);
 		writeKeyValue_Int(settings, "midiType", s_soundSettings.midiType);
+		writeKeyValue_Int(settings, "midiRenderAheadMs", s_soundSettings.midiRenderAheadMs);
+		writeKeyValue_Int(settings, "sf2Polyphony", s_soundSettings.sf2Polyphony);
 		writeKeyValue_Bool(settings, "use16Channels", s_soundSettings.use16Channels);
 		writeKeyValue_Bool(settings, "disableSoundInMenus", s_soundSettings.disableSoundInMenus);
 	}
@@ -742,6 +746,14 @@ namespace TFE_Settings
 		{
 			s_graphicsSettings.extendAjoinLimits = parseBool(value);
 		}
+		else if (strcasecmp("multithreadedRender", key) == 0)
+		{
+			s_graphicsSettings.multithreadedRender = parseBool(value);
+		}
+		else if (strcasecmp("renderThreadCount", key) == 0)
+		{
+			s_graphicsSettings.renderThreadCount = parseInt(value);
+		}
 		else if (strcasecmp("vsync", key) == 0)
 		{
 			s_graphicsSettings.vsync = parseBool(value);
@@ -948,6 +960,14 @@ namespace TFE_Settings
 		{
 			s_soundSettings.midiType = parseInt(value);
 		}
+		else if (strcasecmp("midiRenderAheadMs", key) == 0)
+		{
+			s_soundSettings.midiRenderAheadMs = parseInt(value);
+		}
+		else if (strcasecmp("sf2Polyphony", key) == 0)
+		{
+			s_soundSettings.sf2Polyphony = parseInt(value);
+		}
 		else if (strcasecmp("use16Channels", key) == 0)
 		{
 			s_soundSettings.use16Channels = parseBool(value);
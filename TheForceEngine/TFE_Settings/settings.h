@@ -63,6 +63,8 @@ struct TFE_Settings_Graphics
 	bool  colorCorrection = false;
 	bool  perspectiveCorrectTexturing = false;
 	bool  extendAjoinLimits = true;
+	bool  multithreadedRender = false;	// Software renderer (above 200p): draw vertical strips on worker threads.
+	s32   renderThreadCount = 0;		// 0 = use the number of logical CPU cores.
 	bool  vsync = true;
 	bool  showFps = false;
 	bool  fix3doNormalOverflow = true;
@@ -184,6 +186,8 @@ struct TFE_Settings_Sound
 	s32 audioDevice = -1;			// Use the audio device default.
 	s32 midiOutput  = -1;			// Use the midi type default.
 	s32 midiType = MIDI_TYPE_DEFAULT;
+	s32 midiRenderAheadMs = 50;		// Synthesized music is rendered this far ahead on the midi thread, 0 renders in the audio callback.
+	s32 sf2Polyphony = 128;			// Maximum number of SoundFont voices that sound at once, 0 only limits by the voice pool.
 	bool use16Channels = false;
 	bool disableSoundInMenus = false;
 };
@@ -64,6 +64,7 @@ namespace TFE_Profiler
 	static u32 s_zoneStack[MAX_ZONE_STACK];
 	static u64 s_currentFrame = 1;
 	static u64 s_currentPath;
+	static thread_local bool s_threadEnabled = true;
 
 	void addZoneChild(u32 parentId, u32 zoneId)
 	{
@@ -104,6 +105,8 @@ namespace TFE_Profiler
 
 	u32 beginZone(const char* name, const char* func, u32 lineNumber)
 	{
+		if (!s_threadEnabled) { return NULL_ZONE; }
+
 		ZoneMap::iterator iZone = s_zoneMap.find(name);
 		u32 id = 0;
 
@@ -152,10 +155,16 @@ namespace TFE_Profiler
 
 	void endZone(u32 id, u64 dt)
 	{
+		if (id == NULL_ZONE) { return; }
 		s_zoneList[id].timeInZone[s_writeBuffer] += TFE_System::convertFromTicksToSeconds(dt);
 		s_level--;
 	}
 
+	void setThreadEnabled(bool enabled)
+	{
+		s_threadEnabled = enabled;
+	}
+
 	void addCounter(const char* name, s32* counter)
 	{
 		ZoneMap::iterator iCounter = s_counterMap.find(name);
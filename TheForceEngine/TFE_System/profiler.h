@@ -61,6 +61,10 @@ namespace TFE_Profiler
 
 	void addCounter(const char* name, s32* counter);
 
+	// Zones are only recorded on the main thread, worker threads should disable recording
+	// and report their timings through the main thread instead.
+	void setThreadEnabled(bool enabled);
+
 	// Profile data API, this is used directly.
 	f64  getTimeInFrame();
 
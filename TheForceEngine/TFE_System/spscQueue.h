@@ -0,0 +1,56 @@
+#pragma once
+//////////////////////////////////////////////////////////////////////
+// The Force Engine Single Producer / Single Consumer Queue
+// A fixed size lock-free ring buffer, safe to use between exactly
+// one producer thread and one consumer thread (such as the game and
+// audio threads). Neither side ever blocks, push() fails when full.
+//////////////////////////////////////////////////////////////////////
+
+#include "types.h"
+
+template <typename T, u32 Capacity>
+class SpscQueue
+{
+	static_assert(Capacity && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two.");
+
+public:
+	SpscQueue() : m_head(0), m_tail(0) {}
+
+	// Producer only.
+	bool push(const T& item)
+	{
+		const u32 tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) >= Capacity)
+		{
+			return false;
+		}
+		m_items[tail & (Capacity - 1)] = item;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only.
+	bool pop(T& item)
+	{
+		const u32 head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		item = m_items[head & (Capacity - 1)];
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Approximate when called from a thread that is neither the producer or consumer.
+	u32  size()  const { return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire); }
+	bool empty() const { return size() == 0; }
+	u32  capacity() const { return Capacity; }
+
+private:
+	T m_items[Capacity];
+	// The indices are free-running and wrap naturally, only the low bits are used to index the items.
+	// Keep them on separate cache lines so the two threads do not contend.
+	alignas(64) atomic_u32 m_head;
+	alignas(64) atomic_u32 m_tail;
+};
@@ -8,10 +8,13 @@
 #include <TFE_Game/igame.h>
 #include <TFE_Game/saveSystem.h>
 #include <TFE_Game/reticle.h>
+#include <TFE_Game/timeDemo.h>
+#include <TFE_Game/audioRender.h>
 #include <TFE_Jedi/InfSystem/infSystem.h>
 #include <TFE_FileSystem/fileutil.h>
 #include <TFE_Audio/audioSystem.h>
 #include <TFE_FileSystem/paths.h>
+#include <TFE_FileSystem/filewriterAsync.h>
 #include <TFE_Polygon/polygon.h>
 #include <TFE_RenderBackend/renderBackend.h>
 #include <TFE_Input/inputMapping.h>
@@ -21,6 +24,7 @@
 #include <TFE_System/frameLimiter.h>
 #include <TFE_System/tfeMessage.h>
 #include <TFE_Jedi/Task/task.h>
+#include <TFE_Jedi/Renderer/virtualFramebuffer.h>
 #include <TFE_RenderShared/texturePacker.h>
 #include <TFE_Asset/paletteAsset.h>
 #include <TFE_Asset/imageAsset.h>
@@ -82,6 +86,8 @@ static const char* s_loadRequestFilename = nullptr;
 
 void parseOption(const char* name, const std::vector<const char*>& values, bool longName);
 bool validatePath();
+int  runTimeDemo(int argc, char* argv[]);
+int  runAudioRender(int argc, char* argv[]);
 
 void handleEvent(SDL_Event& Event)
 {
@@ -553,6 +559,17 @@ int main(int argc, char* argv[])
 	TFE_System::logWrite(LOG_MSG, "Paths", "User Documents: \"%s\"", TFE_Paths::getPath(PATH_USER_DOCUMENTS));
 	TFE_System::logWrite(LOG_MSG, "Paths", "Source Data: \"%s\"",    TFE_Paths::getPath(PATH_SOURCE_DATA));
 
+	// The time demo runs headless and exits once the results are written.
+	if (TFE_TimeDemo::isEnabled())
+	{
+		return runTimeDemo(argc, argv);
+	}
+	// The audio render also runs headless and exits once the file is written.
+	if (TFE_AudioRender::isEnabled())
+	{
+		return runAudioRender(argc, argv);
+	}
+
 	// Create a screenshot directory
 	char screenshotDir[TFE_MAX_PATH];
 	TFE_Paths::appendPath(TFE_PathType::PATH_USER_DOCUMENTS, "Screenshots/", screenshotDir);
@@ -742,6 +759,7 @@ int main(int argc, char* argv[])
 		if (TFE_A11Y::hasPendingFont()) { TFE_A11Y::loadPendingFont(); } // Can't load new fonts between TFE_Ui::begin() and TFE_Ui::render();
 		TFE_Ui::begin();
 		TFE_System::update();
+		TFE_Audio::update();
 
 		#ifdef ENABLE_FORCE_SCRIPT
 			TFE_ForceScript::update();
@@ -948,6 +966,7 @@ int main(int argc, char* argv[])
 	TFE_Jedi::texturepacker_freeGlobal();
 	TFE_RenderBackend::destroy();
 	TFE_SaveSystem::destroy();
+	FileWriterAsync::destroy();
 	SDL_Quit();
 
 	#ifdef ENABLE_FORCE_SCRIPT
@@ -960,6 +979,125 @@ int main(int argc, char* argv[])
 	return PROGRAM_SUCCESS;
 }
 
+// Headless benchmark: no window, GPU device or audio output is created, only the software renderers are available.
+int runTimeDemo(int argc, char* argv[])
+{
+	if (!validatePath())
+	{
+		TFE_System::logWrite(LOG_CRITICAL, "TimeDemo", "Cannot find the game data.");
+		TFE_System::logClose();
+		return PROGRAM_ERROR;
+	}
+	if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) != 0)
+	{
+		TFE_System::logWrite(LOG_CRITICAL, "SDL", "Cannot initialize SDL.");
+		TFE_System::logClose();
+		return PROGRAM_ERROR;
+	}
+	TFE_System::init(0.0f, false, c_gitVersion);
+	TFE_Jedi::vfb_setHeadless(true);
+
+	TFE_Audio::init(true, -1);
+	TFE_MidiPlayer::init(TFE_Settings::getSoundSettings()->midiOutput, (MidiDeviceType)TFE_Settings::getSoundSettings()->midiType);
+	TFE_Image::init();
+	TFE_Palette::createDefault256();
+	game_init();
+	TFE_A11Y::init();
+
+	bool result = false;
+	TFE_Game* gameInfo = TFE_Settings::getGame();
+	s_curGame = createGame(gameInfo->id);
+	if (!s_curGame)
+	{
+		TFE_System::logWrite(LOG_ERROR, "TimeDemo", "Cannot create game '%s'.", gameInfo->game);
+	}
+	else if (!s_curGame->runGame(argc, (const char**)argv, nullptr))
+	{
+		TFE_System::logWrite(LOG_ERROR, "TimeDemo", "Cannot run game '%s'.", gameInfo->game);
+	}
+	else
+	{
+		result = s_curGame->runTimeDemo();
+	}
+
+	if (s_curGame)
+	{
+		freeGame(s_curGame);
+		s_curGame = nullptr;
+	}
+	game_destroy();
+	TFE_TimeDemo::destroy();
+
+	// Settings are overridden for the run, so they are not written back to disk.
+	TFE_Audio::shutdown();
+	TFE_MidiPlayer::destroy();
+	TFE_Image::shutdown();
+	TFE_Palette::freeAll();
+	SDL_Quit();
+
+	TFE_System::logWrite(LOG_MSG, "TimeDemo", "Time demo %s.", result ? "complete" : "failed");
+	TFE_System::logClose();
+	TFE_System::freeMessages();
+	return result ? PROGRAM_SUCCESS : PROGRAM_ERROR;
+}
+
+// Headless offline audio: no window or audio device, iMuse and the midi player are driven in simulated time.
+int runAudioRender(int argc, char* argv[])
+{
+	if (!validatePath())
+	{
+		TFE_System::logWrite(LOG_CRITICAL, "AudioRender", "Cannot find the game data.");
+		TFE_System::logClose();
+		return PROGRAM_ERROR;
+	}
+	if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) != 0)
+	{
+		TFE_System::logWrite(LOG_CRITICAL, "SDL", "Cannot initialize SDL.");
+		TFE_System::logClose();
+		return PROGRAM_ERROR;
+	}
+	TFE_System::init(0.0f, false, c_gitVersion);
+
+	TFE_Audio::initOffline();
+	TFE_MidiPlayer::init(TFE_Settings::getSoundSettings()->midiOutput, (MidiDeviceType)TFE_Settings::getSoundSettings()->midiType, true);
+	game_init();
+	TFE_A11Y::init();
+
+	bool result = false;
+	TFE_Game* gameInfo = TFE_Settings::getGame();
+	s_curGame = createGame(gameInfo->id);
+	if (!s_curGame)
+	{
+		TFE_System::logWrite(LOG_ERROR, "AudioRender", "Cannot create game '%s'.", gameInfo->game);
+	}
+	else if (!s_curGame->runGame(argc, (const char**)argv, nullptr))
+	{
+		TFE_System::logWrite(LOG_ERROR, "AudioRender", "Cannot run game '%s'.", gameInfo->game);
+	}
+	else
+	{
+		result = s_curGame->runAudioRender();
+	}
+
+	if (s_curGame)
+	{
+		freeGame(s_curGame);
+		s_curGame = nullptr;
+	}
+	game_destroy();
+	TFE_AudioRender::destroy();
+
+	// Settings are not written back to disk.
+	TFE_Audio::shutdown();
+	TFE_MidiPlayer::destroy();
+	SDL_Quit();
+
+	TFE_System::logWrite(LOG_MSG, "AudioRender", "Audio render %s.", result ? "complete" : "failed");
+	TFE_System::logClose();
+	TFE_System::freeMessages();
+	return result ? PROGRAM_SUCCESS : PROGRAM_ERROR;
+}
+
 void parseOption(const char* name, const std::vector<const char*>& values, bool longName)
 {
 	if (!longName)	// short names use the same style as the originals.
@@ -1013,5 +1151,57 @@ void parseOption(const char* name, const std::vector<const char*>& values, bool
 		{
 			TFE_Settings::getTempSettings()->skipLoadDelay = true;
 		}
+		else if (strcasecmp(name, "timedemo") == 0 && values.size() >= 2)
+		{
+			// --timedemo SECBASE path.txt
+			if (!TFE_TimeDemo::setLevelAndPath(values[0], values[1]))
+			{
+				TFE_System::logWrite(LOG_ERROR, "CommandLine", "Invalid time demo arguments, expected: --timedemo <level> <path-file>");
+			}
+			s_nullAudioDevice = true;
+		}
+		else if (strcasecmp(name, "renderer") == 0 && values.size() >= 1)
+		{
+			// --renderer float
+			TFE_TimeDemo::setRenderer(values[0]);
+		}
+		else if (strcasecmp(name, "res") == 0 && values.size() >= 1)
+		{
+			// --res 1920x1080
+			TFE_TimeDemo::setResolution(values[0]);
+		}
+		else if (strcasecmp(name, "frames") == 0 && values.size() >= 1)
+		{
+			// --frames 1000
+			TFE_TimeDemo::setFrameCount(values[0]);
+		}
+		else if (strcasecmp(name, "out") == 0 && values.size() >= 1)
+		{
+			// --out results.json
+			TFE_TimeDemo::setOutputFile(values[0]);
+		}
+		else if (strcasecmp(name, "audiorender") == 0 && values.size() >= 2)
+		{
+			// --audiorender SECBASE out.wav
+			if (!TFE_AudioRender::setLevelAndOutput(values[0], values[1]))
+			{
+				TFE_System::logWrite(LOG_ERROR, "CommandLine", "Invalid audio render arguments, expected: --audiorender <level> <out.wav>");
+			}
+		}
+		else if (strcasecmp(name, "seconds") == 0 && values.size() >= 1)
+		{
+			// --seconds 60
+			TFE_AudioRender::setSeconds(values[0]);
+		}
+		else if (strcasecmp(name, "seed") == 0 && values.size() >= 1)
+		{
+			// --seed 12345
+			TFE_AudioRender::setSeed(values[0]);
+		}
+		else if (strcasecmp(name, "statetime") == 0 && values.size() >= 1)
+		{
+			// --statetime 15
+			TFE_AudioRender::setStateTime(values[0]);
+		}
 	}
 }
\ No newline at end of file